@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "boost/asio/io_context.hpp"
+
+#include "osr/routing/profile.h"
+
+namespace osr::backend {
+
+// Requests are grouped by how much work a search of their profile usually
+// does. Every class has its own queue and concurrency limit, so a burst of
+// expensive queries can not occupy all routing threads.
+enum class cost_class : std::uint8_t {
+  kCheap,      // foot, wheelchair, bike, railway, ferry
+  kExpensive,  // car (incl. parking / drop-off), bus
+  kSharing     // bike and car sharing
+};
+
+constexpr auto const kNumCostClasses = 3U;
+
+cost_class get_cost_class(search_profile);
+
+std::string_view to_str(cost_class);
+
+// Admission control in front of the routing thread pool: at most
+// max_concurrent_ requests of a class run at the same time, the others wait
+// in a FIFO queue of their class. A request that waited longer than
+// max_queue_wait_ is not executed anymore but shed (i.e. answered with 503),
+// because the client will most likely have given up already and running it
+// would only delay the requests behind it. Expired requests are shed when a
+// request of their class finishes or a new one is submitted. A request that
+// finds max_queue_length_ requests waiting is shed right away.
+struct admission_control {
+  using clock = std::chrono::steady_clock;
+
+  struct limits {
+    unsigned max_concurrent_;
+    std::chrono::milliseconds max_queue_wait_;  // zero = never shed
+    std::size_t max_queue_length_{0U};  // zero = unlimited
+  };
+
+  // run(wait) executes the request, shed(wait) rejects it. Both are called
+  // on a thread of the pool with the time the request spent in the queue.
+  using task_fn_t = std::function<void(clock::duration)>;
+
+  admission_control(boost::asio::io_context& thread_pool,
+                    std::array<limits, kNumCostClasses> const&);
+
+  void submit(cost_class, task_fn_t run, task_fn_t shed);
+
+  std::size_t queue_length(cost_class) const;
+
+private:
+  struct task {
+    clock::time_point enqueued_;
+    task_fn_t run_;
+    task_fn_t shed_;
+  };
+
+  struct queue {
+    limits limits_;
+    unsigned running_{0U};
+    std::deque<task> waiting_;
+  };
+
+  void start(cost_class, task&&);
+  void finished(cost_class);
+
+  // Moves requests that waited too long from the front of the queue to shed.
+  static void drop_expired(queue&,
+                           clock::time_point now,
+                           std::vector<task>& shed);
+
+  boost::asio::io_context& thread_pool_;
+  mutable std::mutex mutex_;
+  std::array<queue, kNumCostClasses> queues_;
+};
+
+}  // namespace osr::backend
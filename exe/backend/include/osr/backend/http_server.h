@@ -1,10 +1,12 @@
 #pragma once
 
+#include <array>
 #include <memory>
 #include <string>
 
 #include "boost/asio/io_context.hpp"
 
+#include "osr/backend/admission.h"
 #include "osr/elevation_storage.h"
 #include "osr/lookup.h"
 #include "osr/platforms.h"
@@ -13,13 +15,17 @@
 namespace osr::backend {
 
 struct http_server {
+  using queue_limits_t =
+      std::array<admission_control::limits, kNumCostClasses>;
+
   http_server(boost::asio::io_context& ioc,
               boost::asio::io_context& thread_pool,
               ways const&,
               lookup const&,
               platforms const*,
               elevation_storage const*,
-              std::string const& static_file_path);
+              std::string const& static_file_path,
+              queue_limits_t const&);
   ~http_server();
   http_server(http_server const&) = delete;
   http_server& operator=(http_server const&) = delete;
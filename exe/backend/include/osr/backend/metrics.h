@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "osr/backend/admission.h"
+#include "osr/routing/algorithms.h"
+#include "osr/routing/profile.h"
+
+namespace osr::backend {
+
+enum class request_phase : std::uint8_t {
+  kMatch,
+  kSearch,
+  kReconstruct,
+  kSerialize
+};
+
+constexpr auto const kNumRequestPhases = 4U;
+
+// Request metrics in the Prometheus text format.
+//
+// Latencies are recorded into per-thread histograms: every thread owns one
+// shard and only does relaxed atomic increments on it, so observe() neither
+// locks nor shares cache lines with other threads. Shards are summed up in
+// to_prometheus() (on scrape).
+struct metrics {
+  // Histogram bucket upper bounds in seconds (+Inf is implicit).
+  static constexpr auto const kBuckets =
+      std::array{0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+                 0.1,    0.25,  0.5,    1.0,   2.5,  5.0,   10.0};
+
+  struct histogram {
+    std::array<std::atomic_uint64_t, kBuckets.size() + 1U> counts_{};
+    std::atomic_uint64_t sum_us_{0U};
+  };
+
+  struct shard {
+    std::array<histogram,
+               kNumProfiles * kNumRoutingAlgorithms * kNumRequestPhases>
+        latency_;
+    std::array<histogram, kNumCostClasses> queue_wait_;
+    std::array<std::atomic_uint64_t, kNumCostClasses> shed_{};
+  };
+
+  metrics();
+  ~metrics();
+  metrics(metrics const&) = delete;
+  metrics& operator=(metrics const&) = delete;
+  metrics(metrics&&) = delete;
+  metrics& operator=(metrics&&) = delete;
+
+  void observe(search_profile,
+               routing_algorithm,
+               request_phase,
+               std::chrono::steady_clock::duration);
+
+  // Time a request spent in the admission queue of its cost class before it
+  // was executed or shed.
+  void observe_queue_wait(cost_class,
+                          std::chrono::steady_clock::duration,
+                          bool shed);
+
+  std::string to_prometheus() const;
+
+  // Gauges, maintained by the HTTP server.
+  std::atomic_int64_t queue_depth_{0};
+  std::atomic_int64_t in_flight_{0};
+
+private:
+  shard& get_shard();
+
+  std::uint64_t id_;
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<shard>> shards_;
+};
+
+}  // namespace osr::backend
@@ -0,0 +1,147 @@
+#include "osr/backend/admission.h"
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "boost/asio/post.hpp"
+
+#include "utl/verify.h"
+
+namespace osr::backend {
+
+cost_class get_cost_class(search_profile const p) {
+  switch (p) {
+    case search_profile::kFoot:
+    case search_profile::kWheelchair:
+    case search_profile::kBike:
+    case search_profile::kBikeFast:
+    case search_profile::kBikeElevationLow:
+    case search_profile::kBikeElevationHigh:
+    case search_profile::kRailway:
+    case search_profile::kFerry: return cost_class::kCheap;
+
+    case search_profile::kCar:
+    case search_profile::kCarDropOff:
+    case search_profile::kCarDropOffWheelchair:
+    case search_profile::kCarParking:
+    case search_profile::kCarParkingWheelchair:
+    case search_profile::kBus: return cost_class::kExpensive;
+
+    case search_profile::kBikeSharing:
+    case search_profile::kCarSharing: return cost_class::kSharing;
+  }
+  throw utl::fail("{} is not a valid profile", static_cast<std::uint8_t>(p));
+}
+
+std::string_view to_str(cost_class const c) {
+  switch (c) {
+    case cost_class::kCheap: return "cheap";
+    case cost_class::kExpensive: return "expensive";
+    case cost_class::kSharing: return "sharing";
+  }
+  return "unknown";
+}
+
+admission_control::admission_control(
+    boost::asio::io_context& thread_pool,
+    std::array<limits, kNumCostClasses> const& l)
+    : thread_pool_{thread_pool} {
+  for (auto i = 0U; i != kNumCostClasses; ++i) {
+    utl::verify(l[i].max_concurrent_ != 0U,
+                "admission_control: concurrency limit of {} must not be zero",
+                to_str(static_cast<cost_class>(i)));
+    queues_[i].limits_ = l[i];
+  }
+}
+
+void admission_control::submit(cost_class const c,
+                               task_fn_t run,
+                               task_fn_t shed_fn) {
+  auto const now = clock::now();
+  auto t = task{now, std::move(run), std::move(shed_fn)};
+  auto shed_tasks = std::vector<task>{};
+  auto run_now = false;
+  {
+    auto const lock = std::scoped_lock{mutex_};
+    auto& q = queues_[static_cast<std::size_t>(c)];
+    drop_expired(q, now, shed_tasks);
+    if (q.running_ < q.limits_.max_concurrent_) {
+      ++q.running_;
+      run_now = true;
+    } else if (q.limits_.max_queue_length_ != 0U &&
+               q.waiting_.size() >= q.limits_.max_queue_length_) {
+      shed_tasks.emplace_back(std::move(t));
+    } else {
+      q.waiting_.emplace_back(std::move(t));
+    }
+  }
+
+  if (run_now) {
+    start(c, std::move(t));
+  }
+  // Shed callbacks run on the pool, not on the thread submitting.
+  for (auto& x : shed_tasks) {
+    boost::asio::post(thread_pool_, [x = std::move(x), now]() {
+      x.shed_(now - x.enqueued_);
+    });
+  }
+}
+
+std::size_t admission_control::queue_length(cost_class const c) const {
+  auto const lock = std::scoped_lock{mutex_};
+  return queues_[static_cast<std::size_t>(c)].waiting_.size();
+}
+
+void admission_control::start(cost_class const c, task&& t) {
+  boost::asio::post(thread_pool_, [this, c, t = std::move(t)]() {
+    try {
+      t.run_(clock::now() - t.enqueued_);
+    } catch (...) {
+      finished(c);
+      throw;
+    }
+    finished(c);
+  });
+}
+
+void admission_control::drop_expired(queue& q,
+                                     clock::time_point const now,
+                                     std::vector<task>& shed) {
+  auto const max_wait = q.limits_.max_queue_wait_;
+  while (!q.waiting_.empty() && max_wait.count() != 0 &&
+         now - q.waiting_.front().enqueued_ > max_wait) {
+    shed.emplace_back(std::move(q.waiting_.front()));
+    q.waiting_.pop_front();
+  }
+}
+
+void admission_control::finished(cost_class const c) {
+  auto shed = std::vector<task>{};
+  auto next = std::optional<task>{};
+  auto const now = clock::now();
+  {
+    auto const lock = std::scoped_lock{mutex_};
+    auto& q = queues_[static_cast<std::size_t>(c)];
+    --q.running_;
+
+    // Expired requests do not take a slot: drop them until one is found that
+    // is still worth running.
+    drop_expired(q, now, shed);
+
+    if (!q.waiting_.empty()) {
+      next.emplace(std::move(q.waiting_.front()));
+      q.waiting_.pop_front();
+      ++q.running_;
+    }
+  }
+
+  if (next.has_value()) {
+    start(c, std::move(*next));
+  }
+  for (auto& t : shed) {
+    t.shed_(now - t.enqueued_);
+  }
+}
+
+}  // namespace osr::backend
@@ -1,6 +1,18 @@
 #include "osr/backend/http_server.h"
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 #include "boost/algorithm/string.hpp"
 #include "boost/asio/post.hpp"
@@ -18,9 +30,13 @@
 #include "net/web_server/serve_static.h"
 #include "net/web_server/web_server.h"
 
+#include "osr/backend/admission.h"
+#include "osr/backend/metrics.h"
 #include "osr/geojson.h"
 #include "osr/lookup.h"
+#include "osr/route_encoding.h"
 #include "osr/routing/algorithms.h"
+#include "osr/routing/cancellation.h"
 #include "osr/routing/parameters.h"
 #include "osr/routing/profiles/bike.h"
 #include "osr/routing/profiles/bike_sharing.h"
@@ -29,6 +45,8 @@
 #include "osr/routing/profiles/car_sharing.h"
 #include "osr/routing/profiles/foot.h"
 #include "osr/routing/route.h"
+#include "osr/routing/search_stats.h"
+#include "osr/routing/simplify.h"
 #include "osr/routing/with_profile.h"
 
 using namespace net;
@@ -60,6 +78,20 @@ web_server::string_res_t json_response(
   return res;
 }
 
+web_server::string_res_t error_response(web_server::http_req_t const& req,
+                                        std::string_view const message,
+                                        http::status const status) {
+  return json_response(
+      req,
+      fmt::format(R"({{"error": {}}})", json::serialize(json::value{message})),
+      status);
+}
+
+// Invalid request parameters, answered with 400 Bad Request.
+struct bad_request : public std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
 location parse_location(json::value const& v) {
   auto const& obj = v.as_object();
   return {obj.at("lat").as_double(), obj.at("lng").as_double(),
@@ -75,6 +107,85 @@ json::value to_json(std::vector<geo::latlng> const& polyline) {
   return a;
 }
 
+web_server::string_res_t ndjson_response(web_server::http_req_t const& req,
+                                         std::string const& content) {
+  auto res = net::string_response(req, content, http::status::ok,
+                                  "application/x-ndjson");
+  set_cors_headers(res);
+  return res;
+}
+
+constexpr auto const kBinaryContentType =
+    std::string_view{"application/x-osr-route"};
+
+web_server::string_res_t binary_response(web_server::http_req_t const& req,
+                                         std::string const& content) {
+  auto res = net::string_response(req, content, http::status::ok,
+                                  kBinaryContentType);
+  set_cors_headers(res);
+  return res;
+}
+
+constexpr auto const kMaxBatchSize = std::size_t{1000U};
+constexpr auto const kMaxBatchBodySize = kMaxBatchSize * 1024U;
+constexpr auto const kBatchChunkSize = std::size_t{16U};
+
+// Collects the NDJSON lines of a batch request. The lines are not streamed:
+// the whole body is sent at once by the thread that finishes the last chunk.
+struct route_batch {
+  route_batch(web_server::http_req_t req,
+              web_server::http_res_cb_t cb,
+              std::size_t const n_queries)
+      : req_{std::move(req)}, cb_{std::move(cb)}, answered_(n_queries) {}
+
+  template <typename... Args>
+  void add(std::size_t const i,
+           fmt::format_string<Args...> fmt_str,
+           Args&&... args) {
+    auto line = fmt::format(R"({{"index": {}, )", i);
+    fmt::format_to(std::back_inserter(line), fmt_str,
+                   std::forward<Args>(args)...);
+    line += "}\n";
+    auto const lock = std::scoped_lock{mutex_};
+    out_ += line;
+    answered_[i] = true;
+  }
+
+  // Adds an error line for every query of the chunk without a line yet.
+  template <typename Chunk>
+  void fail(Chunk const& chunk, std::string_view const message) {
+    auto const error = json::serialize(json::value{message});
+    for (auto const& [i, _] : chunk) {
+      if (!is_answered(i)) {
+        add(i, R"("error": {})", error);
+      }
+    }
+  }
+
+  bool is_answered(std::size_t const i) {
+    auto const lock = std::scoped_lock{mutex_};
+    return answered_[i];
+  }
+
+  void chunk_done() {
+    if (pending_.fetch_sub(1U) == 1U) {
+      done();
+    }
+  }
+
+  void done() {
+    auto const lock = std::scoped_lock{mutex_};
+    cb_(ndjson_response(req_, out_));
+  }
+
+  web_server::http_req_t req_;
+  web_server::http_res_cb_t cb_;
+  std::atomic_size_t pending_{0U};
+  std::mutex mutex_;
+  std::string out_;
+  std::vector<bool> answered_;
+};
+
 struct http_server::impl {
   impl(boost::asio::io_context& ios,
        boost::asio::io_context& thread_pool,
@@ -82,13 +193,16 @@ struct http_server::impl {
        lookup const& l,
        platforms const* pl,
        elevation_storage const* elevations,
-       std::string const& static_file_path)
+       std::string const& static_file_path,
+       std::array<admission_control::limits, kNumCostClasses> const&
+           queue_limits)
       : ioc_{ios},
         thread_pool_{thread_pool},
         w_{g},
         l_{l},
         pl_{pl},
         elevations_{elevations},
+        admission_{thread_pool, queue_limits},
         server_{ioc_} {
     try {
       if (!static_file_path.empty() && fs::is_directory(static_file_path)) {
@@ -108,6 +222,33 @@ struct http_server::impl {
                : to_profile(profile_it->value().as_string());
   }
 
+  // Search timeout in milliseconds from the "timeout" field of the query or
+  // the X-Request-Timeout header. Throws bad_request if it is not a positive
+  // integer.
+  static std::optional<std::chrono::milliseconds> get_timeout_from_request(
+      web_server::http_req_t const& req, boost::json::object const& q) {
+    auto ms = std::int64_t{0};
+    if (auto const it = q.find("timeout"); it != q.end()) {
+      auto const v = it->value().try_to_number<std::int64_t>();
+      if (!v.has_value()) {
+        throw bad_request{"invalid timeout"};
+      }
+      ms = v.value();
+    } else if (auto const h = req.find("X-Request-Timeout"); h != req.end()) {
+      auto const v = std::string_view{h->value()};
+      auto const [ptr, ec] = std::from_chars(v.data(), v.data() + v.size(), ms);
+      if (ec != std::errc{} || ptr != v.data() + v.size()) {
+        throw bad_request{"invalid X-Request-Timeout header"};
+      }
+    } else {
+      return std::nullopt;
+    }
+    if (ms <= 0) {
+      throw bad_request{"timeout must be positive"};
+    }
+    return std::chrono::milliseconds{ms};
+  }
+
   static routing_algorithm get_routing_algorithm_from_request(
       boost::json::object const& q) {
     auto const routing_it = q.find("routing");
@@ -116,52 +257,323 @@ struct http_server::impl {
                : to_algorithm(routing_it->value().as_string());
   }
 
-  void handle_route(web_server::http_req_t const& req,
-                    web_server::http_res_cb_t const& cb) {
-    auto const q = boost::json::parse(req.body()).as_object();
+  enum class response_format : std::uint8_t {
+    kGeoJson,
+    kPolyline5,
+    kPolyline6,
+    kBinary
+  };
+
+  // From the "format" field of the query ("geojson", "polyline",
+  // "polyline6", "binary") or the Accept header. Throws bad_request for other
+  // formats.
+  static response_format get_format_from_request(
+      web_server::http_req_t const& req, boost::json::object const& q) {
+    auto format = std::string_view{};
+    if (auto const it = q.find("format");
+        it != q.end() && it->value().is_string()) {
+      format = it->value().as_string();
+    } else if (auto const accept = req.find(http::field::accept);
+               accept != req.end()) {
+      auto const v = accept->value();
+      format = v.find(kBinaryContentType) != std::string_view::npos ? "binary"
+               : v.find("application/x-polyline6") != std::string_view::npos
+                   ? "polyline6"
+               : v.find("application/x-polyline") != std::string_view::npos
+                   ? "polyline"
+                   : "geojson";
+    }
+    if (format.empty() || format == "geojson") {
+      return response_format::kGeoJson;
+    } else if (format == "polyline") {
+      return response_format::kPolyline5;
+    } else if (format == "polyline6") {
+      return response_format::kPolyline6;
+    } else if (format == "binary") {
+      return response_format::kBinary;
+    }
+    throw bad_request{fmt::format("unknown response format: {}", format)};
+  }
+
+  std::string serialize_route(response_format const format,
+                              path const& p,
+                              search_stats const* stats) const {
+    auto out = std::string{};
+    switch (format) {
+      case response_format::kGeoJson:
+        write_featurecollection(out, w_, p, true, stats);
+        break;
+      case response_format::kPolyline5:
+        write_encoded_polyline_route(out, w_, p, 5U);
+        break;
+      case response_format::kPolyline6:
+        write_encoded_polyline_route(out, w_, p, 6U);
+        break;
+      case response_format::kBinary: write_binary_route(out, w_, p); break;
+    }
+    return out;
+  }
+
+  struct route_query {
+    search_profile profile_;
+    routing_algorithm algo_;
+    direction dir_;
+    location from_;
+    location to_;
+    cost_t max_;
+    profile_parameters params_;
+    bool with_stats_;
+    std::optional<std::chrono::milliseconds> timeout_;
+    response_format format_;
+    std::optional<double> simplify_;  // tolerance in meters
+  };
+
+  using batch_chunk = std::vector<std::pair<std::size_t, route_query>>;
+
+  static route_query parse_route_query(web_server::http_req_t const& req,
+                                       boost::json::object const& q) {
     auto const profile = get_search_profile_from_request(q);
     auto const direction_it = q.find("direction");
-    auto const routing_algo = get_routing_algorithm_from_request(q);
-    auto const dir = to_direction(direction_it == q.end() ||
-                                          !direction_it->value().is_string()
-                                      ? to_str(direction::kForward)
-                                      : direction_it->value().as_string());
-    auto const from = parse_location(q.at("start"));
-    auto const to = parse_location(q.at("destination"));
     auto const max_it = q.find("max");
-    auto const max = static_cast<cost_t>(
-        max_it == q.end() ? 3600 : max_it->value().as_int64());
     auto const foot_speed_result =
         q.try_at("footSpeed")->try_to_number<float>();
-    auto const params =
-        profile == search_profile::kFoot && foot_speed_result.has_value()
-            ? foot<false,
-                   elevator_tracking>::parameters{.speed_meters_per_second_ =
-                                                      foot_speed_result.value()}
-            : get_parameters(profile);
-
-    auto const p = route(params, w_, l_, profile, from, to, max, dir, 100,
-                         nullptr, nullptr, elevations_, routing_algo);
-
-    auto const p1 = route(params, w_, l_, profile, from, std::vector{to}, max,
-                          dir, 100, nullptr, nullptr, elevations_);
-
-    auto const print = [](char const* name, std::optional<path> const& p) {
-      if (p.has_value()) {
-        std::cout << name << " cost: " << p->cost_ << "\n";
-      } else {
-        std::cout << name << ": not found\n";
-      }
-    };
-    print("p", p);
-    print("p1", p1.at(0));
+    auto const stats_it = q.find("stats");
+    auto const simplify_it = q.find("simplify");
+    return {
+        .profile_ = profile,
+        .algo_ = get_routing_algorithm_from_request(q),
+        .dir_ = to_direction(direction_it == q.end() ||
+                                     !direction_it->value().is_string()
+                                 ? to_str(direction::kForward)
+                                 : direction_it->value().as_string()),
+        .from_ = parse_location(q.at("start")),
+        .to_ = parse_location(q.at("destination")),
+        .max_ = static_cast<cost_t>(
+            max_it == q.end() ? 3600 : max_it->value().as_int64()),
+        .params_ =
+            profile == search_profile::kFoot && foot_speed_result.has_value()
+                ? foot<false, elevator_tracking>::parameters{
+                      .speed_meters_per_second_ = foot_speed_result.value()}
+                : get_parameters(profile),
+        .with_stats_ = stats_it != q.end() && stats_it->value().is_bool() &&
+                       stats_it->value().as_bool(),
+        .timeout_ = get_timeout_from_request(req, q),
+        .format_ = get_format_from_request(req, q),
+        .simplify_ = simplify_it != q.end() && simplify_it->value().is_number()
+                         ? std::optional{
+                               simplify_it->value().to_number<double>()}
+                         : std::nullopt};
+  }
+
+  void handle_route(web_server::http_req_t const& req,
+                    boost::json::object const& q,
+                    web_server::http_res_cb_t const& cb) {
+    auto const rq = parse_route_query(req, q);
+    auto const& [profile, routing_algo, dir, from, to, max, params, with_stats,
+                 timeout, format, simplify_tolerance] = rq;
+    auto stats = search_stats{};
+    auto reconstruct_time = std::chrono::microseconds{0};
+    auto cancel = timeout.has_value()
+                      ? cancellation_token::with_timeout(*timeout)
+                      : cancellation_token{};
+
+    auto const match_start = std::chrono::steady_clock::now();
+    auto const from_match =
+        l_.match(params, from, false, dir, 100, nullptr, profile);
+    auto const to_match =
+        l_.match(params, to, true, dir, 100, nullptr, profile);
+    auto const search_start = std::chrono::steady_clock::now();
+    auto p = std::optional<path>{};
+    try {
+      p = route(params, w_, l_, profile, from, to, from_match, to_match, max,
+                dir, nullptr, nullptr, elevations_, routing_algo, nullptr,
+                with_stats ? &stats : nullptr,
+                timeout.has_value() ? &cancel : nullptr, &reconstruct_time);
+    } catch (search_cancelled const&) {
+      cb(json_response(req, R"({"error": "timeout"})",
+                       http::status::gateway_timeout));
+      return;
+    }
+    auto const search_end = std::chrono::steady_clock::now();
+    metrics_.observe(profile, routing_algo, request_phase::kMatch,
+                     search_start - match_start);
+    metrics_.observe(profile, routing_algo, request_phase::kSearch,
+                     search_end - search_start - reconstruct_time);
+    metrics_.observe(profile, routing_algo, request_phase::kReconstruct,
+                     reconstruct_time);
 
     if (!p.has_value()) {
       cb(json_response(req, "could not find a valid path",
                        http::status::not_found));
       return;
     }
-    cb(json_response(req, to_featurecollection(w_, p)));
+    auto const serialize_start = std::chrono::steady_clock::now();
+    if (simplify_tolerance.has_value()) {
+      simplify(*p, *simplify_tolerance);
+    }
+    auto const body =
+        serialize_route(format, *p, with_stats ? &stats : nullptr);
+    metrics_.observe(profile, routing_algo, request_phase::kSerialize,
+                     std::chrono::steady_clock::now() - serialize_start);
+    cb(format == response_format::kBinary ? binary_response(req, body)
+                                          : json_response(req, body));
+  }
+
+  void handle_metrics(web_server::http_req_t const& req,
+                      web_server::http_res_cb_t const& cb) {
+    auto res = net::string_response(req, metrics_.to_prometheus(),
+                                    http::status::ok,
+                                    "text/plain; version=0.0.4");
+    set_cors_headers(res);
+    cb(std::move(res));
+  }
+
+  // Independent route queries, either as a plain array or as
+  // {"queries": [...]}. Queries are grouped by profile and split into chunks
+  // that run on the worker pool under the admission control of their cost
+  // class. Every chunk snaps all of its locations before it starts searching.
+  // The answer is newline-delimited JSON with one {"index": i, ...} object
+  // per query, in completion order, sent once all queries are answered.
+  // Batches with more than kMaxBatchSize queries (or kMaxBatchBodySize bytes)
+  // are answered with 413.
+  void handle_route_batch(web_server::http_req_t const& req,
+                          web_server::http_res_cb_t const& cb) {
+    auto const body = boost::json::parse(req.body());
+    auto const& queries =
+        body.is_array() ? body.as_array() : body.at("queries").as_array();
+    if (queries.size() > kMaxBatchSize) {
+      return cb(error_response(
+          req,
+          fmt::format("batch too large: {} > {} queries", queries.size(),
+                      kMaxBatchSize),
+          http::status::payload_too_large));
+    }
+
+    auto batch = std::make_shared<route_batch>(req, cb, queries.size());
+    auto groups = std::array<batch_chunk, kNumProfiles>{};
+    for (auto const [i, q] : utl::enumerate(queries)) {
+      try {
+        auto rq = parse_route_query(req, q.as_object());
+        utl::verify(rq.format_ != response_format::kBinary,
+                    "binary format not supported in batches");
+        groups[static_cast<std::size_t>(rq.profile_)].emplace_back(
+            i, std::move(rq));
+      } catch (std::exception const& e) {
+        batch->add(i, R"("error": {})", json::serialize(json::value{e.what()}));
+      }
+    }
+
+    auto chunks = std::vector<batch_chunk>{};
+    for (auto& g : groups) {
+      for (auto i = std::size_t{0U}; i < g.size(); i += kBatchChunkSize) {
+        auto const last = std::min(g.size(), i + kBatchChunkSize);
+        chunks.emplace_back(std::make_move_iterator(begin(g) + i),
+                            std::make_move_iterator(begin(g) + last));
+      }
+    }
+
+    if (chunks.empty()) {
+      return batch->done();
+    }
+
+    batch->pending_ = chunks.size();
+    for (auto& chunk : chunks) {
+      auto const c = get_cost_class(chunk.front().second.profile_);
+      auto const shared_chunk =
+          std::make_shared<batch_chunk>(std::move(chunk));
+      metrics_.queue_depth_.fetch_add(1, std::memory_order_relaxed);
+      admission_.submit(
+          c,
+          [this, c, batch,
+           shared_chunk](admission_control::clock::duration const wait) {
+            metrics_.queue_depth_.fetch_sub(1, std::memory_order_relaxed);
+            metrics_.observe_queue_wait(c, wait, false);
+            try {
+              run_batch_chunk(*batch, *shared_chunk);
+            } catch (std::exception const& e) {
+              batch->fail(*shared_chunk, e.what());
+            } catch (...) {
+              batch->fail(*shared_chunk, "unknown error");
+            }
+            batch->chunk_done();
+          },
+          [this, c, batch,
+           shared_chunk](admission_control::clock::duration const wait) {
+            metrics_.queue_depth_.fetch_sub(1, std::memory_order_relaxed);
+            metrics_.observe_queue_wait(c, wait, true);
+            for (auto const& [i, _] : *shared_chunk) {
+              batch->add(i, R"("error": "overloaded")");
+            }
+            batch->chunk_done();
+          });
+    }
+  }
+
+  void run_batch_chunk(route_batch& batch, batch_chunk const& chunk) {
+    // Snap all locations first: consecutive lookups hit the same rtree nodes.
+    auto matches = std::vector<std::optional<std::pair<match_t, match_t>>>{};
+    matches.reserve(chunk.size());
+    auto const match_start = std::chrono::steady_clock::now();
+    for (auto const& [i, rq] : chunk) {
+      try {
+        matches.emplace_back(std::pair{
+            l_.match(rq.params_, rq.from_, false, rq.dir_, 100, nullptr,
+                     rq.profile_),
+            l_.match(rq.params_, rq.to_, true, rq.dir_, 100, nullptr,
+                     rq.profile_)});
+      } catch (std::exception const& e) {
+        matches.emplace_back(std::nullopt);
+        batch.add(i, R"("error": {})", json::serialize(json::value{e.what()}));
+      }
+    }
+    auto const match_time =
+        (std::chrono::steady_clock::now() - match_start) / chunk.size();
+
+    for (auto const [j, entry] : utl::enumerate(chunk)) {
+      if (!matches[j].has_value()) {
+        continue;
+      }
+      auto const& [i, rq] = entry;
+      auto const& [from_match, to_match] = *matches[j];
+      try {
+        auto stats = search_stats{};
+        auto reconstruct_time = std::chrono::microseconds{0};
+        auto cancel = rq.timeout_.has_value()
+                          ? cancellation_token::with_timeout(*rq.timeout_)
+                          : cancellation_token{};
+        auto const search_start = std::chrono::steady_clock::now();
+        auto p =
+            route(rq.params_, w_, l_, rq.profile_, rq.from_, rq.to_,
+                  from_match, to_match, rq.max_, rq.dir_, nullptr, nullptr,
+                  elevations_, rq.algo_, nullptr,
+                  rq.with_stats_ ? &stats : nullptr,
+                  rq.timeout_.has_value() ? &cancel : nullptr,
+                  &reconstruct_time);
+        auto const search_end = std::chrono::steady_clock::now();
+        metrics_.observe(rq.profile_, rq.algo_, request_phase::kMatch,
+                         match_time);
+        metrics_.observe(rq.profile_, rq.algo_, request_phase::kSearch,
+                         search_end - search_start - reconstruct_time);
+        metrics_.observe(rq.profile_, rq.algo_, request_phase::kReconstruct,
+                         reconstruct_time);
+        if (!p.has_value()) {
+          batch.add(i, R"("error": "could not find a valid path")");
+          continue;
+        }
+        if (rq.simplify_.has_value()) {
+          simplify(*p, *rq.simplify_);
+        }
+        auto const fc = serialize_route(rq.format_, *p,
+                                        rq.with_stats_ ? &stats : nullptr);
+        metrics_.observe(rq.profile_, rq.algo_, request_phase::kSerialize,
+                         std::chrono::steady_clock::now() - search_end);
+        batch.add(i, R"("result": {})", fc);
+      } catch (search_cancelled const&) {
+        batch.add(i, R"("error": "timeout")");
+      } catch (std::exception const& e) {
+        batch.add(i, R"("error": {})", json::serialize(json::value{e.what()}));
+      }
+    }
   }
 
   void handle_levels(web_server::http_req_t const& req,
@@ -256,11 +668,35 @@ struct http_server::impl {
       case http::verb::options: return cb(json_response(req, {}));
       case http::verb::post: {
         auto const& target = req.target();
-        if (target.starts_with("/api/route")) {
+        if (target.starts_with("/api/route/batch")) {
+          if (req.body().size() > kMaxBatchBodySize) {
+            return cb(error_response(
+                req,
+                fmt::format("batch too large: > {} bytes", kMaxBatchBodySize),
+                http::status::payload_too_large));
+          }
           return run_parallel(
               [this](web_server::http_req_t const& req1,
                      web_server::http_res_cb_t const& cb1) {
-                handle_route(req1, cb1);
+                handle_route_batch(req1, cb1);
+              },
+              req, cb);
+        } else if (target.starts_with("/api/route")) {
+          // The body is parsed once here to find the cost class and handed
+          // to the worker.
+          auto q = json::object{};
+          auto c = cost_class::kCheap;
+          try {
+            q = json::parse(req.body()).as_object();
+            c = get_cost_class(get_search_profile_from_request(q));
+          } catch (std::exception const& e) {
+            return cb(error_response(req, e.what(), http::status::bad_request));
+          }
+          return run_admitted(
+              c,
+              [this, q = std::move(q)](web_server::http_req_t const& req1,
+                                       web_server::http_res_cb_t const& cb1) {
+                handle_route(req1, q, cb1);
               },
               req, cb);
         } else if (target.starts_with("/api/levels")) {
@@ -290,7 +726,18 @@ struct http_server::impl {
         }
       }
       case http::verb::get:
-      case http::verb::head: return handle_static(req, cb);
+      case http::verb::head:
+        if (req.target() == "/metrics") {
+          // Reads /proc/self/smaps and sums up all shards: not on the I/O
+          // thread.
+          return run_parallel(
+              [this](web_server::http_req_t const& req1,
+                     web_server::http_res_cb_t const& cb1) {
+                handle_metrics(req1, cb1);
+              },
+              req, cb);
+        }
+        return handle_static(req, cb);
       default:
         return cb(json_response(req,
                                 R"({"error": "HTTP method not supported"})",
@@ -303,26 +750,73 @@ struct http_server::impl {
       Fn&& handler,  // NOLINT(cppcoreguidelines-missing-std-forward)
       web_server::http_req_t const& req,
       web_server::http_res_cb_t const& cb) {
+    metrics_.in_flight_.fetch_add(1, std::memory_order_relaxed);
+    metrics_.queue_depth_.fetch_add(1, std::memory_order_relaxed);
     boost::asio::post(
         thread_pool_, [req, cb, h = std::forward<Fn>(handler), this]() {
+          metrics_.queue_depth_.fetch_sub(1, std::memory_order_relaxed);
+          execute(h, req, cb);
+        });
+  }
+
+  // Like run_parallel, but the request has to pass the admission control of
+  // its cost class first. Requests that waited too long are answered with 503.
+  template <typename Fn>
+  void run_admitted(
+      cost_class const c,
+      Fn&& handler,  // NOLINT(cppcoreguidelines-missing-std-forward)
+      web_server::http_req_t const& req,
+      web_server::http_res_cb_t const& cb) {
+    metrics_.in_flight_.fetch_add(1, std::memory_order_relaxed);
+    metrics_.queue_depth_.fetch_add(1, std::memory_order_relaxed);
+    admission_.submit(
+        c,
+        [req, cb, c, h = std::forward<Fn>(handler),
+         this](admission_control::clock::duration const wait) {
+          metrics_.queue_depth_.fetch_sub(1, std::memory_order_relaxed);
+          metrics_.observe_queue_wait(c, wait, false);
+          execute(h, req, cb);
+        },
+        [req, cb, c, this](admission_control::clock::duration const wait) {
+          metrics_.queue_depth_.fetch_sub(1, std::memory_order_relaxed);
+          metrics_.observe_queue_wait(c, wait, true);
+          boost::asio::post(ioc_, [req, cb, this]() {
+            metrics_.in_flight_.fetch_sub(1, std::memory_order_relaxed);
+            cb(json_response(req, R"({"error": "overloaded"})",
+                             http::status::service_unavailable));
+          });
+        });
+  }
+
+  // Runs the handler on the current (pool) thread and hands the response
+  // back to the I/O thread.
+  template <typename Fn>
+  void execute(Fn const& h,
+               web_server::http_req_t const& req,
+               web_server::http_res_cb_t const& cb) {
+    try {
+      h(req, [req, cb, this](web_server::http_res_t&& res) {
+        boost::asio::post(ioc_, [cb, req, res{std::move(res)},
+                                 this]() mutable {
+          metrics_.in_flight_.fetch_sub(1, std::memory_order_relaxed);
           try {
-            h(req, [req, cb, this](web_server::http_res_t&& res) {
-              boost::asio::post(ioc_, [cb, req, res{std::move(res)}]() mutable {
-                try {
-                  cb(std::move(res));
-                } catch (std::exception const& e) {
-                  return cb(json_response(
-                      req, fmt::format(R"({{"error": "{}"}})", e.what()),
-                      http::status::internal_server_error));
-                }
-              });
-            });
+            cb(std::move(res));
           } catch (std::exception const& e) {
             return cb(json_response(
                 req, fmt::format(R"({{"error": "{}"}})", e.what()),
                 http::status::internal_server_error));
           }
         });
+      });
+    } catch (bad_request const& e) {
+      metrics_.in_flight_.fetch_sub(1, std::memory_order_relaxed);
+      return cb(error_response(req, e.what(), http::status::bad_request));
+    } catch (std::exception const& e) {
+      metrics_.in_flight_.fetch_sub(1, std::memory_order_relaxed);
+      return cb(json_response(
+          req, fmt::format(R"({{"error": "{}"}})", e.what()),
+          http::status::internal_server_error));
+    }
   }
 
   void listen(std::string const& host, std::string const& port) {
@@ -355,6 +849,8 @@ private:
   lookup const& l_;
   platforms const* pl_;
   elevation_storage const* elevations_;
+  metrics metrics_;
+  admission_control admission_;
   web_server server_;
   bool serve_static_files_{false};
   std::string static_file_path_;
@@ -366,9 +862,16 @@ http_server::http_server(boost::asio::io_context& ioc,
                          lookup const& l,
                          platforms const* pl,
                          elevation_storage const* elevation,
-                         std::string const& static_file_path)
-    : impl_{new impl(ioc, thread_pool, w, l, pl, elevation, static_file_path)} {
-}
+                         std::string const& static_file_path,
+                         queue_limits_t const& queue_limits)
+    : impl_{new impl(ioc,
+                     thread_pool,
+                     w,
+                     l,
+                     pl,
+                     elevation,
+                     static_file_path,
+                     queue_limits)} {}
 
 http_server::~http_server() = default;
 
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <filesystem>
 #include <thread>
 #include <vector>
@@ -31,6 +32,18 @@ public:
     param(static_file_path_, "static,s", "Path to static files (ui/web)");
     param(threads_, "threads,t", "Number of routing threads");
     param(lock_, "lock,l", "Lock to memory");
+    param(max_cheap_, "max-cheap",
+          "Max. concurrent foot/bike/rail/ferry route requests (0 = threads)");
+    param(max_expensive_, "max-expensive",
+          "Max. concurrent car/bus route requests (0 = threads / 2)");
+    param(max_sharing_, "max-sharing",
+          "Max. concurrent bike/car sharing route requests (0 = threads / 4)");
+    param(max_queue_wait_, "max-queue-wait",
+          "Queue wait in ms after which route requests are rejected with 503 "
+          "(0 = never)");
+    param(max_queue_length_, "max-queue-length",
+          "Max. waiting route requests per cost class, more are rejected with "
+          "503 (0 = unlimited)");
   }
 
   fs::path data_dir_{"osr"};
@@ -39,6 +52,11 @@ public:
   std::string static_file_path_;
   bool lock_{true};
   unsigned threads_{std::thread::hardware_concurrency()};
+  unsigned max_cheap_{0U};
+  unsigned max_expensive_{0U};
+  unsigned max_sharing_{0U};
+  unsigned max_queue_wait_{5000U};
+  std::size_t max_queue_length_{1000U};
 };
 
 auto run(boost::asio::io_context& ioc) {
@@ -94,13 +112,32 @@ int main(int argc, char const* argv[]) {
 
   auto const l = lookup{w, opt.data_dir_, cista::mmap::protection::READ};
 
+  auto const n_threads = std::max(1U, opt.threads_);
+  auto const limit = [&](unsigned const configured, unsigned const divisor) {
+    return configured != 0U ? configured : std::max(1U, n_threads / divisor);
+  };
+  auto const max_wait = std::chrono::milliseconds{opt.max_queue_wait_};
+  auto const queue_limits = http_server::queue_limits_t{
+      admission_control::limits{limit(opt.max_cheap_, 1U), max_wait,
+                                opt.max_queue_length_},
+      admission_control::limits{limit(opt.max_expensive_, 2U), max_wait,
+                                opt.max_queue_length_},
+      admission_control::limits{limit(opt.max_sharing_, 4U), max_wait,
+                                opt.max_queue_length_}};
+
   auto ioc = boost::asio::io_context{};
   auto pool = boost::asio::io_context{};
-  auto server = http_server{
-      ioc, pool, w, l, pl.get(), elevations.get(), opt.static_file_path_};
+  auto server = http_server{ioc,
+                            pool,
+                            w,
+                            l,
+                            pl.get(),
+                            elevations.get(),
+                            opt.static_file_path_,
+                            queue_limits};
 
   auto work_guard = boost::asio::make_work_guard(pool);
-  auto threads = std::vector<std::thread>(std::max(1U, opt.threads_));
+  auto threads = std::vector<std::thread>(n_threads);
   for (auto& t : threads) {
     t = std::thread(run(pool));
   }
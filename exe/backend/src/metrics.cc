@@ -0,0 +1,238 @@
+#include "osr/backend/metrics.h"
+
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string_view>
+
+#include "fmt/core.h"
+
+namespace osr::backend {
+
+namespace {
+
+std::atomic_uint64_t next_metrics_id{0U};
+
+template <typename... Args>
+void append(std::string& out,
+            fmt::format_string<Args...> format,
+            Args&&... args) {
+  fmt::format_to(std::back_inserter(out), format, std::forward<Args>(args)...);
+}
+
+std::size_t histogram_idx(search_profile const p,
+                          routing_algorithm const a,
+                          request_phase const ph) {
+  return (static_cast<std::size_t>(p) * kNumRoutingAlgorithms +
+          static_cast<std::size_t>(a)) *
+             kNumRequestPhases +
+         static_cast<std::size_t>(ph);
+}
+
+std::string_view to_str(request_phase const ph) {
+  switch (ph) {
+    case request_phase::kMatch: return "match";
+    case request_phase::kSearch: return "search";
+    case request_phase::kReconstruct: return "reconstruct";
+    case request_phase::kSerialize: return "serialize";
+  }
+  return "unknown";
+}
+
+struct memory_usage {
+  std::uint64_t rss_{0U};
+  std::uint64_t mmap_rss_{0U};
+};
+
+// Resident set size of the process and the part of it that belongs to the
+// memory mapped data files (*.bin). Linux only, zero elsewhere.
+memory_usage get_memory_usage() {
+  auto m = memory_usage{};
+#if defined(__linux__)
+  auto in = std::ifstream{"/proc/self/smaps"};
+  auto line = std::string{};
+  auto is_data_file = false;
+  while (std::getline(in, line)) {
+    auto const sv = std::string_view{line};
+    if (sv.starts_with("Rss:")) {
+      auto kb = std::uint64_t{0U};
+      std::istringstream{line.substr(4U)} >> kb;
+      m.rss_ += kb * 1024U;
+      if (is_data_file) {
+        m.mmap_rss_ += kb * 1024U;
+      }
+    } else if (sv.find('-') < sv.find(' ')) {
+      // Mapping header: "start-end perms offset dev inode [path]"
+      is_data_file = sv.ends_with(".bin");
+    }
+  }
+#endif
+  return m;
+}
+
+void record(metrics::histogram& h,
+            std::chrono::steady_clock::duration const d) {
+  auto const seconds = std::chrono::duration<double>(d).count();
+  auto bucket = 0U;
+  while (bucket != metrics::kBuckets.size() &&
+         seconds > metrics::kBuckets[bucket]) {
+    ++bucket;
+  }
+  h.counts_[bucket].fetch_add(1U, std::memory_order_relaxed);
+  h.sum_us_.fetch_add(static_cast<std::uint64_t>(
+                          std::chrono::duration_cast<std::chrono::microseconds>(
+                              d)
+                              .count()),
+                      std::memory_order_relaxed);
+}
+
+// Sums up the histogram selected by get() over all shards and appends it in
+// the Prometheus text format. Empty histograms are skipped.
+template <typename GetHistogram>
+void append_histogram(
+    std::string& out,
+    std::string_view name,
+    std::string const& labels,
+    std::vector<std::unique_ptr<metrics::shard>> const& shards,
+    GetHistogram&& get) {  // NOLINT(cppcoreguidelines-missing-std-forward)
+  auto counts = std::array<std::uint64_t, metrics::kBuckets.size() + 1U>{};
+  auto sum_us = std::uint64_t{0U};
+  for (auto const& s : shards) {
+    auto const& h = get(*s);
+    for (auto i = 0U; i != counts.size(); ++i) {
+      counts[i] += h.counts_[i].load(std::memory_order_relaxed);
+    }
+    sum_us += h.sum_us_.load(std::memory_order_relaxed);
+  }
+
+  auto total = std::uint64_t{0U};
+  for (auto const c : counts) {
+    total += c;
+  }
+  if (total == 0U) {
+    return;
+  }
+
+  auto cumulative = std::uint64_t{0U};
+  for (auto i = 0U; i != metrics::kBuckets.size(); ++i) {
+    cumulative += counts[i];
+    append(out, "{}_bucket{{{},le=\"{}\"}} {}\n", name, labels,
+           metrics::kBuckets[i], cumulative);
+  }
+  append(out, "{}_bucket{{{},le=\"+Inf\"}} {}\n", name, labels, total);
+  append(out, "{}_sum{{{}}} {}\n", name, labels,
+         static_cast<double>(sum_us) / 1'000'000.0);
+  append(out, "{}_count{{{}}} {}\n", name, labels, total);
+}
+
+}  // namespace
+
+metrics::metrics() : id_{next_metrics_id.fetch_add(1U)} {}
+
+metrics::~metrics() = default;
+
+metrics::shard& metrics::get_shard() {
+  thread_local auto owner = std::numeric_limits<std::uint64_t>::max();
+  thread_local auto s = static_cast<shard*>(nullptr);
+  if (owner != id_) {
+    auto const lock = std::scoped_lock{mutex_};
+    s = shards_.emplace_back(std::make_unique<shard>()).get();
+    owner = id_;
+  }
+  return *s;
+}
+
+void metrics::observe(search_profile const p,
+                      routing_algorithm const a,
+                      request_phase const ph,
+                      std::chrono::steady_clock::duration const d) {
+  record(get_shard().latency_[histogram_idx(p, a, ph)], d);
+}
+
+void metrics::observe_queue_wait(cost_class const c,
+                                 std::chrono::steady_clock::duration const d,
+                                 bool const shed) {
+  auto& s = get_shard();
+  record(s.queue_wait_[static_cast<std::size_t>(c)], d);
+  if (shed) {
+    s.shed_[static_cast<std::size_t>(c)].fetch_add(1U,
+                                                   std::memory_order_relaxed);
+  }
+}
+
+std::string metrics::to_prometheus() const {
+  auto out = std::string{};
+  append(
+      out,
+      "# HELP osr_request_duration_seconds Request latency by phase.\n"
+      "# TYPE osr_request_duration_seconds histogram\n");
+  {
+    auto const lock = std::scoped_lock{mutex_};
+    for (auto p = 0U; p != kNumProfiles; ++p) {
+      for (auto a = 0U; a != kNumRoutingAlgorithms; ++a) {
+        for (auto ph = 0U; ph != kNumRequestPhases; ++ph) {
+          auto const profile = static_cast<search_profile>(p);
+          auto const algo = static_cast<routing_algorithm>(a);
+          auto const phase = static_cast<request_phase>(ph);
+          auto const idx = histogram_idx(profile, algo, phase);
+
+          append_histogram(
+              out, "osr_request_duration_seconds",
+              fmt::format(R"(profile="{}",algorithm="{}",phase="{}")",
+                          to_str(profile), to_str(algo), to_str(phase)),
+              shards_, [&](shard const& s) -> histogram const& {
+                return s.latency_[idx];
+              });
+        }
+      }
+    }
+
+    append(out,
+           "# HELP osr_queue_wait_seconds Time spent in the admission queue.\n"
+           "# TYPE osr_queue_wait_seconds histogram\n");
+    for (auto c = 0U; c != kNumCostClasses; ++c) {
+      append_histogram(out, "osr_queue_wait_seconds",
+                       fmt::format(R"(class="{}")",
+                                   to_str(static_cast<cost_class>(c))),
+                       shards_, [&](shard const& s) -> histogram const& {
+                         return s.queue_wait_[c];
+                       });
+    }
+
+    append(out,
+           "# HELP osr_requests_shed_total Requests rejected with 503 after "
+           "waiting too long.\n"
+           "# TYPE osr_requests_shed_total counter\n");
+    for (auto c = 0U; c != kNumCostClasses; ++c) {
+      auto shed = std::uint64_t{0U};
+      for (auto const& s : shards_) {
+        shed += s->shed_[c].load(std::memory_order_relaxed);
+      }
+      append(out, "osr_requests_shed_total{{class=\"{}\"}} {}\n",
+             to_str(static_cast<cost_class>(c)), shed);
+    }
+  }
+
+  auto const mem = get_memory_usage();
+  append(
+      out,
+      "# HELP osr_thread_pool_queue_depth Requests waiting for a worker.\n"
+      "# TYPE osr_thread_pool_queue_depth gauge\n"
+      "osr_thread_pool_queue_depth {}\n"
+      "# HELP osr_requests_in_flight Requests received but not answered.\n"
+      "# TYPE osr_requests_in_flight gauge\n"
+      "osr_requests_in_flight {}\n"
+      "# HELP osr_resident_memory_bytes Resident set size.\n"
+      "# TYPE osr_resident_memory_bytes gauge\n"
+      "osr_resident_memory_bytes {}\n"
+      "# HELP osr_mmap_resident_bytes Resident pages of mapped data files.\n"
+      "# TYPE osr_mmap_resident_bytes gauge\n"
+      "osr_mmap_resident_bytes {}\n",
+      queue_depth_.load(std::memory_order_relaxed),
+      in_flight_.load(std::memory_order_relaxed), mem.rss_, mem.mmap_rss_);
+
+  return out;
+}
+
+}  // namespace osr::backend
@@ -1,8 +1,10 @@
 #include <chrono>
+#include <ctime>
 #include <filesystem>
 #include <memory>
 #include <mutex>
 #include <numeric>
+#include <span>
 #include <thread>
 #include <vector>
 
@@ -23,6 +25,8 @@
 #include "osr/lookup.h"
 #include "osr/routing/bidirectional.h"
 #include "osr/routing/dijkstra.h"
+#include "osr/routing/interleaved.h"
+#include "osr/routing/landmarks.h"
 #include "osr/routing/profile.h"
 #include "osr/routing/profiles/car.h"
 #include "osr/routing/route.h"
@@ -43,6 +47,12 @@ public:
     param(from_coords_, "matching,m", "Include node matching to coords");
     param(speed_, "speed,s", "Walking speed");
     param(mem_usage_, "mem", "Track memory usage");
+    param(parallel_, "parallel,p",
+          "Compare with the parallel bidirectional search (CPU time is only "
+          "reported for --threads 1)");
+    param(interleave_, "interleave,i",
+          "Compare one-to-all throughput with batches of N interleaved "
+          "searches per thread (0 = off)");
   }
 
   fs::path data_dir_{"osr"};
@@ -52,6 +62,8 @@ public:
   unsigned threads_{std::thread::hardware_concurrency()};
   float speed_{1.2F};
   bool mem_usage_{false};
+  bool parallel_{false};
+  unsigned interleave_{0U};
 };
 
 struct benchmark_result {
@@ -67,6 +79,12 @@ struct benchmark_result {
   }
 
   std::chrono::microseconds duration_;
+  std::size_t n_settled_{0U};
+  std::size_t n_settled_alt_{0U};
+  std::chrono::microseconds bidir_duration_{0U};
+  std::chrono::microseconds parallel_duration_{0U};
+  std::clock_t bidir_cpu_{0};
+  std::clock_t parallel_cpu_{0};
 };
 
 // needs sorted vector
@@ -79,7 +97,8 @@ benchmark_result quantile(std::vector<benchmark_result> const& v, double q) {
 }
 
 void print_result(std::vector<benchmark_result> const& var,
-                  std::string const& profile) {
+                  std::string const& profile,
+                  bool const print_cpu) {
   auto const avg = benchmark_result{
       std::accumulate(var.begin(), var.end(), std::chrono::microseconds{0U},
                       [](auto&& sum, auto const& res) {
@@ -100,6 +119,61 @@ void print_result(std::vector<benchmark_result> const& var,
             << "\n  99%: " << quantile(var, 0.99)
             << "\n99.9%: " << quantile(var, 0.999)
             << "\n-----------------------------\n";
+
+  auto const n_settled = std::accumulate(
+      var.begin(), var.end(), std::size_t{0U},
+      [](std::size_t const sum, auto const& res) {
+        return sum + res.n_settled_;
+      });
+  auto const n_settled_alt = std::accumulate(
+      var.begin(), var.end(), std::size_t{0U},
+      [](std::size_t const sum, auto const& res) {
+        return sum + res.n_settled_alt_;
+      });
+  if (n_settled != 0U) {
+    std::cout << "settled labels (avg): " << n_settled / var.size() << "\n";
+  }
+  if (n_settled_alt != 0U) {
+    std::cout << "settled labels with ALT (avg): " << n_settled_alt / var.size()
+              << " (" << std::setprecision(1)
+              << 100.0 * (1.0 - static_cast<double>(n_settled_alt) /
+                                    static_cast<double>(n_settled))
+              << "% less)\n";
+  }
+
+  auto const sum = [&](auto&& get) {
+    return std::accumulate(
+        var.begin(), var.end(), decltype(get(var.front())){},
+        [&](auto const acc, auto const& res) { return acc + get(res); });
+  };
+  auto const parallel_duration = sum(
+      [](benchmark_result const& res) { return res.parallel_duration_; });
+  if (parallel_duration.count() != 0) {
+    auto const to_ms = [&](auto const d) {
+      return std::chrono::duration<double, std::milli>(d).count() /
+             static_cast<double>(var.size());
+    };
+    std::cout << std::setprecision(3) << "bidirectional (avg): "
+              << to_ms(sum([](benchmark_result const& res) {
+                   return res.bidir_duration_;
+                 }))
+              << "ms, parallel (avg): " << to_ms(parallel_duration) << "ms\n";
+    if (print_cpu) {
+      auto const cpu_ms = [&](std::clock_t const c) {
+        return 1000.0 * static_cast<double>(c) / CLOCKS_PER_SEC /
+               static_cast<double>(var.size());
+      };
+      std::cout << "cpu time bidirectional (avg): "
+                << cpu_ms(sum([](benchmark_result const& res) {
+                     return res.bidir_cpu_;
+                   }))
+                << "ms, parallel (avg): "
+                << cpu_ms(sum([](benchmark_result const& res) {
+                     return res.parallel_cpu_;
+                   }))
+                << "ms\n";
+    }
+  }
 }
 
 template <Profile P>
@@ -202,6 +276,7 @@ int main(int argc, char const* argv[]) {
                                  search_profile const profile,
                                  const char* profile_label) {
     results.clear();
+    auto const lm = landmarks::try_open(opt.data_dir_, profile);
     auto i = std::atomic_size_t{0U};
     auto m = std::mutex{};
     for (auto& t : threads) {
@@ -236,6 +311,20 @@ int main(int argc, char const* argv[]) {
                       direction::kForward, 250, nullptr, nullptr, nullptr,
                       routing_algorithm::kAStarBi);
             auto const end_time = std::chrono::steady_clock::now();
+            auto const n_settled = get_bidirectional<P>().n_settled_;
+
+            auto n_settled_alt = std::size_t{0U};
+            if (lm != nullptr) {
+              auto const alt_res = route(
+                  params, w, l, profile, start_loc, end_loc, opt.max_dist_,
+                  direction::kForward, 250, nullptr, nullptr, nullptr,
+                  routing_algorithm::kAStarBi, lm.get());
+              n_settled_alt = get_bidirectional<P>().n_settled_;
+              if (alt_res.has_value() != b_res.has_value() ||
+                  (b_res.has_value() && alt_res->cost_ != b_res->cost_)) {
+                std::cout << "ALT not equal" << std::endl;
+              }
+            }
 
             /*std::cout << "took "
                       << std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -251,9 +340,11 @@ int main(int argc, char const* argv[]) {
                         "not equal {} {}", d_res->cost_, b_res->cost_);
             {
               auto const guard = std::lock_guard{m};
-              results.emplace_back(benchmark_result{std::chrono::duration_cast<
-                  decltype(benchmark_result::duration_)>(end_time -
-                                                         middle_time)});
+              results.emplace_back(benchmark_result{
+                  std::chrono::duration_cast<
+                      decltype(benchmark_result::duration_)>(end_time -
+                                                             middle_time),
+                  n_settled, n_settled_alt});
             }
           } else {
             if (w.r_->way_component_[w.r_->node_ways_[start][0]] !=
@@ -272,9 +363,11 @@ int main(int argc, char const* argv[]) {
                 params, w, *w.r_, opt.max_dist_, nullptr, nullptr,
                 elevations.get());
             auto const middle_time = std::chrono::steady_clock::now();
+            auto const cpu_start = std::clock();
             b.template run<direction::kForward, false>(
                 params, w, *w.r_, opt.max_dist_, nullptr, nullptr,
                 elevations.get());
+            auto const bidir_cpu = std::clock() - cpu_start;
             auto const end_time = std::chrono::steady_clock::now();
             /*std::cout << "took "
                       << std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -294,11 +387,57 @@ int main(int argc, char const* argv[]) {
 
               std::cout << "not equal" << std::endl;
             }
+            auto const n_settled = b.n_settled_;
+
+            auto n_settled_alt = std::size_t{0U};
+            if (lm != nullptr) {
+              b.reset(params, opt.max_dist_, start_loc, end_loc);
+              b.alt_.reset(lm.get(), direction::kForward);
+              b.alt_.add_source(start);
+              b.alt_.add_target(end);
+              set_start<P>(params, b, w, start);
+              set_end<P>(params, b, w, end);
+              b.template run<direction::kForward, false>(
+                  params, w, *w.r_, opt.max_dist_, nullptr, nullptr,
+                  elevations.get());
+              n_settled_alt = b.n_settled_;
+              if (b.get_cost_to_mp(b.meet_point_1_, b.meet_point_2_) !=
+                  b_res) {
+                std::cout << "ALT not equal" << std::endl;
+              }
+            }
+
+            auto parallel_duration = std::chrono::steady_clock::duration{};
+            auto parallel_cpu = std::clock_t{0};
+            if (opt.parallel_) {
+              b.reset(params, opt.max_dist_, start_loc, end_loc);
+              set_start<P>(params, b, w, start);
+              set_end<P>(params, b, w, end);
+              auto const parallel_start = std::chrono::steady_clock::now();
+              auto const parallel_cpu_start = std::clock();
+              b.template run_parallel<direction::kForward, false>(
+                  params, w, *w.r_, opt.max_dist_, nullptr, nullptr,
+                  elevations.get());
+              parallel_cpu = std::clock() - parallel_cpu_start;
+              parallel_duration =
+                  std::chrono::steady_clock::now() - parallel_start;
+              if (b.get_cost_to_mp(b.meet_point_1_, b.meet_point_2_) !=
+                  b_res) {
+                std::cout << "parallel not equal" << std::endl;
+              }
+            }
+
             {
+              using duration_t = decltype(benchmark_result::duration_);
               auto const guard = std::lock_guard{m};
-              results.emplace_back(benchmark_result{std::chrono::duration_cast<
-                  decltype(benchmark_result::duration_)>(end_time -
-                                                         start_time)});
+              results.emplace_back(benchmark_result{
+                  std::chrono::duration_cast<duration_t>(end_time -
+                                                         start_time),
+                  n_settled, n_settled_alt,
+                  std::chrono::duration_cast<duration_t>(end_time -
+                                                         middle_time),
+                  std::chrono::duration_cast<duration_t>(parallel_duration),
+                  bidir_cpu, parallel_cpu});
             }
           }
         }
@@ -313,9 +452,75 @@ int main(int argc, char const* argv[]) {
       return res.duration_;
     });
 
-    print_result(results, profile_label);
+    print_result(results, profile_label, threads.size() == 1U);
   };
 
+  // One-to-all throughput: every thread runs its share of the queries either
+  // one after another or in batches of --interleave searches at once.
+  auto const run_throughput_benchmark =
+      [&]<Profile P>(typename P::parameters const& params,
+                     const char* profile_label) {
+        auto starts = std::vector<node_idx_t>{};
+        auto h = cista::BASE_HASH;
+        auto const max_tries = 100U * opt.n_queries_;
+        for (auto n = 0U; starts.size() != opt.n_queries_ && n != max_tries;
+             ++n) {
+          auto const start =
+              node_idx_t{cista::hash_combine(h, n) % w.n_nodes()};
+          if (!w.r_->node_ways_[start].empty()) {
+            starts.push_back(start);
+          }
+        }
+
+        auto const run = [&](unsigned const batch_size) {
+          auto next = std::atomic_size_t{0U};
+          auto const start_time = std::chrono::steady_clock::now();
+          for (auto& t : threads) {
+            t = std::thread([&]() {
+              auto searches = std::vector<dijkstra<P>>(batch_size);
+              while (true) {
+                auto const from = next.fetch_add(batch_size);
+                if (from >= starts.size()) {
+                  break;
+                }
+                auto const to = std::min(from + batch_size, starts.size());
+                for (auto i = from; i != to; ++i) {
+                  auto& d = searches[i - from];
+                  d.reset(opt.max_dist_);
+                  set_start<P>(d, w, starts[i]);
+                }
+                auto const batch = std::span{searches}.subspan(0U, to - from);
+                if (batch_size == 1U) {
+                  batch[0].template run<direction::kForward, false>(
+                      params, w, *w.r_, opt.max_dist_, nullptr, nullptr,
+                      elevations.get());
+                } else {
+                  run_interleaved<direction::kForward, false>(
+                      params, w, *w.r_, opt.max_dist_, nullptr, nullptr,
+                      elevations.get(), batch);
+                }
+              }
+            });
+          }
+          for (auto& t : threads) {
+            t.join();
+          }
+          auto const end_time = std::chrono::steady_clock::now();
+          return std::chrono::duration<double>(end_time - start_time).count();
+        };
+
+        auto const single = run(1U);
+        auto const interleaved = run(opt.interleave_);
+        auto const n = static_cast<double>(starts.size());
+        fmt::println(
+            "\n--- throughput: {} --- (n = {}, threads = {})"
+            "\n  single:           {:8.3f}s {:10.2f} queries/s"
+            "\n  interleaved ({:>2}): {:8.3f}s {:10.2f} queries/s ({:.2f}x)",
+            profile_label, starts.size(), threads.size(), single, n / single,
+            opt.interleave_, interleaved, n / interleaved,
+            single / interleaved);
+      };
+
   auto const run_speed_benchmark = [&](search_profile const profile,
                                        std::string_view label,
                                        float const speed = 0.0F) {
@@ -329,6 +534,9 @@ int main(int argc, char const* argv[]) {
         }
       }();
       run_benchmark.template operator()<P>(params, profile, label.data());
+      if (opt.interleave_ > 1U) {
+        run_throughput_benchmark.template operator()<P>(params, label.data());
+      }
     });
   };
   auto const walk_speed = opt.speed_;
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <vector>
+
+#include "fmt/core.h"
+#include "fmt/std.h"
+
+#include "conf/options_parser.h"
+
+#include "utl/progress_tracker.h"
+
+#include "osr/elevation_storage.h"
+#include "osr/preprocessing/elevation/provider.h"
+#include "osr/ways.h"
+
+using namespace osr;
+namespace fs = std::filesystem;
+namespace ev = osr::preprocessing::elevation;
+
+struct config : public conf::configuration {
+  config(std::filesystem::path data, std::filesystem::path elevation_data)
+      : configuration{"Options"},
+        data_{std::move(data)},
+        elevation_data_{std::move(elevation_data)} {
+    param(data_, "data,d", "data directory created by osr-extract");
+    param(elevation_data_, "elevation_data,e", "directory with elevation data");
+    param(changed_, "changed,c",
+          "directory with added or updated elevation tiles: only ways "
+          "overlapping these tiles are recomputed");
+    param(work_dir_, "work,w",
+          "directory for intermediate results and the checkpoint (default: "
+          "<data>/elevation_tmp)");
+    param(max_open_tiles_, "max_open_tiles", "maximum mapped tiles per driver");
+  }
+
+  std::filesystem::path data_, elevation_data_, changed_, work_dir_;
+  std::size_t max_open_tiles_{ev::kDefaultMaxOpenTiles};
+};
+
+int main(int ac, char const** av) {
+  auto c = config{"./osr", "./elevation"};
+
+  conf::options_parser parser({&c});
+  parser.read_command_line_args(ac, av);
+
+  parser.read_configuration_file();
+
+  parser.print_unrecognized(std::cout);
+  parser.print_used(std::cout);
+
+  if (!fs::is_directory(c.data_)) {
+    fmt::println("directory not found: {}", c.data_);
+    return 1;
+  }
+
+  auto const provider = ev::provider{c.elevation_data_, c.max_open_tiles_};
+  if (provider.driver_count() == 0U) {
+    fmt::println("no elevation data found in {}", c.elevation_data_);
+    return 1;
+  }
+
+  auto changed = std::vector<geo::box>{};
+  if (!c.changed_.empty()) {
+    changed = ev::provider{c.changed_, c.max_open_tiles_}.tile_boxes();
+    if (changed.empty()) {
+      fmt::println("no elevation tiles found in {}", c.changed_);
+      return 1;
+    }
+  }
+
+  utl::activate_progress_tracker("osr");
+  auto const silencer = utl::global_progress_bars{false};
+
+  auto const w = ways{c.data_, cista::mmap::protection::READ};
+  compute_elevations(
+      w, provider, c.data_,
+      c.work_dir_.empty() ? c.data_ / "elevation_tmp" : c.work_dir_, changed);
+}
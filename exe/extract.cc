@@ -1,4 +1,6 @@
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "fmt/core.h"
 #include "fmt/std.h"
@@ -8,6 +10,8 @@
 #include "utl/progress_tracker.h"
 
 #include "osr/extract/extract.h"
+#include "osr/routing/landmarks.h"
+#include "osr/ways.h"
 
 using namespace osr;
 using namespace boost::program_options;
@@ -20,10 +24,13 @@ struct config : public conf::configuration {
     param(out_, "out,o", "output directory");
     param(elevation_data_, "elevation_data,e", "directory with elevation data");
     param(with_platforms_, "with_platforms,p", "extract platform info");
+    param(landmark_profiles_, "landmarks,l",
+          "profiles to precompute ALT landmarks for (e.g. car)");
   }
 
   std::filesystem::path in_, out_, elevation_data_;
   bool with_platforms_{false};
+  std::vector<std::string> landmark_profiles_;
 };
 
 int main(int ac, char const** av) {
@@ -46,4 +53,11 @@ int main(int ac, char const** av) {
   auto const silencer = utl::global_progress_bars{false};
 
   extract(c.with_platforms_, c.in_, c.out_, c.elevation_data_);
+
+  if (!c.landmark_profiles_.empty()) {
+    auto const w = ways{c.out_, cista::mmap::protection::READ};
+    for (auto const& p : c.landmark_profiles_) {
+      compute_landmarks(w, to_profile(p), c.out_);
+    }
+  }
 }
\ No newline at end of file
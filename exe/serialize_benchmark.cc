@@ -0,0 +1,137 @@
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "fmt/core.h"
+#include "fmt/std.h"
+
+#include "conf/options_parser.h"
+
+#include "osr/geojson.h"
+#include "osr/location.h"
+#include "osr/lookup.h"
+#include "osr/routing/parameters.h"
+#include "osr/routing/profile.h"
+#include "osr/routing/route.h"
+#include "osr/types.h"
+#include "osr/ways.h"
+
+namespace fs = std::filesystem;
+using namespace osr;
+
+class settings : public conf::configuration {
+public:
+  explicit settings() : configuration("Options") {
+    param(data_dir_, "data,d", "Data directory");
+    param(n_routes_, ",n", "Number of routes");
+    param(repetitions_, "repetitions,r", "Serializations per route");
+    param(profile_, "profile,p", "Search profile");
+    param(max_, "max,m", "Max. route cost in seconds");
+  }
+
+  fs::path data_dir_{"osr"};
+  unsigned n_routes_{100U};
+  unsigned repetitions_{50U};
+  std::string profile_{"foot"};
+  unsigned max_{3600U};
+};
+
+// Compares the boost::json DOM serialization of route responses
+// (to_featurecollection) with the streaming writer (write_featurecollection).
+int main(int argc, char const* argv[]) {
+  auto opt = settings{};
+  auto parser = conf::options_parser({&opt});
+  parser.read_command_line_args(argc, argv);
+
+  if (parser.help()) {
+    parser.print_help(std::cout);
+    return 0;
+  } else if (parser.version()) {
+    return 0;
+  }
+
+  parser.read_configuration_file();
+  parser.print_unrecognized(std::cout);
+  parser.print_used(std::cout);
+
+  if (!fs::is_directory(opt.data_dir_)) {
+    fmt::println("directory not found: {}", opt.data_dir_);
+    return 1;
+  }
+
+  auto const w = ways{opt.data_dir_, cista::mmap::protection::READ};
+  auto const l = lookup{w, opt.data_dir_, cista::mmap::protection::READ};
+  auto const profile = to_profile(opt.profile_);
+  auto const params = get_parameters(profile);
+
+  auto paths = std::vector<std::optional<path>>{};
+  auto h = cista::BASE_HASH;
+  auto n = 0U;
+  for (auto attempt = 0U;
+       paths.size() != opt.n_routes_ && attempt != 100U * opt.n_routes_;
+       ++attempt) {
+    auto const start = node_idx_t{cista::hash_combine(h, ++n) % w.n_nodes()};
+    auto const end = node_idx_t{cista::hash_combine(h, ++n) % w.n_nodes()};
+    if (w.r_->node_ways_[start].empty() || w.r_->node_ways_[end].empty()) {
+      continue;
+    }
+    auto p = route(params, w, l, profile,
+                   location{w.get_node_pos(start).as_latlng(), level_t{0.F}},
+                   location{w.get_node_pos(end).as_latlng(), level_t{0.F}},
+                   static_cast<cost_t>(opt.max_), direction::kForward, 100.0);
+    if (p.has_value() && !p->segments_.empty()) {
+      paths.emplace_back(std::move(p));
+    }
+  }
+
+  auto n_segments = std::size_t{0U};
+  auto n_points = std::size_t{0U};
+  for (auto const& p : paths) {
+    n_segments += p->segments_.size();
+    for (auto const& s : p->segments_) {
+      n_points += s.polyline_.size();
+    }
+  }
+  auto const per_route = [&](std::size_t const x) {
+    return paths.empty() ? 0.0
+                         : static_cast<double>(x) /
+                               static_cast<double>(paths.size());
+  };
+  fmt::println("routes: {}, segments/route: {:.1f}, points/route: {:.1f}",
+               paths.size(), per_route(n_segments), per_route(n_points));
+  if (paths.empty()) {
+    return 1;
+  }
+
+  auto const measure = [&](char const* label, auto&& serialize) {
+    auto bytes = std::size_t{0U};
+    auto const start = std::chrono::steady_clock::now();
+    for (auto i = 0U; i != opt.repetitions_; ++i) {
+      for (auto const& p : paths) {
+        bytes += serialize(p);
+      }
+    }
+    auto const seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+            .count();
+    auto const n_serialized =
+        static_cast<double>(paths.size()) * opt.repetitions_;
+    fmt::println("{:>6}: {:8.2f} us/route {:8.1f} MB/s", label,
+                 1'000'000.0 * seconds / n_serialized,
+                 static_cast<double>(bytes) / seconds / 1'000'000.0);
+    return seconds;
+  };
+
+  auto const dom = measure("dom", [&](std::optional<path> const& p) {
+    return to_featurecollection(w, p).size();
+  });
+  auto buf = std::string{};
+  auto const stream = measure("stream", [&](std::optional<path> const& p) {
+    buf.clear();
+    write_featurecollection(buf, w, *p);
+    return buf.size();
+  });
+  fmt::println("speedup: {:.2f}x", dom / stream);
+}
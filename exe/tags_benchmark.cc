@@ -0,0 +1,177 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "fmt/core.h"
+#include "fmt/std.h"
+
+#include "conf/options_parser.h"
+
+#include "cista/hash.h"
+
+#include "osmium/handler.hpp"
+#include "osmium/io/pbf_input.hpp"
+#include "osmium/io/reader.hpp"
+#include "osmium/memory/buffer.hpp"
+#include "osmium/osm/object.hpp"
+#include "osmium/visitor.hpp"
+
+#include "osr/extract/tags.h"
+
+using namespace osr;
+namespace fs = std::filesystem;
+
+struct config : public conf::configuration {
+  explicit config(std::filesystem::path in)
+      : configuration{"Options"}, in_{std::move(in)} {
+    param(in_, "in,i", "OpenStreetMap .osm.pbf input path");
+    param(rounds_, "rounds,r", "number of passes over the input");
+  }
+
+  std::filesystem::path in_;
+  unsigned rounds_{5U};
+};
+
+// Key dispatch as done by the tags parser before the perfect hash table:
+// FNV-1a over the full key, then a switch over the hashes.
+tag_key fnv_find(std::string_view const key) {
+  switch (cista::hash(key)) {
+    case cista::hash("ramp"): return tag_key::kRamp;
+    case cista::hash("type"): return tag_key::kType;
+    case cista::hash("parking"): return tag_key::kParking;
+    case cista::hash("amenity"): return tag_key::kAmenity;
+    case cista::hash("building"): return tag_key::kBuilding;
+    case cista::hash("landuse"): return tag_key::kLanduse;
+    case cista::hash("railway"): return tag_key::kRailway;
+    case cista::hash("oneway"): return tag_key::kOneway;
+    case cista::hash("junction"): return tag_key::kJunction;
+    case cista::hash("oneway:bicycle"): return tag_key::kOnewayBicycle;
+    case cista::hash("oneway:bus"): return tag_key::kOnewayBus;
+    case cista::hash("oneway:psv"): return tag_key::kOnewayPsv;
+    case cista::hash("busway"): return tag_key::kBusway;
+    case cista::hash("busway:left"): return tag_key::kBuswayLeft;
+    case cista::hash("busway:right"): return tag_key::kBuswayRight;
+    case cista::hash("busway:both"): return tag_key::kBuswayBoth;
+    case cista::hash("motor_vehicle:forward"):
+      return tag_key::kMotorVehicleForward;
+    case cista::hash("motor_vehicle"): return tag_key::kMotorVehicle;
+    case cista::hash("foot"): return tag_key::kFoot;
+    case cista::hash("bicycle"): return tag_key::kBicycle;
+    case cista::hash("highway"): return tag_key::kHighway;
+    case cista::hash("indoor:level"): return tag_key::kIndoorLevel;
+    case cista::hash("level"): return tag_key::kLevel;
+    case cista::hash("name"): return tag_key::kName;
+    case cista::hash("ref"): return tag_key::kRef;
+    case cista::hash("entrance"): return tag_key::kEntrance;
+    case cista::hash("sidewalk"): return tag_key::kSidewalk;
+    case cista::hash("sidewalk:both"): return tag_key::kSidewalkBoth;
+    case cista::hash("sidewalk:left"): return tag_key::kSidewalkLeft;
+    case cista::hash("sidewalk:right"): return tag_key::kSidewalkRight;
+    case cista::hash("cycleway"): return tag_key::kCycleway;
+    case cista::hash("motorcar"): return tag_key::kMotorcar;
+    case cista::hash("barrier"): return tag_key::kBarrier;
+    case cista::hash("platform_edge"): return tag_key::kPlatformEdge;
+    case cista::hash("public_transport"): return tag_key::kPublicTransport;
+    case cista::hash("construction"): return tag_key::kConstruction;
+    case cista::hash("vehicle"): return tag_key::kVehicle;
+    case cista::hash("psv"): return tag_key::kPsv;
+    case cista::hash("bus"): return tag_key::kBus;
+    case cista::hash("access"): return tag_key::kAccess;
+    case cista::hash("access:conditional"): return tag_key::kAccessConditional;
+    case cista::hash("maxspeed"): return tag_key::kMaxspeed;
+    case cista::hash("toll"): return tag_key::kToll;
+    case cista::hash("incline"): return tag_key::kIncline;
+    case cista::hash("route"): return tag_key::kRoute;
+    case cista::hash("service"): return tag_key::kService;
+    default: return tag_key::kUnknown;
+  }
+}
+
+template <typename Fn>
+void for_each_object(std::vector<osmium::memory::Buffer> const& buffers,
+                     Fn&& fn) {
+  for (auto const& buf : buffers) {
+    for (auto const& o : buf.select<osmium::OSMObject>()) {
+      fn(o);
+    }
+  }
+}
+
+template <typename Fn>
+void measure(std::string_view const name,
+             unsigned const rounds,
+             std::uint64_t const n_tags,
+             Fn&& fn) {
+  auto checksum = std::uint64_t{0U};
+  auto const start = std::chrono::steady_clock::now();
+  for (auto i = 0U; i != rounds; ++i) {
+    checksum += fn();
+  }
+  auto const seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+  fmt::println("{:<16} {:>8.3f}s  {:>8.2f} M tags/s  [checksum={}]", name,
+               seconds, static_cast<double>(n_tags) * rounds / seconds / 1E6,
+               checksum);
+}
+
+int main(int ac, char const** av) {
+  auto c = config{"./planet-latest.osm.pbf"};
+
+  conf::options_parser parser({&c});
+  parser.read_command_line_args(ac, av);
+
+  parser.read_configuration_file();
+
+  parser.print_unrecognized(std::cout);
+  parser.print_used(std::cout);
+
+  if (!fs::is_regular_file(c.in_)) {
+    fmt::println("input file {} not found", c.in_);
+    return 1;
+  }
+
+  auto buffers = std::vector<osmium::memory::Buffer>{};
+  auto reader = osmium::io::Reader{osmium::io::File{c.in_.generic_string()}};
+  while (auto buf = reader.read()) {
+    buffers.emplace_back(std::move(buf));
+  }
+  reader.close();
+
+  auto n_tags = std::uint64_t{0U};
+  for_each_object(buffers, [&](osmium::OSMObject const& o) {
+    n_tags += o.tags().size();
+  });
+  fmt::println("{} tags in {} buffers", n_tags, buffers.size());
+
+  measure("keys: fnv", c.rounds_, n_tags, [&]() {
+    auto sum = std::uint64_t{0U};
+    for_each_object(buffers, [&](osmium::OSMObject const& o) {
+      for (auto const& t : o.tags()) {
+        sum += static_cast<std::uint64_t>(fnv_find(t.key()));
+      }
+    });
+    return sum;
+  });
+
+  measure("keys: perfect", c.rounds_, n_tags, [&]() {
+    auto sum = std::uint64_t{0U};
+    for_each_object(buffers, [&](osmium::OSMObject const& o) {
+      for (auto const& t : o.tags()) {
+        sum += static_cast<std::uint64_t>(kTagKeys.find(t.key()));
+      }
+    });
+    return sum;
+  });
+
+  measure("tags{}", c.rounds_, n_tags, [&]() {
+    auto sum = std::uint64_t{0U};
+    for_each_object(buffers, [&](osmium::OSMObject const& o) {
+      auto const t = tags{o};
+      sum += t.highway_.size() + static_cast<std::uint64_t>(t.access_) +
+             (t.is_platform() ? 1U : 0U);
+    });
+    return sum;
+  });
+}
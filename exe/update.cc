@@ -0,0 +1,64 @@
+#include <iostream>
+
+#include "fmt/core.h"
+#include "fmt/std.h"
+
+#include "conf/options_parser.h"
+
+#include "utl/progress_tracker.h"
+
+#include "osr/extract/update.h"
+
+using namespace osr;
+namespace fs = std::filesystem;
+
+struct config : public conf::configuration {
+  config(std::filesystem::path in, std::filesystem::path data)
+      : configuration{"Options"}, in_{std::move(in)}, data_{std::move(data)} {
+    param(in_, "in,i", "OpenStreetMap change file (.osc, .osc.gz)");
+    param(data_, "data,d", "data directory created by osr-extract");
+  }
+
+  std::filesystem::path in_, data_;
+};
+
+int main(int ac, char const** av) {
+  auto c = config{"./changes.osc.gz", "./osr"};
+
+  conf::options_parser parser({&c});
+  parser.read_command_line_args(ac, av);
+
+  parser.read_configuration_file();
+
+  parser.print_unrecognized(std::cout);
+  parser.print_used(std::cout);
+
+  if (!fs::is_regular_file(c.in_)) {
+    fmt::println("input file {} not found", c.in_);
+    return 1;
+  }
+
+  if (!fs::is_directory(c.data_)) {
+    fmt::println("directory not found: {}", c.data_);
+    return 1;
+  }
+
+  utl::activate_progress_tracker("osr");
+  auto const silencer = utl::global_progress_bars{false};
+
+  auto const s = update(c.in_, c.data_);
+  fmt::println(
+      "ways: {} modified, {} deleted, {} new, {} with new geometry\n"
+      "nodes: {} modified, {} deleted, {} new\n"
+      "restrictions: {} relations changed",
+      s.modified_ways_, s.deleted_ways_, s.new_ways_, s.moved_ways_,
+      s.modified_nodes_, s.deleted_nodes_, s.new_nodes_, s.restrictions_);
+
+  if (s.unsupported_ != 0U) {
+    fmt::println(
+        "{} changes cannot be applied incrementally, run osr-extract to "
+        "include them",
+        s.unsupported_);
+    return 2;
+  }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cinttypes>
+#include <chrono>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "osr/types.h"
+
+namespace osr {
+
+// Compiled time condition of an access:conditional=no @ (...) restriction.
+// The way is blocked if the local time lies in a month of months_ (bit 0 =
+// January), on a weekday of weekdays_ (bit 0 = Monday) and within
+// [from_, to_) minutes of the day. If from_ > to_, the interval wraps
+// midnight and the part after midnight belongs to the following day.
+struct time_rule {
+  bool matches(std::chrono::local_seconds) const;
+
+  way_idx_t way_;
+  std::uint16_t months_;
+  std::uint8_t weekdays_;
+  std::uint16_t from_, to_;
+};
+
+// Compiles the condition part of access:conditional (without "no @ (" and
+// ")"). Supports the opening hours subset "24/7", months ("Jan", "Nov-Feb"),
+// weekdays ("Mo-Fr,Su") and times ("07:00-09:00,16:00-18:30") combined in
+// rules separated by ";". Returns std::nullopt for everything else (holidays,
+// dates, weight/vehicle conditions, ...).
+std::optional<std::vector<time_rule>> compile_conditional_access(
+    std::string_view condition, way_idx_t);
+
+}  // namespace osr
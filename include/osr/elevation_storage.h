@@ -2,10 +2,14 @@
 
 #include <cstdint>
 #include <filesystem>
+#include <limits>
 #include <memory>
+#include <span>
 
 #include "cista/mmap.h"
 
+#include "geo/box.h"
+
 #include "osr/types.h"
 #include "osr/ways.h"
 
@@ -42,6 +46,24 @@ struct elevation_storage {
   mm_vecvec<way_idx_t, encoding> elevations_;
 };
 
+// Computes the elevation storage of an existing data directory without
+// touching the ways. If changed is not empty and the directory already has
+// elevations, only ways overlapping one of the changed tile boxes are
+// recomputed. Intermediate results are stored in work_dir with a checkpoint
+// after every chunk_size ways, so an interrupted run continues when called
+// again with the same input. A checkpoint of a different input is discarded.
+// Returns false (keeping the checkpoint) if max_chunks chunks were computed
+// before all ways were done.
+constexpr auto const kElevationChunkSize = std::size_t{1U} << 16U;
+bool compute_elevations(
+    ways const&,
+    preprocessing::elevation::provider const&,
+    std::filesystem::path const& dir,
+    std::filesystem::path const& work_dir,
+    std::span<geo::box const> changed,
+    std::size_t chunk_size = kElevationChunkSize,
+    std::size_t max_chunks = std::numeric_limits<std::size_t>::max());
+
 elevation_storage::elevation get_elevations(elevation_storage const*,
                                             way_idx_t const way,
                                             std::uint16_t const segment);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "osr/extract/tags.h"
+#include "osr/types.h"
+#include "osr/ways.h"
+
+namespace osmium {
+class Relation;
+}  // namespace osmium
+
+namespace osr {
+
+way_properties get_way_properties(tags const&,
+                                  osm_obj_type = osm_obj_type::kWay);
+
+std::pair<node_properties, level_bits_t> get_node_properties(tags const&);
+
+// Appends one restriction for every from/to way pair of a turn restriction
+// relation. Appends nothing for other relations and if the via node or all
+// from/to ways are not part of the graph.
+void resolve_restriction(ways const&,
+                         osmium::Relation const&,
+                         std::vector<resolved_restriction>&);
+
+}  // namespace osr
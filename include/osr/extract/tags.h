@@ -5,6 +5,7 @@
 #include "osmium/osm/object.hpp"
 
 #include "osr/types.h"
+#include "osr/util/perfect_hash.h"
 
 namespace osr {
 
@@ -12,6 +13,167 @@ enum class osm_obj_type : std::uint8_t { kWay, kNode, kRelation };
 
 enum class override : std::uint8_t { kNone, kWhitelist, kBlacklist };
 
+// Keys evaluated by the tags parser.
+enum class tag_key : std::uint8_t {
+  kUnknown,
+  kRamp,
+  kType,
+  kParking,
+  kAmenity,
+  kBuilding,
+  kLanduse,
+  kRailway,
+  kOneway,
+  kJunction,
+  kOnewayBicycle,
+  kOnewayBus,
+  kOnewayPsv,
+  kBusway,
+  kBuswayLeft,
+  kBuswayRight,
+  kBuswayBoth,
+  kMotorVehicleForward,
+  kMotorVehicle,
+  kFoot,
+  kBicycle,
+  kHighway,
+  kIndoorLevel,
+  kLevel,
+  kName,
+  kRef,
+  kEntrance,
+  kSidewalk,
+  kSidewalkBoth,
+  kSidewalkLeft,
+  kSidewalkRight,
+  kCycleway,
+  kMotorcar,
+  kBarrier,
+  kPlatformEdge,
+  kPublicTransport,
+  kConstruction,
+  kVehicle,
+  kPsv,
+  kBus,
+  kAccess,
+  kAccessConditional,
+  kMaxspeed,
+  kToll,
+  kIncline,
+  kRoute,
+  kService
+};
+
+// Values evaluated by the tags parser where a key has several interesting
+// values (access, vehicle, public_transport, route).
+enum class tag_value : std::uint8_t {
+  kUnknown,
+  kPlatform,
+  kStopPosition,
+  kPrivate,
+  kDelivery,
+  kNo,
+  kDestination,
+  kPermissive,
+  kYes,
+  kAgricultural,
+  kForestry,
+  kEmergency,
+  kDesignated,
+  kDismount,
+  kCustomers,
+  kPsv,
+  kBus,
+  kTrolleybus,
+  kMinibus,
+  kShareTaxi,
+  kTrain,
+  kLightRail,
+  kSubway,
+  kTram,
+  kMonorail,
+  kFerry,
+  kFunicular
+};
+
+constexpr auto const kTagKeys = perfect_hash_map<tag_key, 46U>{{{
+    {"ramp", tag_key::kRamp},
+    {"type", tag_key::kType},
+    {"parking", tag_key::kParking},
+    {"amenity", tag_key::kAmenity},
+    {"building", tag_key::kBuilding},
+    {"landuse", tag_key::kLanduse},
+    {"railway", tag_key::kRailway},
+    {"oneway", tag_key::kOneway},
+    {"junction", tag_key::kJunction},
+    {"oneway:bicycle", tag_key::kOnewayBicycle},
+    {"oneway:bus", tag_key::kOnewayBus},
+    {"oneway:psv", tag_key::kOnewayPsv},
+    {"busway", tag_key::kBusway},
+    {"busway:left", tag_key::kBuswayLeft},
+    {"busway:right", tag_key::kBuswayRight},
+    {"busway:both", tag_key::kBuswayBoth},
+    {"motor_vehicle:forward", tag_key::kMotorVehicleForward},
+    {"motor_vehicle", tag_key::kMotorVehicle},
+    {"foot", tag_key::kFoot},
+    {"bicycle", tag_key::kBicycle},
+    {"highway", tag_key::kHighway},
+    {"indoor:level", tag_key::kIndoorLevel},
+    {"level", tag_key::kLevel},
+    {"name", tag_key::kName},
+    {"ref", tag_key::kRef},
+    {"entrance", tag_key::kEntrance},
+    {"sidewalk", tag_key::kSidewalk},
+    {"sidewalk:both", tag_key::kSidewalkBoth},
+    {"sidewalk:left", tag_key::kSidewalkLeft},
+    {"sidewalk:right", tag_key::kSidewalkRight},
+    {"cycleway", tag_key::kCycleway},
+    {"motorcar", tag_key::kMotorcar},
+    {"barrier", tag_key::kBarrier},
+    {"platform_edge", tag_key::kPlatformEdge},
+    {"public_transport", tag_key::kPublicTransport},
+    {"construction", tag_key::kConstruction},
+    {"vehicle", tag_key::kVehicle},
+    {"psv", tag_key::kPsv},
+    {"bus", tag_key::kBus},
+    {"access", tag_key::kAccess},
+    {"access:conditional", tag_key::kAccessConditional},
+    {"maxspeed", tag_key::kMaxspeed},
+    {"toll", tag_key::kToll},
+    {"incline", tag_key::kIncline},
+    {"route", tag_key::kRoute},
+    {"service", tag_key::kService},
+}}};
+
+constexpr auto const kTagValues = perfect_hash_map<tag_value, 26U>{{{
+    {"platform", tag_value::kPlatform},
+    {"stop_position", tag_value::kStopPosition},
+    {"private", tag_value::kPrivate},
+    {"delivery", tag_value::kDelivery},
+    {"no", tag_value::kNo},
+    {"destination", tag_value::kDestination},
+    {"permissive", tag_value::kPermissive},
+    {"yes", tag_value::kYes},
+    {"agricultural", tag_value::kAgricultural},
+    {"forestry", tag_value::kForestry},
+    {"emergency", tag_value::kEmergency},
+    {"designated", tag_value::kDesignated},
+    {"dismount", tag_value::kDismount},
+    {"customers", tag_value::kCustomers},
+    {"psv", tag_value::kPsv},
+    {"bus", tag_value::kBus},
+    {"trolleybus", tag_value::kTrolleybus},
+    {"minibus", tag_value::kMinibus},
+    {"share_taxi", tag_value::kShareTaxi},
+    {"train", tag_value::kTrain},
+    {"light_rail", tag_value::kLightRail},
+    {"subway", tag_value::kSubway},
+    {"tram", tag_value::kTram},
+    {"monorail", tag_value::kMonorail},
+    {"ferry", tag_value::kFerry},
+    {"funicular", tag_value::kFunicular},
+}}};
+
 struct tags {
   explicit tags(osmium::OSMObject const& o) {
     auto const add_levels = [](auto&& t, level_bits_t& level_bits) {
@@ -30,56 +192,56 @@ struct tags {
     auto circular = false;
     auto oneway_defined = false;
     for (auto const& t : o.tags()) {
-      switch (cista::hash(std::string_view{t.key()})) {
+      switch (kTagKeys.find(t.key())) {
         using namespace std::string_view_literals;
-        case cista::hash("ramp"): is_ramp_ |= t.value() != "no"sv; break;
-        case cista::hash("type"):
+        case tag_key::kRamp: is_ramp_ |= t.value() != "no"sv; break;
+        case tag_key::kType:
           is_route_ |=
               o.type() == osmium::item_type::relation && t.value() == "route"sv;
           break;
-        case cista::hash("parking"): is_parking_ = true; break;
-        case cista::hash("amenity"):
+        case tag_key::kParking: is_parking_ = true; break;
+        case tag_key::kAmenity:
           is_parking_ |=
               (t.value() == "parking"sv || t.value() == "parking_entrance"sv);
           break;
-        case cista::hash("building"):
+        case tag_key::kBuilding:
           is_parking_ |= t.value() == "parking"sv;
           landuse_ = true;
           break;
-        case cista::hash("landuse"): landuse_ = true; break;
-        case cista::hash("railway"):
+        case tag_key::kLanduse: landuse_ = true; break;
+        case tag_key::kRailway:
           railway_ = t.value();
           landuse_ |= railway_ == "station_area"sv;
           break;
-        case cista::hash("oneway"):
+        case tag_key::kOneway:
           oneway_defined = true;
           oneway_ |= t.value() == "yes"sv;
           break;
-        case cista::hash("junction"):
+        case tag_key::kJunction:
           oneway_ |= t.value() == "roundabout"sv;
           circular |= t.value() == "circular"sv;
           break;
-        case cista::hash("oneway:bicycle"):
+        case tag_key::kOnewayBicycle:
           not_oneway_bike_ = t.value() == "no"sv;
           break;
-        case cista::hash("oneway:bus"):
-        case cista::hash("oneway:psv"):
+        case tag_key::kOnewayBus:
+        case tag_key::kOnewayPsv:
           not_oneway_bus_psv_ |= t.value() == "no"sv;
           break;
-        case cista::hash("busway"):
-        case cista::hash("busway:left"):
-        case cista::hash("busway:right"):
-        case cista::hash("busway:both"):
+        case tag_key::kBusway:
+        case tag_key::kBuswayLeft:
+        case tag_key::kBuswayRight:
+        case tag_key::kBuswayBoth:
           not_oneway_bus_psv_ |= t.value() == "opposite_lane"sv;
           break;
-        case cista::hash("motor_vehicle:forward"):
-        case cista::hash("motor_vehicle"):
+        case tag_key::kMotorVehicleForward:
+        case tag_key::kMotorVehicle:
           motor_vehicle_ = t.value();
           is_destination_ |= motor_vehicle_ == "destination"sv;
           break;
-        case cista::hash("foot"): foot_ = t.value(); break;
-        case cista::hash("bicycle"): bicycle_ = t.value(); break;
-        case cista::hash("highway"):
+        case tag_key::kFoot: foot_ = t.value(); break;
+        case tag_key::kBicycle: bicycle_ = t.value(); break;
+        case tag_key::kHighway:
           highway_ = t.value();
           if (highway_ == "elevator") {
             is_elevator_ = true;
@@ -88,86 +250,89 @@ struct tags {
             is_platform_ = true;
           }
           break;
-        case cista::hash("indoor:level"): [[fallthrough]];
-        case cista::hash("level"):
+        case tag_key::kIndoorLevel: [[fallthrough]];
+        case tag_key::kLevel:
           has_level_ = true;
           add_levels(t, level_bits_);
           break;
-        case cista::hash("name"): name_ = t.value(); break;
-        case cista::hash("ref"): ref_ = t.value(); break;
-        case cista::hash("entrance"): is_entrance_ = true; break;
-        case cista::hash("sidewalk"):
-        case cista::hash("sidewalk:both"):
-        case cista::hash("sidewalk:left"): [[fallthrough]];
-        case cista::hash("sidewalk:right"):
+        case tag_key::kName: name_ = t.value(); break;
+        case tag_key::kRef: ref_ = t.value(); break;
+        case tag_key::kEntrance: is_entrance_ = true; break;
+        case tag_key::kSidewalk:
+        case tag_key::kSidewalkBoth:
+        case tag_key::kSidewalkLeft: [[fallthrough]];
+        case tag_key::kSidewalkRight:
           if (t.value() == "separate"sv) {
             sidewalk_separate_ = true;
           }
           break;
-        case cista::hash("cycleway"): cycleway_ = t.value(); break;
-        case cista::hash("motorcar"):
+        case tag_key::kCycleway: cycleway_ = t.value(); break;
+        case tag_key::kMotorcar:
           motorcar_ = t.value();
           is_destination_ |= motorcar_ == "destination";
           break;
-        case cista::hash("barrier"): barrier_ = t.value(); break;
-        case cista::hash("platform_edge"): is_platform_ = true; break;
-        case cista::hash("public_transport"):
-          switch (cista::hash(std::string_view{t.value()})) {
-            case cista::hash("platform"):
-            case cista::hash("stop_position"): is_platform_ = true;
+        case tag_key::kBarrier: barrier_ = t.value(); break;
+        case tag_key::kPlatformEdge: is_platform_ = true; break;
+        case tag_key::kPublicTransport:
+          switch (kTagValues.find(t.value())) {
+            case tag_value::kPlatform:
+            case tag_value::kStopPosition: is_platform_ = true; break;
+            default: break;
           }
           break;
-        case cista::hash("construction"): is_construction_ = true; break;
-        case cista::hash("vehicle"):
-          switch (cista::hash(std::string_view{t.value()})) {
-            case cista::hash("private"):
-            case cista::hash("delivery"):
-            case cista::hash("no"): vehicle_ = override::kBlacklist; break;
-
-            case cista::hash("destination"):
+        case tag_key::kConstruction: is_construction_ = true; break;
+        case tag_key::kVehicle:
+          switch (kTagValues.find(t.value())) {
+            case tag_value::kPrivate:
+            case tag_value::kDelivery:
+            case tag_value::kNo: vehicle_ = override::kBlacklist; break;
+
+            case tag_value::kDestination:
               is_destination_ = true;
               [[fallthrough]];
-            case cista::hash("permissive"): [[fallthrough]];
-            case cista::hash("yes"): vehicle_ = override::kWhitelist; break;
+            case tag_value::kPermissive: [[fallthrough]];
+            case tag_value::kYes: vehicle_ = override::kWhitelist; break;
+            default: break;
           }
           break;
-        case cista::hash("psv"):
+        case tag_key::kPsv:
           if (bus_ == override::kNone) {
             bus_ = t.value() == "no"sv ? override::kBlacklist
                                        : override::kWhitelist;
           }
           break;
-        case cista::hash("bus"):  // more specific than psv
+        case tag_key::kBus:  // more specific than psv
           bus_ =
               t.value() == "no"sv ? override::kBlacklist : override::kWhitelist;
           break;
-        case cista::hash("access"):
-          switch (cista::hash(std::string_view{t.value()})) {
-            case cista::hash("no"):
-            case cista::hash("agricultural"):
-            case cista::hash("forestry"):
-            case cista::hash("emergency"): [[fallthrough]];
-            case cista::hash("delivery"): access_ = override::kBlacklist; break;
-
-            case cista::hash("private"):
+        case tag_key::kAccess:
+          switch (kTagValues.find(t.value())) {
+            case tag_value::kNo:
+            case tag_value::kAgricultural:
+            case tag_value::kForestry:
+            case tag_value::kEmergency: [[fallthrough]];
+            case tag_value::kDelivery: access_ = override::kBlacklist; break;
+
+            case tag_value::kPrivate:
               access_ = override::kBlacklist;
               private_access_ = true;
               break;
 
-            case cista::hash("designated"):
-            case cista::hash("dismount"):
-            case cista::hash("customers"):
-            case cista::hash("permissive"): [[fallthrough]];
-            case cista::hash("yes"): access_ = override::kWhitelist; break;
+            case tag_value::kDesignated:
+            case tag_value::kDismount:
+            case tag_value::kCustomers:
+            case tag_value::kPermissive: [[fallthrough]];
+            case tag_value::kYes: access_ = override::kWhitelist; break;
 
-            case cista::hash("psv"):
-            case cista::hash("bus"):
+            case tag_value::kPsv:
+            case tag_value::kBus:
               access_ = override::kBlacklist;
               bus_ = override::kWhitelist;
               break;
+            default: break;
           }
           break;
-        case cista::hash("access:conditional"): {
+        case tag_key::kAccessConditional: {
           constexpr auto const kPrefix = "no @ ("sv;
           constexpr auto const kPostfix = ")"sv;
           auto const value = std::string_view{t.value()};
@@ -177,17 +342,18 @@ struct tags {
                                                  kPostfix.length());
           }
         } break;
-        case cista::hash("maxspeed"): max_speed_ = t.value(); break;
-        case cista::hash("toll"): toll_ = t.value() == "yes"sv; break;
-        case cista::hash("incline"): {
+        case tag_key::kMaxspeed: max_speed_ = t.value(); break;
+        case tag_key::kToll: toll_ = t.value() == "yes"sv; break;
+        case tag_key::kIncline: {
           auto const value = std::string_view{t.value()};
           is_incline_down_ = t.value() == "down"sv || value.starts_with("-"sv);
         } break;
-        case cista::hash("route"):
+        case tag_key::kRoute:
           route_type_ = t.value();
           is_ferry_route_ = t.value() == "ferry"sv;
           break;
-        case cista::hash("service"): service_ = t.value(); break;
+        case tag_key::kService: service_ = t.value(); break;
+        default: break;
       }
     }
     if (circular && !oneway_defined) {
@@ -198,18 +364,18 @@ struct tags {
   bool is_platform() const { return is_platform_ && !is_construction_; }
 
   bool is_public_transport_route() const {
-    switch (cista::hash(route_type_)) {
-      case cista::hash("bus"):
-      case cista::hash("trolleybus"):
-      case cista::hash("minibus"):
-      case cista::hash("share_taxi"):
-      case cista::hash("train"):
-      case cista::hash("light_rail"):
-      case cista::hash("subway"):
-      case cista::hash("tram"):
-      case cista::hash("monorail"):
-      case cista::hash("ferry"):
-      case cista::hash("funicular"): return true;
+    switch (kTagValues.find(route_type_)) {
+      case tag_value::kBus:
+      case tag_value::kTrolleybus:
+      case tag_value::kMinibus:
+      case tag_value::kShareTaxi:
+      case tag_value::kTrain:
+      case tag_value::kLightRail:
+      case tag_value::kSubway:
+      case tag_value::kTram:
+      case tag_value::kMonorail:
+      case tag_value::kFerry:
+      case tag_value::kFunicular: return true;
       default: return false;
     }
   }
@@ -685,4 +851,13 @@ struct ferry_profile {
   }
 };
 
+// Nodes with these tags are graph nodes even if they are used by a single
+// way (or no way at all).
+inline bool is_graph_node(tags const& t) {
+  auto const accessible = is_accessible<car_profile>(t, osm_obj_type::kNode) &&
+                          is_accessible<bike_profile>(t, osm_obj_type::kNode) &&
+                          is_accessible<foot_profile>(t, osm_obj_type::kNode);
+  return !accessible || t.is_elevator_ || t.is_platform();
+}
+
 }  // namespace osr
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace osr {
+
+struct update_stats {
+  std::size_t modified_ways_{0U};
+  std::size_t deleted_ways_{0U};
+  std::size_t new_ways_{0U};
+  std::size_t modified_nodes_{0U};
+  std::size_t deleted_nodes_{0U};
+  std::size_t new_nodes_{0U};
+  std::size_t moved_ways_{0U};
+  std::size_t restrictions_{0U};
+
+  // Changes that cannot be applied in place (nodes with old ids that become
+  // graph nodes, which would split existing ways, routable ways with old ids,
+  // elevators, ways depending on relations, ...). They need a full extract.
+  std::size_t unsupported_{0U};
+};
+
+// Applies an OSM change file (.osc, .osc.gz) to an extracted data directory
+// in place. Existing graph node and way indices stay valid: changed tags and
+// node positions are patched, deleted ways and nodes are made inaccessible
+// (tombstoned). New ways and graph nodes are appended (new OSM objects have
+// higher ids than existing ones), ways with a changed node list get the new
+// geometry, and the node buckets of the affected graph nodes are rebuilt.
+// Turn restrictions of changed relations are resolved again. The routing
+// data, polylines, components and the rtree are updated for the changed
+// ways and nodes only. ALT landmark files are removed.
+//
+// All changes are classified before anything is written. If one of them is
+// unsupported, the data is left unchanged and only unsupported_ is set.
+//
+// Not updated: elevations, platforms, route and platform relations, big
+// street neighbors of unchanged ways, and components split by a change.
+update_stats update(std::filesystem::path const& osc,
+                    std::filesystem::path const& dir);
+
+}  // namespace osr
@@ -6,9 +6,11 @@
 #include "utl/pairwise.h"
 #include "utl/pipes.h"
 
+#include "osr/json_writer.h"
 #include "osr/platforms.h"
 #include "osr/routing/dijkstra.h"
 #include "osr/routing/profiles/foot.h"
+#include "osr/routing/search_stats.h"
 #include "osr/ways.h"
 
 namespace osr {
@@ -33,14 +35,33 @@ boost::json::value to_line_string(std::initializer_list<T>&& line) {
   return to_line_string(line);
 }
 
+inline boost::json::value to_json(search_stats const& s) {
+  return {{"pushed", s.n_pushed_},
+          {"popped", s.n_popped_},
+          {"dominated", s.n_dominated_},
+          {"buckets_scanned", s.n_buckets_scanned_},
+          {"adjacent_calls", s.n_adjacent_calls_},
+          {"cost_map_size", s.cost_map_size_},
+          {"cost_map_rehashes", s.n_rehashes_},
+          {"reconstruct_us", s.reconstruct_time_.count()}};
+}
+
 inline std::string to_featurecollection(ways const& w,
                                         std::optional<osr::path> const& p,
-                                        bool const with_properties = true) {
+                                        bool const with_properties = true,
+                                        search_stats const* stats = nullptr) {
+  auto metadata = with_properties ? boost::json::value{{"duration", p->cost_},
+                                                       {"distance", p->dist_}}
+                                  : boost::json::value{{}};
+  if (stats != nullptr) {
+    if (!metadata.is_object()) {
+      metadata = boost::json::object{};
+    }
+    metadata.as_object()["stats"] = to_json(*stats);
+  }
   return boost::json::serialize(boost::json::object{
       {"type", "FeatureCollection"},
-      {"metadata", with_properties ? boost::json::value{{"duration", p->cost_},
-                                                        {"distance", p->dist_}}
-                                   : boost::json::value{{}}},
+      {"metadata", std::move(metadata)},
       {"features",
        utl::all(p->segments_) | utl::transform([&](const path::segment& s) {
          return boost::json::object{
@@ -58,6 +79,74 @@ inline std::string to_featurecollection(ways const& w,
        }) | utl::emplace_back_to<boost::json::array>()}});
 }
 
+// Streaming variant of to_featurecollection: appends the feature collection
+// to out without building a boost::json DOM. Without properties, metadata is
+// an empty object.
+inline void write_featurecollection(std::string& out,
+                                    ways const& w,
+                                    path const& p,
+                                    bool const with_properties = true,
+                                    search_stats const* stats = nullptr) {
+  auto j = json_writer{out};
+  j.begin_object().member("type", "FeatureCollection");
+
+  j.key("metadata").begin_object();
+  if (with_properties) {
+    j.member("duration", p.cost_).member("distance", p.dist_);
+  }
+  if (stats != nullptr) {
+    j.key("stats")
+        .begin_object()
+        .member("pushed", stats->n_pushed_)
+        .member("popped", stats->n_popped_)
+        .member("dominated", stats->n_dominated_)
+        .member("buckets_scanned", stats->n_buckets_scanned_)
+        .member("adjacent_calls", stats->n_adjacent_calls_)
+        .member("cost_map_size", stats->cost_map_size_)
+        .member("cost_map_rehashes", stats->n_rehashes_)
+        .member("reconstruct_us", stats->reconstruct_time_.count())
+        .end_object();
+  }
+  j.end_object();
+
+  j.key("features").begin_array();
+  for (auto const& s : p.segments_) {
+    j.begin_object().member("type", "Feature");
+    j.key("properties")
+        .begin_object()
+        .member("level", s.from_level_.to_float())
+        .member("osm_way_id", s.way_ == way_idx_t::invalid()
+                                  ? 0U
+                                  : to_idx(w.way_osm_idx_[s.way_]))
+        .member("cost", s.cost_)
+        .member("distance", s.dist_)
+        .end_object();
+    j.key("geometry")
+        .begin_object()
+        .member("type", "LineString")
+        .key("coordinates")
+        .begin_array();
+    for (auto const& x : s.polyline_) {
+      j.coordinate(x);
+    }
+    j.end_array().end_object();
+    j.end_object();
+  }
+  j.end_array();
+
+  j.end_object();
+}
+
+inline std::string to_featurecollection_stream(
+    ways const& w,
+    path const& p,
+    bool const with_properties = true,
+    search_stats const* stats = nullptr) {
+  auto out = std::string{};
+  write_featurecollection(out, w, p, with_properties, stats);
+  return out;
+}
+
 inline boost::json::value to_point(point const p) {
   return {{"type", "Point"}, {"coordinates", to_array(p)}};
 }
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cmath>
+#include <concepts>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include "fmt/format.h"
+
+namespace osr {
+
+// Streaming JSON writer that appends directly to a string buffer, without
+// building a DOM first. Floating point numbers are written in their shortest
+// round-trip representation (fmt uses Dragonbox for this). JSON has no NaN or
+// infinity, so non-finite numbers are written as null. The caller is
+// responsible for a well-formed sequence of calls.
+struct json_writer {
+  explicit json_writer(std::string& out) : out_{out} {}
+
+  json_writer& begin_object() {
+    separate();
+    out_.push_back('{');
+    comma_ = false;
+    return *this;
+  }
+
+  json_writer& end_object() {
+    out_.push_back('}');
+    comma_ = true;
+    return *this;
+  }
+
+  json_writer& begin_array() {
+    separate();
+    out_.push_back('[');
+    comma_ = false;
+    return *this;
+  }
+
+  json_writer& end_array() {
+    out_.push_back(']');
+    comma_ = true;
+    return *this;
+  }
+
+  json_writer& key(std::string_view const k) {
+    separate();
+    write_string(k);
+    out_.push_back(':');
+    comma_ = false;
+    return *this;
+  }
+
+  json_writer& value(std::string_view const s) {
+    separate();
+    write_string(s);
+    comma_ = true;
+    return *this;
+  }
+
+  json_writer& value(char const* s) { return value(std::string_view{s}); }
+
+  json_writer& value(bool const b) {
+    separate();
+    out_.append(b ? "true" : "false");
+    comma_ = true;
+    return *this;
+  }
+
+  template <typename T>
+    requires(std::integral<T> && !std::same_as<T, bool>)
+  json_writer& value(T const x) {
+    separate();
+    fmt::format_to(std::back_inserter(out_), "{}", x);
+    comma_ = true;
+    return *this;
+  }
+
+  template <std::floating_point T>
+  json_writer& value(T const x) {
+    separate();
+    write_number(x);
+    comma_ = true;
+    return *this;
+  }
+
+  // [lng, lat] as used by GeoJSON.
+  template <typename LatLng>
+  json_writer& coordinate(LatLng const& p) {
+    separate();
+    out_.push_back('[');
+    write_number(p.lng());
+    out_.push_back(',');
+    write_number(p.lat());
+    out_.push_back(']');
+    comma_ = true;
+    return *this;
+  }
+
+  template <typename T>
+  json_writer& member(std::string_view const k, T const& v) {
+    return key(k).value(v);
+  }
+
+private:
+  void separate() {
+    if (comma_) {
+      out_.push_back(',');
+    }
+  }
+
+  template <std::floating_point T>
+  void write_number(T const x) {
+    if (std::isfinite(x)) {
+      fmt::format_to(std::back_inserter(out_), "{}", x);
+    } else {
+      out_.append("null");
+    }
+  }
+
+  void write_string(std::string_view const s) {
+    out_.push_back('"');
+    for (auto const c : s) {
+      switch (c) {
+        case '"': out_.append("\\\""); break;
+        case '\\': out_.append("\\\\"); break;
+        case '\n': out_.append("\\n"); break;
+        case '\r': out_.append("\\r"); break;
+        case '\t': out_.append("\\t"); break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20U) {
+            fmt::format_to(std::back_inserter(out_), "\\u{:04x}",
+                           static_cast<unsigned>(c));
+          } else {
+            out_.push_back(c);
+          }
+      }
+    }
+    out_.push_back('"');
+  }
+
+  std::string& out_;
+  bool comma_{false};
+};
+
+}  // namespace osr
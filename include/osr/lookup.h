@@ -94,6 +94,17 @@ struct lookup {
 
   void build_rtree();
 
+  // Replaces the rtree entry of a way whose geometry changed. `before` is the
+  // bounding box of the previous geometry. Call write_meta() after the last
+  // update.
+  void update_way(way_idx_t, geo::box const& before);
+
+  // Adds the rtree entry of a new way. Call write_meta() after the last
+  // insert.
+  void insert(way_idx_t);
+
+  void write_meta();
+
   cista::mmap mm(char const* file) {
     return cista::mmap{(p_ / file).generic_string().c_str(), mode_};
   }
@@ -223,8 +234,6 @@ struct lookup {
 
   hash_set<node_idx_t> find_elevators(geo::box const& b) const;
 
-  void insert(way_idx_t);
-
   template <Profile P>
   match_t get_way_candidates(P::parameters const& params,
                              location const& query,
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "osr/preprocessing/elevation/shared.h"
+
+namespace osr::preprocessing::elevation {
+
+constexpr auto const kDefaultMaxDecodedBlocks = std::size_t{1024U};
+
+// Decoded raster blocks of a driver, already converted to meters.
+//
+// Once more than max_blocks blocks are decoded, the least recently used block
+// is released. Blocks are shared, so a block that is in use stays valid after
+// it was evicted. Every thread keeps its most recently used block alive
+// until the cache is destroyed.
+struct block_cache {
+  using block_t = std::shared_ptr<std::vector<elevation_meters_t> const>;
+  using decode_fn_t = std::function<std::vector<elevation_meters_t>()>;
+
+  struct key {
+    std::uint64_t pack() const {
+      return static_cast<std::uint64_t>(tile_) << 40U |
+             static_cast<std::uint64_t>(level_) << 32U | block_;
+    }
+
+    std::uint32_t tile_{0U};  // 24 bit
+    std::uint8_t level_{0U};
+    std::uint32_t block_{0U};
+  };
+
+  explicit block_cache(std::size_t max_blocks = kDefaultMaxDecodedBlocks);
+  ~block_cache();
+  block_cache(block_cache const&) = delete;
+  block_cache& operator=(block_cache const&) = delete;
+  block_cache(block_cache&&) = delete;
+  block_cache& operator=(block_cache&&) = delete;
+
+  // Calls decode if the block is not cached. Decoding runs without holding the
+  // lock, so concurrent misses of the same block may decode it twice.
+  block_t get(key, decode_fn_t const& decode) const;
+
+  std::size_t n_decoded() const;
+
+private:
+  struct impl;
+  std::unique_ptr<impl> impl_;
+};
+
+}  // namespace osr::preprocessing::elevation
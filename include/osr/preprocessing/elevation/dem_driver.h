@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+#include <span>
 #include <vector>
 
 #include "cista/containers/rtree.h"
@@ -9,19 +11,26 @@
 #include "osr/preprocessing/elevation/dem_tile.h"
 #include "osr/preprocessing/elevation/resolution.h"
 #include "osr/preprocessing/elevation/shared.h"
+#include "osr/preprocessing/elevation/tile_cache.h"
 
 namespace osr::preprocessing::elevation {
 
 struct dem_driver {
-  dem_driver() = default;
+  explicit dem_driver(std::size_t max_open_tiles = kDefaultMaxOpenTiles);
   bool add_tile(std::filesystem::path const&);
   elevation_meters_t get(geo::latlng const&) const;
+
+  // Fills the invalid entries of out with the elevation of pos.
+  void get(std::span<geo::latlng const> pos,
+           std::span<elevation_meters_t> out) const;
   tile_idx_t tile_idx(geo::latlng const&) const;
   resolution max_resolution() const;
   std::size_t n_tiles() const;
 
   cista::raw::rtree<std::size_t> rtree_{};
   std::vector<dem_tile> tiles_{};
+  std::vector<bool> overlaps_{};  // see add_overlaps()
+  std::unique_ptr<tile_cache> cache_;
 };
 
 }  // namespace osr::preprocessing::elevation
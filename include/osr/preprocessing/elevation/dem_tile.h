@@ -3,12 +3,14 @@
 #include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <span>
 
 #include "geo/box.h"
 #include "geo/latlng.h"
 
 #include "osr/preprocessing/elevation/resolution.h"
 #include "osr/preprocessing/elevation/shared.h"
+#include "osr/preprocessing/elevation/tile_cache.h"
 
 namespace osr::preprocessing::elevation {
 
@@ -19,8 +21,11 @@ union pixel_value {
   float float32_;
 };
 
+elevation_meters_t to_meters(std::int16_t, pixel_value nodata);
+elevation_meters_t to_meters(float, pixel_value nodata);
+
 struct dem_tile {
-  explicit dem_tile(std::filesystem::path const&);
+  dem_tile(std::filesystem::path const&, tile_cache&);
   ~dem_tile();
   dem_tile(dem_tile&& grid) noexcept;
   dem_tile(dem_tile const&) = delete;
@@ -28,6 +33,10 @@ struct dem_tile {
   dem_tile& operator=(dem_tile&&) = delete;
 
   elevation_meters_t get(geo::latlng const&) const;
+
+  // Batch version of get(): out[i] = get(pos[i]).
+  void get(std::span<geo::latlng const> pos,
+           std::span<elevation_meters_t> out) const;
   tile_idx_t tile_idx(geo::latlng const&) const;
   geo::box get_box() const;
 
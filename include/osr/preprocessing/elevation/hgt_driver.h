@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+#include <span>
 #include <optional>
 #include <variant>
 #include <vector>
@@ -11,6 +13,7 @@
 #include "osr/preprocessing/elevation/hgt_tile.h"
 #include "osr/preprocessing/elevation/resolution.h"
 #include "osr/preprocessing/elevation/shared.h"
+#include "osr/preprocessing/elevation/tile_cache.h"
 
 namespace osr::preprocessing::elevation {
 
@@ -20,16 +23,23 @@ static_assert(IsTile<hgt_tile<1201>>);
 struct hgt_driver {
   using hgt_tile_t = std::variant<hgt_tile<3601>, hgt_tile<1201>>;
 
-  hgt_driver() = default;
+  explicit hgt_driver(std::size_t max_open_tiles = kDefaultMaxOpenTiles);
   bool add_tile(std::filesystem::path const&);
   elevation_meters_t get(geo::latlng const&) const;
+
+  // Fills the invalid entries of out with the elevation of pos.
+  void get(std::span<geo::latlng const> pos,
+           std::span<elevation_meters_t> out) const;
   tile_idx_t tile_idx(geo::latlng const&) const;
   resolution max_resolution() const;
   std::size_t n_tiles() const;
-  static std::optional<hgt_tile_t> open(std::filesystem::path const&);
+  static std::optional<hgt_tile_t> open(std::filesystem::path const&,
+                                         tile_cache&);
 
   cista::raw::rtree<std::size_t> rtree_;
   std::vector<hgt_tile_t> tiles_;
+  std::vector<bool> overlaps_;  // see add_overlaps()
+  std::unique_ptr<tile_cache> cache_;
 };
 
 }  // namespace osr::preprocessing::elevation
@@ -2,13 +2,14 @@
 
 #include <cstdint>
 #include <memory>
-#include <string>
+#include <span>
 
 #include "geo/box.h"
 #include "geo/latlng.h"
 
 #include "osr/preprocessing/elevation/resolution.h"
 #include "osr/preprocessing/elevation/shared.h"
+#include "osr/preprocessing/elevation/tile_cache.h"
 
 namespace osr::preprocessing::elevation {
 
@@ -16,7 +17,7 @@ template <std::size_t RasterSize>
 struct hgt_tile {
   constexpr static auto const kBytesPerPixel = std::size_t{2U};
 
-  explicit hgt_tile(std::string const& path,
+  explicit hgt_tile(tile_cache::handle,
                     std::int8_t const lat,
                     std::int16_t const lng);
   ~hgt_tile();
@@ -26,6 +27,10 @@ struct hgt_tile {
   hgt_tile& operator=(hgt_tile&&) = delete;
 
   elevation_meters_t get(geo::latlng const&) const;
+
+  // Batch version of get(): out[i] = get(pos[i]).
+  void get(std::span<geo::latlng const> pos,
+           std::span<elevation_meters_t> out) const;
   tile_idx_t tile_idx(geo::latlng const&) const;
 
   resolution max_resolution() const;
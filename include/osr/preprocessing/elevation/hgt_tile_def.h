@@ -3,12 +3,11 @@
 #include "osr/preprocessing/elevation/hgt_tile.h"
 
 #include <algorithm>
+#include <array>
 #include <bit>
+#include <cstring>
 #include <limits>
-
-#include "cista/mmap.h"
-
-#include "utl/verify.h"
+#include <span>
 
 // SRTM HGT File Format
 //
@@ -44,18 +43,16 @@ struct hgt_tile<RasterSize>::hgt_tile<RasterSize>::impl {
   constexpr static auto kStepWidth = double{1. / (RasterSize - 1U)};
   constexpr static auto kCenterOffset = kStepWidth / 2.;
 
-  impl(std::string const& path, std::int8_t const lat, std::int16_t const lng)
-      : file_{cista::mmap{path.data(), cista::mmap::protection::READ}},
-        sw_lat_{lat},
-        sw_lng_{lng} {
-    utl::verify(file_.size() == file_size(),
-                "HGT tile '{}' ({}x{}) has incorrect file size ({} != {})",
-                path, RasterSize, RasterSize, file_.size(), file_size());
-  }
+  impl(tile_cache::handle file, std::int8_t const lat, std::int16_t const lng)
+      : file_{file}, sw_lat_{lat}, sw_lng_{lng} {}
 
   template <std::size_t UpperBound>
   std::size_t get_offset(geo::latlng const& pos) const {
-    auto const box = get_box();
+    return get_offset<UpperBound>(get_box(), pos);
+  }
+
+  template <std::size_t UpperBound>
+  static std::size_t get_offset(geo::box const& box, geo::latlng const& pos) {
     if (box.contains(pos)) {
       // Column: Left to right
       auto const column = std::clamp(
@@ -84,7 +81,7 @@ struct hgt_tile<RasterSize>::hgt_tile<RasterSize>::impl {
   }
 
   elevation_meters_t get(std::size_t const offset) const {
-    auto const byte_ptr = file_.data() + offset;
+    auto const byte_ptr = file_.get().data() + offset;
     auto const raw_value = *reinterpret_cast<std::int16_t const*>(byte_ptr);
     // Byte is stored in big-endian
     auto const meters = std::endian::native == std::endian::big
@@ -94,6 +91,43 @@ struct hgt_tile<RasterSize>::hgt_tile<RasterSize>::impl {
                                   : elevation_meters_t{meters};
   }
 
+  void get(std::span<geo::latlng const> pos,
+           std::span<elevation_meters_t> out) const {
+    constexpr auto const kBatchSize = std::size_t{64U};
+    constexpr auto const kInvalidOffset =
+        std::numeric_limits<std::size_t>::max();
+
+    auto const box = get_box();
+    auto const* data = file_.get().data();
+    auto offsets = std::array<std::size_t, kBatchSize>{};
+    auto raw = std::array<std::int16_t, kBatchSize>{};
+    for (auto start = std::size_t{0U}; start < pos.size();
+         start += kBatchSize) {
+      auto const n = std::min(kBatchSize, pos.size() - start);
+      for (auto i = std::size_t{0U}; i != n; ++i) {
+        offsets[i] = get_offset<RasterSize>(box, pos[start + i]);
+      }
+      for (auto i = std::size_t{0U}; i != n; ++i) {
+        raw[i] = 0;
+        if (offsets[i] != kInvalidOffset) {
+          std::memcpy(&raw[i], data + kBytesPerPixel * offsets[i],
+                      kBytesPerPixel);
+        }
+      }
+      // Byte is stored in big-endian, plain loop to allow vectorization
+      if constexpr (std::endian::native != std::endian::big) {
+        for (auto i = std::size_t{0U}; i != n; ++i) {
+          raw[i] = std::byteswap(raw[i]);
+        }
+      }
+      for (auto i = std::size_t{0U}; i != n; ++i) {
+        out[start + i] = offsets[i] == kInvalidOffset || raw[i] == kVoidValue
+                             ? elevation_meters_t::invalid()
+                             : elevation_meters_t{raw[i]};
+      }
+    }
+  }
+
   tile_idx_t tile_idx(geo::latlng const& pos) const {
     constexpr auto const kSegments = 1 << (tile_idx_t::kSubTileIdxSize / 2);
     auto const offset = get_offset<kSegments>(pos);
@@ -120,17 +154,17 @@ struct hgt_tile<RasterSize>::hgt_tile<RasterSize>::impl {
     return {.x_ = kStepWidth, .y_ = kStepWidth};
   }
 
-  cista::mmap file_{};
+  tile_cache::handle file_;
   // south west coordinate
   std::int8_t sw_lat_;
   std::int16_t sw_lng_;
 };
 
 template <std::size_t RasterSize>
-hgt_tile<RasterSize>::hgt_tile(std::string const& path,
+hgt_tile<RasterSize>::hgt_tile(tile_cache::handle file,
                                std::int8_t const lat,
                                std::int16_t const lng)
-    : impl_{std::make_unique<impl>(path, lat, lng)} {}
+    : impl_{std::make_unique<impl>(file, lat, lng)} {}
 
 template <std::size_t RasterSize>
 hgt_tile<RasterSize>::~hgt_tile() = default;
@@ -143,6 +177,12 @@ elevation_meters_t hgt_tile<RasterSize>::get(geo::latlng const& pos) const {
   return impl_->get(pos);
 }
 
+template <std::size_t RasterSize>
+void hgt_tile<RasterSize>::get(std::span<geo::latlng const> pos,
+                               std::span<elevation_meters_t> out) const {
+  impl_->get(pos, out);
+}
+
 template <std::size_t RasterSize>
 tile_idx_t hgt_tile<RasterSize>::tile_idx(geo::latlng const& pos) const {
   return impl_->tile_idx(pos);
@@ -1,16 +1,22 @@
 #pragma once
 
 #include <filesystem>
+#include <span>
+#include <vector>
 
+#include "geo/box.h"
 #include "geo/latlng.h"
 
 #include "osr/preprocessing/elevation/resolution.h"
 #include "osr/preprocessing/elevation/shared.h"
+#include "osr/preprocessing/elevation/tile_cache.h"
 
 namespace osr::preprocessing::elevation {
 
 struct provider {
-  provider(std::filesystem::path const&);
+  // Tiles are memory mapped on demand, at most max_open_tiles per driver.
+  explicit provider(std::filesystem::path const&,
+                    std::size_t max_open_tiles = kDefaultMaxOpenTiles);
   ~provider();
   provider(provider const&) = delete;
   provider& operator=(provider const&) = delete;
@@ -18,8 +24,16 @@ struct provider {
   provider& operator=(provider&&) = delete;
 
   elevation_meters_t get(geo::latlng const&) const;
+
+  // Batch version of get(): out[i] = get(pos[i]).
+  // Drivers with overviews may read a coarser level that is still at least as
+  // fine as sampling, the spacing of pos (default: full resolution).
+  void get(std::span<geo::latlng const> pos,
+           std::span<elevation_meters_t> out,
+           resolution const& sampling = {}) const;
   tile_idx_t tile_idx(geo::latlng const&) const;
   std::size_t driver_count() const;
+  std::vector<geo::box> tile_boxes() const;
   resolution max_resolution() const;
 
 private:
@@ -2,7 +2,10 @@
 
 #include <compare>
 #include <concepts>
+#include <span>
+#include <vector>
 
+#include "cista/containers/rtree.h"
 #include "cista/strong.h"
 
 #include "geo/box.h"
@@ -55,13 +58,44 @@ concept IsProvider =
     };
 
 template <typename Tile>
-concept IsTile = IsProvider<Tile> && requires(Tile const& tile) {
-  { tile.get_box() } -> std::same_as<geo::box>;
-};
+concept IsTile =
+    IsProvider<Tile> && requires(Tile const& tile,
+                                 std::span<geo::latlng const> pos,
+                                 std::span<elevation_meters_t> out) {
+      { tile.get_box() } -> std::same_as<geo::box>;
+      { tile.get(pos, out) } -> std::same_as<void>;
+    };
 
 template <typename Driver>
-concept IsDriver = IsProvider<Driver> && requires(Driver const& driver) {
-  { driver.n_tiles() } -> std::same_as<std::size_t>;
-};
+concept IsDriver =
+    IsProvider<Driver> && requires(Driver const& driver,
+                                   std::span<geo::latlng const> pos,
+                                   std::span<elevation_meters_t> out) {
+      { driver.n_tiles() } -> std::same_as<std::size_t>;
+      { driver.get(pos, out) } -> std::same_as<void>;
+    };
+
+// Records for the tile with the next index (overlaps.size()) and all tiles
+// already in the rtree whether their box overlaps another tile box of the
+// driver. Touching boxes do not count. Only positions of overlapping tiles
+// can get a value from a second tile, the others skip that lookup. Has to be
+// called before the new box is inserted.
+inline void add_overlaps(cista::raw::rtree<std::size_t> const& rtree,
+                         geo::box const& box,
+                         std::vector<bool>& overlaps) {
+  auto const min = box.min_.lnglat_float();
+  auto const max = box.max_.lnglat_float();
+  auto overlapping = false;
+  rtree.search(min, max,
+               [&](auto const& a, auto const& b, std::size_t const& idx) {
+                 if (a[0] < max[0] && min[0] < b[0] && a[1] < max[1] &&
+                     min[1] < b[1]) {
+                   overlaps[idx] = true;
+                   overlapping = true;
+                 }
+                 return false;
+               });
+  overlaps.push_back(overlapping);
+}
 
 }  // namespace osr::preprocessing::elevation
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "cista/containers/rtree.h"
+
+#include "geo/latlng.h"
+
+#include "osr/preprocessing/elevation/block_cache.h"
+#include "osr/preprocessing/elevation/resolution.h"
+#include "osr/preprocessing/elevation/shared.h"
+#include "osr/preprocessing/elevation/tiff_tile.h"
+#include "osr/preprocessing/elevation/tile_cache.h"
+
+namespace osr::preprocessing::elevation {
+
+static_assert(IsTile<tiff_tile>);
+
+struct tiff_driver {
+  explicit tiff_driver(
+      std::size_t max_open_tiles = kDefaultMaxOpenTiles,
+      std::size_t max_decoded_blocks = kDefaultMaxDecodedBlocks);
+  bool add_tile(std::filesystem::path const&);
+  elevation_meters_t get(geo::latlng const&) const;
+
+  // Fills the invalid entries of out with the elevation of pos.
+  void get(std::span<geo::latlng const> pos,
+           std::span<elevation_meters_t> out) const;
+
+  // Like get(), but may read overviews at least as fine as sampling.
+  void get(std::span<geo::latlng const> pos,
+           std::span<elevation_meters_t> out,
+           resolution const& sampling) const;
+  tile_idx_t tile_idx(geo::latlng const&) const;
+  resolution max_resolution() const;
+  std::size_t n_tiles() const;
+
+  cista::raw::rtree<std::size_t> rtree_{};
+  std::vector<tiff_tile> tiles_{};
+  std::vector<bool> overlaps_{};  // see add_overlaps()
+  std::unique_ptr<tile_cache> cache_;
+  std::unique_ptr<block_cache> blocks_;
+};
+
+}  // namespace osr::preprocessing::elevation
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <span>
+
+#include "geo/box.h"
+#include "geo/latlng.h"
+
+#include "osr/preprocessing/elevation/block_cache.h"
+#include "osr/preprocessing/elevation/resolution.h"
+#include "osr/preprocessing/elevation/shared.h"
+#include "osr/preprocessing/elevation/tile_cache.h"
+
+namespace osr::preprocessing::elevation {
+
+// Single band GeoTIFF / BigTIFF in geographic coordinates, organized in tiles
+// or strips, uncompressed or DEFLATE compressed (predictor 1, 2 or 3).
+// Reduced resolution images following the main image (overviews, as written
+// by cloud optimized GeoTIFFs) are used when sampling at a coarser resolution.
+struct tiff_tile {
+  tiff_tile(std::filesystem::path const&, tile_cache&, block_cache&);
+  ~tiff_tile();
+  tiff_tile(tiff_tile&&) noexcept;
+  tiff_tile(tiff_tile const&) = delete;
+  tiff_tile& operator=(tiff_tile const&) = delete;
+  tiff_tile& operator=(tiff_tile&&) = delete;
+
+  elevation_meters_t get(geo::latlng const&) const;
+
+  // Batch version of get(): out[i] = get(pos[i]).
+  void get(std::span<geo::latlng const> pos,
+           std::span<elevation_meters_t> out) const;
+
+  // Reads the coarsest level that is at least as fine as sampling.
+  void get(std::span<geo::latlng const> pos,
+           std::span<elevation_meters_t> out,
+           resolution const& sampling) const;
+  tile_idx_t tile_idx(geo::latlng const&) const;
+  geo::box get_box() const;
+  resolution max_resolution() const;
+  std::size_t n_levels() const;
+
+private:
+  struct impl;
+  std::unique_ptr<impl> impl_;
+};
+
+}  // namespace osr::preprocessing::elevation
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+
+#include "cista/mmap.h"
+
+namespace osr::preprocessing::elevation {
+
+constexpr auto const kDefaultMaxOpenTiles = std::size_t{256U};
+
+// Memory mapped tile files of a driver, keyed by the rtree tile index.
+//
+// Files are mapped on first access. Once more than max_open tiles are mapped,
+// the least recently used mapping is released. Every thread additionally
+// keeps its most recently used mapping alive, so the budget is max_open plus
+// one mapping per thread. All mappings are released with the cache.
+//
+// Files are mapped and unmapped outside of the cache lock, so threads that
+// hit other tiles are not blocked by the I/O. All files have to be added
+// before the first get().
+struct tile_cache {
+  explicit tile_cache(std::size_t max_open = kDefaultMaxOpenTiles);
+  ~tile_cache();
+  tile_cache(tile_cache const&) = delete;
+  tile_cache& operator=(tile_cache const&) = delete;
+  tile_cache(tile_cache&&) = delete;
+  tile_cache& operator=(tile_cache&&) = delete;
+
+  struct handle {
+    // Valid until the next call of get() on the same thread.
+    cista::mmap const& get() const;
+
+    tile_cache const* cache_{nullptr};
+    std::size_t tile_idx_{0U};
+  };
+
+  // Registers a file. The returned handle refers to the next tile index.
+  handle add(std::filesystem::path);
+
+  cista::mmap const& get(std::size_t tile_idx) const;
+
+  std::size_t n_tiles() const;
+  std::size_t n_open() const;
+
+private:
+  struct impl;
+  std::unique_ptr<impl> impl_;
+};
+
+}  // namespace osr::preprocessing::elevation
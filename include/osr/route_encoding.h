@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "geo/latlng.h"
+
+#include "osr/point.h"
+#include "osr/routing/path.h"
+
+namespace osr {
+
+struct ways;
+
+// Coordinate in 1e-7 degrees, the fixed-point resolution of way_polylines_.
+struct fixed_coord {
+  std::int32_t lat_, lng_;
+};
+
+// point stores the osmium x (longitude) in lat_ and y (latitude) in lng_.
+inline fixed_coord to_fixed(point const p) { return {p.lng_, p.lat_}; }
+
+// Exact for coordinates that were converted from a point (path polylines).
+inline fixed_coord to_fixed(geo::latlng const& p) {
+  return {static_cast<std::int32_t>(std::llround(p.lat_ * 1e7)),
+          static_cast<std::int32_t>(std::llround(p.lng_ * 1e7))};
+}
+
+// Google encoded polyline algorithm format with precision 5 or 6.
+// Coordinates are rounded from the 1e-7 fixed-point values with integer
+// arithmetic only.
+struct polyline_encoder {
+  explicit polyline_encoder(std::string& out, unsigned precision = 5U);
+
+  void add(fixed_coord);
+
+  template <typename Collection>
+  void add_all(Collection const& c) {
+    for (auto const& x : c) {
+      add(to_fixed(x));
+    }
+  }
+
+  std::string& out_;
+  std::int32_t divisor_;
+  std::int32_t prev_lat_{0};
+  std::int32_t prev_lng_{0};
+};
+
+template <typename Collection>
+std::string encode_polyline(Collection const& c,
+                            unsigned const precision = 5U) {
+  auto out = std::string{};
+  auto enc = polyline_encoder{out, precision};
+  enc.add_all(c);
+  return out;
+}
+
+std::vector<geo::latlng> decode_polyline(std::string_view,
+                                         unsigned precision = 5U);
+
+// Route as JSON with one encoded polyline per segment:
+// {"metadata": {"duration", "distance"}, "precision": 5,
+//  "segments": [{"level", "osm_way_id", "cost", "distance", "polyline"}]}
+void write_encoded_polyline_route(std::string& out,
+                                  ways const&,
+                                  path const&,
+                                  unsigned precision = 5U);
+
+// Compact binary route (all integers are LEB128 varints, signed ones zigzag
+// encoded):
+//   "OSR" version(1 byte = 1)
+//   cost, distance (m), n_segments
+//   per segment: osm_way_id, cost, distance, level (1 byte, level_t::v_),
+//                mode (1 byte), n_points,
+//                n_points x (zigzag dlat, zigzag dlng) in 1e-7 degrees,
+//                delta to the previous point of the route (first: to 0,0)
+void write_binary_route(std::string& out, ways const&, path const&);
+
+}  // namespace osr
@@ -5,8 +5,16 @@
 
 namespace osr {
 
-enum class routing_algorithm : std::uint8_t { kDijkstra, kAStarBi };
+enum class routing_algorithm : std::uint8_t {
+  kDijkstra,
+  kAStarBi,
+  kAStarBiParallel  // forward and backward search on separate threads
+};
+
+constexpr auto const kNumRoutingAlgorithms = 3U;
 
 routing_algorithm to_algorithm(std::string_view);
 
+std::string_view to_str(routing_algorithm);
+
 }  // namespace osr
@@ -11,8 +11,10 @@
 
 #include "osr/elevation_storage.h"
 #include "osr/routing/additional_edge.h"
+#include "osr/routing/cancellation.h"
 #include "osr/routing/dial.h"
 #include "osr/routing/profile.h"
+#include "osr/routing/search_stats.h"
 #include "osr/types.h"
 #include "osr/ways.h"
 
@@ -20,7 +22,7 @@ namespace osr {
 
 struct sharing_data;
 
-template <Profile P, bool EarlyTermination = false>
+template <Profile P, bool EarlyTermination = false, bool WithStats = false>
 struct astar {
   using profile_t = P;
   using key = typename P::key;
@@ -45,6 +47,8 @@ struct astar {
     pq_.n_buckets(max + 1U);
     cost_.clear();
     max_reached_ = false;
+    stats_ = {};
+    cancel_ = {};
     destinations_.clear();
     remaining_destinations_ = 0U;
     early_termination_max_cost_ = kInfeasible;
@@ -129,7 +133,10 @@ struct astar {
            sharing_data const* sharing,
            elevation_storage const* elevations) {
     while (!pq_.empty()) {
-      auto l = pq_.pop();
+      if (cancel_()) {
+        break;
+      }
+      auto l = stats_.pop(pq_);
       auto const curr_node = l.get_node();
       auto const curr_cost = get_cost(curr_node);
       auto const curr_heur =
@@ -168,6 +175,7 @@ struct astar {
         std::cout << "\n";
       }
 
+      stats_.adjacent();
       P::template adjacent<SearchDir, WithBlocked>(
           params, r, curr_node, blocked, sharing, elevations,
           [&](node const neighbor, std::uint32_t const cost, distance_t,
@@ -192,17 +200,20 @@ struct astar {
               auto next = label{neighbor, static_cast<cost_t>(heur)};
               next.track(l, r, way, neighbor.get_node(), track);
               pq_.push(std::move(next));
+              stats_.pushed(cost_);
 
               if constexpr (kDebug) {
                 std::cout << " -> PUSH\n";
               }
             } else {
+              stats_.dominated();
               if constexpr (kDebug) {
                 std::cout << " -> DOMINATED\n";
               }
             }
           });
     }
+    stats_.finish(cost_);
     return !max_reached_;
   }
 
@@ -271,6 +282,9 @@ struct astar {
   double dest_radius_{};
   double distance_lon_degrees_{};
   double beeline_distance_{};
+
+  [[no_unique_address]] search_stats_t<WithStats> stats_;
+  cancellation_check cancel_;
 };
 
 }  // namespace osr
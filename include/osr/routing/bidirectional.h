@@ -1,6 +1,11 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <exception>
 #include <limits>
+#include <vector>
 
 #include "utl/verify.h"
 
@@ -10,17 +15,21 @@
 #include "osr/elevation_storage.h"
 #include "osr/location.h"
 #include "osr/routing/additional_edge.h"
+#include "osr/routing/cancellation.h"
 #include "osr/routing/dial.h"
+#include "osr/routing/landmarks.h"
 #include "osr/routing/profile.h"
+#include "osr/routing/search_stats.h"
 #include "osr/routing/sharing_data.h"
 #include "osr/types.h"
+#include "osr/util/worker_thread.h"
 #include "osr/ways.h"
 
 namespace osr {
 
 struct sharing_data;
 
-template <Profile P>
+template <Profile P, bool WithStats = false>
 struct bidirectional {
   using profile_t = P;
   using key = typename P::key;
@@ -34,11 +43,26 @@ struct bidirectional {
   constexpr static auto const kDistanceLatDegrees =
       geo::kEarthRadiusMeters * geo::kPI / 180;
   constexpr static auto const kLongestNodeDistance = cost_t{300};
+  constexpr static auto const kParallelBatchSize = 128U;
 
   struct get_bucket {
     cost_t operator()(label const& l) { return l.cost(); }
   };
 
+  struct meetpoint {
+    node mp_1_;
+    node mp_2_;
+    cost_t cost_;
+  };
+
+  struct parallel_state {
+    std::barrier<> sync_{2};
+    std::array<meetpoint, 2> best_;
+    std::array<std::size_t, 2> n_settled_{};
+    bool cancelled_{false};  // written by the forward side only
+    std::atomic_bool failed_{false};  // one side threw and left the barrier
+  };
+
   void clear_mp() {
     meet_point_1_ = meet_point_1_.invalid();
     meet_point_2_ = meet_point_2_.invalid();
@@ -72,6 +96,10 @@ struct bidirectional {
             : max;
     max_reached_1_ = false;
     max_reached_2_ = false;
+    n_settled_ = 0U;
+    stats_ = {};
+    cancel_ = {};
+    alt_.reset(nullptr, direction::kForward);
   }
 
   void add(P::parameters const& params,
@@ -148,10 +176,20 @@ struct bidirectional {
     auto const p = get_node_pos(idx);
     auto const dist = distapprox(p, end_loc_.pos_);
     auto const other_dist = distapprox(p, start_loc_.pos_);
-    return 0.5 *
-           (P::lower_bound_heuristic(params, dist) -
-            P::lower_bound_heuristic(params, other_dist)) *
-           (dir == direction::kForward ? 1 : -1);
+    auto to_end = P::lower_bound_heuristic(params, dist);
+    auto from_start = P::lower_bound_heuristic(params, other_dist);
+    if (alt_.active()) {
+      to_end = std::max(to_end, static_cast<double>(alt_.to_target(idx)));
+      from_start =
+          std::max(from_start, static_cast<double>(alt_.from_source(idx)));
+    }
+    return 0.5 * (to_end - from_start) * (dir == direction::kForward ? 1 : -1);
+  }
+
+  search_stats_t<WithStats> total_stats() const {
+    auto s = stats_[0];
+    s += stats_[1];
+    return s;
   }
 
   cost_t get_cost_to_mp(node const n1, node const n2) const {
@@ -163,28 +201,31 @@ struct bidirectional {
     return clamp_cost(static_cast<std::uint64_t>(f_cost) + b_cost);
   }
 
+  // Pops the next label of pq and relaxes its outgoing edges. Returns the
+  // settled node or node::invalid() if the label was outdated.
   template <direction SearchDir, bool WithBlocked, direction PathDir>
-  bool run_single(P::parameters const& params,
-                  ways const& w,
-                  ways::routing const& r,
-                  cost_t const max,
-                  bitvec<node_idx_t> const* blocked,
-                  sharing_data const* sharing,
-                  elevation_storage const* elevations,
-                  dial<label, get_bucket>& pq,
-                  cost_map& costs) {
+  node expand(P::parameters const& params,
+              ways const& w,
+              ways::routing const& r,
+              cost_t const max,
+              bitvec<node_idx_t> const* blocked,
+              sharing_data const* sharing,
+              elevation_storage const* elevations,
+              dial<label, get_bucket>& pq,
+              cost_map& costs) {
     auto const adjusted_max =
         clamp_cost((static_cast<std::uint64_t>(max) + radius_) / 2U);
     auto const is_fwd = PathDir == direction::kForward;
+    auto& stats = stats_[is_fwd ? 0U : 1U];
 
-    auto const l = pq.pop();
+    auto const l = stats.pop(pq);
     auto const curr = l.get_node();
     auto const curr_cost = get_cost<PathDir>(curr);
     if (static_cast<std::int64_t>(curr_cost) <
         static_cast<std::int64_t>(l.cost()) -
             static_cast<std::int64_t>(
                 heuristic(params, w, l.n_, PathDir, sharing))) {
-      return true;
+      return node::invalid();
     }
     if constexpr (kDebug) {
       std::cout << "EXTRACT ";
@@ -192,6 +233,7 @@ struct bidirectional {
       std::cout << "\n";
     }
 
+    stats.adjacent();
     P::template adjacent<SearchDir, WithBlocked>(
         params, r, curr, blocked, sharing, elevations,
         [&](node const neighbor, std::uint32_t const cost, distance_t,
@@ -222,17 +264,40 @@ struct bidirectional {
             auto next = label{neighbor, static_cast<cost_t>(heur)};
             next.track(l, r, way, neighbor.get_node(), track);
             pq.push(std::move(next));
+            stats.pushed(costs);
 
             if constexpr (kDebug) {
               std::cout << " -> PUSH\n";
             }
           } else {
+            stats.dominated();
             if constexpr (kDebug) {
               std::cout << " -> DOMINATED\n";
             }
           }
         });
 
+    return curr;
+  }
+
+  // Checks whether the settled node curr connects both searches and updates
+  // the best meeting point (mp_1, mp_2, best) accordingly. Only reads the
+  // cost maps.
+  template <direction SearchDir, bool WithBlocked, direction PathDir>
+  void find_meetpoint(P::parameters const& params,
+                      ways const& w,
+                      ways::routing const& r,
+                      bitvec<node_idx_t> const* blocked,
+                      sharing_data const* sharing,
+                      elevation_storage const* elevations,
+                      cost_map const& costs,
+                      node const curr,
+                      node& mp_1,
+                      node& mp_2,
+                      cost_t& best) const {
+    auto const is_fwd = PathDir == direction::kForward;
+    auto const curr_cost = get_cost<PathDir>(curr);
+
     auto const evaluate_meetpoint = [&](cost_t cost, cost_t other_cost,
                                         node meetpoint1, node meetpoint2) {
       if constexpr (kDebug) {
@@ -241,100 +306,120 @@ struct bidirectional {
       }
       auto const tentative = static_cast<std::uint64_t>(cost) +
                              static_cast<std::uint64_t>(other_cost);
-      if (tentative < best_cost_) {
-        meet_point_1_ = meetpoint1;
-        meet_point_2_ = meetpoint2;
-        assert(tentative == get_cost_to_mp(meet_point_1_, meet_point_2_));
-        best_cost_ = clamp_cost(tentative);
+      if (tentative < best) {
+        mp_1 = meetpoint1;
+        mp_2 = meetpoint2;
+        assert(tentative == get_cost_to_mp(mp_1, mp_2));
+        best = clamp_cost(tentative);
 
         if constexpr (kDebug) {
-          std::cout << " with cost " << best_cost_ << " -> ACCEPTED\n";
+          std::cout << " with cost " << best << " -> ACCEPTED\n";
         }
       } else if constexpr (kDebug) {
         std::cout << " -> DOMINATED\n";
       }
     };
 
-    auto const handle_end_of_way_meetpoint = [&]() {
-      auto const opposite_cost_map = is_fwd ? &cost2_ : &cost1_;
-      auto const opposite_candidate = opposite_cost_map->find(curr.get_key());
-      if (opposite_candidate != end(*opposite_cost_map)) {
-        auto const other_cost = opposite_candidate->second.cost(curr);
-        if (other_cost != kInfeasible) {
-          evaluate_meetpoint(curr_cost, other_cost, curr, curr);
-        } else {
-          auto const pred_it = costs.find(curr.get_key());
-          if (pred_it == end(costs)) {
+    auto const opposite_cost_map = is_fwd ? &cost2_ : &cost1_;
+    auto const opposite_candidate = opposite_cost_map->find(curr.get_key());
+    if (opposite_candidate == end(*opposite_cost_map)) {
+      return;
+    }
+
+    auto const other_cost = opposite_candidate->second.cost(curr);
+    if (other_cost != kInfeasible) {
+      evaluate_meetpoint(curr_cost, other_cost, curr, curr);
+      return;
+    }
+
+    auto const pred_it = costs.find(curr.get_key());
+    if (pred_it == end(costs)) {
+      return;
+    }
+    auto const pred = pred_it->second.pred(curr);
+    if (!pred.has_value()) {
+      return;
+    }
+    P::template adjacent<opposite(SearchDir), WithBlocked>(
+        params, r, curr, blocked, sharing, elevations,
+        [&](node const neighbor, std::uint32_t const, distance_t,
+            way_idx_t const, std::uint16_t, std::uint16_t,
+            elevation_storage::elevation const, bool const) {
+          if (neighbor.get_key() != pred->get_key()) {
             return;
           }
-          auto const pred = pred_it->second.pred(curr);
-          if (!pred.has_value()) {
+          auto const opposite_it = opposite_cost_map->find(neighbor.get_key());
+          if (opposite_it == end(*opposite_cost_map)) {
             return;
           }
-          P::template adjacent<opposite(SearchDir), WithBlocked>(
-              params, r, curr, blocked, sharing, elevations,
-              [&](node const neighbor, std::uint32_t const, distance_t,
-                  way_idx_t const, std::uint16_t, std::uint16_t,
-                  elevation_storage::elevation const, bool const) {
-                if (neighbor.get_key() != pred->get_key()) {
-                  return;
-                }
-                auto const opposite_it =
-                    opposite_cost_map->find(neighbor.get_key());
-                if (opposite_it == end(*opposite_cost_map)) {
-                  return;
-                }
-                auto const opposite_curr = opposite_it->second.pred(neighbor);
-                if (!opposite_curr.has_value() ||
-                    opposite_curr->get_key() != curr.get_key()) {
-                  return;
-                }
-                auto const opposite_curr_cost =
-                    opposite_candidate->second.cost(*opposite_curr);
-                auto const pred_cost = get_cost<PathDir>(*pred);
-                auto const opposite_pred_cost =
-                    opposite_it->second.cost(neighbor);
-                auto const evaluate_meetpoint_with_potential_u_turn_cost =
-                    [&](cost_t const cost_1, cost_t const cost_2,
-                        node const meet_1, node const meet_2) {
-                      evaluate_meetpoint(cost_1, cost_2,
-                                         is_fwd ? meet_1 : meet_2,
-                                         is_fwd ? meet_2 : meet_1);
-                    };
-                if (static_cast<std::uint64_t>(pred_cost) + opposite_pred_cost >
-                    static_cast<std::uint64_t>(curr_cost) +
-                        opposite_curr_cost) {
-                  evaluate_meetpoint_with_potential_u_turn_cost(
-                      pred_cost, opposite_pred_cost, *pred, neighbor);
-                } else {
-                  evaluate_meetpoint_with_potential_u_turn_cost(
-                      curr_cost, opposite_curr_cost, curr, *opposite_curr);
-                }
-              });
-        }
-      }
-    };
+          auto const opposite_curr = opposite_it->second.pred(neighbor);
+          if (!opposite_curr.has_value() ||
+              opposite_curr->get_key() != curr.get_key()) {
+            return;
+          }
+          auto const opposite_curr_cost =
+              opposite_candidate->second.cost(*opposite_curr);
+          auto const pred_cost = get_cost<PathDir>(*pred);
+          auto const opposite_pred_cost = opposite_it->second.cost(neighbor);
+          auto const evaluate_meetpoint_with_potential_u_turn_cost =
+              [&](cost_t const cost_1, cost_t const cost_2, node const meet_1,
+                  node const meet_2) {
+                evaluate_meetpoint(cost_1, cost_2, is_fwd ? meet_1 : meet_2,
+                                   is_fwd ? meet_2 : meet_1);
+              };
+          if (static_cast<std::uint64_t>(pred_cost) + opposite_pred_cost >
+              static_cast<std::uint64_t>(curr_cost) + opposite_curr_cost) {
+            evaluate_meetpoint_with_potential_u_turn_cost(
+                pred_cost, opposite_pred_cost, *pred, neighbor);
+          } else {
+            evaluate_meetpoint_with_potential_u_turn_cost(
+                curr_cost, opposite_curr_cost, curr, *opposite_curr);
+          }
+        });
+  }
 
-    handle_end_of_way_meetpoint();
-
-    if (best_cost_ != kInfeasible) {
-      auto const top_f =
-          pq1_.empty() ? get_cost<direction::kForward>(meet_point_1_)
-                       : pq1_.buckets_[pq1_.get_next_bucket()].back().cost();
-      auto const top_r =
-          pq2_.empty() ? get_cost<direction::kBackward>(meet_point_2_)
-                       : pq2_.buckets_[pq2_.get_next_bucket()].back().cost();
-      if (static_cast<std::uint64_t>(top_f) + top_r >=
-          static_cast<std::uint64_t>(best_cost_) +
-              static_cast<std::uint64_t>(radius_)) {
-        if (kDebug) {
-          std::cout << "stopping criterion met " << top_f << " " << top_r << " "
-                    << best_cost_ << " " << radius_ << std::endl;
-        }
-        return false;
+  // Stopping criterion: no label left in the queues can improve best.
+  bool is_done(node const mp_1, node const mp_2, cost_t const best) const {
+    if (best == kInfeasible) {
+      return false;
+    }
+    auto const top_f =
+        pq1_.empty() ? get_cost<direction::kForward>(mp_1)
+                     : pq1_.buckets_[pq1_.get_next_bucket()].back().cost();
+    auto const top_r =
+        pq2_.empty() ? get_cost<direction::kBackward>(mp_2)
+                     : pq2_.buckets_[pq2_.get_next_bucket()].back().cost();
+    if (static_cast<std::uint64_t>(top_f) + top_r >=
+        static_cast<std::uint64_t>(best) + static_cast<std::uint64_t>(radius_)) {
+      if (kDebug) {
+        std::cout << "stopping criterion met " << top_f << " " << top_r << " "
+                  << best << " " << radius_ << std::endl;
       }
+      return true;
     }
-    return true;
+    return false;
+  }
+
+  template <direction SearchDir, bool WithBlocked, direction PathDir>
+  bool run_single(P::parameters const& params,
+                  ways const& w,
+                  ways::routing const& r,
+                  cost_t const max,
+                  bitvec<node_idx_t> const* blocked,
+                  sharing_data const* sharing,
+                  elevation_storage const* elevations,
+                  dial<label, get_bucket>& pq,
+                  cost_map& costs) {
+    auto const curr = expand<SearchDir, WithBlocked, PathDir>(
+        params, w, r, max, blocked, sharing, elevations, pq, costs);
+    if (curr == node::invalid()) {
+      return true;
+    }
+    ++n_settled_;
+    find_meetpoint<SearchDir, WithBlocked, PathDir>(
+        params, w, r, blocked, sharing, elevations, costs, curr, meet_point_1_,
+        meet_point_2_, best_cost_);
+    return !is_done(meet_point_1_, meet_point_2_, best_cost_);
   }
 
   template <direction SearchDir, bool WithBlocked>
@@ -349,6 +434,9 @@ struct bidirectional {
       return false;
     }
     while (!pq1_.empty() || !pq2_.empty()) {
+      if (cancel_()) {
+        break;
+      }
       if (!pq1_.empty() &&
           !run_single<SearchDir, WithBlocked, direction::kForward>(
               params, w, r, max, blocked, sharing, elevations, pq1_, cost1_)) {
@@ -360,6 +448,8 @@ struct bidirectional {
         break;
       }
     }
+    stats_[0].finish(cost1_);
+    stats_[1].finish(cost2_);
     if (best_cost_ != kInfeasible && best_cost_ > max) {
       clear_mp();
       return false;
@@ -390,6 +480,164 @@ struct bidirectional {
     }
   }
 
+  // One side of run_parallel(). Rounds of three phases, separated by
+  // barriers: (1) expand up to kParallelBatchSize labels, writing only this
+  // side's queue and cost map, (2) look for meeting points among the labels
+  // settled in (1) while both cost maps are read-only, (3) evaluate the
+  // stopping criterion on the merged best meeting point. Both sides see the
+  // same state in (3) and therefore stop in the same round. A side that
+  // throws drops out of the barrier, so the other side is not blocked and
+  // stops in its next round.
+  template <direction SearchDir, bool WithBlocked, direction PathDir>
+  void run_side(P::parameters const& params,
+                ways const& w,
+                ways::routing const& r,
+                cost_t const max,
+                bitvec<node_idx_t> const* blocked,
+                sharing_data const* sharing,
+                elevation_storage const* elevations,
+                parallel_state& s) {
+    try {
+      run_rounds<SearchDir, WithBlocked, PathDir>(params, w, r, max, blocked,
+                                                  sharing, elevations, s);
+    } catch (...) {
+      s.failed_ = true;
+      s.sync_.arrive_and_drop();
+      throw;
+    }
+  }
+
+  template <direction SearchDir, bool WithBlocked, direction PathDir>
+  void run_rounds(P::parameters const& params,
+                  ways const& w,
+                  ways::routing const& r,
+                  cost_t const max,
+                  bitvec<node_idx_t> const* blocked,
+                  sharing_data const* sharing,
+                  elevation_storage const* elevations,
+                  parallel_state& s) {
+    constexpr auto const kIdx = PathDir == direction::kForward ? 0U : 1U;
+    auto& pq = kIdx == 0U ? pq1_ : pq2_;
+    auto& costs = kIdx == 0U ? cost1_ : cost2_;
+    auto& best = s.best_[kIdx];
+
+    auto settled = std::vector<node>{};
+    while (true) {
+      settled.clear();
+      // Once per round, before the first barrier, so the token is checked
+      // even while the forward queue is empty. cancel_ is not shared between
+      // threads, so only the forward side reads it.
+      if (kIdx == 0U && cancel_.now()) {
+        s.cancelled_ = true;
+      }
+      for (auto i = 0U; i != kParallelBatchSize && !pq.empty(); ++i) {
+        auto const curr = expand<SearchDir, WithBlocked, PathDir>(
+            params, w, r, max, blocked, sharing, elevations, pq, costs);
+        if (curr != node::invalid()) {
+          settled.push_back(curr);
+        }
+      }
+      s.n_settled_[kIdx] += settled.size();
+      s.sync_.arrive_and_wait();
+
+      for (auto const curr : settled) {
+        find_meetpoint<SearchDir, WithBlocked, PathDir>(
+            params, w, r, blocked, sharing, elevations, costs, curr,
+            best.mp_1_, best.mp_2_, best.cost_);
+      }
+      s.sync_.arrive_and_wait();
+
+      auto const& overall =
+          s.best_[0].cost_ <= s.best_[1].cost_ ? s.best_[0] : s.best_[1];
+      auto const done = s.cancelled_ || s.failed_ ||
+                        (pq1_.empty() && pq2_.empty()) ||
+                        is_done(overall.mp_1_, overall.mp_2_, overall.cost_);
+      s.sync_.arrive_and_wait();
+      if (done) {
+        break;
+      }
+    }
+  }
+
+  // Same result as run(), but the forward search runs on the calling thread
+  // and the backward search on the persistent helper thread of this engine.
+  // Exceptions of either side are rethrown after both sides finished.
+  template <direction SearchDir, bool WithBlocked>
+  bool run_parallel(P::parameters const& params,
+                    ways const& w,
+                    ways::routing const& r,
+                    cost_t const max,
+                    bitvec<node_idx_t> const* blocked,
+                    sharing_data const* sharing,
+                    elevation_storage const* elevations) {
+    if (radius_ == max) {
+      return false;
+    }
+
+    auto s = parallel_state{};
+    s.best_.fill(meetpoint{meet_point_1_, meet_point_2_, best_cost_});
+
+    helper_.start([&]() {
+      run_side<opposite(SearchDir), WithBlocked, direction::kBackward>(
+          params, w, r, max, blocked, sharing, elevations, s);
+    });
+    auto error = std::exception_ptr{};
+    try {
+      run_side<SearchDir, WithBlocked, direction::kForward>(
+          params, w, r, max, blocked, sharing, elevations, s);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    try {
+      helper_.wait();
+    } catch (...) {
+      if (error == nullptr) {
+        error = std::current_exception();
+      }
+    }
+    if (error != nullptr) {
+      std::rethrow_exception(error);
+    }
+
+    auto const& best =
+        s.best_[0].cost_ <= s.best_[1].cost_ ? s.best_[0] : s.best_[1];
+    meet_point_1_ = best.mp_1_;
+    meet_point_2_ = best.mp_2_;
+    best_cost_ = best.cost_;
+    n_settled_ += s.n_settled_[0] + s.n_settled_[1];
+    stats_[0].finish(cost1_);
+    stats_[1].finish(cost2_);
+
+    if (best_cost_ != kInfeasible && best_cost_ > max) {
+      clear_mp();
+      return false;
+    }
+    return !max_reached_1_ || !max_reached_2_;
+  }
+
+  bool run_parallel(P::parameters const& params,
+                    ways const& w,
+                    ways::routing const& r,
+                    cost_t const max,
+                    bitvec<node_idx_t> const* blocked,
+                    sharing_data const* sharing,
+                    elevation_storage const* elevations,
+                    direction const dir) {
+    if (blocked == nullptr) {
+      return dir == direction::kForward
+                 ? run_parallel<direction::kForward, false>(
+                       params, w, r, max, blocked, sharing, elevations)
+                 : run_parallel<direction::kBackward, false>(
+                       params, w, r, max, blocked, sharing, elevations);
+    } else {
+      return dir == direction::kForward
+                 ? run_parallel<direction::kForward, true>(
+                       params, w, r, max, blocked, sharing, elevations)
+                 : run_parallel<direction::kBackward, true>(
+                       params, w, r, max, blocked, sharing, elevations);
+    }
+  }
+
   dial<label, get_bucket> pq1_{get_bucket{}};
   dial<label, get_bucket> pq2_{get_bucket{}};
   location start_loc_;
@@ -403,6 +651,20 @@ struct bidirectional {
   double distance_lon_degrees_;
   bool max_reached_1_;
   bool max_reached_2_;
+  std::size_t n_settled_{0U};
+
+  // Optional ALT lower bounds, set up after reset() by the caller.
+  landmark_bounds alt_;
+
+  // Forward and backward search count separately (they may run on
+  // different threads, see run_parallel()).
+  std::array<search_stats_t<WithStats>, 2> stats_{};
+
+  // Only checked by the thread of the forward search.
+  cancellation_check cancel_;
+
+  // Runs the backward side of run_parallel().
+  worker_thread helper_;
 };
 
 }  // namespace osr
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+
+namespace osr {
+
+// Cooperative cancellation of a search: either explicitly via cancel() (e.g.
+// when the client disconnected) or when the deadline has passed.
+struct cancellation_token {
+  using clock = std::chrono::steady_clock;
+
+  cancellation_token() = default;
+  explicit cancellation_token(clock::time_point const deadline)
+      : deadline_{deadline} {}
+
+  static cancellation_token with_timeout(clock::duration const timeout) {
+    return cancellation_token{clock::now() + timeout};
+  }
+
+  void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+  bool is_cancelled() const {
+    return cancelled_.load(std::memory_order_relaxed) ||
+           (deadline_.has_value() && clock::now() >= *deadline_);
+  }
+
+  std::optional<clock::time_point> deadline_;
+  std::atomic_bool cancelled_{false};
+};
+
+// Thrown by route() and map_match() if the search was cancelled.
+struct search_cancelled : public std::runtime_error {
+  search_cancelled() : std::runtime_error{"search cancelled"} {}
+};
+
+// Per-engine check: looks at the token only every kInterval calls, so
+// reading the clock does not show up in the search loop. Engines clear it in
+// reset(), the token has to be set afterwards.
+struct cancellation_check {
+  static constexpr auto const kInterval = 1024U;
+
+  // Returns true if the search should stop.
+  bool operator()() {
+    if (token_ == nullptr || (n_++ % kInterval) != 0U) {
+      return false;
+    }
+    cancelled_ = token_->is_cancelled();
+    return cancelled_;
+  }
+
+  // Looks at the token right away, for loops that check once per batch.
+  bool now() {
+    if (token_ == nullptr) {
+      return false;
+    }
+    cancelled_ = token_->is_cancelled();
+    return cancelled_;
+  }
+
+  cancellation_token const* token_{nullptr};
+  unsigned n_{0U};
+  bool cancelled_{false};
+};
+
+}  // namespace osr
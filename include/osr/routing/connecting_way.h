@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "osr/elevation_storage.h"
+#include "osr/types.h"
+#include "osr/ways.h"
+
+namespace osr {
+
+struct connecting_way {
+  constexpr bool valid() const noexcept { return way_ != way_idx_t::invalid(); }
+
+  way_idx_t way_{way_idx_t::invalid()};
+  std::uint16_t from_{};
+  std::uint16_t to_{};
+  bool is_loop_{};
+  distance_t distance_{};
+  elevation_storage::elevation elevation_{};
+};
+
+inline connecting_way make_connecting_way(
+    ways::routing const& r,
+    way_idx_t const way,
+    std::uint16_t const a_idx,
+    std::uint16_t const b_idx,
+    distance_t const dist,
+    elevation_storage::elevation const elevation) {
+  auto const is_loop = way != way_idx_t::invalid() && r.is_loop(way) &&
+                       static_cast<unsigned>(std::abs(a_idx - b_idx)) ==
+                           r.way_nodes_[way].size() - 2U;
+  return {way, a_idx, b_idx, is_loop, dist, elevation};
+}
+
+}  // namespace osr
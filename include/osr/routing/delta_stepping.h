@@ -0,0 +1,276 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "utl/verify.h"
+
+#include "osr/elevation_storage.h"
+#include "osr/routing/connecting_way.h"
+#include "osr/routing/dial.h"
+#include "osr/routing/profile.h"
+#include "osr/routing/search_stats.h"
+#include "osr/types.h"
+#include "osr/util/worker_thread.h"
+#include "osr/ways.h"
+
+namespace osr {
+
+struct sharing_data;
+
+// Parallel one-to-all search (delta-stepping with buckets of width delta_).
+// Labels are partitioned by the hash of their key: every thread owns one
+// shard with its own cost map and bucket queue. All labels of the current
+// bucket are expanded in parallel, relaxations are written to per-thread
+// buffers and applied by the owner of the target shard in a second phase.
+// Costs are the same as the ones computed by dijkstra<P>. Shard 0 runs on the
+// calling thread, the others on worker threads owned by the search.
+template <Profile P>
+struct delta_stepping {
+  using profile_t = P;
+  using key = typename P::key;
+  using label = typename P::label;
+  using node = typename P::node;
+  using entry = typename P::entry;
+  using hash = typename P::hash;
+  using cost_map = typename ankerl::unordered_dense::map<key, entry, hash>;
+
+  static constexpr auto const kNoBucket = std::numeric_limits<cost_t>::max();
+
+  struct get_bucket {
+    cost_t operator()(label const& l) const { return l.cost() / delta_; }
+    cost_t delta_;
+  };
+
+  struct relaxation {
+    label pred_;
+    label next_;
+  };
+
+  struct shard {
+    explicit shard(cost_t const delta) : pq_{get_bucket{delta}} {}
+
+    dial<label, get_bucket> pq_;
+    cost_map cost_;
+    std::vector<std::vector<relaxation>> out_;
+    cost_t next_bucket_{kNoBucket};
+    bool max_reached_{false};
+  };
+
+  explicit delta_stepping(
+      unsigned const n_threads = std::thread::hardware_concurrency(),
+      cost_t const delta = 30U)
+      : delta_{delta} {
+    utl::verify(delta != 0U, "delta_stepping: delta must not be zero");
+    auto const n = std::max(1U, n_threads);
+    shards_.reserve(n);
+    for (auto i = 0U; i != n; ++i) {
+      shards_.emplace_back(delta);
+      shards_.back().out_.resize(n);
+    }
+    workers_ = std::vector<worker_thread>(n - 1U);
+  }
+
+  void reset(cost_t const max) {
+    for (auto& s : shards_) {
+      s.pq_.clear();
+      s.pq_.n_buckets(max / delta_ + 1U);
+      s.cost_.clear();
+      s.next_bucket_ = kNoBucket;
+      s.max_reached_ = false;
+      for (auto& out : s.out_) {
+        out.clear();
+      }
+    }
+    max_reached_ = false;
+  }
+
+  shard& get_shard(key const& k) {
+    return shards_[hash{}(k) % shards_.size()];
+  }
+
+  shard const& get_shard(key const& k) const {
+    return shards_[hash{}(k) % shards_.size()];
+  }
+
+  void add_start(ways const&, label const l) {
+    auto& s = get_shard(l.get_node().get_key());
+    if (s.cost_[l.get_node().get_key()].update(l, l.get_node(), l.cost(),
+                                               node::invalid())) {
+      utl::verify(
+          l.cost() / delta_ < s.pq_.n_buckets(),
+          "delta_stepping::add_start: label cost exceeds max: {} >= {}",
+          l.cost(), s.pq_.n_buckets() * delta_);
+      s.pq_.push(l);
+    }
+  }
+
+  cost_t get_cost(node const n) const {
+    auto const& s = get_shard(n.get_key());
+    auto const it = s.cost_.find(n.get_key());
+    return it != end(s.cost_) ? it->second.cost(n) : kInfeasible;
+  }
+
+  // Connecting ways are not recorded, reconstruction enumerates adjacency.
+  connecting_way const* get_connection(node) const { return nullptr; }
+
+  template <direction SearchDir, bool WithBlocked>
+  void run_shard(P::parameters const& params,
+                 ways::routing const& r,
+                 cost_t const max,
+                 bitvec<node_idx_t> const* blocked,
+                 sharing_data const* sharing,
+                 elevation_storage const* elevations,
+                 std::barrier<>& sync,
+                 std::atomic_bool const& failed,
+                 unsigned const idx) {
+    auto& s = shards_[idx];
+    while (true) {
+      // Phase 0: agree on the current bucket.
+      s.next_bucket_ = s.pq_.empty() ? kNoBucket : s.pq_.get_next_bucket();
+      sync.arrive_and_wait();
+      auto current = kNoBucket;
+      for (auto const& x : shards_) {
+        current = std::min(current, x.next_bucket_);
+      }
+      if (failed) {
+        // Shards may read failed at different times in this phase, so every
+        // shard that stops early leaves the barrier as well.
+        sync.arrive_and_drop();
+        break;
+      }
+      if (current == kNoBucket) {
+        break;
+      }
+
+      // Phase 1: expand all labels of the current bucket of this shard.
+      while (!s.pq_.empty() && s.pq_.get_next_bucket() == current) {
+        auto const l = s.pq_.pop();
+        auto const curr = l.get_node();
+        auto const it = s.cost_.find(curr.get_key());
+        if (it == end(s.cost_) || it->second.cost(curr) < l.cost()) {
+          continue;
+        }
+
+        P::template adjacent<SearchDir, WithBlocked>(
+            params, r, curr, blocked, sharing, elevations,
+            [&](node const neighbor, std::uint32_t const cost, distance_t,
+                way_idx_t const way, std::uint16_t, std::uint16_t,
+                elevation_storage::elevation, bool const track) {
+              auto const total = static_cast<std::uint64_t>(l.cost()) + cost;
+              if (total >= max) {
+                s.max_reached_ = true;
+                return;
+              }
+              auto next = label{neighbor, static_cast<cost_t>(total)};
+              next.track(l, r, way, neighbor.get_node(), track);
+              auto const owner = hash{}(neighbor.get_key()) % shards_.size();
+              s.out_[owner].push_back(relaxation{l, next});
+            });
+      }
+      sync.arrive_and_wait();
+
+      // Phase 2: apply the relaxations targeting this shard.
+      for (auto& other : shards_) {
+        for (auto const& x : other.out_[idx]) {
+          auto const n = x.next_.get_node();
+          if (s.cost_[n.get_key()].update(x.pred_, n, x.next_.cost(),
+                                          x.pred_.get_node())) {
+            s.pq_.push(x.next_);
+          }
+        }
+        other.out_[idx].clear();
+      }
+      sync.arrive_and_wait();
+    }
+  }
+
+  template <direction SearchDir, bool WithBlocked>
+  bool run(P::parameters const& params,
+           ways const&,
+           ways::routing const& r,
+           cost_t const max,
+           bitvec<node_idx_t> const* blocked,
+           sharing_data const* sharing,
+           elevation_storage const* elevations) {
+    // A shard that throws drops out of the barrier, so the other shards are
+    // not blocked and stop at the start of the next bucket. The first
+    // exception is rethrown once all shards have stopped.
+    auto const n = static_cast<unsigned>(shards_.size());
+    auto sync = std::barrier<>{static_cast<std::ptrdiff_t>(n)};
+    auto failed = std::atomic_bool{false};
+    auto const run_worker = [&](unsigned const i) {
+      try {
+        run_shard<SearchDir, WithBlocked>(params, r, max, blocked, sharing,
+                                          elevations, sync, failed, i);
+      } catch (...) {
+        failed = true;
+        sync.arrive_and_drop();
+        throw;
+      }
+    };
+
+    for (auto i = 1U; i < n; ++i) {
+      workers_[i - 1U].start([&, i]() { run_worker(i); });
+    }
+    auto error = std::exception_ptr{};
+    try {
+      run_worker(0U);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    for (auto& worker : workers_) {
+      try {
+        worker.wait();
+      } catch (...) {
+        if (error == nullptr) {
+          error = std::current_exception();
+        }
+      }
+    }
+    if (error != nullptr) {
+      std::rethrow_exception(error);
+    }
+
+    max_reached_ = std::ranges::any_of(
+        shards_, [](shard const& s) { return s.max_reached_; });
+    return !max_reached_;
+  }
+
+  bool run(P::parameters const& params,
+           ways const& w,
+           ways::routing const& r,
+           cost_t const max,
+           bitvec<node_idx_t> const* blocked,
+           sharing_data const* sharing,
+           elevation_storage const* elevations,
+           direction const dir) {
+    if (blocked == nullptr) {
+      return dir == direction::kForward
+                 ? run<direction::kForward, false>(params, w, r, max, blocked,
+                                                   sharing, elevations)
+                 : run<direction::kBackward, false>(params, w, r, max, blocked,
+                                                    sharing, elevations);
+    } else {
+      return dir == direction::kForward
+                 ? run<direction::kForward, true>(params, w, r, max, blocked,
+                                                  sharing, elevations)
+                 : run<direction::kBackward, true>(params, w, r, max, blocked,
+                                                   sharing, elevations);
+    }
+  }
+
+  cost_t delta_;
+  std::vector<shard> shards_;
+  std::vector<worker_thread> workers_;
+  bool max_reached_{false};
+  [[no_unique_address]] no_search_stats stats_;
+};
+
+}  // namespace osr
@@ -2,14 +2,19 @@
 
 #include <cstdint>
 #include <algorithm>
+#include <limits>
+#include <utility>
 #include <vector>
 
 #include "utl/verify.h"
 
 #include "osr/elevation_storage.h"
 #include "osr/routing/additional_edge.h"
+#include "osr/routing/cancellation.h"
+#include "osr/routing/connecting_way.h"
 #include "osr/routing/dial.h"
 #include "osr/routing/profile.h"
+#include "osr/routing/search_stats.h"
 #include "osr/types.h"
 #include "osr/ways.h"
 
@@ -17,7 +22,7 @@ namespace osr {
 
 struct sharing_data;
 
-template <Profile P, bool EarlyTermination = false>
+template <Profile P, bool EarlyTermination = false, bool WithStats = false>
 struct dijkstra {
   using profile_t = P;
   using key = typename P::key;
@@ -36,7 +41,11 @@ struct dijkstra {
     pq_.clear();
     pq_.n_buckets(max + 1U);
     cost_.clear();
+    connection_heads_.clear();
+    connections_.clear();
     max_reached_ = false;
+    stats_ = {};
+    cancel_ = {};
     if constexpr (EarlyTermination) {
       destinations_.clear();
       remaining_destinations_ = 0U;
@@ -75,83 +84,125 @@ struct dijkstra {
     return it != end(cost_) ? it->second.cost(n) : kInfeasible;
   }
 
+  // The way over which n was reached (only with store_connections_).
+  connecting_way const* get_connection(node const n) const {
+    auto const it = connection_heads_.find(n.get_key());
+    if (it == end(connection_heads_)) {
+      return nullptr;
+    }
+    for (auto i = it->second; i != kNoConnection; i = connections_[i].next_) {
+      if (connections_[i].n_ == n) {
+        return &connections_[i].way_;
+      }
+    }
+    return nullptr;
+  }
+
+  // Pops and expands one label. Returns false if the search terminated
+  // early. The queue must not be empty.
   template <direction SearchDir, bool WithBlocked>
-  bool run(P::parameters const& params,
-           ways const& w,
-           ways::routing const& r,
-           cost_t const max,
-           bitvec<node_idx_t> const* blocked,
-           sharing_data const* sharing,
-           elevation_storage const* elevations) {
-    while (!pq_.empty()) {
-      auto l = pq_.pop();
+  bool step(P::parameters const& params,
+            ways const& w,
+            ways::routing const& r,
+            cost_t const max,
+            bitvec<node_idx_t> const* blocked,
+            sharing_data const* sharing,
+            elevation_storage const* elevations) {
+    auto l = stats_.pop(pq_);
 
-      if (get_cost(l.get_node()) < l.cost()) {
-        continue;
-      }
+    if (get_cost(l.get_node()) < l.cost()) {
+      return true;
+    }
 
-      if constexpr (EarlyTermination) {
-        if (std::find(begin(destinations_), end(destinations_), l.get_node()) !=
-            end(destinations_)) {
-          --remaining_destinations_;
-          auto const curr_cost = get_cost(l.get_node());
-          early_termination_max_cost_ = std::min(
-              early_termination_max_cost_,
-              static_cast<cost_t>(std::min(
-                  {static_cast<std::uint64_t>(curr_cost) * 2 +
-                       static_cast<std::uint64_t>(
-                           P::upper_bound_heuristic(params, 1500U)),
-                   static_cast<std::uint64_t>(
-                       curr_cost + P::upper_bound_heuristic(params, 10000U)),
-                   static_cast<std::uint64_t>(kInfeasible - 1U)})));
-          if (remaining_destinations_ == 0U) {
-            break;
-          }
-        }
-        if (l.cost() > early_termination_max_cost_) {
-          terminated_early_max_cost_ = true;
-          break;
+    if constexpr (EarlyTermination) {
+      if (std::find(begin(destinations_), end(destinations_), l.get_node()) !=
+          end(destinations_)) {
+        --remaining_destinations_;
+        auto const curr_cost = get_cost(l.get_node());
+        early_termination_max_cost_ = std::min(
+            early_termination_max_cost_,
+            static_cast<cost_t>(std::min(
+                {static_cast<std::uint64_t>(curr_cost) * 2 +
+                     static_cast<std::uint64_t>(
+                         P::upper_bound_heuristic(params, 1500U)),
+                 static_cast<std::uint64_t>(
+                     curr_cost + P::upper_bound_heuristic(params, 10000U)),
+                 static_cast<std::uint64_t>(kInfeasible - 1U)})));
+        if (remaining_destinations_ == 0U) {
+          return false;
         }
       }
-
-      if constexpr (kDebug) {
-        std::cout << "EXTRACT ";
-        l.get_node().print(std::cout, w);
-        std::cout << "\n";
+      if (l.cost() > early_termination_max_cost_) {
+        terminated_early_max_cost_ = true;
+        return false;
       }
+    }
 
-      auto const curr = l.get_node();
-      P::template adjacent<SearchDir, WithBlocked>(
-          params, r, curr, blocked, sharing, elevations,
-          [&](node const neighbor, std::uint32_t const cost, distance_t,
-              way_idx_t const way, std::uint16_t, std::uint16_t,
-              elevation_storage::elevation, bool const track) {
-            if constexpr (kDebug) {
-              std::cout << "  NEIGHBOR ";
-              neighbor.print(std::cout, w);
+    if constexpr (kDebug) {
+      std::cout << "EXTRACT ";
+      l.get_node().print(std::cout, w);
+      std::cout << "\n";
+    }
+
+    auto const curr = l.get_node();
+    stats_.adjacent();
+    P::template adjacent<SearchDir, WithBlocked>(
+        params, r, curr, blocked, sharing, elevations,
+        [&](node const neighbor, std::uint32_t const cost,
+            distance_t const dist, way_idx_t const way,
+            std::uint16_t const a_idx, std::uint16_t const b_idx,
+            elevation_storage::elevation const elevation, bool const track) {
+          if constexpr (kDebug) {
+            std::cout << "  NEIGHBOR ";
+            neighbor.print(std::cout, w);
+          }
+
+          auto const total = static_cast<std::uint64_t>(l.cost()) + cost;
+          if (total >= max) {
+            max_reached_ = true;
+            return;
+          }
+          if (cost_[neighbor.get_key()].update(
+                  l, neighbor, static_cast<cost_t>(total), curr)) {
+            auto next = label{neighbor, static_cast<cost_t>(total)};
+            next.track(l, r, way, neighbor.get_node(), track);
+            pq_.push(std::move(next));
+            stats_.pushed(cost_);
+            if (store_connections_) {
+              store_connection(neighbor,
+                               make_connecting_way(r, way, a_idx, b_idx,
+                                                   dist, elevation));
             }
 
-            auto const total = static_cast<std::uint64_t>(l.cost()) + cost;
-            if (total >= max) {
-              max_reached_ = true;
-              return;
+            if constexpr (kDebug) {
+              std::cout << " -> PUSH\n";
             }
-            if (cost_[neighbor.get_key()].update(
-                    l, neighbor, static_cast<cost_t>(total), curr)) {
-              auto next = label{neighbor, static_cast<cost_t>(total)};
-              next.track(l, r, way, neighbor.get_node(), track);
-              pq_.push(std::move(next));
-
-              if constexpr (kDebug) {
-                std::cout << " -> PUSH\n";
-              }
-            } else {
-              if constexpr (kDebug) {
-                std::cout << " -> DOMINATED\n";
-              }
+          } else {
+            stats_.dominated();
+            if constexpr (kDebug) {
+              std::cout << " -> DOMINATED\n";
             }
-          });
+          }
+        });
+    return true;
+  }
+
+  template <direction SearchDir, bool WithBlocked>
+  bool run(P::parameters const& params,
+           ways const& w,
+           ways::routing const& r,
+           cost_t const max,
+           bitvec<node_idx_t> const* blocked,
+           sharing_data const* sharing,
+           elevation_storage const* elevations) {
+    while (!pq_.empty()) {
+      if (cancel_() || !step<SearchDir, WithBlocked>(params, w, r, max,
+                                                     blocked, sharing,
+                                                     elevations)) {
+        break;
+      }
     }
+    stats_.finish(cost_);
     return !max_reached_;
   }
 
@@ -178,15 +229,49 @@ struct dijkstra {
     }
   }
 
+  void store_connection(node const n, connecting_way const& conn) {
+    auto const [it, inserted] =
+        connection_heads_.try_emplace(n.get_key(), kNoConnection);
+    for (auto i = it->second; i != kNoConnection; i = connections_[i].next_) {
+      if (connections_[i].n_ == n) {
+        connections_[i].way_ = conn;
+        return;
+      }
+    }
+    connections_.push_back({.n_ = n, .way_ = conn, .next_ = it->second});
+    it->second = static_cast<std::uint32_t>(connections_.size() - 1U);
+  }
+
   dial<label, get_bucket> pq_{get_bucket{}};
   ankerl::unordered_dense::map<key, entry, hash> cost_;
   bool max_reached_{};
 
+  // Opt-in (see set_store_connections() in route.h): remember the
+  // connecting way of every improving relaxation, so path reconstruction is
+  // a direct walk instead of enumerating the adjacency of every predecessor
+  // again. Records of the nodes of one key form a list through next_, so a
+  // push costs one record in a flat buffer (kept over reset()) and one map
+  // write of a fixed-size head index.
+  struct connection {
+    node n_;
+    connecting_way way_;
+    std::uint32_t next_;
+  };
+  static constexpr auto const kNoConnection =
+      std::numeric_limits<std::uint32_t>::max();
+
+  bool store_connections_{false};
+  ankerl::unordered_dense::map<key, std::uint32_t, hash> connection_heads_;
+  std::vector<connection> connections_;
+
   // for early termination
   std::vector<node> destinations_;
   std::size_t remaining_destinations_{0U};
   cost_t early_termination_max_cost_{kInfeasible};
   bool terminated_early_max_cost_{false};
+
+  [[no_unique_address]] search_stats_t<WithStats> stats_;
+  cancellation_check cancel_;
 };
 
 }  // namespace osr
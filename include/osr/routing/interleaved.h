@@ -0,0 +1,158 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "utl/zip.h"
+
+#include "osr/elevation_storage.h"
+#include "osr/routing/dijkstra.h"
+#include "osr/routing/profile.h"
+#include "osr/routing/sharing_data.h"
+#include "osr/types.h"
+#include "osr/util/prefetch.h"
+#include "osr/ways.h"
+
+namespace osr {
+
+// The graph data of an expansion is addressed level by level: the node gives
+// its ways and its positions in them (node_ways_, node_in_way_idx_), the
+// ways give the neighbors and distances (way_nodes_, way_node_dist_). A
+// level can only be requested once the level before it is loaded, so the
+// prefetch is split into stages which are issued one round apart. The cost
+// map is not prefetched: unordered_dense keeps its bucket array private and
+// finding the entry of a neighbor would be the (blocking) lookup itself.
+constexpr auto const kPrefetchStages = 4U;
+
+// Start of bucket i of a vecvec, without loading the bucket.
+auto bucket_data(auto const& vv, auto const i) {
+  return vv.data_.data() + vv.bucket_starts_[to_idx(i)];
+}
+
+// Requests the graph data of stage `stage` for the expansion of node n.
+// Additional nodes of sharing data have no graph data to prefetch.
+inline void prefetch_stage(ways::routing const& r,
+                           sharing_data const* sharing,
+                           node_idx_t const n,
+                           unsigned const stage) {
+  if (n == node_idx_t::invalid() ||
+      (sharing != nullptr && sharing->is_additional_node(n))) {
+    return;
+  }
+  switch (stage) {
+    case 0U:
+      prefetch(&r.node_properties_[n]);
+      prefetch(&r.node_ways_.bucket_starts_[to_idx(n)]);
+      prefetch(&r.node_in_way_idx_.bucket_starts_[to_idx(n)]);
+      break;
+
+    case 1U:
+      prefetch(bucket_data(r.node_ways_, n));
+      prefetch(bucket_data(r.node_in_way_idx_, n));
+      break;
+
+    case 2U:
+      for (auto const way : r.node_ways_[n]) {
+        prefetch(&r.way_properties_[way]);
+        prefetch(&r.way_nodes_.bucket_starts_[to_idx(way)]);
+        prefetch(&r.way_node_dist_.bucket_starts_[to_idx(way)]);
+      }
+      break;
+
+    case 3U:
+      for (auto const [way, i] :
+           utl::zip(r.node_ways_[n], r.node_in_way_idx_[n])) {
+        prefetch(bucket_data(r.way_nodes_, way) + i);
+        prefetch(bucket_data(r.way_node_dist_, way) + i);
+      }
+      break;
+
+    default: break;
+  }
+}
+
+// Node expanded by the next step of the search, if any.
+template <Profile P, bool EarlyTermination>
+node_idx_t next_node(dijkstra<P, EarlyTermination> const& d) {
+  if (d.pq_.empty()) {
+    return node_idx_t::invalid();
+  }
+  auto const& bucket = d.pq_.buckets_[d.pq_.get_next_bucket()];
+  return bucket.back().get_node().get_node();
+}
+
+// Runs independent one-to-all / one-to-many searches round-robin on the
+// calling thread: in every round, each search either issues the next
+// prefetch stage for the label it expands next or, once all stages are
+// issued, expands it. While one search waits for its cache misses, the
+// others do useful work.
+//
+// Every search has to be reset and have its start labels added before.
+// Results are the same as running each search on its own.
+template <direction SearchDir, bool WithBlocked, Profile P, bool ET>
+void run_interleaved(typename P::parameters const& params,
+                     ways const& w,
+                     ways::routing const& r,
+                     cost_t const max,
+                     bitvec<node_idx_t> const* blocked,
+                     sharing_data const* sharing,
+                     elevation_storage const* elevations,
+                     std::span<dijkstra<P, ET>> searches) {
+  auto active = searches.size();
+  auto done = std::vector<bool>(searches.size());
+  auto stage = std::vector<unsigned>(searches.size());
+  for (auto i = 0U; i != searches.size(); ++i) {
+    done[i] = searches[i].pq_.empty();
+    active -= done[i] ? 1U : 0U;
+  }
+
+  while (active != 0U) {
+    for (auto i = 0U; i != searches.size(); ++i) {
+      if (done[i]) {
+        continue;
+      }
+      auto& d = searches[i];
+      if (stage[i] != kPrefetchStages) {
+        prefetch_stage(r, sharing, next_node(d), stage[i]++);
+        continue;
+      }
+      stage[i] = 0U;
+      if (!d.template step<SearchDir, WithBlocked>(
+              params, w, r, max, blocked, sharing, elevations) ||
+          d.pq_.empty()) {
+        done[i] = true;
+        --active;
+        d.stats_.finish(d.cost_);
+        continue;
+      }
+      prefetch_stage(r, sharing, next_node(d), stage[i]++);
+    }
+  }
+}
+
+template <Profile P, bool ET>
+void run_interleaved(typename P::parameters const& params,
+                     ways const& w,
+                     ways::routing const& r,
+                     cost_t const max,
+                     bitvec<node_idx_t> const* blocked,
+                     sharing_data const* sharing,
+                     elevation_storage const* elevations,
+                     direction const dir,
+                     std::span<dijkstra<P, ET>> searches) {
+  if (blocked == nullptr) {
+    dir == direction::kForward
+        ? run_interleaved<direction::kForward, false>(
+              params, w, r, max, blocked, sharing, elevations, searches)
+        : run_interleaved<direction::kBackward, false>(
+              params, w, r, max, blocked, sharing, elevations, searches);
+  } else {
+    dir == direction::kForward
+        ? run_interleaved<direction::kForward, true>(
+              params, w, r, max, blocked, sharing, elevations, searches)
+        : run_interleaved<direction::kBackward, true>(
+              params, w, r, max, blocked, sharing, elevations, searches);
+  }
+}
+
+}  // namespace osr
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <span>
+
+#include "cista/mmap.h"
+
+#include "osr/routing/parameters.h"
+#include "osr/routing/profile.h"
+#include "osr/types.h"
+#include "osr/ways.h"
+
+namespace osr {
+
+// Landmark distance tables for ALT (A*, landmarks, triangle inequality) lower
+// bounds of one profile. Row n of from_ holds the cost from every landmark to
+// node n, row n of to_ the cost from node n to every landmark. Both are the
+// minimum over all labels of the node. spread_[n] is the largest difference
+// between the cheapest and the most expensive label of node n (over all
+// landmarks and both directions) and keeps the bounds admissible for profiles
+// where the labels of a node differ in cost (turn restrictions, u-turns).
+//
+// Costs are computed with the default parameters of the profile and without
+// elevation costs. A hash of the parameters is stored with the tables:
+// route() ignores the landmarks for queries with other parameters, which
+// could make edges cheaper (e.g. a higher walking speed).
+struct landmarks {
+  using lm_cost_t = std::uint16_t;
+
+  static constexpr auto const kMaxLandmarks = 16U;
+  static constexpr auto const kUnreachable =
+      std::numeric_limits<lm_cost_t>::max();
+
+  landmarks(std::filesystem::path const&,
+            search_profile,
+            cista::mmap::protection);
+
+  static std::unique_ptr<landmarks> try_open(std::filesystem::path const&,
+                                             search_profile);
+
+  std::size_t n_landmarks() const { return nodes_.size(); }
+
+  // True if the tables were computed with these parameters.
+  bool matches(profile_parameters const&) const;
+
+  bool has(node_idx_t const n) const {
+    return n != node_idx_t::invalid() && to_idx(n) < spread_.size();
+  }
+
+  std::span<lm_cost_t const> from(node_idx_t const n) const {
+    return {&from_[to_idx(n) * n_landmarks()], n_landmarks()};
+  }
+
+  std::span<lm_cost_t const> to(node_idx_t const n) const {
+    return {&to_[to_idx(n) * n_landmarks()], n_landmarks()};
+  }
+
+  lm_cost_t spread(node_idx_t const n) const { return spread_[to_idx(n)]; }
+
+  search_profile profile_;
+  mm_vec<std::uint64_t> params_hash_;  // one entry
+  mm_vec<node_idx_t> nodes_;
+  mm_vec<lm_cost_t> from_;
+  mm_vec<lm_cost_t> to_;
+  mm_vec<lm_cost_t> spread_;
+};
+
+// Selects up to n_landmarks landmarks (farthest-first) and writes the
+// distance tables of the given profile to the directory.
+void compute_landmarks(ways const&,
+                       search_profile,
+                       std::filesystem::path const&,
+                       unsigned n_landmarks = landmarks::kMaxLandmarks);
+
+// ALT lower bounds for a fixed set of source and target nodes (i.e. all
+// candidate nodes of the start and destination match). Sources and targets
+// have to be added before the first bound is requested.
+struct landmark_bounds {
+  void reset(landmarks const*, direction search_dir);
+
+  void add_source(node_idx_t);
+  void add_target(node_idx_t);
+
+  bool active() const { return lm_ != nullptr; }
+
+  // lower bound for the cost from n to the closest target
+  cost_t to_target(node_idx_t n) const;
+
+  // lower bound for the cost from the closest source to n
+  cost_t from_source(node_idx_t n) const;
+
+  std::span<landmarks::lm_cost_t const> get_from(node_idx_t) const;
+  std::span<landmarks::lm_cost_t const> get_to(node_idx_t) const;
+
+  landmarks const* lm_{nullptr};
+  bool backward_{false};
+  bool sources_unknown_{false};
+  bool targets_unknown_{false};
+  unsigned n_sources_{0U};
+  unsigned n_targets_{0U};
+  std::array<std::int32_t, landmarks::kMaxLandmarks> source_from_max_{};
+  std::array<std::int32_t, landmarks::kMaxLandmarks> source_to_min_{};
+  std::array<std::int32_t, landmarks::kMaxLandmarks> target_from_min_{};
+  std::array<std::int32_t, landmarks::kMaxLandmarks> target_to_max_{};
+};
+
+}  // namespace osr
@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <vector>
 
 #include "boost/json/fwd.hpp"
@@ -16,6 +17,8 @@
 
 namespace osr {
 
+struct cancellation_token;
+
 struct matched_route {
   path path_{};
   std::vector<std::size_t> segment_offsets_{};
@@ -26,6 +29,25 @@ struct matched_route {
   std::chrono::milliseconds total_duration_{0};
 };
 
+// Raw snapshot of the map matching state (matched points, per segment search
+// state, result). Only the search labels that show up in the debug output are
+// copied, not the whole cost maps. The JSON debug output is built on demand
+// by to_json() - possibly later or on another thread. A trace references the
+// ways and lookup it was recorded with and must not outlive them.
+struct map_match_trace {
+  map_match_trace() = default;
+  map_match_trace(map_match_trace const&) = delete;
+  map_match_trace& operator=(map_match_trace const&) = delete;
+  map_match_trace(map_match_trace&&) = delete;
+  map_match_trace& operator=(map_match_trace&&) = delete;
+  virtual ~map_match_trace() = default;
+
+  virtual boost::json::object to_json() const = 0;
+};
+
+using map_match_trace_fn =
+    std::function<void(std::shared_ptr<map_match_trace const>)>;
+
 matched_route map_match(
     ways const&,
     lookup const&,
@@ -36,6 +58,8 @@ matched_route map_match(
     elevation_storage const* = nullptr,
     std::function<void(matched_route const&,
                        std::function<boost::json::object()> const&)> const&
-        debug_fn = nullptr);
+        debug_fn = nullptr,
+    map_match_trace_fn const& trace_fn = nullptr,
+    cancellation_token const* cancel = nullptr);
 
 }  // namespace osr
@@ -73,6 +73,16 @@ struct segment_data {
   std::chrono::microseconds astar_duration_{};
 };
 
+// Everything map_match<P> builds up while matching. Kept in one heap
+// allocation: segment_data::sharing_ references additional_node_coordinates_
+// and segment_data::additional_edges_, so these must not move.
+template <Profile P>
+struct map_match_state {
+  std::vector<point_data<P>> pds_{};
+  std::vector<segment_data<P>> segments_{};
+  std::vector<geo::latlng> additional_node_coordinates_{};
+};
+
 struct node_ref {
   std::size_t matched_way_idx_{};
   direction dir_{};
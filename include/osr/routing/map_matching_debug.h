@@ -113,6 +113,13 @@ struct debug_route_segment {
   std::chrono::microseconds d_dijkstra_{};
 };
 
+// Nodes within 1500m of the segment start and end (on ways found by the
+// lookup) whose search labels are part of the debug output.
+hash_set<node_idx_t> get_debug_label_nodes(ways const&,
+                                           lookup const&,
+                                           geo::latlng const& from,
+                                           geo::latlng const& to);
+
 template <Profile P>
 boost::json::object build_map_match_debug_json(
     ways const& w,
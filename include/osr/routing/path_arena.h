@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "geo/latlng.h"
+
+#include "osr/elevation_storage.h"
+#include "osr/routing/mode.h"
+#include "osr/routing/path.h"
+#include "osr/types.h"
+
+namespace osr {
+
+// Segment of a path stored in a path_arena. Same fields as path::segment,
+// but the polyline is the range [points_begin_, points_end_) of the arena.
+struct arena_segment {
+  std::uint32_t points_begin_{0U};
+  std::uint32_t points_end_{0U};
+  level_t from_level_{kNoLevel};
+  level_t to_level_{kNoLevel};
+  node_idx_t from_{node_idx_t::invalid()};
+  node_idx_t to_{node_idx_t::invalid()};
+  way_idx_t way_{way_idx_t::invalid()};
+  cost_t cost_{kInfeasible};
+  distance_t dist_{0};
+  elevation_storage::elevation elevation_{};
+  mode mode_{mode::kFoot};
+};
+
+// Path whose segments are the range [segments_begin_, segments_end_) of a
+// path_arena. Without reconstruction, the range is empty.
+struct arena_path {
+  cost_t cost_{kInfeasible};
+  double dist_{0.0};
+  elevation_storage::elevation elevation_{};
+  std::uint32_t segments_begin_{0U};
+  std::uint32_t segments_end_{0U};
+  bool uses_elevator_{false};
+  node_idx_t track_node_{node_idx_t::invalid()};
+};
+
+// Storage for the segments and coordinates of many paths: one contiguous
+// buffer each instead of one vector per segment polyline. clear() keeps the
+// capacity, so a reused (e.g. thread-local) arena stops allocating once it
+// has grown to the working set.
+struct path_arena {
+  void clear() {
+    points_.clear();
+    segments_.clear();
+  }
+
+  std::span<arena_segment const> segments(arena_path const& p) const {
+    return {segments_.data() + p.segments_begin_,
+            segments_.data() + p.segments_end_};
+  }
+
+  std::span<geo::latlng const> polyline(arena_segment const& s) const {
+    return {points_.data() + s.points_begin_, points_.data() + s.points_end_};
+  }
+
+  // Appends a segment with the given polyline. points_begin_ and points_end_
+  // of the segment are overwritten.
+  void add_segment(std::span<geo::latlng const> polyline, arena_segment);
+
+  // Copies a path (with owned polylines) into the arena.
+  arena_path append(path const&);
+
+  // Materializes an arena path as path with owned polylines.
+  path to_path(arena_path const&) const;
+
+  std::vector<geo::latlng> points_;
+  std::vector<arena_segment> segments_;
+};
+
+path_arena& get_thread_local_path_arena();
+
+}  // namespace osr
@@ -12,7 +12,9 @@
 #include "geo/latlng.h"
 
 #include "osr/elevation_storage.h"
+#include "osr/routing/connecting_way.h"
 #include "osr/routing/path.h"
+#include "osr/routing/path_arena.h"
 #include "osr/routing/profile.h"
 #include "osr/routing/sharing_data.h"
 #include "osr/types.h"
@@ -22,17 +24,6 @@
 
 namespace osr {
 
-struct connecting_way {
-  constexpr bool valid() const noexcept { return way_ != way_idx_t::invalid(); }
-
-  way_idx_t way_{way_idx_t::invalid()};
-  std::uint16_t from_{};
-  std::uint16_t to_{};
-  bool is_loop_{};
-  distance_t distance_{};
-  elevation_storage::elevation elevation_{};
-};
-
 template <direction SearchDir, bool WithBlocked, Profile P>
 inline connecting_way find_connecting_way(typename P::parameters const& params,
                                           ways const& w,
@@ -51,10 +42,7 @@ inline connecting_way find_connecting_way(typename P::parameters const& params,
           std::uint16_t const b_idx,
           elevation_storage::elevation const elevation, bool) {
         if (target == to && cost == expected_cost) {
-          auto const is_loop = way != way_idx_t::invalid() && r.is_loop(way) &&
-                               static_cast<unsigned>(std::abs(a_idx - b_idx)) ==
-                                   r.way_nodes_[way].size() - 2U;
-          conn = {way, a_idx, b_idx, is_loop, dist, elevation};
+          conn = make_connecting_way(r, way, a_idx, b_idx, dist, elevation);
         }
       });
   utl::verify(
@@ -98,25 +86,30 @@ inline connecting_way find_connecting_way(typename P::parameters const& params,
   }
 }
 
-template <Profile P>
-inline double add_path(typename P::parameters const& params,
-                       ways const& w,
-                       ways::routing const& r,
-                       bitvec<node_idx_t> const* blocked,
-                       sharing_data const* sharing,
-                       elevation_storage const* elevations,
-                       typename P::node const from,
-                       typename P::node const to,
-                       cost_t const expected_cost,
-                       std::vector<path::segment>& path,
-                       direction const dir) {
+// Fills the segment from -> to. Segment is path::segment or arena_segment,
+// Polyline receives the coordinates via clear() and emplace_back().
+template <Profile P, typename Segment, typename Polyline>
+inline double write_segment(typename P::parameters const& params,
+                            ways const& w,
+                            ways::routing const& r,
+                            bitvec<node_idx_t> const* blocked,
+                            sharing_data const* sharing,
+                            elevation_storage const* elevations,
+                            typename P::node const from,
+                            typename P::node const to,
+                            cost_t const expected_cost,
+                            Segment& segment,
+                            Polyline& polyline,
+                            direction const dir,
+                            connecting_way const* known) {
   auto const& [way, from_idx, to_idx, is_loop, distance, elevation] =
-      find_connecting_way<P>(params, w, blocked, sharing, elevations, from, to,
-                             expected_cost, dir);
+      known != nullptr
+          ? *known
+          : find_connecting_way<P>(params, w, blocked, sharing, elevations,
+                                   from, to, expected_cost, dir);
 
   auto j = 0U;
   auto active = false;
-  auto& segment = path.emplace_back();
   segment.way_ = way;
   segment.dist_ = distance;
   segment.cost_ = expected_cost;
@@ -150,10 +143,10 @@ inline double add_path(typename P::parameters const& params,
       if (active) {
         if (w.node_to_osm_[r.way_nodes_[way][start_idx]] == osm_idx) {
           // Again "from" node, then it's shorter to start from here.
-          segment.polyline_.clear();
+          polyline.clear();
         }
 
-        segment.polyline_.emplace_back(coord);
+        polyline.emplace_back(coord);
         if (w.node_to_osm_[r.way_nodes_[way][end_idx]] == osm_idx) {
           break;
         }
@@ -175,11 +168,63 @@ inline double add_path(typename P::parameters const& params,
     segment.from_ =
         dir == direction::kBackward ? to.get_node() : from.get_node();
     segment.to_ = dir == direction::kBackward ? from.get_node() : to.get_node();
-    segment.polyline_ = {get_node_pos(segment.from_),
-                         get_node_pos(segment.to_)};
+    polyline.clear();
+    polyline.emplace_back(get_node_pos(segment.from_));
+    polyline.emplace_back(get_node_pos(segment.to_));
   }
 
   return distance;
 }
 
+template <Profile P>
+inline double add_path(typename P::parameters const& params,
+                       ways const& w,
+                       ways::routing const& r,
+                       bitvec<node_idx_t> const* blocked,
+                       sharing_data const* sharing,
+                       elevation_storage const* elevations,
+                       typename P::node const from,
+                       typename P::node const to,
+                       cost_t const expected_cost,
+                       std::vector<path::segment>& path,
+                       direction const dir,
+                       connecting_way const* known = nullptr) {
+  auto& segment = path.emplace_back();
+  return write_segment<P>(params, w, r, blocked, sharing, elevations, from, to,
+                          expected_cost, segment, segment.polyline_, dir,
+                          known);
+}
+
+// Appends the coordinates of the last segment to the arena buffer.
+struct arena_polyline {
+  void clear() { points_.resize(begin_); }
+  void emplace_back(geo::latlng const& x) { points_.push_back(x); }
+
+  std::vector<geo::latlng>& points_;
+  std::size_t begin_;
+};
+
+template <Profile P>
+inline double add_path(typename P::parameters const& params,
+                       ways const& w,
+                       ways::routing const& r,
+                       bitvec<node_idx_t> const* blocked,
+                       sharing_data const* sharing,
+                       elevation_storage const* elevations,
+                       typename P::node const from,
+                       typename P::node const to,
+                       cost_t const expected_cost,
+                       path_arena& arena,
+                       direction const dir,
+                       connecting_way const* known = nullptr) {
+  auto& segment = arena.segments_.emplace_back();
+  auto polyline = arena_polyline{arena.points_, arena.points_.size()};
+  segment.points_begin_ = static_cast<std::uint32_t>(polyline.begin_);
+  auto const dist =
+      write_segment<P>(params, w, r, blocked, sharing, elevations, from, to,
+                       expected_cost, segment, polyline, dir, known);
+  segment.points_end_ = static_cast<std::uint32_t>(arena.points_.size());
+  return dist;
+}
+
 }  // namespace osr
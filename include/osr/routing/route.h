@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <string_view>
 #include <vector>
 
@@ -12,6 +13,7 @@
 #include "osr/routing/mode.h"
 #include "osr/routing/parameters.h"
 #include "osr/routing/path.h"
+#include "osr/routing/path_arena.h"
 #include "osr/routing/profile.h"
 #include "osr/types.h"
 
@@ -19,20 +21,34 @@ namespace osr {
 
 struct ways;
 
-template <Profile, bool EarlyTermination>
+template <Profile, bool EarlyTermination, bool WithStats>
 struct dijkstra;
 
-template <Profile>
+template <Profile, bool WithStats>
 struct bidirectional;
 
 struct sharing_data;
 
+struct landmarks;
+
+struct search_stats;
+
+struct cancellation_token;
+
 template <Profile P>
-bidirectional<P>& get_bidirectional();
+bidirectional<P, false>& get_bidirectional();
 
 template <Profile P>
-dijkstra<P, false>& get_dijkstra();
+dijkstra<P, false, false>& get_dijkstra();
 
+// Enables (or disables) recording the connecting way of every relaxation in
+// the searches this thread runs. Path reconstruction then walks the
+// predecessors directly instead of enumerating their adjacency again, at the
+// cost of one record per improving relaxation.
+void set_store_connections(bool);
+
+// One-to-many search. With parallel, the one-to-all search runs on all
+// hardware threads (delta_stepping) instead of Dijkstra. Costs are the same.
 std::vector<std::optional<path>> route(
     profile_parameters const&,
     ways const&,
@@ -48,8 +64,35 @@ std::vector<std::optional<path>> route(
     elevation_storage const* = nullptr,
     std::function<bool(path const&)> const& do_reconstruct = [](path const&) {
       return false;
-    });
+    },
+    bool parallel = false);
+
+// Same as above, but the paths are written to the arena: contiguous segment
+// and coordinate buffers instead of one vector per segment polyline. The
+// arena is only appended to; clearing it is up to the caller.
+std::vector<std::optional<arena_path>> route(
+    profile_parameters const&,
+    ways const&,
+    lookup const&,
+    search_profile,
+    location const& from,
+    std::vector<location> const& to,
+    cost_t max,
+    direction,
+    double max_match_distance,
+    path_arena&,
+    bitvec<node_idx_t> const* blocked = nullptr,
+    sharing_data const* sharing = nullptr,
+    elevation_storage const* = nullptr,
+    std::function<bool(path const&)> const& do_reconstruct = [](path const&) {
+      return false;
+    },
+    bool parallel = false);
 
+// If stats is set, the search runs with statistics enabled and writes them
+// to *stats. If the cancellation token fires during the search,
+// search_cancelled is thrown. If the last argument is set, the time spent in
+// path reconstruction is added to it (also without statistics).
 std::optional<path> route(profile_parameters const&,
                           ways const&,
                           lookup const&,
@@ -62,7 +105,11 @@ std::optional<path> route(profile_parameters const&,
                           bitvec<node_idx_t> const* blocked = nullptr,
                           sharing_data const* sharing = nullptr,
                           elevation_storage const* = nullptr,
-                          routing_algorithm = routing_algorithm::kDijkstra);
+                          routing_algorithm = routing_algorithm::kDijkstra,
+                          landmarks const* = nullptr,
+                          search_stats* = nullptr,
+                          cancellation_token const* = nullptr,
+                          std::chrono::microseconds* = nullptr);
 
 std::vector<std::optional<path>> route(
     profile_parameters const&,
@@ -80,7 +127,8 @@ std::vector<std::optional<path>> route(
     elevation_storage const* = nullptr,
     std::function<bool(path const&)> const& do_reconstruct = [](path const&) {
       return false;
-    });
+    },
+    bool parallel = false);
 
 std::optional<path> route(profile_parameters const&,
                           ways const& w,
@@ -95,6 +143,10 @@ std::optional<path> route(profile_parameters const&,
                           bitvec<node_idx_t> const* blocked = nullptr,
                           sharing_data const* sharing = nullptr,
                           elevation_storage const* = nullptr,
-                          routing_algorithm = routing_algorithm::kDijkstra);
+                          routing_algorithm = routing_algorithm::kDijkstra,
+                          landmarks const* = nullptr,
+                          search_stats* = nullptr,
+                          cancellation_token const* = nullptr,
+                          std::chrono::microseconds* = nullptr);
 
 }  // namespace osr
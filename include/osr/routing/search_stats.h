@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <type_traits>
+
+namespace osr {
+
+// Counters of a single search. Engines instantiated with WithStats = true
+// record them, otherwise no_search_stats (all no-ops) is used instead.
+struct search_stats {
+  template <typename Dial>
+  auto pop(Dial& pq) {
+    auto const from = pq.current_bucket_;
+    auto l = pq.pop();
+    n_buckets_scanned_ += pq.current_bucket_ - from + 1U;
+    ++n_popped_;
+    return l;
+  }
+
+  template <typename CostMap>
+  void pushed(CostMap const& m) {
+    ++n_pushed_;
+    if (m.bucket_count() != bucket_count_) {
+      n_rehashes_ += bucket_count_ == 0U ? 0U : 1U;
+      bucket_count_ = m.bucket_count();
+    }
+  }
+
+  void dominated() { ++n_dominated_; }
+
+  void adjacent() { ++n_adjacent_calls_; }
+
+  template <typename CostMap>
+  void finish(CostMap const& m) {
+    cost_map_size_ = m.size();
+  }
+
+  void reconstructed(std::chrono::steady_clock::duration const d) {
+    reconstruct_time_ +=
+        std::chrono::duration_cast<std::chrono::microseconds>(d);
+  }
+
+  search_stats& operator+=(search_stats const& o) {
+    n_pushed_ += o.n_pushed_;
+    n_popped_ += o.n_popped_;
+    n_dominated_ += o.n_dominated_;
+    n_buckets_scanned_ += o.n_buckets_scanned_;
+    n_adjacent_calls_ += o.n_adjacent_calls_;
+    n_rehashes_ += o.n_rehashes_;
+    cost_map_size_ += o.cost_map_size_;
+    reconstruct_time_ += o.reconstruct_time_;
+    return *this;
+  }
+
+  std::uint64_t n_pushed_{0U};
+  std::uint64_t n_popped_{0U};
+  std::uint64_t n_dominated_{0U};
+  std::uint64_t n_buckets_scanned_{0U};
+  std::uint64_t n_adjacent_calls_{0U};
+  std::uint64_t n_rehashes_{0U};
+  std::uint64_t cost_map_size_{0U};
+  std::chrono::microseconds reconstruct_time_{0};
+  std::uint64_t bucket_count_{0U};
+};
+
+struct no_search_stats {
+  template <typename Dial>
+  auto pop(Dial& pq) {
+    return pq.pop();
+  }
+
+  template <typename CostMap>
+  void pushed(CostMap const&) {}
+
+  void dominated() {}
+
+  void adjacent() {}
+
+  template <typename CostMap>
+  void finish(CostMap const&) {}
+
+  void reconstructed(std::chrono::steady_clock::duration) {}
+
+  no_search_stats& operator+=(no_search_stats const&) { return *this; }
+};
+
+template <bool WithStats>
+using search_stats_t =
+    std::conditional_t<WithStats, search_stats, no_search_stats>;
+
+}  // namespace osr
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "geo/polyline.h"
+
+#include "osr/routing/path.h"
+
+namespace osr {
+
+// Douglas-Peucker simplification of a polyline. Points closer than
+// tolerance (meters) to the simplified line are removed, the first and the
+// last point are always kept.
+void simplify(geo::polyline&, double tolerance);
+
+// Simplifies every segment on its own, so segment boundaries (and with them
+// way changes, level changes and costs) are not touched.
+void simplify(path&, double tolerance);
+
+}  // namespace osr
@@ -1,36 +1,165 @@
 #pragma once
 
 #include <cinttypes>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <memory>
+
+#include "utl/verify.h"
 
 #include "osr/types.h"
 
 namespace osr {
 
+// Tracks for every id whether it was seen once or more than once.
+//
+// Bits are stored in pages of 2^16 ids which are allocated on first use, so
+// memory is proportional to the touched id ranges instead of the largest id.
+// Pages are found through a fixed two-level table (directories of 2^16 pages,
+// allocated on first use as well), so no table is ever resized and all
+// operations are lock-free and thread-safe. Ids are limited to 2^48.
 struct multi_counter {
-  using size_type = bitvec64::size_type;
+  using size_type = std::uint64_t;
+
+  static constexpr auto const kPageBits = 16U;
+  static constexpr auto const kDirBits = 16U;
+  static constexpr auto const kTopBits = 16U;
+  static constexpr auto const kPageSize = size_type{1U} << kPageBits;
+  static constexpr auto const kPagesPerDir = size_type{1U} << kDirBits;
+  static constexpr auto const kDirs = size_type{1U} << kTopBits;
+  static constexpr auto const kMaxSize = size_type{1U}
+                                         << (kPageBits + kDirBits + kTopBits);
+  static constexpr auto const kBlocksPerPage = kPageSize / 64U;
+
+  struct page {
+    std::array<std::atomic_uint64_t, kBlocksPerPage> once_{};
+    std::array<std::atomic_uint64_t, kBlocksPerPage> multi_{};
+  };
 
-  bool is_multi(size_type const i) const { return multi_[i]; }
+  struct dir {
+    ~dir() {
+      for (auto& p : pages_) {
+        delete p.load();
+      }
+    }
+
+    std::array<std::atomic<page*>, kPagesPerDir> pages_{};
+  };
+
+  multi_counter() : dirs_{std::make_unique<std::atomic<dir*>[]>(kDirs)} {}
+  multi_counter(multi_counter const&) = delete;
+  multi_counter& operator=(multi_counter const&) = delete;
+  multi_counter(multi_counter&&) = delete;
+  multi_counter& operator=(multi_counter&&) = delete;
+
+  ~multi_counter() {
+    for (auto i = size_type{0U}; i != kDirs; ++i) {
+      delete dirs_[i].load();
+    }
+  }
+
+  bool is_multi(size_type const i) const {
+    if (i >= kMaxSize) {
+      return false;
+    }
+    auto const* pg = find_page(i);
+    return pg != nullptr &&
+           (pg->multi_[block(i)].load(std::memory_order_relaxed) & bit(i)) !=
+               0U;
+  }
 
   void increment(size_type const i) {
-    once_.resize(std::max(once_.size(), i + 1U));
-    multi_.resize(std::max(multi_.size(), i + 1U));
-    if (once_[i]) {
-      if (!multi_[i]) {
-        multi_.set(i, true);
+    utl::verify(i < kMaxSize, "multi_counter: id {} out of range", i);
+    auto& pg = get_page(i);
+    auto const b = bit(i);
+    auto const before =
+        pg.once_[block(i)].fetch_or(b, std::memory_order_relaxed);
+    if ((before & b) != 0U &&
+        (pg.multi_[block(i)].load(std::memory_order_relaxed) & b) == 0U) {
+      pg.multi_[block(i)].fetch_or(b, std::memory_order_relaxed);
+    }
+
+    auto size = size_.load(std::memory_order_relaxed);
+    while (size < i + 1U &&
+           !size_.compare_exchange_weak(size, i + 1U,
+                                        std::memory_order_relaxed)) {
+    }
+  }
+
+  // Calls fn(id) for every id seen more than once, in ascending order.
+  template <typename Fn>
+  void for_each_multi(Fn&& fn) const {
+    for (auto d = size_type{0U}; d != kDirs; ++d) {
+      auto const* dr = dirs_[d].load(std::memory_order_acquire);
+      if (dr == nullptr) {
+        continue;
+      }
+      for (auto p = size_type{0U}; p != kPagesPerDir; ++p) {
+        auto const* pg = dr->pages_[p].load(std::memory_order_acquire);
+        if (pg == nullptr) {
+          continue;
+        }
+        auto const first = ((d << kDirBits) + p) << kPageBits;
+        for (auto b = size_type{0U}; b != kBlocksPerPage; ++b) {
+          auto bits = pg->multi_[b].load(std::memory_order_relaxed);
+          while (bits != 0U) {
+            auto const offset = static_cast<size_type>(std::countr_zero(bits));
+            fn(first + b * 64U + offset);
+            bits &= bits - 1U;
+          }
+        }
       }
-    } else {
-      once_.set(i, true);
     }
   }
 
-  size_type size() const noexcept { return once_.size(); }
+  // One past the largest id seen.
+  size_type size() const noexcept { return size_.load(); }
+
+private:
+  static constexpr size_type block(size_type const i) {
+    return (i & (kPageSize - 1U)) / 64U;
+  }
+
+  static constexpr std::uint64_t bit(size_type const i) {
+    return std::uint64_t{1U} << (i % 64U);
+  }
+
+  static constexpr size_type dir_idx(size_type const i) {
+    return i >> (kPageBits + kDirBits);
+  }
+
+  static constexpr size_type page_idx(size_type const i) {
+    return (i >> kPageBits) & (kPagesPerDir - 1U);
+  }
+
+  page const* find_page(size_type const i) const {
+    auto const* dr = dirs_[dir_idx(i)].load(std::memory_order_acquire);
+    return dr == nullptr
+               ? nullptr
+               : dr->pages_[page_idx(i)].load(std::memory_order_acquire);
+  }
+
+  // Returns the object in slot, allocating it if the slot is still empty.
+  template <typename T>
+  static T& get_or_create(std::atomic<T*>& slot) {
+    auto* x = slot.load(std::memory_order_acquire);
+    if (x == nullptr) {
+      auto fresh = std::make_unique<T>();
+      if (slot.compare_exchange_strong(x, fresh.get(),
+                                       std::memory_order_acq_rel)) {
+        x = fresh.release();
+      }
+    }
+    return *x;
+  }
 
-  void reserve(size_type const size) {
-    once_.blocks_.reserve(size / bitvec64::bits_per_block);
-    multi_.blocks_.reserve(size / bitvec64::bits_per_block);
+  page& get_page(size_type const i) {
+    return get_or_create(get_or_create(dirs_[dir_idx(i)]).pages_[page_idx(i)]);
   }
 
-  bitvec64 once_, multi_;
+  std::unique_ptr<std::atomic<dir*>[]> dirs_;
+  std::atomic<size_type> size_{0U};
 };
 
-}  // namespace osr
\ No newline at end of file
+}  // namespace osr
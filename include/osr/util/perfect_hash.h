@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cinttypes>
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+namespace osr {
+
+// Perfect hash map from a fixed set of strings to ids, built at compile time.
+//
+// The hash only looks at the length and the first, middle and last character,
+// multiplied by a seed that is searched at compile time so that all keys land
+// in different slots. A lookup is one multiplication, one table access and
+// one string comparison. Strings not in the set map to Id{}.
+template <typename Id, std::size_t N, unsigned Bits = 8U>
+struct perfect_hash_map {
+  static_assert(N < (1U << Bits) && N < 255U);
+
+  using entry_t = std::pair<std::string_view, Id>;
+
+  static constexpr auto const kSlots = std::size_t{1U} << Bits;
+  static constexpr auto const kMaxSeed = std::uint32_t{1U} << 20U;
+
+  consteval explicit perfect_hash_map(std::array<entry_t, N> const& entries)
+      : entries_{entries} {
+    for (auto seed = std::uint32_t{0x9E3779B1U}; seed < kMaxSeed + 0x9E3779B1U;
+         seed += 2U) {
+      if (try_seed(seed)) {
+        seed_ = seed;
+        return;
+      }
+    }
+    throw "perfect_hash_map: no collision-free seed";
+  }
+
+  constexpr Id find(std::string_view const s) const {
+    auto const i = slots_[slot(s, seed_)];
+    return i != 0U && entries_[i - 1U].first == s ? entries_[i - 1U].second
+                                                  : Id{};
+  }
+
+  static constexpr std::uint32_t features(std::string_view const s) {
+    if (s.empty()) {
+      return 0U;
+    }
+    auto const c = [&](std::size_t const i) {
+      return static_cast<std::uint32_t>(static_cast<unsigned char>(s[i]));
+    };
+    return static_cast<std::uint32_t>(s.size()) | (c(0U) << 8U) |
+           (c(s.size() / 2U) << 16U) | (c(s.size() - 1U) << 24U);
+  }
+
+  static constexpr std::size_t slot(std::string_view const s,
+                                    std::uint32_t const seed) {
+    auto const h = features(s) * seed;
+    return static_cast<std::size_t>((h ^ (h >> 15U)) >> (32U - Bits));
+  }
+
+  constexpr bool try_seed(std::uint32_t const seed) {
+    slots_ = {};
+    for (auto i = 0U; i != N; ++i) {
+      auto& s = slots_[slot(entries_[i].first, seed)];
+      if (s != 0U) {
+        return false;
+      }
+      s = static_cast<std::uint8_t>(i + 1U);
+    }
+    return true;
+  }
+
+  std::array<entry_t, N> entries_;
+  std::array<std::uint8_t, kSlots> slots_{};
+  std::uint32_t seed_{0U};
+};
+
+}  // namespace osr
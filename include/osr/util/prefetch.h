@@ -0,0 +1,20 @@
+#pragma once
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+namespace osr {
+
+// Hint to load the cache line containing p. Never faults.
+inline void prefetch(void const* p) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(p, 0, 3);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_prefetch(static_cast<char const*>(p), _MM_HINT_T0);
+#else
+  (void)p;
+#endif
+}
+
+}  // namespace osr
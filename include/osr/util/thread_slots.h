@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cinttypes>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace osr {
+
+// One Slot per thread and owner (e.g. a cache), created on first use and
+// released with the owner. A slot is only accessed by its thread. Every
+// thread remembers its slots of the last used owners in a small thread-local
+// table indexed by owner id, so threads alternating between a few owners
+// (e.g. the caches of several drivers) find their slots without locking.
+// Owner ids are never reused, so a pointer is only dereferenced while its
+// owner is alive.
+template <typename Slot>
+struct thread_slots {
+  Slot& get() {
+    thread_local auto recent = std::array<last_used, kRecentOwners>{};
+    auto& last = recent[id_ % kRecentOwners];
+    if (last.owner_id_ != id_) {
+      auto const lock = std::lock_guard{mutex_};
+      auto& s = slots_[std::this_thread::get_id()];
+      if (s == nullptr) {
+        s = std::make_unique<Slot>();
+      }
+      last = {.owner_id_ = id_, .slot_ = s.get()};
+    }
+    return *last.slot_;
+  }
+
+private:
+  static constexpr auto const kRecentOwners = 8U;
+
+  struct last_used {
+    std::uint64_t owner_id_{std::numeric_limits<std::uint64_t>::max()};
+    Slot* slot_{nullptr};
+  };
+
+  static inline auto next_id_ = std::atomic_uint64_t{0U};
+
+  std::uint64_t id_{next_id_.fetch_add(1U)};
+  std::mutex mutex_;
+  std::unordered_map<std::thread::id, std::unique_ptr<Slot>> slots_;
+};
+
+}  // namespace osr
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace osr {
+
+// Runs one task at a time on a thread that is started on first use and
+// joined by the destructor, so repeated parallel searches do not start a
+// thread per query. Exceptions of the task are rethrown by wait().
+struct worker_thread {
+  worker_thread() = default;
+  worker_thread(worker_thread const&) = delete;
+  worker_thread& operator=(worker_thread const&) = delete;
+  worker_thread(worker_thread&&) = delete;
+  worker_thread& operator=(worker_thread&&) = delete;
+
+  ~worker_thread() {
+    if (!thread_.joinable()) {
+      return;
+    }
+    {
+      auto const lock = std::scoped_lock{mutex_};
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  // Starts fn on the worker. Every start() has to be followed by wait().
+  void start(std::function<void()> fn) {
+    if (!thread_.joinable()) {
+      thread_ = std::thread{[this]() { loop(); }};
+    }
+    {
+      auto const lock = std::scoped_lock{mutex_};
+      task_ = std::move(fn);
+      done_ = false;
+    }
+    cv_.notify_all();
+  }
+
+  // Blocks until the task started last is finished.
+  void wait() {
+    auto lock = std::unique_lock{mutex_};
+    cv_.wait(lock, [&]() { return done_; });
+    if (error_ != nullptr) {
+      std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+  }
+
+private:
+  void loop() {
+    auto lock = std::unique_lock{mutex_};
+    while (true) {
+      cv_.wait(lock, [&]() { return stop_ || task_ != nullptr; });
+      if (task_ == nullptr) {
+        return;
+      }
+
+      auto task = std::exchange(task_, nullptr);
+      lock.unlock();
+      auto error = std::exception_ptr{};
+      try {
+        task();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      lock.lock();
+      error_ = std::move(error);
+      done_ = true;
+      cv_.notify_all();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::function<void()> task_;
+  std::exception_ptr error_;
+  bool done_{true};
+  bool stop_{false};
+  std::thread thread_;
+};
+
+}  // namespace osr
@@ -10,6 +10,7 @@
 #endif
 #include <filesystem>
 #include <ranges>
+#include <span>
 
 #include "fmt/ranges.h"
 #include "fmt/std.h"
@@ -27,6 +28,7 @@
 #include "utl/verify.h"
 #include "utl/zip.h"
 
+#include "osr/conditional_access.h"
 #include "osr/point.h"
 #include "osr/routing/turns.h"
 #include "osr/types.h"
@@ -201,9 +203,10 @@ struct ways {
   void compute_big_street_neighbors();
   void connect_ways();
   void compute_turn_bearings();
+  void update_turn_bearings(node_idx_t);
   void build_components();
 
-  std::optional<way_idx_t> find_way(osm_way_idx_t const i) {
+  std::optional<way_idx_t> find_way(osm_way_idx_t const i) const {
     auto const it = std::lower_bound(begin(way_osm_idx_), end(way_osm_idx_), i);
     return it != end(way_osm_idx_) && *it == i
                ? std::optional{way_idx_t{
@@ -249,6 +252,22 @@ struct ways {
 
   std::optional<std::string_view> get_access_restriction(way_idx_t) const;
 
+  // Compiles all conditional access restrictions to time rules, skipping
+  // ways whose restriction was removed. Restrictions that cannot be compiled
+  // stay available as string only.
+  void compile_conditional_access();
+
+  // Compiled time rules of a way (empty if it has none or they could not be
+  // compiled). The rules are sorted by way.
+  std::span<time_rule const> get_access_rules(way_idx_t) const;
+
+  // Ways blocked by a conditional access restriction at local time t.
+  bitvec<way_idx_t> get_blocked_ways(std::chrono::local_seconds t) const;
+
+  // Graph nodes of the ways blocked at local time t, usable as blocked mask
+  // for route(). Junctions with other ways are blocked as well.
+  bitvec<node_idx_t> get_blocked_nodes(std::chrono::local_seconds t) const;
+
   std::filesystem::path p_;
   cista::mmap::protection mode_;
 
@@ -387,6 +406,11 @@ struct ways {
 
   mm_bitvec<way_idx_t> way_has_conditional_access_no_;
   mm_vec<pair<way_idx_t, string_idx_t>> way_conditional_access_no_;
+  mm_vec<time_rule> way_conditional_access_rules_;
+
+  // Resolved turn restrictions with their relation, sorted by relation.
+  // Restrictions of changed relations are re-resolved by incremental updates.
+  mm_vec<pair<osm_rel_idx_t, resolved_restriction>> restriction_relations_;
 
   multi_counter node_way_counter_;
 };
@@ -0,0 +1,179 @@
+#include "osr/conditional_access.h"
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <utility>
+
+namespace osr {
+
+namespace {
+
+constexpr auto const kMonths =
+    std::array<std::string_view, 12U>{"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                      "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+constexpr auto const kWeekdays =
+    std::array<std::string_view, 7U>{"Mo", "Tu", "We", "Th", "Fr", "Sa", "Su"};
+constexpr auto const kAllMonths = std::uint16_t{(1U << 12U) - 1U};
+constexpr auto const kAllWeekdays = std::uint8_t{(1U << 7U) - 1U};
+constexpr auto const kMinutesPerDay = std::uint16_t{24U * 60U};
+
+using time_span = std::pair<std::uint16_t, std::uint16_t>;
+
+template <typename Fn>
+bool for_each_part(std::string_view s, char const sep, Fn&& fn) {
+  while (true) {
+    auto const pos = s.find(sep);
+    if (!fn(s.substr(0U, pos))) {
+      return false;
+    }
+    if (pos == std::string_view::npos) {
+      return true;
+    }
+    s.remove_prefix(pos + 1U);
+  }
+}
+
+std::string_view trim(std::string_view s) {
+  while (!s.empty() && s.front() == ' ') {
+    s.remove_prefix(1U);
+  }
+  while (!s.empty() && s.back() == ' ') {
+    s.remove_suffix(1U);
+  }
+  return s;
+}
+
+std::optional<unsigned> find_name(std::span<std::string_view const> names,
+                                  std::string_view const s) {
+  auto const it = std::find(begin(names), end(names), s);
+  return it == end(names)
+             ? std::nullopt
+             : std::optional{static_cast<unsigned>(it - begin(names))};
+}
+
+// "Mo-Fr,Su" -> bit mask. Ranges may wrap ("Fr-Mo", "Nov-Feb").
+std::optional<std::uint16_t> parse_mask(
+    std::span<std::string_view const> names, std::string_view const s) {
+  auto mask = 0U;
+  auto const ok = for_each_part(s, ',', [&](std::string_view const part) {
+    auto const dash = part.find('-');
+    auto const from = find_name(names, part.substr(0U, dash));
+    auto const to = dash == std::string_view::npos
+                        ? from
+                        : find_name(names, part.substr(dash + 1U));
+    if (!from.has_value() || !to.has_value()) {
+      return false;
+    }
+    for (auto i = *from;; i = (i + 1U) % names.size()) {
+      mask |= 1U << i;
+      if (i == *to) {
+        break;
+      }
+    }
+    return true;
+  });
+  return ok ? std::optional{static_cast<std::uint16_t>(mask)} : std::nullopt;
+}
+
+// "HH:MM" -> minutes of the day, "24:00" included.
+std::optional<std::uint16_t> parse_time(std::string_view const s) {
+  auto const is_digit = [](char const c) { return c >= '0' && c <= '9'; };
+  if (s.size() != 5U || s[2] != ':' || !is_digit(s[0]) || !is_digit(s[1]) ||
+      !is_digit(s[3]) || !is_digit(s[4])) {
+    return std::nullopt;
+  }
+  auto const h = (s[0] - '0') * 10 + (s[1] - '0');
+  auto const m = (s[3] - '0') * 10 + (s[4] - '0');
+  auto const minutes = h * 60 + m;
+  return m < 60 && minutes <= kMinutesPerDay
+             ? std::optional{static_cast<std::uint16_t>(minutes)}
+             : std::nullopt;
+}
+
+// "07:00-09:00,16:00-18:30" -> time spans.
+bool parse_times(std::string_view const s, std::vector<time_span>& spans) {
+  return for_each_part(s, ',', [&](std::string_view const part) {
+    auto const dash = part.find('-');
+    if (dash == std::string_view::npos) {
+      return false;
+    }
+    auto const from = parse_time(part.substr(0U, dash));
+    auto const to = parse_time(part.substr(dash + 1U));
+    if (!from.has_value() || !to.has_value() || *from == *to) {
+      return false;
+    }
+    spans.emplace_back(*from, *to);
+    return true;
+  });
+}
+
+}  // namespace
+
+bool time_rule::matches(std::chrono::local_seconds const t) const {
+  auto const in = [&](std::chrono::local_days const d) {
+    auto const month = unsigned{std::chrono::year_month_day{d}.month()} - 1U;
+    auto const weekday = std::chrono::weekday{d}.iso_encoding() - 1U;
+    return (months_ & (1U << month)) != 0U &&
+           (weekdays_ & (1U << weekday)) != 0U;
+  };
+
+  auto const day = std::chrono::floor<std::chrono::days>(t);
+  auto const minute = static_cast<std::uint16_t>(
+      std::chrono::floor<std::chrono::minutes>(t - day).count());
+  if (from_ <= to_) {
+    return minute >= from_ && minute < to_ && in(day);
+  }
+  return (minute >= from_ && in(day)) ||
+         (minute < to_ && in(day - std::chrono::days{1}));
+}
+
+std::optional<std::vector<time_rule>> compile_conditional_access(
+    std::string_view const condition, way_idx_t const way) {
+  auto rules = std::vector<time_rule>{};
+  auto const ok = for_each_part(condition, ';', [&](std::string_view rule) {
+    rule = trim(rule);
+    if (rule.empty()) {
+      return true;
+    }
+
+    auto months = std::optional<std::uint16_t>{};
+    auto weekdays = std::optional<std::uint16_t>{};
+    auto spans = std::vector<time_span>{};
+    auto const valid = for_each_part(rule, ' ', [&](std::string_view const x) {
+      if (x.empty() || x == "24/7") {
+        return true;
+      } else if (x.front() >= '0' && x.front() <= '9') {
+        return spans.empty() && parse_times(x, spans);
+      } else if (auto const w = parse_mask(kWeekdays, x); w.has_value()) {
+        weekdays = weekdays.value_or(0U) | *w;
+        return true;
+      } else if (auto const m = parse_mask(kMonths, x); m.has_value()) {
+        months = months.value_or(0U) | *m;
+        return true;
+      }
+      return false;
+    });
+    if (!valid) {
+      return false;
+    }
+
+    if (spans.empty()) {
+      spans.emplace_back(0U, kMinutesPerDay);
+    }
+    for (auto const& [from, to] : spans) {
+      rules.push_back(
+          {.way_ = way,
+           .months_ = months.value_or(kAllMonths),
+           .weekdays_ = static_cast<std::uint8_t>(
+               weekdays.value_or(kAllWeekdays)),
+           .from_ = from,
+           .to_ = to});
+    }
+    return true;
+  });
+  return ok && !rules.empty() ? std::optional{std::move(rules)}
+                             : std::nullopt;
+}
+
+}  // namespace osr
@@ -3,16 +3,29 @@
 #include <algorithm>
 #include <array>
 #include <execution>
+#include <fstream>
 #include <mutex>
+#include <optional>
 #include <ranges>
+#include <span>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "fmt/std.h"
+
+#include "geo/box.h"
 
 #include "utl/enumerate.h"
+#include "utl/helpers/algorithm.h"
 #include "utl/pairwise.h"
 #include "utl/parallel_for.h"
 #include "utl/progress_tracker.h"
 #include "utl/raii.h"
+#include "utl/verify.h"
 
+#include "cista/hash.h"
 #include "cista/strong.h"
 
 #include "osr/point.h"
@@ -28,8 +41,14 @@ namespace osr {
 namespace elevation_files {
 constexpr auto const kDataName = "elevation_data.bin";
 constexpr auto const kIndexName = "elevation_idx.bin";
+constexpr auto const kCheckpointName = "elevation_checkpoint.txt";
+constexpr auto const kMappingName = "elevation_mapping.bin";
+constexpr auto const kUnorderedDataName = "elevation_unordered_data.bin";
+constexpr auto const kUnorderedIndexName = "elevation_unordered_idx.bin";
 };  // namespace elevation_files
 
+constexpr auto const kElevationCheckpointVersion = std::uint32_t{1U};
+
 using path_vec = std::vector<fs::path>;
 using sort_idx_t = cista::strong<std::uint32_t, struct sort_idx_>;
 using node_point_map = mm_vec_map<node_idx_t, point>;
@@ -81,66 +100,86 @@ elevation_storage::elevation get_way_elevation(ev::provider const& provider,
                                                point const from,
                                                point const to,
                                                ev::resolution const& res) {
+  // TODO Approximation only for short ways
+  // Use slightly larger value to not skip intermediate values
+  constexpr auto const kSafetyFactor = 1.000001;
+  constexpr auto const kMaxSegmentSamples = 1024.;
+  // map longitude in [-360, 360] to [-180, 180]
+  auto const adjust_lng = [](double const x) {
+    if (x < -180.) {
+      return x + 360.;
+    } else if (x <= 180.) {
+      return x;
+    } else {
+      return x - 360.;
+    }
+  };
+
+  // Without elevations at both ends, the samples in between are not used.
   auto elevation = elevation_storage::elevation{};
   auto a = provider.get(from);
   auto const b = provider.get(to);
-  if (a != ev::elevation_meters_t::invalid() &&
-      b != ev::elevation_meters_t::invalid()) {
-    // TODO Approximation only for short ways
-    // Use slightly larger value to not skip intermediate values
-    constexpr auto const kSafetyFactor = 1.000001;
-    // map longitude in [-360, 360] to [-180, 180]
-    auto const adjust_lng = [](double const x) {
-      if (x < -180.) {
-        return x + 360.;
-      } else if (x <= 180.) {
-        return x;
+  if (a == ev::elevation_meters_t::invalid() ||
+      b == ev::elevation_meters_t::invalid()) {
+    return elevation;
+  }
+
+  // Sample all positions between the ends with one provider call.
+  thread_local auto samples = std::vector<geo::latlng>{};
+  thread_local auto meters = std::vector<ev::elevation_meters_t>{};
+  auto const from_lat = from.lat();
+  auto const from_lng = from.lng();
+  auto const min_lng_diff = adjust_lng(to.lng() - from_lng);
+  auto const lat_diff = to.lat() - from_lat;
+  // Long segments are sampled coarser, drivers with overviews then read a
+  // matching lower resolution level instead of full resolution blocks.
+  auto const steps = static_cast<int>(std::min(
+      kMaxSegmentSamples,
+      std::max(std::ceil(kSafetyFactor * std::abs(lat_diff) / res.y_),
+               std::ceil(kSafetyFactor * std::abs(min_lng_diff) / res.x_))));
+  samples.clear();
+  meters.clear();
+  if (steps > 1) {
+    auto const way_dir =
+        ev::resolution{.x_ = min_lng_diff / steps, .y_ = lat_diff / steps};
+    for (auto s = 1; s < steps; ++s) {
+      samples.push_back(
+          {from_lat + s * way_dir.y_, adjust_lng(from_lng + s * way_dir.x_)});
+    }
+    auto const spacing =
+        std::max(std::abs(min_lng_diff), std::abs(lat_diff)) / steps;
+    meters.resize(samples.size());
+    provider.get(samples, meters,
+                 ev::resolution{.x_ = spacing, .y_ = spacing});
+  }
+
+  for (auto const m : meters) {
+    if (m != ev::elevation_meters_t::invalid()) {
+      if (a < m) {
+        elevation.up_ +=
+            static_cast<cista::base_t<elevation_monotonic_t>>(to_idx(m - a));
       } else {
-        return x - 360.;
+        elevation.down_ +=
+            static_cast<cista::base_t<elevation_monotonic_t>>(to_idx(a - m));
       }
-    };
-    auto const from_lat = from.lat();
-    auto const from_lng = from.lng();
-    auto const min_lng_diff = adjust_lng(to.lng() - from_lng);
-    auto const lat_diff = to.lat() - from_lat;
-    auto const steps = static_cast<int>(
-        std::max(std::ceil(kSafetyFactor * std::abs(lat_diff) / res.y_),
-                 std::ceil(kSafetyFactor * std::abs(min_lng_diff) / res.x_)));
-    if (steps > 1) {
-      auto const way_dir =
-          ev::resolution{.x_ = min_lng_diff / steps, .y_ = lat_diff / steps};
-      for (auto s = 1; s < steps; ++s) {
-        auto const m = provider.get(
-            {from_lat + s * way_dir.y_, adjust_lng(from_lng + s * way_dir.x_)});
-        if (m != ev::elevation_meters_t::invalid()) {
-          if (a < m) {
-            elevation.up_ += static_cast<cista::base_t<elevation_monotonic_t>>(
-                to_idx(m - a));
-          } else {
-            elevation.down_ +=
-                static_cast<cista::base_t<elevation_monotonic_t>>(
-                    to_idx(a - m));
-          }
-          a = m;
-        }
-      }
-    }
-    if (a < b) {
-      elevation.up_ +=
-          static_cast<cista::base_t<elevation_monotonic_t>>(to_idx(b - a));
-    } else {
-      elevation.down_ +=
-          static_cast<cista::base_t<elevation_monotonic_t>>(to_idx(a - b));
+      a = m;
     }
   }
+  if (a < b) {
+    elevation.up_ +=
+        static_cast<cista::base_t<elevation_monotonic_t>>(to_idx(b - a));
+  } else {
+    elevation.down_ +=
+        static_cast<cista::base_t<elevation_monotonic_t>>(to_idx(a - b));
+  }
   return elevation;
 }
 
 node_point_map calculate_points(path_vec& paths,
+                                fs::path const& dir,
                                 ways const& w,
                                 utl::progress_tracker_ptr& pt) {
-  auto const& path =
-      paths.emplace_back(fs::temp_directory_path() / "temp_osr_extract_points");
+  auto const& path = paths.emplace_back(dir / "temp_osr_extract_points");
   auto points = node_point_map{mm(path, cista::mmap::protection::WRITE)};
 
   auto const size = w.n_nodes();
@@ -160,13 +199,16 @@ node_point_map calculate_points(path_vec& paths,
   return points;
 }
 
+// Ways to compute, sorted by tile (ties by way index, so the order is the
+// same in every run over the same input).
 way_ordering_vec calculate_way_order(path_vec& paths,
+                                     fs::path const& dir,
                                      ways const& w,
                                      node_point_map const& points,
                                      ev::provider const& provider,
+                                     bitvec<way_idx_t> const* affected,
                                      utl::progress_tracker_ptr& pt) {
-  auto const& path = paths.emplace_back(fs::temp_directory_path() /
-                                        "temp_osr_extract_way_ordering");
+  auto const& path = paths.emplace_back(dir / "temp_osr_extract_way_ordering");
   auto ordering = mm_vec<way_ordering_t>{mm(path, kWriteMode)};
 
   auto const size = w.n_ways();
@@ -174,7 +216,8 @@ way_ordering_vec calculate_way_order(path_vec& paths,
   pt->in_high(size);
 
   for (auto const [way_idx, way] : utl::enumerate(w.r_->way_nodes_)) {
-    if (!way.empty()) {
+    if (!way.empty() &&
+        (affected == nullptr || affected->test(way_idx_t{way_idx}))) {
       auto const node_point = points[way.front()];
       auto const tile_idx = provider.tile_idx(node_point);
       if (tile_idx != ev::tile_idx_t::invalid()) {
@@ -190,36 +233,75 @@ way_ordering_vec calculate_way_order(path_vec& paths,
 #endif
       begin(ordering), end(ordering),
       [](way_ordering_t const& a, way_ordering_t const& b) {
-        return a.order_ < b.order_;
+        return std::tie(a.order_, a.way_idx_) < std::tie(b.order_, b.way_idx_);
       });
 
   return ordering;
 }
 
+encoding_result_t open_encoding_result(fs::path const& mapping_path,
+                                       fs::path const& encoding_data_path,
+                                       fs::path const& encoding_idx_path,
+                                       cista::mmap::protection const mode) {
+  return encoding_result_t{
+      .mappings_ = mm_vec<mapping_t>{mm(mapping_path, mode)},
+      .encodings_ =
+          mm_vecvec<sort_idx_t, elevation_storage::encoding>{
+              mm_vec<elevation_storage::encoding>{
+                  mm(encoding_data_path, mode)},
+              mm_vec<cista::base_t<sort_idx_t>>{mm(encoding_idx_path, mode)}},
+  };
+}
+
+void encode_way(ways const& w,
+                ev::provider const& provider,
+                node_point_map const& points,
+                ev::resolution const& res,
+                way_idx_t const way_idx,
+                encoding_result_t& result,
+                std::mutex& m) {
+  thread_local auto elevations = std::vector<elevation_storage::encoding>{};
+
+  // Calculate elevations
+  elevations.clear();
+  auto elevations_idx = std::size_t{0U};
+  for (auto const [from, to] : utl::pairwise(w.r_->way_nodes_[way_idx])) {
+    auto const elevation = elevation_storage::encoding{
+        get_way_elevation(provider, points[from], points[to], res)};
+    if (elevation) {
+      elevations.resize(elevations_idx);
+      elevations.push_back(elevation);
+    }
+    ++elevations_idx;
+  }
+
+  // Store elevations unordered
+  if (!elevations.empty()) {
+    auto const lock = std::lock_guard{m};
+    result.mappings_.emplace_back(way_idx,
+                                  sort_idx_t{result.encodings_.size()});
+    result.encodings_.emplace_back(elevations);
+  }
+}
+
 encoding_result_t calculate_way_encodings(
     path_vec& paths,
+    fs::path const& dir,
     ways const& w,
     ev::provider const& provider,
     mm_vec<way_ordering_t> const& ordering,
     node_point_map const& points,
     utl::progress_tracker_ptr& pt) {
   paths.reserve(paths.size() + 3U);
-  auto const& mapping_path = paths.emplace_back(fs::temp_directory_path() /
-                                                "temp_osr_extract_mapping");
-  auto const& encoding_data_path = paths.emplace_back(
-      fs::temp_directory_path() / "temp_osr_extract_unordered_encoding_data");
-  auto const& encoding_idx_path = paths.emplace_back(
-      fs::temp_directory_path() / "temp_osr_extract_unordered_encoding_idx");
-
-  auto result = encoding_result_t{
-      .mappings_ = mm_vec<mapping_t>{mm(mapping_path, kWriteMode)},
-      .encodings_ =
-          mm_vecvec<sort_idx_t, elevation_storage::encoding>{
-              mm_vec<elevation_storage::encoding>{
-                  mm(encoding_data_path, kWriteMode)},
-              mm_vec<cista::base_t<sort_idx_t>>{
-                  mm(encoding_idx_path, kWriteMode)}},
-  };
+  auto const& mapping_path =
+      paths.emplace_back(dir / "temp_osr_extract_mapping");
+  auto const& encoding_data_path =
+      paths.emplace_back(dir / "temp_osr_extract_unordered_encoding_data");
+  auto const& encoding_idx_path =
+      paths.emplace_back(dir / "temp_osr_extract_unordered_encoding_idx");
+
+  auto result = open_encoding_result(mapping_path, encoding_data_path,
+                                     encoding_idx_path, kWriteMode);
   result.mappings_.reserve(ordering.size());
 
   auto const res = provider.max_resolution();
@@ -230,40 +312,135 @@ encoding_result_t calculate_way_encodings(
   utl::parallel_for(
       ordering,
       [&](way_ordering_t const way_ordering) {
-        thread_local auto elevations =
-            std::vector<elevation_storage::encoding>{};
-
-        auto const& way_idx = way_ordering.way_idx_;
-
-        // Calculate elevations
-        elevations.clear();
-        auto elevations_idx = std::size_t{0U};
-        for (auto const [from, to] : utl::pairwise(w.r_->way_nodes_[way_idx])) {
-          auto const elevation = elevation_storage::encoding{
-              get_way_elevation(provider, points[from], points[to], res)};
-          if (elevation) {
-            elevations.resize(elevations_idx);
-            elevations.push_back(elevation);
-          }
-          ++elevations_idx;
-        }
-
-        // Store elevations unordered
-        if (!elevations.empty()) {
-          auto const lock = std::lock_guard{m};
-          result.mappings_.emplace_back(way_idx,
-                                        sort_idx_t{result.encodings_.size()});
-          result.encodings_.emplace_back(elevations);
-        }
+        encode_way(w, provider, points, res, way_ordering.way_idx_, result, m);
       },
       pt->update_fn());
 
   return result;
 }
 
+// Identifies the input of a resumable run: data set, elevation source and
+// the ways to compute in their processing order.
+std::uint64_t encoding_fingerprint(ways const& w,
+                                   ev::provider const& provider,
+                                   mm_vec<way_ordering_t> const& ordering) {
+  auto h = cista::BASE_HASH;
+  auto const add = [&](auto const& x) {
+    h = cista::hash(
+        std::string_view{reinterpret_cast<char const*>(&x), sizeof(x)}, h);
+  };
+  add(kElevationCheckpointVersion);
+  add(w.n_ways());
+  add(w.n_nodes());
+  add(w.r_->way_nodes_.data_.size());
+  auto const res = provider.max_resolution();
+  add(res.x_);
+  add(res.y_);
+  add(provider.driver_count());
+  for (auto const& b : provider.tile_boxes()) {
+    add(b.min_.lat_);
+    add(b.min_.lng_);
+    add(b.max_.lat_);
+    add(b.max_.lng_);
+  }
+  static_assert(sizeof(way_ordering_t) ==
+                sizeof(way_idx_t) + sizeof(ev::tile_idx_t));
+  return cista::hash(
+      std::string_view{reinterpret_cast<char const*>(ordering.data()),
+                       ordering.size() * sizeof(way_ordering_t)},
+      h);
+}
+
+// Like calculate_way_encodings, but processes the ordering in chunks and
+// stores a checkpoint after every chunk. Intermediate files are kept in dir
+// and reused by the next call if the checkpoint exists and was written for
+// the same input. Returns nothing if max_chunks chunks were computed before
+// all ways were done.
+std::optional<encoding_result_t> calculate_way_encodings_resumable(
+    fs::path const& dir,
+    ways const& w,
+    ev::provider const& provider,
+    mm_vec<way_ordering_t> const& ordering,
+    node_point_map const& points,
+    std::size_t const chunk_size,
+    std::size_t const max_chunks,
+    utl::progress_tracker_ptr& pt) {
+  auto const checkpoint_path = dir / elevation_files::kCheckpointName;
+  auto const fingerprint = encoding_fingerprint(w, provider, ordering);
+
+  auto done = std::size_t{0U};
+  auto n_mappings = std::size_t{0U};
+  auto resume = false;
+  if (fs::exists(checkpoint_path)) {
+    auto f = std::ifstream{checkpoint_path};
+    auto checkpoint_fingerprint = std::uint64_t{0U};
+    f >> checkpoint_fingerprint >> done >> n_mappings;
+    resume = f && checkpoint_fingerprint == fingerprint;
+    if (!resume) {
+      fmt::println("ignoring elevation checkpoint {} of a different input",
+                   checkpoint_path);
+      done = 0U;
+      n_mappings = 0U;
+    }
+  }
+
+  auto result = open_encoding_result(
+      dir / elevation_files::kMappingName,
+      dir / elevation_files::kUnorderedDataName,
+      dir / elevation_files::kUnorderedIndexName,
+      resume ? cista::mmap::protection::MODIFY : kWriteMode);
+
+  if (resume) {
+    utl::verify(done <= ordering.size() &&
+                    n_mappings <= result.mappings_.size() &&
+                    n_mappings <= result.encodings_.size(),
+                "invalid elevation checkpoint {}", checkpoint_path);
+
+    // Drop results computed after the checkpoint.
+    result.mappings_.resize(n_mappings);
+    auto& e = result.encodings_;
+    e.bucket_starts_.resize(n_mappings == 0U ? 0U : n_mappings + 1U);
+    e.data_.resize(n_mappings == 0U ? 0U : e.bucket_starts_[n_mappings]);
+  }
+
+  auto const res = provider.max_resolution();
+  auto m = std::mutex{};
+
+  pt->in_high(ordering.size());
+  auto n_chunks = std::size_t{0U};
+  for (auto start = done; start < ordering.size(); start += chunk_size) {
+    if (n_chunks++ == max_chunks) {
+      return std::nullopt;
+    }
+
+    auto const n = std::min(chunk_size, ordering.size() - start);
+    utl::parallel_for_run(n, [&](std::size_t const i) {
+      encode_way(w, provider, points, res, ordering[start + i].way_idx_,
+                 result, m);
+      pt->update_monotonic(start + i);
+    });
+
+    result.mappings_.mmap_.sync();
+    result.encodings_.data_.mmap_.sync();
+    result.encodings_.bucket_starts_.mmap_.sync();
+
+    auto const tmp_path = fs::path{checkpoint_path.string() + ".tmp"};
+    {
+      auto f = std::ofstream{tmp_path};
+      f << fingerprint << ' ' << (start + n) << ' '
+        << result.mappings_.size() << '\n';
+    }
+    fs::rename(tmp_path, checkpoint_path);
+  }
+
+  return result;
+}
+
 void write_ordered_encodings(elevation_storage& storage,
                              encoding_result_t&& result,
-                             utl::progress_tracker_ptr& pt) {
+                             utl::progress_tracker_ptr& pt,
+                             elevation_storage const* previous = nullptr,
+                             bitvec<way_idx_t> const* affected = nullptr) {
   std::sort(
 #if __cpp_lib_execution
       std::execution::par_unseq,
@@ -273,16 +450,64 @@ void write_ordered_encodings(elevation_storage& storage,
         return a.way_idx_ < b.way_idx_;
       });
 
-  pt->in_high(result.mappings_.size());
-
-  for (auto const& mapping : result.mappings_) {
-    storage.elevations_.resize(to_idx(mapping.way_idx_) + 1U);
+  auto const copy = [&](way_idx_t const way, auto&& encodings) {
+    storage.elevations_.resize(to_idx(way) + 1U);
     auto bucket = storage.elevations_.back();
-    for (auto const e : result.encodings_[mapping.sort_idx_]) {
+    for (auto const e : encodings) {
       bucket.push_back(e);
     }
+  };
+
+  if (previous == nullptr) {
+    pt->in_high(result.mappings_.size());
+    for (auto const& mapping : result.mappings_) {
+      copy(mapping.way_idx_, result.encodings_[mapping.sort_idx_]);
+      pt->increment();
+    }
+    return;
+  }
+
+  // Merge with the previous elevations of ways that were not recomputed.
+  auto n_ways = static_cast<way_idx_t::value_t>(previous->elevations_.size());
+  if (!result.mappings_.empty()) {
+    n_ways = std::max(n_ways, to_idx(result.mappings_.back().way_idx_) + 1U);
+  }
+  pt->in_high(n_ways);
+  auto it = begin(result.mappings_);
+  for (auto way = way_idx_t{0U}; way != n_ways; ++way) {
+    if (it != end(result.mappings_) && it->way_idx_ == way) {
+      copy(way, result.encodings_[it->sort_idx_]);
+      ++it;
+    } else if (way < previous->elevations_.size() &&
+               !previous->elevations_[way].empty() &&
+               (affected == nullptr || !affected->test(way))) {
+      copy(way, previous->elevations_[way]);
+    }
+    pt->increment();
+  }
+}
+
+// Ways with a polyline bounding box that overlaps one of the boxes.
+bitvec<way_idx_t> find_affected_ways(ways const& w,
+                                     std::span<geo::box const> boxes,
+                                     utl::progress_tracker_ptr& pt) {
+  auto affected = bitvec<way_idx_t>{};
+  affected.resize(w.n_ways());
+  pt->in_high(w.n_ways());
+  for (auto way = way_idx_t{0U}; way != w.n_ways(); ++way) {
+    auto bbox = geo::box{};
+    for (auto const& p : w.way_polylines_[way]) {
+      bbox.extend(p);
+    }
+    affected.set(way, utl::any_of(boxes, [&](geo::box const& b) {
+                   return bbox.min_.lat_ <= b.max_.lat_ &&
+                          b.min_.lat_ <= bbox.max_.lat_ &&
+                          bbox.min_.lng_ <= b.max_.lng_ &&
+                          b.min_.lng_ <= bbox.max_.lng_;
+                 }));
     pt->increment();
   }
+  return affected;
 }
 
 void elevation_storage::set_elevations(ways const& w,
@@ -295,18 +520,80 @@ void elevation_storage::set_elevations(ways const& w,
     }
   });
 
+  auto const tmp = fs::temp_directory_path();
   pt->status("Precalculating way points").out_bounds(75, 77);
-  auto const points = calculate_points(cleanup_paths.get(), w, pt);
+  auto const points = calculate_points(cleanup_paths.get(), tmp, w, pt);
   pt->status("Calculating way order").out_bounds(77, 81);
-  auto const processing_order =
-      calculate_way_order(cleanup_paths.get(), w, points, provider, pt);
+  auto const processing_order = calculate_way_order(
+      cleanup_paths.get(), tmp, w, points, provider, nullptr, pt);
   pt->status("Calculating way elevations").out_bounds(81, 89);
   auto unordered_encodings = calculate_way_encodings(
-      cleanup_paths.get(), w, provider, processing_order, points, pt);
+      cleanup_paths.get(), tmp, w, provider, processing_order, points, pt);
   pt->status("Storing ordered elevations").out_bounds(89, 90);
   write_ordered_encodings(*this, std::move(unordered_encodings), pt);
 }
 
+bool compute_elevations(ways const& w,
+                        ev::provider const& provider,
+                        fs::path const& dir,
+                        fs::path const& work_dir,
+                        std::span<geo::box const> changed,
+                        std::size_t const chunk_size,
+                        std::size_t const max_chunks) {
+  utl::verify(chunk_size != 0U, "compute_elevations: chunk_size is zero");
+
+  auto pt = utl::get_active_progress_tracker_or_activate("osr");
+  auto cleanup_paths = utl::make_raii(path_vec{}, [](path_vec const& paths) {
+    auto e = std::error_code{};
+    for (auto const& path : paths) {
+      fs::remove(path, e);
+    }
+  });
+
+  fs::create_directories(work_dir);
+
+  auto previous = changed.empty() ? nullptr : elevation_storage::try_open(dir);
+  auto affected = std::optional<bitvec<way_idx_t>>{};
+  if (previous != nullptr) {
+    pt->status("Finding ways in changed tiles").out_bounds(0, 5);
+    affected = find_affected_ways(w, changed, pt);
+  }
+
+  pt->status("Precalculating way points").out_bounds(5, 10);
+  auto const points = calculate_points(cleanup_paths.get(), work_dir, w, pt);
+  pt->status("Calculating way order").out_bounds(10, 20);
+  auto const processing_order = calculate_way_order(
+      cleanup_paths.get(), work_dir, w, points, provider,
+      affected.has_value() ? &*affected : nullptr, pt);
+  pt->status("Calculating way elevations").out_bounds(20, 90);
+  {
+    auto unordered_encodings = calculate_way_encodings_resumable(
+        work_dir, w, provider, processing_order, points, chunk_size,
+        max_chunks, pt);
+    if (!unordered_encodings.has_value()) {
+      return false;
+    }
+    pt->status("Storing ordered elevations").out_bounds(90, 100);
+    auto storage = elevation_storage{work_dir, kWriteMode};
+    write_ordered_encodings(storage, std::move(*unordered_encodings), pt,
+                            previous.get(),
+                            affected.has_value() ? &*affected : nullptr);
+  }
+  previous.reset();
+
+  for (auto const& name :
+       {elevation_files::kDataName, elevation_files::kIndexName}) {
+    fs::rename(work_dir / name, dir / name);
+  }
+  for (auto const& name :
+       {elevation_files::kCheckpointName, elevation_files::kMappingName,
+        elevation_files::kUnorderedDataName,
+        elevation_files::kUnorderedIndexName}) {
+    cleanup_paths.get().emplace_back(work_dir / name);
+  }
+  return true;
+}
+
 elevation_storage::elevation elevation_storage::get_elevations(
     way_idx_t const way, std::uint16_t const segment) const {
   return (way < elevations_.size() && segment < elevations_[way].size())
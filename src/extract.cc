@@ -6,8 +6,6 @@
 
 #include "osr/extract/extract.h"
 
-#include "boost/thread/tss.hpp"
-
 #include "fmt/core.h"
 #include "fmt/std.h"
 
@@ -15,6 +13,7 @@
 
 #include "osmium/area/assembler.hpp"
 #include "osmium/area/multipolygon_manager.hpp"
+#include "osmium/builder/osm_object_builder.hpp"
 #include "osmium/handler/node_locations_for_ways.hpp"
 #include "osmium/index/map/flex_mem.hpp"
 #include "osmium/io/pbf_input.hpp"
@@ -24,11 +23,14 @@
 #include "utl/helpers/algorithm.h"
 #include "utl/parser/arg_parser.h"
 #include "utl/progress_tracker.h"
+#include "utl/raii.h"
+#include "utl/zip.h"
 
 #include "tiles/osm/hybrid_node_idx.h"
 #include "tiles/osm/tmp_file.h"
 
 #include "osr/elevation_storage.h"
+#include "osr/extract/properties.h"
 #include "osr/extract/tags.h"
 #include "osr/lookup.h"
 #include "osr/platforms.h"
@@ -128,8 +130,8 @@ std::tuple<level_t, level_t, bool> get_levels(tags const& t) {
   return get_levels(t.has_level_, t.level_bits_);
 }
 
-way_properties get_way_properties(
-    tags const& t, osm_obj_type const obj_type = osm_obj_type::kWay) {
+way_properties get_way_properties(tags const& t,
+                                  osm_obj_type const obj_type) {
   auto const [from, to, _] = get_levels(t);
   auto p = way_properties{};
   std::memset(&p, 0, sizeof(way_properties));
@@ -340,208 +342,267 @@ struct way_handler : public osm::handler::Handler {
   hash_map<osm_node_idx_t, level_bits_t>& elevator_nodes_;
 };
 
-struct node_handler : public osm::handler::Handler {
-  struct cache {
-    void clear() {
-      from_.clear();
-      to_.clear();
-    }
-    std::vector<way_idx_t> from_, to_;
-  };
+// Node data needed after the way pass. It is collected during the
+// coordinates pass, so the input does not have to be decoded a third time.
+// Nodes whose tags change the node properties and nodes which are made graph
+// nodes by their own tags (which may not be part of any way) are kept in a
+// temporary memory mapped file. All other graph nodes get the default
+// properties and their position from the way geometry.
+struct cached_node {
+  osm_node_idx_t osm_idx_;
+  point pos_;
+  node_properties p_;
+  level_bits_t level_bits_;
+};
 
-  node_handler(ways& w,
-               platforms* platforms,
-               std::vector<resolved_restriction>& r,
-               hash_map<osm_node_idx_t, level_bits_t> const& elevator_nodes)
-      : platforms_{platforms}, r_{r}, w_{w}, elevator_nodes_{elevator_nodes} {
-    w_.r_->node_properties_.resize(w_.n_nodes());
-    w_.r_->node_positions_.resize(w_.n_nodes());
-  }
+struct node_cache {
+  static constexpr auto const kInitialBufferSize = std::size_t{1024U * 1024U};
 
-  void node(osm::Node const& n) {
-    auto const osm_node_idx = osm_node_idx_t{n.id()};
-    if (auto const node_idx = w_.find_node_idx(osm_node_idx);
-        node_idx.has_value()) {
-      auto const t = tags{n};
-      auto const [p, level_bits] = get_node_properties(t);
-      w_.r_->node_properties_[*node_idx] = p;
-      w_.r_->node_positions_[*node_idx] = point::from_location(n.location());
-
-      if (platforms_ != nullptr && t.is_platform()) {
-        auto const l = std::lock_guard{platforms_mutex_};
-        platforms_->node(*node_idx, n);
-      }
+  explicit node_cache(fs::path const& p)
+      : nodes_{cista::mmap{p.generic_string().c_str(),
+                           cista::mmap::protection::WRITE}} {}
 
-      if (p.is_elevator() && p.is_multi_level()) {
-        auto const l = std::scoped_lock{multi_level_elevators_mutex_};
-        w_.r_->multi_level_elevators_.emplace_back(*node_idx, level_bits);
-      } else if (auto const it = elevator_nodes_.find(osm_node_idx);
-                 it != end(elevator_nodes_)) {
-        auto const [from, to, is_multi] = get_levels(true, it->second);
-        auto& x = w_.r_->node_properties_[*node_idx];
-        x.is_elevator_ = true;
-        x.from_level_ = to_idx(from);
-        x.to_level_ = to_idx(to);
-        x.is_multi_level_ = is_multi;
-        if (is_multi) {
-          auto const l = std::scoped_lock{multi_level_elevators_mutex_};
-          w_.r_->multi_level_elevators_.emplace_back(*node_idx, it->second);
-        }
-      }
-    }
+  mm_vec<cached_node> nodes_;
+  osm_mem::Buffer platform_nodes_{kInitialBufferSize,
+                                  osm_mem::Buffer::auto_grow::yes};
+  osm_mem::Buffer restrictions_{kInitialBufferSize,
+                                osm_mem::Buffer::auto_grow::yes};
+};
+
+node_properties get_untagged_node_properties() {
+  auto buf = osm_mem::Buffer{1024U, osm_mem::Buffer::auto_grow::yes};
+  {
+    auto const builder = osm::builder::NodeBuilder{buf};
   }
+  buf.commit();
+  return get_node_properties(tags{buf.get<osm::Node>(0U)}).first;
+}
 
-  void relation(osm::Relation const& r) {
-    static auto c = boost::thread_specific_ptr<cache>{};
-    if (c.get() == nullptr) {
-      c.reset(new cache{});
-    }
-    c->clear();
+void resolve_restriction(ways const& w,
+                         osm::Relation const& r,
+                         std::vector<resolved_restriction>& out) {
+  auto const type = r.tags()["type"];
+  if (type == nullptr || type != "restriction"sv) {
+    return;
+  }
 
-    auto const type = r.tags()["type"];
-    if (type == nullptr || type != "restriction"sv) {
-      return;
-    }
+  auto const restriction_ptr = r.tags()["restriction"];
+  if (restriction_ptr == nullptr) {
+    return;
+  }
 
-    auto const restriction_ptr = r.tags()["restriction"];
-    if (restriction_ptr == nullptr) {
-      return;
-    }
+  auto const restriction_sv = std::string_view{restriction_ptr};
+  auto restriction_type = resolved_restriction::type::kNo;
+  if (restriction_sv.starts_with("no")) {
+    restriction_type = resolved_restriction::type::kNo;
+  } else if (restriction_sv.starts_with("only")) {
+    restriction_type = resolved_restriction::type::kOnly;
+  } else {
+    return;
+  }
 
-    auto const restriction_sv = std::string_view{restriction_ptr};
-    auto restriction_type = resolved_restriction::type::kNo;
-    if (restriction_sv.starts_with("no")) {
-      restriction_type = resolved_restriction::type::kNo;
-    } else if (restriction_sv.starts_with("only")) {
-      restriction_type = resolved_restriction::type::kOnly;
-    } else {
-      return;
+  auto applies_to_bus = true;
+  if (auto const except_ptr = r.tags()["except"]; except_ptr != nullptr) {
+    auto val = std::string_view{except_ptr};
+    while (!val.empty()) {
+      auto const sep = val.find(';');
+      auto const token =
+          sep == std::string_view::npos ? val : val.substr(0, sep);
+      if (token == "bus"sv || token == "psv"sv) {
+        applies_to_bus = false;
+        break;
+      }
+      val.remove_prefix(sep == std::string_view::npos ? val.size() : sep + 1U);
     }
+  }
 
-    auto applies_to_bus = true;
-    if (auto const except_ptr = r.tags()["except"]; except_ptr != nullptr) {
-      auto val = std::string_view{except_ptr};
-      while (!val.empty()) {
-        auto const sep = val.find(';');
-        auto const token =
-            sep == std::string_view::npos ? val : val.substr(0, sep);
-        if (token == "bus"sv || token == "psv"sv) {
-          applies_to_bus = false;
-          break;
+  auto via = node_idx_t::invalid();
+  auto from = std::vector<way_idx_t>{};
+  auto to = std::vector<way_idx_t>{};
+  for (auto const& m : r.members()) {
+    switch (cista::hash(std::string_view{m.role()})) {
+      case cista::hash("to"): {
+        auto const x = w.find_way(osm_way_idx_t{m.positive_ref()});
+        if (x.has_value()) {
+          to.emplace_back(*x);
         }
-        val.remove_prefix(sep == std::string_view::npos ? val.size()
-                                                        : sep + 1U);
+        break;
       }
-    }
 
-    auto via = node_idx_t::invalid();
-    for (auto const& m : r.members()) {
-      switch (cista::hash(std::string_view{m.role()})) {
-        case cista::hash("to"): {
-          auto const to = w_.find_way(osm_way_idx_t{m.positive_ref()});
-          if (to.has_value()) {
-            c->to_.emplace_back(*to);
-          }
-          break;
+      case cista::hash("from"): {
+        auto const x = w.find_way(osm_way_idx_t{m.positive_ref()});
+        if (x.has_value()) {
+          from.emplace_back(*x);
         }
+        break;
+      }
 
-        case cista::hash("from"): {
-          auto const from = w_.find_way(osm_way_idx_t{m.positive_ref()});
-          if (from.has_value()) {
-            c->from_.emplace_back(*from);
+      case cista::hash("via"):
+        if (m.type() == osmium::item_type::node) {
+          auto const v = w.find_node_idx(osm_node_idx_t{m.positive_ref()});
+          if (v.has_value()) {
+            via = *v;
           }
-          break;
         }
-
-        case cista::hash("via"):
-          if (m.type() == osmium::item_type::node) {
-            auto const v = w_.find_node_idx(osm_node_idx_t{m.positive_ref()});
-            if (v.has_value()) {
-              via = *v;
-            }
-          }
-          break;
-      }
+        break;
     }
+  }
 
-    if (via == node_idx_t::invalid() || c->from_.empty() || c->to_.empty()) {
-      return;
-    }
+  if (via == node_idx_t::invalid() || from.empty() || to.empty()) {
+    return;
+  }
 
-    auto const l = std::scoped_lock{r_mutex_};
-    for (auto const& from : c->from_) {
-      for (auto const& to : c->to_) {
-        r_.emplace_back(resolved_restriction{restriction_type, from, to, via,
-                                             applies_to_bus});
-      }
+  for (auto const& f : from) {
+    for (auto const& t : to) {
+      out.emplace_back(
+          resolved_restriction{restriction_type, f, t, via, applies_to_bus});
     }
   }
+}
 
-  std::mutex platforms_mutex_;
-  platforms* platforms_;
-
-  std::mutex multi_level_elevators_mutex_;
+struct restriction_handler : public osm::handler::Handler {
+  restriction_handler(ways& w, std::vector<resolved_restriction>& r)
+      : w_{w}, r_{r} {}
 
-  std::vector<resolved_restriction>& r_;
-  std::mutex r_mutex_;
+  void relation(osm::Relation const& r) {
+    auto const first = r_.size();
+    resolve_restriction(w_, r, r_);
+    for (auto i = first; i != r_.size(); ++i) {
+      w_.restriction_relations_.push_back(
+          {osm_rel_idx_t{r.positive_id()}, r_[i]});
+    }
+  }
 
   ways& w_;
+  std::vector<resolved_restriction>& r_;
+};
 
-  hash_map<osm_node_idx_t, level_bits_t> const& elevator_nodes_;
+// Results of the coordinates pass for one buffer. Tags are evaluated (and
+// node way counters incremented) in parallel, the node index, relation ways
+// and the node cache are updated in input order.
+struct coordinates_batch {
+  osm_mem::Buffer buf_;
+  std::vector<std::pair<osm::Relation const*, way_properties>> rel_ways_;
+  std::vector<cached_node> nodes_;
+  std::vector<osm::Node const*> platform_nodes_;
+  std::vector<osm::Relation const*> restrictions_;
 };
 
-struct mark_inaccessible_handler : public osm::handler::Handler {
-  explicit mark_inaccessible_handler(bool track_platforms, ways& w)
-      : track_platforms_{track_platforms}, w_{w} {}
+struct node_tags_handler : public osm::handler::Handler {
+  node_tags_handler(bool const track_platforms,
+                    node_properties const& untagged,
+                    multi_counter& node_way_counter,
+                    coordinates_batch& batch)
+      : track_platforms_{track_platforms},
+        untagged_{untagged},
+        node_way_counter_{node_way_counter},
+        batch_{batch} {}
 
   void node(osm::Node const& n) {
     auto const t = tags{n};
-    auto const accessible =
-        is_accessible<car_profile>(t, osm_obj_type::kNode) &&
-        is_accessible<bike_profile>(t, osm_obj_type::kNode) &&
-        is_accessible<foot_profile>(t, osm_obj_type::kNode);
-    if (!accessible || t.is_elevator_ || t.is_platform()) {
-      w_.node_way_counter_.increment(n.positive_id());
+    auto const counted = is_graph_node(t);
+    if (counted) {
+      node_way_counter_.increment(n.positive_id());
     }
 
     if (track_platforms_ && t.is_platform()) {
-      // Wnsure nodes are created even if they are not part of a routable way.
-      w_.node_way_counter_.increment(n.positive_id());
+      // Ensure nodes are created even if they are not part of a routable way.
+      node_way_counter_.increment(n.positive_id());
+      batch_.platform_nodes_.push_back(&n);
+    }
+
+    if (!counted && n.tags().empty()) {
+      return;
+    }
+    auto const [p, level_bits] = get_node_properties(t);
+    if (counted || level_bits != 0U ||
+        std::memcmp(&p, &untagged_, sizeof(node_properties)) != 0) {
+      batch_.nodes_.push_back({.osm_idx_ = osm_node_idx_t{n.id()},
+                               .pos_ = point::from_location(n.location()),
+                               .p_ = p,
+                               .level_bits_ = level_bits});
     }
   }
 
   bool track_platforms_;
-  ways& w_;
+  node_properties untagged_;
+  multi_counter& node_way_counter_;
+  coordinates_batch& batch_;
 };
 
 struct rel_ways_handler : public osm::handler::Handler {
-  explicit rel_ways_handler(platforms* pl, rel_ways_t& rel_ways)
-      : pl_{pl}, rel_ways_{rel_ways} {}
+  explicit rel_ways_handler(coordinates_batch& batch) : batch_{batch} {}
 
   void relation(osm::Relation const& r) {
+    if (auto const type = r.tags()["type"];
+        type != nullptr && type == "restriction"sv) {
+      batch_.restrictions_.push_back(&r);
+    }
+
     auto const p = get_way_properties(tags{r}, osm_obj_type::kRelation);
     if (!p.is_accessible() && !p.in_route()) {
       return;
     }
+    batch_.rel_ways_.emplace_back(&r, p);
+  }
 
-    auto const platform = p.is_platform_ && pl_ != nullptr
-                              ? pl_->relation(r)
-                              : platform_idx_t::invalid();
+  coordinates_batch& batch_;
+};
 
-    for (auto const& m : r.members()) {
-      if (m.type() == osm::item_type::way) {
-        auto rw = rel_ways_.emplace(osm_way_idx_t{m.positive_ref()},
-                                    rel_way{p, platform});
-        if (!rw.second) {
-          rw.first->second.p_.in_route_ |= p.in_route_;
-        }
+void add_rel_ways(platforms* pl,
+                  rel_ways_t& rel_ways,
+                  osm::Relation const& r,
+                  way_properties const& p) {
+  auto const platform = p.is_platform_ && pl != nullptr
+                            ? pl->relation(r)
+                            : platform_idx_t::invalid();
+
+  for (auto const& m : r.members()) {
+    if (m.type() == osm::item_type::way) {
+      auto rw = rel_ways.emplace(osm_way_idx_t{m.positive_ref()},
+                                 rel_way{p, platform});
+      if (!rw.second) {
+        rw.first->second.p_.in_route_ |= p.in_route_;
       }
     }
   }
+}
 
-  platforms* pl_;
-  rel_ways_t& rel_ways_;
-};
+// Reads all buffers, runs `parallel` (buffer -> batch) on multiple threads
+// and `serial` (batch -> void) in input order.
+template <typename Batch, typename ProgressTracker, typename Parallel,
+          typename Serial>
+void parallel_apply(osm_io::Reader& reader,
+                    ProgressTracker& pt,
+                    Parallel&& parallel,
+                    Serial&& serial) {
+  oneapi::tbb::parallel_pipeline(
+      std::thread::hardware_concurrency() * 4U,
+      oneapi::tbb::make_filter<void, osm_mem::Buffer>(
+          oneapi::tbb::filter_mode::serial_in_order,
+          [&](oneapi::tbb::flow_control& fc) {
+            auto buf = reader.read();
+            pt->update(reader.offset());
+            if (!buf) {
+              fc.stop();
+            }
+            return buf;
+          }) &
+          oneapi::tbb::make_filter<osm_mem::Buffer, Batch>(
+              oneapi::tbb::filter_mode::parallel, parallel) &
+          oneapi::tbb::make_filter<Batch, void>(
+              oneapi::tbb::filter_mode::serial_in_order, serial));
+}
+
+// Shows the duration of a finished extract phase as progress status.
+template <typename ProgressTracker>
+void report_duration(ProgressTracker& pt,
+                     std::string_view phase,
+                     std::chrono::steady_clock::time_point const start) {
+  auto const duration = std::chrono::duration<double>{
+      std::chrono::steady_clock::now() - start};
+  pt->status(fmt::format("{} done [{:.1f}s]", phase, duration.count()));
+}
 
 void extract(bool const with_platforms,
              fs::path const& in,
@@ -580,79 +641,161 @@ void extract(bool const with_platforms,
     pl = std::make_unique<platforms>(out, cista::mmap::protection::WRITE);
   }
 
-  w.node_way_counter_.reserve(12000000000);
+  auto const node_cache_path = out / "tmp_node_cache.bin";
+  auto const remove_node_cache =
+      utl::make_raii(fs::path{node_cache_path}, [](fs::path const& p) {
+        auto e = std::error_code{};
+        fs::remove(p, e);
+      });
+  auto cache = std::make_optional<node_cache>(node_cache_path);
+
   {  // Collect node coordinates.
+    auto const start = std::chrono::steady_clock::now();
     pt->status("Load OSM / Coordinates").in_high(file_size).out_bounds(0, 15);
 
     auto node_idx_builder = tiles::hybrid_node_idx_builder{node_idx};
+    auto const untagged = get_untagged_node_properties();
 
-    auto inaccessible_handler = mark_inaccessible_handler{pl != nullptr, w};
-    auto rel_ways_h = rel_ways_handler{pl.get(), rel_ways};
     auto reader = osm_io::Reader{input_file, osm_eb::node | osm_eb::relation,
                                  osmium::io::read_meta::no};
-    while (auto buffer = reader.read()) {
-      pt->update(reader.offset());
-      osm::apply(buffer, node_idx_builder, inaccessible_handler, rel_ways_h);
-    }
+    parallel_apply<coordinates_batch>(
+        reader, pt,
+        [&](osm_mem::Buffer&& buf) {
+          auto batch = coordinates_batch{.buf_ = std::move(buf)};
+          auto node_tags_h = node_tags_handler{pl != nullptr, untagged,
+                                               w.node_way_counter_, batch};
+          auto rel_ways_h = rel_ways_handler{batch};
+          osm::apply(batch.buf_, node_tags_h, rel_ways_h);
+          return batch;
+        },
+        [&](coordinates_batch&& batch) {
+          osm::apply(batch.buf_, node_idx_builder);
+          for (auto const& [r, p] : batch.rel_ways_) {
+            add_rel_ways(pl.get(), rel_ways, *r, p);
+          }
+          for (auto const& n : batch.nodes_) {
+            cache->nodes_.push_back(n);
+          }
+          for (auto const* n : batch.platform_nodes_) {
+            cache->platform_nodes_.add_item(*n);
+            cache->platform_nodes_.commit();
+          }
+          for (auto const* r : batch.restrictions_) {
+            cache->restrictions_.add_item(*r);
+            cache->restrictions_.commit();
+          }
+        });
     reader.close();
     node_idx_builder.finish();
+    report_duration(pt, "Load OSM / Coordinates", start);
   }
 
   auto elevator_nodes = hash_map<osm_node_idx_t, level_bits_t>{};
   {  // Extract streets, places, and areas.
+    auto const start = std::chrono::steady_clock::now();
     pt->status("Load OSM / Ways").in_high(file_size).out_bounds(15, 40);
 
     auto h = way_handler{w, pl.get(), rel_ways, elevator_nodes};
     auto reader =
         osm_io::Reader{input_file, osm_eb::way, osmium::io::read_meta::no};
 
-    oneapi::tbb::parallel_pipeline(
-        std::thread::hardware_concurrency() * 4U,
-        oneapi::tbb::make_filter<void, osm_mem::Buffer>(
-            oneapi::tbb::filter_mode::serial_in_order,
-            [&](oneapi::tbb::flow_control& fc) {
-              auto buf = reader.read();
-              pt->update(reader.offset());
-              if (!buf) {
-                fc.stop();
-              }
-              return buf;
-            }) &
-            oneapi::tbb::make_filter<osm_mem::Buffer, osm_mem::Buffer>(
-                oneapi::tbb::filter_mode::parallel,
-                [&](osm_mem::Buffer&& buf) {
-                  update_locations(node_idx, buf);
-                  return std::move(buf);
-                }) &
-            oneapi::tbb::make_filter<osm_mem::Buffer, void>(
-                oneapi::tbb::filter_mode::serial_in_order,
-                [&](osm_mem::Buffer&& buf) { osm::apply(buf, h); }));
+    parallel_apply<osm_mem::Buffer>(
+        reader, pt,
+        [&](osm_mem::Buffer&& buf) {
+          update_locations(node_idx, buf);
+          return std::move(buf);
+        },
+        [&](osm_mem::Buffer&& buf) { osm::apply(buf, h); });
 
     pt->update(pt->in_high_);
     reader.close();
+    report_duration(pt, "Load OSM / Ways", start);
   }
 
+  w.compile_conditional_access();
   w.r_->write(out);
   w.sync();
 
-  w.connect_ways();
-  w.build_components();
+  {
+    auto const start = std::chrono::steady_clock::now();
+    w.connect_ways();
+    w.build_components();
+    report_duration(pt, "Build graph", start);
+  }
 
   auto r = std::vector<resolved_restriction>{};
-  {
-    pt->status("Load OSM / Node Properties")
-        .in_high(file_size)
+  {  // Node properties, elevators, platforms and restrictions from the cache.
+    auto const start = std::chrono::steady_clock::now();
+    pt->status("Node Properties")
+        .in_high(cache->nodes_.size())
         .out_bounds(90, 95);
-    auto reader = osm_io::Reader{input_file, osm_eb::node | osm_eb::relation,
-                                 osmium::io::read_meta::no};
-    auto h = node_handler{w, pl.get(), r, elevator_nodes};
-    while (auto b = reader.read()) {
-      pt->update(reader.offset());
-      osm::apply(b, h);
+
+    auto& node_properties = w.r_->node_properties_;
+    auto& node_positions = w.r_->node_positions_;
+    node_properties.resize(w.n_nodes());
+    node_positions.resize(w.n_nodes());
+    std::fill(begin(node_properties), end(node_properties),
+              get_untagged_node_properties());
+    for (auto const [osm_nodes, polyline] :
+         utl::zip(w.way_osm_nodes_, w.way_polylines_)) {
+      for (auto const [osm_node_idx, pos] : utl::zip(osm_nodes, polyline)) {
+        if (w.node_way_counter_.is_multi(to_idx(osm_node_idx))) {
+          node_positions[w.get_node_idx(osm_node_idx)] = pos;
+        }
+      }
     }
 
-    reader.close();
+    for (auto const [i, n] : utl::enumerate(cache->nodes_)) {
+      pt->update(i);
+      auto const node_idx = w.find_node_idx(n.osm_idx_);
+      if (!node_idx.has_value()) {
+        continue;
+      }
+      node_properties[*node_idx] = n.p_;
+      node_positions[*node_idx] = n.pos_;
+      if (n.p_.is_elevator() && n.p_.is_multi_level()) {
+        w.r_->multi_level_elevators_.emplace_back(*node_idx, n.level_bits_);
+      }
+    }
+
+    for (auto const& [osm_node_idx, level_bits] : elevator_nodes) {
+      auto const node_idx = w.find_node_idx(osm_node_idx);
+      if (!node_idx.has_value()) {
+        continue;
+      }
+      auto& x = node_properties[*node_idx];
+      if (x.is_elevator() && x.is_multi_level()) {
+        continue;  // Tagged as multi level elevator node itself.
+      }
+      auto const [from, to, is_multi] = get_levels(true, level_bits);
+      x.is_elevator_ = true;
+      x.from_level_ = to_idx(from);
+      x.to_level_ = to_idx(to);
+      x.is_multi_level_ = is_multi;
+      if (is_multi) {
+        w.r_->multi_level_elevators_.emplace_back(*node_idx, level_bits);
+      }
+    }
+
+    if (pl) {
+      for (auto const& n : cache->platform_nodes_.select<osm::Node>()) {
+        if (auto const node_idx = w.find_node_idx(osm_node_idx_t{n.id()});
+            node_idx.has_value()) {
+          pl->node(*node_idx, n);
+        }
+      }
+    }
+
+    auto h = restriction_handler{w, r};
+    osm::apply(cache->restrictions_, h);
+    std::stable_sort(
+        begin(w.restriction_relations_), end(w.restriction_relations_),
+        [](auto&& a, auto&& b) { return a.first < b.first; });
+
+    cache.reset();
+    fs::remove(node_cache_path, ec);
     pt->update(pt->in_high_);
+    report_duration(pt, "Node Properties", start);
   }
 
   w.add_restriction(r);
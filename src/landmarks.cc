@@ -0,0 +1,315 @@
+#include "osr/routing/landmarks.h"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "fmt/core.h"
+
+#include "cista/hash.h"
+#include "cista/reflection/for_each_field.h"
+
+#include "utl/progress_tracker.h"
+#include "utl/verify.h"
+
+#include "osr/routing/dijkstra.h"
+#include "osr/routing/with_profile.h"
+
+namespace fs = std::filesystem;
+
+namespace osr {
+
+namespace {
+
+constexpr auto const kUnknown = std::numeric_limits<std::int32_t>::max();
+
+cista::mmap lm_mm(fs::path const& dir,
+                  search_profile const profile,
+                  std::string_view name,
+                  cista::mmap::protection const mode) {
+  auto const file = dir / fmt::format("landmarks_{}_{}.bin", to_str(profile),
+                                      name);
+  return cista::mmap{file.generic_string().c_str(), mode};
+}
+
+// Field by field (recursing into nested parameters), padding is not hashed.
+template <typename Parameters>
+std::uint64_t params_hash(Parameters const& params,
+                          std::uint64_t h = cista::BASE_HASH) {
+  cista::for_each_field(params, [&](auto const& field) {
+    if constexpr (std::is_aggregate_v<std::decay_t<decltype(field)>>) {
+      h = params_hash(field, h);
+    } else {
+      h = cista::hash(std::string_view{reinterpret_cast<char const*>(&field),
+                                       sizeof(field)},
+                      h);
+    }
+  });
+  return h;
+}
+
+std::int32_t get(landmarks::lm_cost_t const c) {
+  return c == landmarks::kUnreachable ? kUnknown : c;
+}
+
+std::int32_t add(std::int32_t const a, std::int32_t const b) {
+  return a == kUnknown || b == kUnknown ? kUnknown : a + b;
+}
+
+template <Profile P>
+void compute(ways const& w, landmarks& lm, unsigned const n_landmarks) {
+  using lm_cost_t = landmarks::lm_cost_t;
+
+  auto const params = typename P::parameters{};
+  auto const n_nodes = w.n_nodes();
+  auto const max = static_cast<cost_t>(landmarks::kUnreachable);
+  auto d = dijkstra<P>{};
+
+  auto pt = utl::get_active_progress_tracker_or_activate("osr");
+  pt->status(fmt::format("Landmarks {}", to_str(lm.profile_)))
+      .in_high(2U * n_landmarks)
+      .out_bounds(0, 100);
+
+  lm.params_hash_.resize(1U);
+  lm.params_hash_[0U] = params_hash(params);
+  lm.nodes_.resize(n_landmarks);
+  std::fill(begin(lm.nodes_), end(lm.nodes_), node_idx_t::invalid());
+  lm.from_.resize(static_cast<std::size_t>(n_nodes) * n_landmarks);
+  std::fill(begin(lm.from_), end(lm.from_), landmarks::kUnreachable);
+  lm.to_.resize(static_cast<std::size_t>(n_nodes) * n_landmarks);
+  std::fill(begin(lm.to_), end(lm.to_), landmarks::kUnreachable);
+  lm.spread_.resize(n_nodes);
+  std::fill(begin(lm.spread_), end(lm.spread_), lm_cost_t{0U});
+
+  // One-to-all search from / to the given node. Calls fn(node, min, max) for
+  // every reached node with the cheapest and most expensive label cost.
+  auto const settle = [&](node_idx_t const start, direction const dir,
+                          auto&& fn) {
+    d.reset(max);
+    P::resolve_all(*w.r_, start, kNoLevel, [&](typename P::node const n) {
+      d.add_start(w, typename P::label{n, 0U});
+    });
+    d.run(params, w, *w.r_, max, nullptr, nullptr, nullptr, dir);
+
+    for (auto n = node_idx_t{0U}; n != n_nodes; ++n) {
+      auto min_cost = kInfeasible;
+      auto max_cost = cost_t{0U};
+      P::resolve_all(*w.r_, n, kNoLevel, [&](typename P::node const x) {
+        auto const c = d.get_cost(x);
+        if (c != kInfeasible) {
+          min_cost = std::min(min_cost, c);
+          max_cost = std::max(max_cost, c);
+        }
+      });
+      if (min_cost < max) {
+        fn(n, static_cast<lm_cost_t>(min_cost),
+           static_cast<lm_cost_t>(std::min(max_cost - min_cost, max - 1U)));
+      }
+    }
+  };
+
+  // Farthest-first: the first landmark is the node farthest away from an
+  // arbitrary seed, every further landmark maximizes the distance to the
+  // closest landmark selected so far.
+  auto min_dist = std::vector<lm_cost_t>(n_nodes, landmarks::kUnreachable);
+  auto const farthest = [&]() {
+    auto best = node_idx_t::invalid();
+    auto best_dist = lm_cost_t{0U};
+    for (auto n = node_idx_t{0U}; n != n_nodes; ++n) {
+      auto const dist = min_dist[to_idx(n)];
+      if (dist != landmarks::kUnreachable && dist > best_dist) {
+        best = n;
+        best_dist = dist;
+      }
+    }
+    return best;
+  };
+
+  auto seed = node_idx_t{0U};
+  while (seed != n_nodes && w.r_->node_ways_[seed].empty()) {
+    ++seed;
+  }
+  if (seed == n_nodes) {
+    return;
+  }
+  settle(seed, direction::kForward,
+         [&](node_idx_t const n, lm_cost_t const c, lm_cost_t) {
+           min_dist[to_idx(n)] = c;
+         });
+
+  for (auto i = 0U; i != n_landmarks; ++i) {
+    auto const l = farthest();
+    if (l == node_idx_t::invalid()) {
+      break;
+    }
+    lm.nodes_[i] = l;
+
+    if (i == 0U) {
+      std::fill(begin(min_dist), end(min_dist), landmarks::kUnreachable);
+    }
+    settle(l, direction::kForward,
+           [&](node_idx_t const n, lm_cost_t const c, lm_cost_t const spread) {
+             auto const idx = to_idx(n);
+             lm.from_[idx * n_landmarks + i] = c;
+             lm.spread_[idx] = std::max(lm.spread_[idx], spread);
+             min_dist[idx] = i == 0U ? c : std::min(min_dist[idx], c);
+           });
+    pt->increment();
+
+    settle(l, direction::kBackward,
+           [&](node_idx_t const n, lm_cost_t const c, lm_cost_t const spread) {
+             auto const idx = to_idx(n);
+             lm.to_[idx * n_landmarks + i] = c;
+             lm.spread_[idx] = std::max(lm.spread_[idx], spread);
+           });
+    pt->increment();
+
+    // Selected landmarks must not be picked again.
+    min_dist[to_idx(l)] = 0U;
+  }
+}
+
+}  // namespace
+
+landmarks::landmarks(fs::path const& p,
+                     search_profile const profile,
+                     cista::mmap::protection const mode)
+    : profile_{profile},
+      params_hash_{lm_mm(p, profile, "params", mode)},
+      nodes_{lm_mm(p, profile, "nodes", mode)},
+      from_{lm_mm(p, profile, "from", mode)},
+      to_{lm_mm(p, profile, "to", mode)},
+      spread_{lm_mm(p, profile, "spread", mode)} {}
+
+std::unique_ptr<landmarks> landmarks::try_open(fs::path const& p,
+                                               search_profile const profile) {
+  for (auto const name : {"params", "nodes", "from", "to", "spread"}) {
+    auto const file =
+        p / fmt::format("landmarks_{}_{}.bin", to_str(profile), name);
+    if (!fs::exists(file)) {
+      return nullptr;
+    }
+  }
+  return std::make_unique<landmarks>(p, profile, cista::mmap::protection::READ);
+}
+
+bool landmarks::matches(profile_parameters const& params) const {
+  return params_hash_.size() == 1U &&
+         std::visit([&](auto const& p) { return params_hash(p); }, params) ==
+             params_hash_[0U];
+}
+
+void compute_landmarks(ways const& w,
+                       search_profile const profile,
+                       fs::path const& p,
+                       unsigned const n_landmarks) {
+  utl::verify(!is_rental_profile(profile),
+              "landmarks not supported for profile {}", to_str(profile));
+  utl::verify(n_landmarks != 0U && n_landmarks <= landmarks::kMaxLandmarks,
+              "invalid number of landmarks: {}", n_landmarks);
+
+  auto lm = landmarks{p, profile, cista::mmap::protection::WRITE};
+  with_profile(profile, [&]<Profile P>(P&&) { compute<P>(w, lm, n_landmarks); });
+}
+
+void landmark_bounds::reset(landmarks const* lm, direction const search_dir) {
+  lm_ = lm;
+  backward_ = search_dir == direction::kBackward;
+  sources_unknown_ = false;
+  targets_unknown_ = false;
+  n_sources_ = 0U;
+  n_targets_ = 0U;
+  source_from_max_.fill(0);
+  source_to_min_.fill(kUnknown);
+  target_from_min_.fill(kUnknown);
+  target_to_max_.fill(0);
+}
+
+std::span<landmarks::lm_cost_t const> landmark_bounds::get_from(
+    node_idx_t const n) const {
+  // In a backward search, costs are those of the reversed graph.
+  return backward_ ? lm_->to(n) : lm_->from(n);
+}
+
+std::span<landmarks::lm_cost_t const> landmark_bounds::get_to(
+    node_idx_t const n) const {
+  return backward_ ? lm_->from(n) : lm_->to(n);
+}
+
+void landmark_bounds::add_source(node_idx_t const n) {
+  if (!lm_->has(n)) {
+    sources_unknown_ = true;
+    return;
+  }
+  ++n_sources_;
+  auto const from = get_from(n);
+  auto const to = get_to(n);
+  auto const spread = static_cast<std::int32_t>(lm_->spread(n));
+  for (auto i = 0U; i != lm_->n_landmarks(); ++i) {
+    source_from_max_[i] =
+        std::max(source_from_max_[i], add(get(from[i]), spread));
+    source_to_min_[i] = std::min(source_to_min_[i], get(to[i]));
+  }
+}
+
+void landmark_bounds::add_target(node_idx_t const n) {
+  if (!lm_->has(n)) {
+    targets_unknown_ = true;
+    return;
+  }
+  ++n_targets_;
+  auto const from = get_from(n);
+  auto const to = get_to(n);
+  auto const spread = static_cast<std::int32_t>(lm_->spread(n));
+  for (auto i = 0U; i != lm_->n_landmarks(); ++i) {
+    target_from_min_[i] = std::min(target_from_min_[i], get(from[i]));
+    target_to_max_[i] = std::max(target_to_max_[i], add(get(to[i]), spread));
+  }
+}
+
+cost_t landmark_bounds::to_target(node_idx_t const n) const {
+  if (!active() || targets_unknown_ || n_targets_ == 0U || !lm_->has(n)) {
+    return 0U;
+  }
+  auto const from = get_from(n);
+  auto const to = get_to(n);
+  auto const spread = static_cast<std::int32_t>(lm_->spread(n));
+  auto best = std::int32_t{0};
+  for (auto i = 0U; i != lm_->n_landmarks(); ++i) {
+    // d(n, t) >= d(l, t) - d(l, n)
+    if (target_from_min_[i] != kUnknown && from[i] != landmarks::kUnreachable) {
+      best = std::max(best, target_from_min_[i] - (from[i] + spread));
+    }
+    // d(n, t) >= d(n, l) - d(t, l)
+    if (target_to_max_[i] != kUnknown && to[i] != landmarks::kUnreachable) {
+      best = std::max(best, to[i] - target_to_max_[i]);
+    }
+  }
+  return static_cast<cost_t>(best);
+}
+
+cost_t landmark_bounds::from_source(node_idx_t const n) const {
+  if (!active() || sources_unknown_ || n_sources_ == 0U || !lm_->has(n)) {
+    return 0U;
+  }
+  auto const from = get_from(n);
+  auto const to = get_to(n);
+  auto const spread = static_cast<std::int32_t>(lm_->spread(n));
+  auto best = std::int32_t{0};
+  for (auto i = 0U; i != lm_->n_landmarks(); ++i) {
+    // d(s, n) >= d(l, n) - d(l, s)
+    if (source_from_max_[i] != kUnknown && from[i] != landmarks::kUnreachable) {
+      best = std::max(best, from[i] - source_from_max_[i]);
+    }
+    // d(s, n) >= d(s, l) - d(n, l)
+    if (source_to_min_[i] != kUnknown && to[i] != landmarks::kUnreachable) {
+      best = std::max(best, source_to_min_[i] - (to[i] + spread));
+    }
+  }
+  return static_cast<cost_t>(best);
+}
+
+}  // namespace osr
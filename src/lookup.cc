@@ -16,7 +16,7 @@ lookup::lookup(ways const& ways,
                cista::mmap::protection mode)
     : p_{std::move(p)},
       mode_{mode},
-      rtree_{mode == cista::mmap::protection::READ
+      rtree_{mode != cista::mmap::protection::WRITE
                  ? *cista::read<cista::mm_rtree<way_idx_t>::meta>(
                        p_ / "rtree_meta.bin")
                  : cista::mm_rtree<way_idx_t>::meta{},
@@ -25,15 +25,31 @@ lookup::lookup(ways const& ways,
 
 void lookup::build_rtree() {
   for (auto way = way_idx_t{0U}; way != ways_.n_ways(); ++way) {
-    auto b = geo::box{};
-    for (auto const& c : ways_.way_polylines_[way]) {
-      b.extend(c);
-    }
-    rtree_.insert(b.min_.lnglat_float(), b.max_.lnglat_float(), way);
+    insert(way);
+  }
+  write_meta();
+}
+
+void lookup::insert(way_idx_t const way) {
+  auto b = geo::box{};
+  for (auto const& c : ways_.way_polylines_[way]) {
+    b.extend(c);
   }
-  rtree_.write_meta(p_ / "rtree_meta.bin");
+  rtree_.insert(b.min_.lnglat_float(), b.max_.lnglat_float(), way);
 }
 
+void lookup::update_way(way_idx_t const way, geo::box const& before) {
+  auto after = geo::box{};
+  for (auto const& c : ways_.way_polylines_[way]) {
+    after.extend(c);
+  }
+  rtree_.delete_element(before.min_.lnglat_float(), before.max_.lnglat_float(),
+                        way);
+  rtree_.insert(after.min_.lnglat_float(), after.max_.lnglat_float(), way);
+}
+
+void lookup::write_meta() { rtree_.write_meta(p_ / "rtree_meta.bin"); }
+
 std::vector<raw_way_candidate> lookup::get_raw_way_candidates(
     location const& query, double const max_match_distance) const {
   auto way_candidates = std::vector<raw_way_candidate>{};
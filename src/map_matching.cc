@@ -15,6 +15,7 @@
 #include "utl/verify.h"
 
 #include "osr/routing/astar.h"
+#include "osr/routing/cancellation.h"
 #include "osr/routing/map_matching_data.h"
 #include "osr/routing/map_matching_debug.h"
 #include "osr/routing/path_reconstruction.h"
@@ -210,6 +211,116 @@ double get_dijkstra_limit(typename P::parameters const& params,
   }
 }
 
+// Copy of the parts of a segment that build_map_match_debug_json reads: the
+// search counters, the additional edges and only those cost map entries that
+// end up as node labels or on reconstructed paths. sharing_ is left empty,
+// the debug output detects additional nodes via ways::is_additional_node.
+template <Profile P>
+segment_data<P> trace_segment(ways const& w,
+                              lookup const& l,
+                              point_data<P> const& from_pd,
+                              point_data<P> const& to_pd,
+                              segment_data<P> const& seg) {
+  auto t = segment_data<P>{};
+  t.min_cost_ = seg.min_cost_;
+  t.max_cost_ = seg.max_cost_;
+  t.dijkstra_cost_limit_ = seg.dijkstra_cost_limit_;
+  t.all_beelined_ = seg.all_beelined_;
+  t.beeline_from_ = seg.beeline_from_;
+  t.beeline_dist_ = seg.beeline_dist_;
+  t.selected_start_match_idx_ = seg.selected_start_match_idx_;
+  t.selected_dest_match_idx_ = seg.selected_dest_match_idx_;
+  t.additional_edges_ = seg.additional_edges_;
+  t.path_segments_ = seg.path_segments_;
+  t.astar_duration_ = seg.astar_duration_;
+  t.astar_.max_reached_ = seg.astar_.max_reached_;
+  t.astar_.remaining_destinations_ = seg.astar_.remaining_destinations_;
+  t.astar_.early_termination_max_cost_ =
+      seg.astar_.early_termination_max_cost_;
+  t.astar_.terminated_early_max_cost_ = seg.astar_.terminated_early_max_cost_;
+
+  auto const copy_entry = [&](typename P::node const n) {
+    if (auto const it = seg.astar_.cost_.find(n.get_key());
+        it != end(seg.astar_.cost_)) {
+      t.astar_.cost_.emplace(it->first, it->second);
+    }
+  };
+
+  for (auto const& mw : from_pd.matched_ways_) {
+    copy_entry(mw.fwd_node_);
+    copy_entry(mw.bwd_node_);
+  }
+  for (auto const& mw : to_pd.matched_ways_) {
+    for (auto const dest : {mw.fwd_node_, mw.bwd_node_}) {
+      auto n = std::optional{dest};
+      while (n.has_value()) {
+        auto const it = seg.astar_.cost_.find(n->get_key());
+        if (it == end(seg.astar_.cost_)) {
+          break;
+        }
+        t.astar_.cost_.emplace(it->first, it->second);
+        n = it->second.pred(*n);
+      }
+    }
+  }
+  for (auto const n :
+       get_debug_label_nodes(w, l, from_pd.loc_.pos_, to_pd.loc_.pos_)) {
+    P::resolve_all(*w.r_, n, kNoLevel,
+                   [&](typename P::node const x) { copy_entry(x); });
+  }
+
+  return t;
+}
+
+template <Profile P>
+struct map_match_trace_impl final : public map_match_trace {
+  map_match_trace_impl(ways const& w,
+                       lookup const& l,
+                       typename P::parameters const& params,
+                       std::vector<location> points,
+                       map_match_state<P>& state,
+                       matched_route result)
+      : w_{w},
+        l_{l},
+        params_{params},
+        points_{std::move(points)},
+        pds_{std::move(state.pds_)},
+        additional_node_coordinates_{
+            std::move(state.additional_node_coordinates_)},
+        result_{std::move(result)} {
+    segments_.reserve(state.segments_.size());
+    for (auto const [i, seg] : utl::enumerate(state.segments_)) {
+      segments_.emplace_back(
+          trace_segment<P>(w, l, pds_[i], pds_[i + 1U], seg));
+    }
+  }
+
+  boost::json::object to_json() const override {
+    auto const additional_node_offset = w_.n_nodes();
+    return build_map_match_debug_json<P>(
+        w_, l_, params_, points_, pds_, segments_, result_,
+        [&](node_idx_t const n) -> geo::latlng {
+          if (n == node_idx_t::invalid()) {
+            return {};
+          } else if (w_.is_additional_node(n)) {
+            return additional_node_coordinates_.at(to_idx(n) -
+                                                   additional_node_offset);
+          } else {
+            return w_.get_node_pos(n).as_latlng();
+          }
+        });
+  }
+
+  ways const& w_;
+  lookup const& l_;
+  typename P::parameters params_;
+  std::vector<location> points_;
+  std::vector<point_data<P>> pds_;
+  std::vector<segment_data<P>> segments_;
+  std::vector<geo::latlng> additional_node_coordinates_;
+  matched_route result_;
+};
+
 template <Profile P>
 matched_route map_match(
     ways const& w,
@@ -220,17 +331,21 @@ matched_route map_match(
     elevation_storage const* elevations,
     std::function<void(matched_route const&,
                        std::function<boost::json::object()> const&)> const&
-        debug_fn) {
+        debug_fn,
+    map_match_trace_fn const& trace_fn,
+    cancellation_token const* cancel) {
   utl::verify(points.size() >= 2, "map_match requires at least 2 points");
   auto const start_time = std::chrono::steady_clock::now();
 
+  auto state = std::make_unique<map_match_state<P>>();
+
   auto const n_route_segments = points.size() - 1U;
-  auto segments = std::vector<segment_data<P>>{};
+  auto& segments = state->segments_;
   segments.resize(n_route_segments);
 
   auto const additional_node_offset = w.n_nodes();
   auto next_additional_node = node_idx_t{additional_node_offset};
-  auto additional_node_coordinates = std::vector<geo::latlng>{};
+  auto& additional_node_coordinates = state->additional_node_coordinates_;
   auto result = matched_route{};
 
   auto const get_node_pos = [&](node_idx_t const n) -> geo::latlng {
@@ -243,7 +358,8 @@ matched_route map_match(
     }
   };
 
-  auto pds = utl::to_vec(points, [&](auto const& mp) {
+  auto& pds = state->pds_;
+  pds = utl::to_vec(points, [&](auto const& mp) {
     return match_input_point<P>(w, l, params, blocked, mp);
   });
 
@@ -261,6 +377,10 @@ matched_route map_match(
   }
 
   for (auto seg_idx = 0U; seg_idx < n_route_segments; ++seg_idx) {
+    if (cancel != nullptr && cancel->is_cancelled()) {
+      throw search_cancelled{};
+    }
+
     auto& from_pd = pds[seg_idx];
     auto& to_pd = pds[seg_idx + 1U];
     auto& seg = segments[seg_idx];
@@ -351,6 +471,7 @@ matched_route map_match(
 
     seg.dijkstra_cost_limit_ = dijkstra_max_cost;
     seg.astar_.reset(dijkstra_max_cost, from_pd.loc_, to_pd.loc_);
+    seg.astar_.cancel_.token_ = cancel;
 
     auto const get_min_start_cost = [&](matched_way<P> const& from_mw) {
       auto min_start_cost = kInfeasible;
@@ -403,6 +524,9 @@ matched_route map_match(
       seg.astar_.run(params, w, *w.r_, dijkstra_max_cost, blocked,
                      seg.sharing_.get(), elevations, direction::kForward);
       seg.astar_.reset_pq();
+      if (seg.astar_.cancel_.cancelled_) {
+        throw search_cancelled{};
+      }
       seg.astar_duration_ =
           std::chrono::duration_cast<std::chrono::microseconds>(
               std::chrono::steady_clock::now() - dijkstra_start);
@@ -773,6 +897,11 @@ matched_route map_match(
     });
   }
 
+  if (trace_fn) {
+    trace_fn(std::make_shared<map_match_trace_impl<P>>(w, l, params, points,
+                                                       *state, result));
+  }
+
   return result;
 }
 
@@ -786,10 +915,12 @@ matched_route map_match(
     elevation_storage const* elevations,
     std::function<void(matched_route const&,
                        std::function<boost::json::object()> const&)> const&
-        debug_fn) {
+        debug_fn,
+    map_match_trace_fn const& trace_fn,
+    cancellation_token const* cancel) {
   return with_profile(profile, [&]<Profile P>(P&&) {
     return map_match<P>(w, l, std::get<typename P::parameters>(params), points,
-                        blocked, elevations, debug_fn);
+                        blocked, elevations, debug_fn, trace_fn, cancel);
   });
 }
 
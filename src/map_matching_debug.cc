@@ -136,6 +136,28 @@ boost::json::object to_json_match(debug_match const& dm,
 
 }  // namespace
 
+hash_set<node_idx_t> get_debug_label_nodes(ways const& w,
+                                           lookup const& l,
+                                           geo::latlng const& from,
+                                           geo::latlng const& to) {
+  constexpr auto kLabelRadius = 1500.0;  // meters
+
+  auto radius_nodes = hash_set<node_idx_t>{};
+  auto const find_nodes_near = [&](geo::latlng const& pos) {
+    l.find(geo::box{pos, kLabelRadius}, [&](way_idx_t const way) {
+      for (auto const node : w.r_->way_nodes_[way]) {
+        auto const node_pos = w.get_node_pos(node).as_latlng();
+        if (geo::distance(node_pos, pos) <= kLabelRadius) {
+          radius_nodes.insert(node);
+        }
+      }
+    });
+  };
+  find_nodes_near(from);
+  find_nodes_near(to);
+  return radius_nodes;
+}
+
 template <Profile P>
 boost::json::object build_map_match_debug_json(
     ways const& w,
@@ -608,30 +630,9 @@ boost::json::object build_map_match_debug_json(
       }
     }
 
-    // Collect labels for nodes within 1500m radius of segment start/end
-    constexpr auto kLabelRadius = 1500.0;  // meters
-    auto const start_pos = from_pd.loc_.pos_;
-    auto const end_pos = to_pd.loc_.pos_;
-
-    // Find ways near start and end, register their nodes, then collect labels
-    auto radius_nodes = hash_set<node_idx_t>{};
-
-    // Helper to collect nodes from ways in a radius around a point
-    auto const find_nodes_near = [&](geo::latlng const& pos) {
-      l.find(geo::box{pos, kLabelRadius}, [&](way_idx_t const way) {
-        for (auto const node : w.r_->way_nodes_[way]) {
-          auto const node_pos = w.get_node_pos(node).as_latlng();
-          if (geo::distance(node_pos, pos) <= kLabelRadius) {
-            radius_nodes.insert(node);
-          }
-        }
-      });
-    };
-
-    find_nodes_near(start_pos);
-    find_nodes_near(end_pos);
-
-    // Now process each node in radius
+    // Collect labels for nodes around segment start/end
+    auto const radius_nodes =
+        get_debug_label_nodes(w, l, from_pd.loc_.pos_, to_pd.loc_.pos_);
     for (auto const node_idx : radius_nodes) {
       // Skip additional nodes
       if (w.is_additional_node(node_idx)) {
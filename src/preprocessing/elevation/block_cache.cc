@@ -0,0 +1,92 @@
+#include "osr/preprocessing/elevation/block_cache.h"
+
+#include <list>
+#include <mutex>
+#include <utility>
+
+#include "utl/verify.h"
+
+#include "osr/types.h"
+#include "osr/util/thread_slots.h"
+
+namespace osr::preprocessing::elevation {
+
+namespace {
+
+// Most recently used block of one thread.
+struct slot {
+  std::uint64_t key_{0U};
+  block_cache::block_t block_;
+};
+
+}  // namespace
+
+struct block_cache::impl {
+  explicit impl(std::size_t const max_blocks) : max_blocks_{max_blocks} {}
+
+  using lru_t = std::list<std::pair<std::uint64_t, block_t>>;
+
+  block_t find(std::uint64_t const key) {
+    auto const lock = std::lock_guard{mutex_};
+    auto const it = blocks_.find(key);
+    if (it == end(blocks_)) {
+      return nullptr;
+    }
+    lru_.splice(begin(lru_), lru_, it->second);
+    return it->second->second;
+  }
+
+  block_t insert(std::uint64_t const key, block_t block) {
+    auto const lock = std::lock_guard{mutex_};
+    auto const it = blocks_.find(key);
+    if (it != end(blocks_)) {
+      lru_.splice(begin(lru_), lru_, it->second);
+      return it->second->second;
+    }
+    lru_.emplace_front(key, std::move(block));
+    blocks_.emplace(key, begin(lru_));
+    while (lru_.size() > max_blocks_) {
+      blocks_.erase(lru_.back().first);
+      lru_.pop_back();
+    }
+    return lru_.front().second;
+  }
+
+  std::size_t max_blocks_;
+  hash_map<std::uint64_t, lru_t::iterator> blocks_;
+  lru_t lru_;
+  std::mutex mutex_;
+  thread_slots<slot> slots_;
+};
+
+block_cache::block_cache(std::size_t const max_blocks)
+    : impl_{std::make_unique<impl>(max_blocks)} {
+  utl::verify(max_blocks != 0U, "block_cache: max_blocks must be positive");
+}
+
+block_cache::~block_cache() = default;
+
+block_cache::block_t block_cache::get(key const k,
+                                      decode_fn_t const& decode) const {
+  auto const packed = k.pack();
+  auto& s = impl_->slots_.get();
+  if (s.block_ != nullptr && s.key_ == packed) {
+    return s.block_;
+  }
+
+  auto block = impl_->find(packed);
+  if (block == nullptr) {
+    block = impl_->insert(
+        packed, std::make_shared<std::vector<elevation_meters_t> const>(
+                    decode()));
+  }
+  s = {.key_ = packed, .block_ = block};
+  return block;
+}
+
+std::size_t block_cache::n_decoded() const {
+  auto const lock = std::lock_guard{impl_->mutex_};
+  return impl_->lru_.size();
+}
+
+}  // namespace osr::preprocessing::elevation
@@ -1,9 +1,14 @@
 #include "osr/preprocessing/elevation/dem_driver.h"
 
+#include <optional>
+
 namespace fs = std::filesystem;
 
 namespace osr::preprocessing::elevation {
 
+dem_driver::dem_driver(std::size_t const max_open_tiles)
+    : cache_{std::make_unique<tile_cache>(max_open_tiles)} {}
+
 bool dem_driver::add_tile(fs::path const& path) {
   auto const ext = path.extension().string();
   if (ext != ".hdr") {
@@ -11,8 +16,9 @@ bool dem_driver::add_tile(fs::path const& path) {
   }
 
   auto const idx = static_cast<std::size_t>(tiles_.size());
-  auto const& tile = tiles_.emplace_back(dem_tile{path});
+  auto const& tile = tiles_.emplace_back(dem_tile{path, *cache_});
   auto const box = tile.get_box();
+  add_overlaps(rtree_, box, overlaps_);
   rtree_.insert(box.min_.lnglat_float(), box.max_.lnglat_float(), idx);
   return true;
 }
@@ -28,6 +34,50 @@ elevation_meters_t dem_driver::get(geo::latlng const& pos) const {
   return meters;
 }
 
+void dem_driver::get(std::span<geo::latlng const> pos,
+                     std::span<elevation_meters_t> out) const {
+  auto i = std::size_t{0U};
+  while (i != pos.size()) {
+    if (out[i] != elevation_meters_t::invalid()) {
+      ++i;
+      continue;
+    }
+
+    auto const p = pos[i].lnglat_float();
+    auto tile = std::optional<std::size_t>{};
+    rtree_.search(p, p,
+                  [&](auto const&, auto const&, std::size_t const& tile_idx) {
+                    tile = tile_idx;
+                    return true;
+                  });
+    if (!tile.has_value()) {
+      ++i;
+      continue;
+    }
+
+    // Resolve the tile once for the run of positions within its box.
+    auto const& t = tiles_[*tile];
+    auto const box = t.get_box();
+    auto end = i + 1U;
+    while (end != pos.size() && out[end] == elevation_meters_t::invalid() &&
+           box.contains(pos[end])) {
+      ++end;
+    }
+    t.get(pos.subspan(i, end - i), out.subspan(i, end - i));
+
+    // No data values may be covered by an overlapping tile.
+    if (!overlaps_[*tile]) {
+      i = end;
+      continue;
+    }
+    for (; i != end; ++i) {
+      if (out[i] == elevation_meters_t::invalid()) {
+        out[i] = get(pos[i]);
+      }
+    }
+  }
+}
+
 tile_idx_t dem_driver::tile_idx(geo::latlng const& pos) const {
   auto const p = pos.lnglat_float();
   auto idx = tile_idx_t::invalid();
@@ -2,16 +2,17 @@
 
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <functional>
 #include <limits>
+#include <span>
 #include <stdexcept>
 #include <unordered_map>
 
 #include "boost/algorithm/string/case_conv.hpp"
 
-#include "cista/mmap.h"
 #include "cista/strong.h"
 
 #include "utl/verify.h"
@@ -161,6 +162,25 @@ struct bil_header {
   pixel_value nodata_{};
 };
 
+elevation_meters_t to_meters(std::int16_t const value,
+                             pixel_value const nodata) {
+  return value != nodata.int16_ && value != kNoData
+             ? elevation_meters_t{value}
+             : elevation_meters_t::invalid();
+}
+
+elevation_meters_t to_meters(float const value, pixel_value const nodata) {
+  // Also rejects NaN
+  if (std::equal_to<>()(value, nodata.float32_) ||
+      !(value > -32767.5F && value < 32767.5F)) {
+    return elevation_meters_t::invalid();
+  }
+  auto const meters =
+      static_cast<cista::base_t<elevation_meters_t>>(std::round(value));
+  return meters != kNoData ? elevation_meters_t{meters}
+                           : elevation_meters_t::invalid();
+}
+
 fs::path get_bil_path(fs::path const& path) {
   auto const bil_path =
       fs::path{path.parent_path() / fs::path(path.stem().string() + ".bil")};
@@ -170,33 +190,29 @@ fs::path get_bil_path(fs::path const& path) {
   return bil_path;
 }
 
+tile_cache::handle add_bil_file(tile_cache& cache,
+                                fs::path const& data_file,
+                                bil_header const& hdr) {
+  auto const expected_size = hdr.row_size_ * hdr.rows_;
+  auto const size = fs::file_size(data_file);
+  utl::verify(size == expected_size,
+              "BIL tile '{}' ({}x{}) has incorrect file size ({} != {})",
+              data_file.string(), hdr.cols_, hdr.rows_, size, expected_size);
+  return cache.add(data_file);
+}
+
 struct dem_tile::impl {
-  explicit impl(fs::path const& path)
+  impl(fs::path const& path, tile_cache& cache)
       : data_file_{get_bil_path(path)},
         hdr_{data_file_},
-        mapped_file_{cista::mmap{data_file_.string().data(),
-                                 cista::mmap::protection::READ}} {
-    auto const expected_size = hdr_.row_size_ * hdr_.rows_;
-    utl::verify(mapped_file_.size() == expected_size,
-                "BIL tile '{}' ({}x{}) has incorrect file size ({} != {})",
-                data_file_.string(), hdr_.cols_, hdr_.rows_,
-                mapped_file_.size(), expected_size);
-  }
+        mapped_file_{add_bil_file(cache, data_file_, hdr_)} {}
 
   pixel_value get(geo::latlng const& pos) const {
     if (!get_box().contains(pos)) {
       return hdr_.nodata_;
     }
 
-    auto const pix_x = std::clamp(
-        0U, static_cast<unsigned>((pos.lng_ - hdr_.ulx_) / hdr_.xdim_),
-        hdr_.cols_ - 1U);
-    auto const pix_y = std::clamp(
-        0U, static_cast<unsigned>((hdr_.uly_ - pos.lat_) / hdr_.ydim_),
-        hdr_.rows_ - 1U);
-    auto const byte_pos = hdr_.row_size_ * pix_y + hdr_.pixel_size_ * pix_x;
-
-    auto const* byte_ptr = mapped_file_.data() + byte_pos;
+    auto const* byte_ptr = mapped_file_.get().data() + get_byte_pos(pos);
 
     pixel_value val{};
 
@@ -212,6 +228,33 @@ struct dem_tile::impl {
     return val;
   }
 
+  template <typename T, typename Convert>
+  void get(std::span<geo::latlng const> pos,
+           std::span<elevation_meters_t> out,
+           Convert&& convert) const {
+    auto const box = get_box();
+    auto const* data = mapped_file_.get().data();
+    for (auto i = std::size_t{0U}; i != pos.size(); ++i) {
+      if (!box.contains(pos[i])) {
+        out[i] = elevation_meters_t::invalid();
+        continue;
+      }
+      auto value = T{};
+      std::memcpy(&value, data + get_byte_pos(pos[i]), sizeof(T));
+      out[i] = convert(value);
+    }
+  }
+
+  unsigned get_byte_pos(geo::latlng const& pos) const {
+    auto const pix_x = std::clamp(
+        0U, static_cast<unsigned>((pos.lng_ - hdr_.ulx_) / hdr_.xdim_),
+        hdr_.cols_ - 1U);
+    auto const pix_y = std::clamp(
+        0U, static_cast<unsigned>((hdr_.uly_ - pos.lat_) / hdr_.ydim_),
+        hdr_.rows_ - 1U);
+    return hdr_.row_size_ * pix_y + hdr_.pixel_size_ * pix_x;
+  }
+
   geo::box get_box() const {
     return {{hdr_.bry_, hdr_.brx_}, {hdr_.uly_, hdr_.ulx_}};
   }
@@ -229,11 +272,11 @@ struct dem_tile::impl {
 
   fs::path data_file_;
   bil_header hdr_;
-  cista::mmap mapped_file_;
+  tile_cache::handle mapped_file_;
 };
 
-dem_tile::dem_tile(fs::path const& path)
-    : impl_(std::make_unique<impl>(path)) {}
+dem_tile::dem_tile(fs::path const& path, tile_cache& cache)
+    : impl_(std::make_unique<impl>(path, cache)) {}
 
 dem_tile::dem_tile(dem_tile&& grid) noexcept : impl_(std::move(grid.impl_)) {}
 
@@ -241,24 +284,26 @@ dem_tile::~dem_tile() = default;
 
 elevation_meters_t dem_tile::get(geo::latlng const& pos) const {
   auto const val = get_raw(pos);
+  switch (impl_->hdr_.pixel_type_) {
+    case pixel_type::int16: return to_meters(val.int16_, impl_->hdr_.nodata_);
+    case pixel_type::float32:
+      return to_meters(val.float32_, impl_->hdr_.nodata_);
+  }
+  throw std::runtime_error{"dem_grid: invalid pixel type"};
+}
+
+void dem_tile::get(std::span<geo::latlng const> pos,
+                   std::span<elevation_meters_t> out) const {
+  auto const nodata = impl_->hdr_.nodata_;
   switch (impl_->hdr_.pixel_type_) {
     case pixel_type::int16:
-      if (val.int16_ == impl_->hdr_.nodata_.int16_) {
-        return elevation_meters_t::invalid();
-      } else {
-        auto const value = val.int16_;
-        return value != kNoData ? elevation_meters_t{value}
-                                : elevation_meters_t::invalid();
-      }
+      impl_->get<std::int16_t>(
+          pos, out, [&](std::int16_t const x) { return to_meters(x, nodata); });
+      return;
     case pixel_type::float32:
-      if (std::equal_to<>()(val.float32_, impl_->hdr_.nodata_.float32_)) {
-        return elevation_meters_t::invalid();
-      } else {
-        auto const value = static_cast<cista::base_t<elevation_meters_t>>(
-            std::round(val.float32_));
-        return value != kNoData ? elevation_meters_t{value}
-                                : elevation_meters_t::invalid();
-      }
+      impl_->get<float>(pos, out,
+                        [&](float const x) { return to_meters(x, nodata); });
+      return;
   }
   throw std::runtime_error{"dem_grid: invalid pixel type"};
 }
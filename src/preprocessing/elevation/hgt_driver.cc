@@ -38,15 +38,19 @@ struct grid_point {
   std::int16_t lng_;
 };
 
+hgt_driver::hgt_driver(std::size_t const max_open_tiles)
+    : cache_{std::make_unique<tile_cache>(max_open_tiles)} {}
+
 bool hgt_driver::add_tile(fs::path const& path) {
   auto const ext = path.extension().string();
   if (ext != ".hgt") {
     return false;
   }
-  auto tile = open(path);
+  auto tile = open(path, *cache_);
   if (tile.has_value()) {
     auto const box =
         std::visit([](IsTile auto const& t) { return t.get_box(); }, *tile);
+    add_overlaps(rtree_, box, overlaps_);
     rtree_.insert(box.min_.lnglat_float(), box.max_.lnglat_float(),
                   static_cast<std::size_t>(tiles_.size()));
     tiles_.emplace_back(std::move(tile.value()));
@@ -71,6 +75,55 @@ elevation_meters_t hgt_driver::get(geo::latlng const& pos) const {
   return meters;
 }
 
+void hgt_driver::get(std::span<geo::latlng const> pos,
+                     std::span<elevation_meters_t> out) const {
+  auto i = std::size_t{0U};
+  while (i != pos.size()) {
+    if (out[i] != elevation_meters_t::invalid()) {
+      ++i;
+      continue;
+    }
+
+    auto const p = pos[i].lnglat_float();
+    auto tile = std::optional<std::size_t>{};
+    rtree_.search(p, p,
+                  [&](auto const&, auto const&, std::size_t const& tile_idx) {
+                    tile = tile_idx;
+                    return true;
+                  });
+    if (!tile.has_value()) {
+      ++i;
+      continue;
+    }
+
+    // Resolve the tile once for the run of positions within its box.
+    auto const& t = tiles_[*tile];
+    auto const box =
+        std::visit([](IsTile auto const& x) { return x.get_box(); }, t);
+    auto end = i + 1U;
+    while (end != pos.size() && out[end] == elevation_meters_t::invalid() &&
+           box.contains(pos[end])) {
+      ++end;
+    }
+    std::visit(
+        [&](IsTile auto const& x) {
+          x.get(pos.subspan(i, end - i), out.subspan(i, end - i));
+        },
+        t);
+
+    // Void values may be covered by an overlapping tile.
+    if (!overlaps_[*tile]) {
+      i = end;
+      continue;
+    }
+    for (; i != end; ++i) {
+      if (out[i] == elevation_meters_t::invalid()) {
+        out[i] = get(pos[i]);
+      }
+    }
+  }
+}
+
 tile_idx_t hgt_driver::tile_idx(geo::latlng const& pos) const {
   auto const p = pos.lnglat_float();
   auto idx = tile_idx_t::invalid();
@@ -100,15 +153,16 @@ resolution hgt_driver::max_resolution() const {
 
 std::size_t hgt_driver::n_tiles() const { return tiles_.size(); }
 
-std::optional<hgt_driver::hgt_tile_t> hgt_driver::open(fs::path const& path) {
+std::optional<hgt_driver::hgt_tile_t> hgt_driver::open(fs::path const& path,
+                                                       tile_cache& cache) {
   try {
     auto sw = grid_point{path.filename().string()};
     auto const file_size = fs::file_size(path);
     switch (file_size) {
       case hgt_tile<3601>::file_size():
-        return hgt_tile<3601>{path.string(), sw.lat_, sw.lng_};
+        return hgt_tile<3601>{cache.add(path), sw.lat_, sw.lng_};
       case hgt_tile<1201>::file_size():
-        return hgt_tile<1201>{path.string(), sw.lat_, sw.lng_};
+        return hgt_tile<1201>{cache.add(path), sw.lat_, sw.lng_};
       default: return {};
     }
   } catch (std::runtime_error const& e) {
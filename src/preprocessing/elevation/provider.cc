@@ -1,6 +1,8 @@
 #include "osr/preprocessing/elevation/provider.h"
 
+#include <algorithm>
 #include <memory>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -9,13 +11,15 @@
 #include "osr/elevation_storage.h"
 #include "osr/preprocessing/elevation/dem_driver.h"
 #include "osr/preprocessing/elevation/hgt_driver.h"
+#include "osr/preprocessing/elevation/tiff_driver.h"
 
 namespace osr::preprocessing::elevation {
 
 static_assert(IsDriver<dem_driver>);
 static_assert(IsDriver<hgt_driver>);
+static_assert(IsDriver<tiff_driver>);
 
-using driver_t = std::variant<dem_driver, hgt_driver>;
+using driver_t = std::variant<dem_driver, hgt_driver, tiff_driver>;
 
 struct provider::impl {
   impl() = default;
@@ -35,6 +39,23 @@ struct provider::impl {
     return elevation_meters_t::invalid();
   }
 
+  void get(std::span<geo::latlng const> pos,
+           std::span<elevation_meters_t> out,
+           resolution const& sampling) const {
+    std::ranges::fill(out, elevation_meters_t::invalid());
+    for (auto const& driver : drivers_) {
+      std::visit(
+          [&](IsDriver auto const& d) {
+            if constexpr (requires { d.get(pos, out, sampling); }) {
+              d.get(pos, out, sampling);
+            } else {
+              d.get(pos, out);
+            }
+          },
+          driver);
+    }
+  }
+
   tile_idx_t tile_idx(geo::latlng const& pos) const {
     for (auto const [driver_idx, driver] : utl::enumerate(drivers_)) {
       auto idx = std::visit(
@@ -50,11 +71,13 @@ struct provider::impl {
   std::vector<driver_t> drivers_;
 };
 
-provider::provider(std::filesystem::path const& p)
+provider::provider(std::filesystem::path const& p,
+                   std::size_t const max_open_tiles)
     : impl_{std::make_unique<impl>()} {
   if (std::filesystem::is_directory(p)) {
-    auto dem = dem_driver{};
-    auto hgt = hgt_driver{};
+    auto dem = dem_driver{max_open_tiles};
+    auto hgt = hgt_driver{max_open_tiles};
+    auto tiff = tiff_driver{max_open_tiles};
     for (auto const& file : std::filesystem::recursive_directory_iterator(p)) {
       [&]() {
         if (!file.is_regular_file()) {
@@ -67,6 +90,9 @@ provider::provider(std::filesystem::path const& p)
         if (hgt.add_tile(path)) {
           return;
         }
+        if (tiff.add_tile(path)) {
+          return;
+        }
       }();
     }
     if (dem.n_tiles() > 0U) {
@@ -75,6 +101,9 @@ provider::provider(std::filesystem::path const& p)
     if (hgt.n_tiles() > 0U) {
       impl_->add_driver(std::move(hgt));
     }
+    if (tiff.n_tiles() > 0U) {
+      impl_->add_driver(std::move(tiff));
+    }
   }
 }
 
@@ -84,12 +113,37 @@ elevation_meters_t provider::get(geo::latlng const& pos) const {
   return impl_->get(pos);
 }
 
+void provider::get(std::span<geo::latlng const> pos,
+                   std::span<elevation_meters_t> out,
+                   resolution const& sampling) const {
+  impl_->get(pos, out, sampling);
+}
+
 tile_idx_t provider::tile_idx(geo::latlng const& pos) const {
   return impl_->tile_idx(pos);
 }
 
 std::size_t provider::driver_count() const { return impl_->drivers_.size(); }
 
+std::vector<geo::box> provider::tile_boxes() const {
+  auto boxes = std::vector<geo::box>{};
+  for (auto const& driver : impl_->drivers_) {
+    std::visit(
+        [&](IsDriver auto const& d) {
+          for (auto const& tile : d.tiles_) {
+            if constexpr (IsTile<std::decay_t<decltype(tile)>>) {
+              boxes.push_back(tile.get_box());
+            } else {
+              boxes.push_back(std::visit(
+                  [](IsTile auto const& t) { return t.get_box(); }, tile));
+            }
+          }
+        },
+        driver);
+  }
+  return boxes;
+}
+
 resolution provider::max_resolution() const {
   auto res = resolution{};
   for (auto const& driver : impl_->drivers_) {
@@ -0,0 +1,132 @@
+#include "osr/preprocessing/elevation/tiff_driver.h"
+
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace osr::preprocessing::elevation {
+
+tiff_driver::tiff_driver(std::size_t const max_open_tiles,
+                         std::size_t const max_decoded_blocks)
+    : cache_{std::make_unique<tile_cache>(max_open_tiles)},
+      blocks_{std::make_unique<block_cache>(max_decoded_blocks)} {}
+
+bool tiff_driver::add_tile(fs::path const& path) {
+  auto const ext = path.extension().string();
+  if (ext != ".tif" && ext != ".tiff") {
+    return false;
+  }
+
+  try {
+    auto tile = tiff_tile{path, *cache_, *blocks_};
+    auto const box = tile.get_box();
+    add_overlaps(rtree_, box, overlaps_);
+    rtree_.insert(box.min_.lnglat_float(), box.max_.lnglat_float(),
+                  static_cast<std::size_t>(tiles_.size()));
+    tiles_.emplace_back(std::move(tile));
+    return true;
+  } catch (std::exception const& e) {
+    std::cerr << "Error opening '" << path << "': " << e.what() << "\n";
+    return false;
+  }
+}
+
+elevation_meters_t tiff_driver::get(geo::latlng const& pos) const {
+  auto const p = pos.lnglat_float();
+  auto meters = elevation_meters_t::invalid();
+  rtree_.search(p, p,
+                [&](auto const&, auto const&, std::size_t const& tile_idx) {
+                  meters = tiles_[tile_idx].get(pos);
+                  return meters != elevation_meters_t::invalid();
+                });
+  return meters;
+}
+
+void tiff_driver::get(std::span<geo::latlng const> pos,
+                      std::span<elevation_meters_t> out) const {
+  get(pos, out, resolution{});
+}
+
+void tiff_driver::get(std::span<geo::latlng const> pos,
+                      std::span<elevation_meters_t> out,
+                      resolution const& sampling) const {
+  auto i = std::size_t{0U};
+  while (i != pos.size()) {
+    if (out[i] != elevation_meters_t::invalid()) {
+      ++i;
+      continue;
+    }
+
+    auto const p = pos[i].lnglat_float();
+    auto tile = std::optional<std::size_t>{};
+    rtree_.search(p, p,
+                  [&](auto const&, auto const&, std::size_t const& tile_idx) {
+                    tile = tile_idx;
+                    return true;
+                  });
+    if (!tile.has_value()) {
+      ++i;
+      continue;
+    }
+
+    // Resolve the tile once for the run of positions within its box.
+    auto const& t = tiles_[*tile];
+    auto const box = t.get_box();
+    auto end = i + 1U;
+    while (end != pos.size() && out[end] == elevation_meters_t::invalid() &&
+           box.contains(pos[end])) {
+      ++end;
+    }
+    t.get(pos.subspan(i, end - i), out.subspan(i, end - i), sampling);
+
+    // No data values may be covered by an overlapping tile.
+    if (!overlaps_[*tile]) {
+      i = end;
+      continue;
+    }
+    for (; i != end; ++i) {
+      if (out[i] != elevation_meters_t::invalid()) {
+        continue;
+      }
+      auto const q = pos[i].lnglat_float();
+      rtree_.search(
+          q, q, [&](auto const&, auto const&, std::size_t const& tile_idx) {
+            if (tile_idx != *tile) {
+              tiles_[tile_idx].get(pos.subspan(i, 1U), out.subspan(i, 1U),
+                                   sampling);
+            }
+            return out[i] != elevation_meters_t::invalid();
+          });
+    }
+  }
+}
+
+tile_idx_t tiff_driver::tile_idx(geo::latlng const& pos) const {
+  auto const p = pos.lnglat_float();
+  auto idx = tile_idx_t::invalid();
+  rtree_.search(p, p,
+                [&](auto const&, auto const&, std::size_t const& tile_idx) {
+                  idx = tiles_[tile_idx].tile_idx(pos);
+                  if (idx == tile_idx_t::invalid()) {
+                    return false;
+                  }
+                  idx.tile_idx_ = static_cast<tile_idx_t::data_t>(tile_idx);
+                  return true;
+                });
+  return idx;
+}
+
+resolution tiff_driver::max_resolution() const {
+  auto res = resolution{};
+  for (auto const& tile : tiles_) {
+    res.update(tile.max_resolution());
+  }
+  return res;
+}
+
+std::size_t tiff_driver::n_tiles() const { return tiles_.size(); }
+
+}  // namespace osr::preprocessing::elevation
@@ -0,0 +1,677 @@
+#include "osr/preprocessing/elevation/tiff_tile.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cinttypes>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "zlib.h"
+
+#include "utl/verify.h"
+
+#include "osr/preprocessing/elevation/dem_tile.h"
+
+// TIFF 6.0: https://www.itu.int/itudoc/itu-t/com16/tiff-fx/docs/tiff6.pdf
+// BigTIFF: https://www.awaresystems.be/imaging/tiff/bigtiff.html
+// GeoTIFF: https://docs.ogc.org/is/19-008r4/19-008r4.html
+// Cloud optimized GeoTIFF: https://docs.ogc.org/is/21-026/21-026.html
+
+namespace fs = std::filesystem;
+
+namespace osr::preprocessing::elevation {
+
+namespace {
+
+constexpr auto const kMaxIfds = 64U;
+constexpr auto const kMaxBlockPixels = std::uint64_t{1U} << 26U;
+
+enum tiff_tag : std::uint16_t {
+  kNewSubfileType = 254,
+  kImageWidth = 256,
+  kImageLength = 257,
+  kBitsPerSample = 258,
+  kCompression = 259,
+  kStripOffsets = 273,
+  kSamplesPerPixel = 277,
+  kRowsPerStrip = 278,
+  kStripByteCounts = 279,
+  kPredictor = 317,
+  kTileWidth = 322,
+  kTileLength = 323,
+  kTileOffsets = 324,
+  kTileByteCounts = 325,
+  kSampleFormat = 339,
+  kModelPixelScale = 33550,
+  kModelTiepoint = 33922,
+  kGeoKeyDirectory = 34735,
+  kGdalNoData = 42113
+};
+
+enum tiff_type : std::uint16_t {
+  kByte = 1,
+  kAscii = 2,
+  kShort = 3,
+  kLong = 4,
+  kDouble = 12,
+  kLong8 = 16,
+  kIfd8 = 18
+};
+
+enum geo_key : std::uint16_t { kModelType = 1024, kRasterType = 1025 };
+
+constexpr auto const kModelTypeProjected = 1U;
+constexpr auto const kRasterPixelIsPoint = 2U;
+
+constexpr auto const kSubfileReducedImage = 1U;
+constexpr auto const kSubfileMask = 4U;
+
+enum class compression : std::uint8_t { none, deflate };
+
+enum class predictor : std::uint8_t { none, horizontal, floating_point };
+
+struct ifd_entry {
+  std::uint16_t tag_;
+  std::uint16_t type_;
+  std::uint64_t count_;
+  std::size_t value_offset_;
+};
+
+struct reader {
+  template <typename T>
+  T read(std::size_t const offset) const {
+    utl::verify(offset <= data_.size() && sizeof(T) <= data_.size() - offset,
+                "tiff: offset {} out of bounds", offset);
+    auto x = T{};
+    std::memcpy(&x, data_.data() + offset, sizeof(T));
+    return swap_ ? std::byteswap(x) : x;
+  }
+
+  double read_double(std::size_t const offset) const {
+    return std::bit_cast<double>(read<std::uint64_t>(offset));
+  }
+
+  std::vector<ifd_entry> read_ifd(std::size_t const offset,
+                                  std::uint64_t& next) const {
+    auto const n = big_tiff_ ? read<std::uint64_t>(offset)
+                             : read<std::uint16_t>(offset);
+    auto const first = offset + (big_tiff_ ? 8U : 2U);
+    auto const entry_size = big_tiff_ ? 20U : 12U;
+    auto const inline_size = big_tiff_ ? 8U : 4U;
+    utl::verify(n <= (data_.size() - first) / entry_size,
+                "tiff: invalid directory at {}", offset);
+
+    auto entries = std::vector<ifd_entry>{};
+    for (auto i = std::uint64_t{0U}; i != n; ++i) {
+      auto const e = first + i * entry_size;
+      auto const type = read<std::uint16_t>(e + 2U);
+      auto const count = big_tiff_ ? read<std::uint64_t>(e + 4U)
+                                   : read<std::uint32_t>(e + 4U);
+      auto const value = e + (big_tiff_ ? 12U : 8U);
+      auto const is_inline = count * type_size(type) <= inline_size;
+      auto const value_offset =
+          is_inline ? value
+          : big_tiff_
+              ? static_cast<std::size_t>(read<std::uint64_t>(value))
+              : std::size_t{read<std::uint32_t>(value)};
+      entries.push_back({.tag_ = read<std::uint16_t>(e),
+                         .type_ = type,
+                         .count_ = count,
+                         .value_offset_ = value_offset});
+    }
+    auto const next_pos = first + n * entry_size;
+    next = big_tiff_ ? read<std::uint64_t>(next_pos)
+                     : read<std::uint32_t>(next_pos);
+    return entries;
+  }
+
+  std::vector<std::uint64_t> read_uints(ifd_entry const& e) const {
+    auto const size = type_size(e.type_);
+    utl::verify(size != 0U && e.count_ <= data_.size() / size,
+                "tiff: invalid tag {}", e.tag_);
+    auto values = std::vector<std::uint64_t>(e.count_);
+    for (auto i = std::size_t{0U}; i != values.size(); ++i) {
+      auto const offset = e.value_offset_ + i * size;
+      switch (e.type_) {
+        case kByte: values[i] = read<std::uint8_t>(offset); break;
+        case kShort: values[i] = read<std::uint16_t>(offset); break;
+        case kLong: values[i] = read<std::uint32_t>(offset); break;
+        case kLong8: [[fallthrough]];
+        case kIfd8: values[i] = read<std::uint64_t>(offset); break;
+        default: throw utl::fail("tiff: tag {} is not integral", e.tag_);
+      }
+    }
+    return values;
+  }
+
+  std::vector<double> read_doubles(ifd_entry const& e) const {
+    utl::verify(e.type_ == kDouble && e.count_ <= data_.size() / 8U,
+                "tiff: tag {} is not double", e.tag_);
+    auto values = std::vector<double>(e.count_);
+    for (auto i = std::size_t{0U}; i != values.size(); ++i) {
+      values[i] = read_double(e.value_offset_ + i * 8U);
+    }
+    return values;
+  }
+
+  std::string read_string(ifd_entry const& e) const {
+    utl::verify(e.type_ == kAscii && e.value_offset_ <= data_.size() &&
+                    e.count_ <= data_.size() - e.value_offset_,
+                "tiff: tag {} is not ascii", e.tag_);
+    auto const* first = reinterpret_cast<char const*>(data_.data()) +
+                        static_cast<std::ptrdiff_t>(e.value_offset_);
+    auto s = std::string{first, static_cast<std::size_t>(e.count_)};
+    s.erase(std::find(begin(s), end(s), '\0'), end(s));
+    return s;
+  }
+
+  static std::size_t type_size(std::uint16_t const type) {
+    switch (type) {
+      case kByte: [[fallthrough]];
+      case kAscii: return 1U;
+      case kShort: return 2U;
+      case kLong: return 4U;
+      case kDouble: [[fallthrough]];
+      case kLong8: [[fallthrough]];
+      case kIfd8: return 8U;
+      default: return 0U;
+    }
+  }
+
+  std::span<std::uint8_t const> data_;
+  bool swap_{false};
+  bool big_tiff_{false};
+};
+
+ifd_entry const* find(std::vector<ifd_entry> const& ifd,
+                      std::uint16_t const tag) {
+  auto const it = std::ranges::find(ifd, tag, &ifd_entry::tag_);
+  return it == end(ifd) ? nullptr : &*it;
+}
+
+std::uint64_t get_uint(reader const& r,
+                       std::vector<ifd_entry> const& ifd,
+                       std::uint16_t const tag,
+                       std::uint64_t const def) {
+  auto const e = find(ifd, tag);
+  if (e == nullptr || e->count_ == 0U) {
+    return def;
+  }
+  return r.read_uints(*e).front();
+}
+
+std::vector<std::uint64_t> get_uints(reader const& r,
+                                     std::vector<ifd_entry> const& ifd,
+                                     std::uint16_t const tag) {
+  auto const e = find(ifd, tag);
+  utl::verify(e != nullptr, "tiff: missing tag {}", tag);
+  return r.read_uints(*e);
+}
+
+// GDAL writes the no data value as text, e.g. "-32768", "nan" or "-inf".
+// Values that can not be parsed are ignored (NaN never matches a sample).
+double parse_nodata(std::string_view s) {
+  auto const is_space = [](char const c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+  };
+  while (!s.empty() && is_space(s.front())) {
+    s.remove_prefix(1U);
+  }
+  while (!s.empty() && is_space(s.back())) {
+    s.remove_suffix(1U);
+  }
+  if (s.starts_with('+')) {
+    s.remove_prefix(1U);
+  }
+  auto value = std::numeric_limits<double>::quiet_NaN();
+  auto const [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+  return ec == std::errc{} && ptr == s.data() + s.size()
+             ? value
+             : std::numeric_limits<double>::quiet_NaN();
+}
+
+// Byte plane i holds the i-th most significant byte of every sample.
+void undo_floating_point_predictor(std::uint8_t* row,
+                                   std::size_t const width,
+                                   std::size_t const bytes_per_sample) {
+  thread_local auto tmp = std::vector<std::uint8_t>{};
+  auto const n = width * bytes_per_sample;
+  for (auto i = std::size_t{1U}; i < n; ++i) {
+    row[i] = static_cast<std::uint8_t>(row[i] + row[i - 1U]);
+  }
+  tmp.assign(row, row + n);
+  for (auto x = std::size_t{0U}; x != width; ++x) {
+    for (auto b = std::size_t{0U}; b != bytes_per_sample; ++b) {
+      auto const native_b = std::endian::native == std::endian::little
+                                ? bytes_per_sample - 1U - b
+                                : b;
+      row[x * bytes_per_sample + native_b] = tmp[b * width + x];
+    }
+  }
+}
+
+}  // namespace
+
+struct tiff_tile::impl {
+  // One image: the full resolution image or an overview.
+  struct level {
+    std::uint32_t width_{0U};
+    std::uint32_t height_{0U};
+    std::uint32_t block_width_{0U};
+    std::uint32_t block_height_{0U};
+    std::uint32_t blocks_across_{0U};
+    double xdim_{0.};  // x pixel dimension, degrees
+    double ydim_{0.};  // y pixel dimension, degrees
+    std::vector<std::uint64_t> offsets_;
+    std::vector<std::uint64_t> byte_counts_;
+    compression compression_{compression::none};
+    predictor predictor_{predictor::none};
+  };
+
+  impl(fs::path const& path, tile_cache& files, block_cache& blocks)
+      : path_{path}, file_{files.add(path)}, blocks_{blocks} {
+    utl::verify(file_.tile_idx_ < (1U << 24U), "tiff: too many files");
+    read_header();
+  }
+
+  void read_header() {
+    auto const& file = file_.get();
+    auto r = reader{.data_ = {file.data(), file.size()}};
+    utl::verify(file.size() >= 8U, "tiff: '{}' too small", path_.string());
+
+    auto const byte_order = r.read<std::uint16_t>(0U);
+    utl::verify(byte_order == 0x4949U || byte_order == 0x4D4DU,
+                "tiff: '{}' invalid byte order", path_.string());
+    auto const file_big_endian = byte_order == 0x4D4DU;
+    r.swap_ = file_big_endian != (std::endian::native == std::endian::big);
+    swap_ = r.swap_;
+
+    auto const version = r.read<std::uint16_t>(2U);
+    utl::verify(version == 42U || version == 43U,
+                "tiff: '{}' invalid version {}", path_.string(), version);
+    r.big_tiff_ = version == 43U;
+    auto next = r.big_tiff_ ? r.read<std::uint64_t>(8U)
+                            : std::uint64_t{r.read<std::uint32_t>(4U)};
+
+    for (auto i = 0U; next != 0U && i != kMaxIfds; ++i) {
+      auto const ifd = r.read_ifd(static_cast<std::size_t>(next), next);
+      auto const subfile = get_uint(r, ifd, kNewSubfileType, 0U);
+      if ((subfile & kSubfileMask) != 0U) {
+        continue;
+      }
+      if (levels_.empty()) {
+        utl::verify((subfile & kSubfileReducedImage) == 0U,
+                    "tiff: '{}' starts with an overview", path_.string());
+        read_format(r, ifd);
+        read_geo(r, ifd);
+        levels_.push_back(read_level(r, ifd));
+      } else if ((subfile & kSubfileReducedImage) != 0U) {
+        levels_.push_back(read_level(r, ifd));
+      }
+    }
+    utl::verify(!levels_.empty(), "tiff: '{}' has no image", path_.string());
+
+    std::ranges::sort(levels_, std::greater{}, &level::width_);
+    auto const& full = levels_.front();
+    for (auto& l : levels_) {
+      l.xdim_ = xdim_ * full.width_ / l.width_;
+      l.ydim_ = ydim_ * full.height_ / l.height_;
+    }
+  }
+
+  void read_format(reader const& r, std::vector<ifd_entry> const& ifd) {
+    auto const bits = get_uint(r, ifd, kBitsPerSample, 1U);
+    auto const format = get_uint(r, ifd, kSampleFormat, 1U);
+    utl::verify(get_uint(r, ifd, kSamplesPerPixel, 1U) == 1U,
+                "tiff: '{}' has more than one band", path_.string());
+    if (bits == 16U && format == 2U) {
+      pixel_type_ = pixel_type::int16;
+      nodata_.int16_ = std::numeric_limits<std::int16_t>::min();
+    } else if (bits == 32U && format == 3U) {
+      pixel_type_ = pixel_type::float32;
+      nodata_.float32_ = std::numeric_limits<float>::quiet_NaN();
+    } else {
+      throw utl::fail("tiff: '{}' unsupported sample format {} ({} bits)",
+                      path_.string(), format, bits);
+    }
+
+    if (auto const e = find(ifd, kGdalNoData); e != nullptr) {
+      auto const value = parse_nodata(r.read_string(*e));
+      switch (pixel_type_) {
+        case pixel_type::int16:
+          if (std::abs(value) <= std::numeric_limits<std::int16_t>::max()) {
+            nodata_.int16_ = static_cast<std::int16_t>(std::round(value));
+          }
+          break;
+        case pixel_type::float32:
+          nodata_.float32_ = static_cast<float>(value);
+          break;
+      }
+    }
+  }
+
+  void read_geo(reader const& r, std::vector<ifd_entry> const& ifd) {
+    auto const scale = find(ifd, kModelPixelScale);
+    auto const tiepoint = find(ifd, kModelTiepoint);
+    utl::verify(scale != nullptr && tiepoint != nullptr,
+                "tiff: '{}' has no pixel scale / tiepoint", path_.string());
+    auto const s = r.read_doubles(*scale);
+    auto const t = r.read_doubles(*tiepoint);
+    utl::verify(s.size() >= 2U && t.size() >= 6U && s[0] > 0. && s[1] > 0.,
+                "tiff: '{}' invalid pixel scale / tiepoint", path_.string());
+
+    auto pixel_is_point = false;
+    if (auto const e = find(ifd, kGeoKeyDirectory); e != nullptr) {
+      auto const keys = r.read_uints(*e);
+      for (auto k = std::size_t{4U}; k + 3U < keys.size(); k += 4U) {
+        auto const inline_value = keys[k + 1U] == 0U;
+        if (keys[k] == kModelType && inline_value) {
+          utl::verify(keys[k + 3U] != kModelTypeProjected,
+                      "tiff: '{}' uses a projected coordinate system",
+                      path_.string());
+        } else if (keys[k] == kRasterType && inline_value) {
+          pixel_is_point = keys[k + 3U] == kRasterPixelIsPoint;
+        }
+      }
+    }
+
+    xdim_ = s[0];
+    ydim_ = s[1];
+    ulx_ = t[3] - t[0] * xdim_;
+    uly_ = t[4] + t[1] * ydim_;
+    if (pixel_is_point) {
+      ulx_ -= xdim_ / 2.;
+      uly_ += ydim_ / 2.;
+    }
+  }
+
+  level read_level(reader const& r, std::vector<ifd_entry> const& ifd) const {
+    auto l = level{};
+    l.width_ = static_cast<std::uint32_t>(get_uint(r, ifd, kImageWidth, 0U));
+    l.height_ = static_cast<std::uint32_t>(get_uint(r, ifd, kImageLength, 0U));
+    utl::verify(l.width_ != 0U && l.height_ != 0U,
+                "tiff: '{}' missing image size", path_.string());
+
+    switch (get_uint(r, ifd, kCompression, 1U)) {
+      case 1U: l.compression_ = compression::none; break;
+      case 8U: [[fallthrough]];
+      case 32946U: l.compression_ = compression::deflate; break;
+      default:
+        throw utl::fail("tiff: '{}' unsupported compression {}",
+                        path_.string(), get_uint(r, ifd, kCompression, 1U));
+    }
+
+    switch (get_uint(r, ifd, kPredictor, 1U)) {
+      case 1U: l.predictor_ = predictor::none; break;
+      case 2U:
+        utl::verify(pixel_type_ == pixel_type::int16,
+                    "tiff: '{}' horizontal predictor for float samples",
+                    path_.string());
+        l.predictor_ = predictor::horizontal;
+        break;
+      case 3U: l.predictor_ = predictor::floating_point; break;
+      default:
+        throw utl::fail("tiff: '{}' unsupported predictor {}", path_.string(),
+                        get_uint(r, ifd, kPredictor, 1U));
+    }
+
+    if (find(ifd, kTileWidth) != nullptr) {
+      l.block_width_ =
+          static_cast<std::uint32_t>(get_uint(r, ifd, kTileWidth, 0U));
+      l.block_height_ =
+          static_cast<std::uint32_t>(get_uint(r, ifd, kTileLength, 0U));
+      l.offsets_ = get_uints(r, ifd, kTileOffsets);
+      l.byte_counts_ = get_uints(r, ifd, kTileByteCounts);
+    } else {
+      l.block_width_ = l.width_;
+      l.block_height_ = static_cast<std::uint32_t>(
+          std::min(get_uint(r, ifd, kRowsPerStrip, l.height_),
+                   std::uint64_t{l.height_}));
+      l.offsets_ = get_uints(r, ifd, kStripOffsets);
+      l.byte_counts_ = get_uints(r, ifd, kStripByteCounts);
+    }
+    utl::verify(l.block_width_ != 0U && l.block_height_ != 0U &&
+                    std::uint64_t{l.block_width_} * l.block_height_ <=
+                        kMaxBlockPixels,
+                "tiff: '{}' invalid block size {}x{}", path_.string(),
+                l.block_width_, l.block_height_);
+
+    l.blocks_across_ = (l.width_ + l.block_width_ - 1U) / l.block_width_;
+    auto const blocks_down =
+        (l.height_ + l.block_height_ - 1U) / l.block_height_;
+    utl::verify(
+        l.offsets_.size() == std::size_t{l.blocks_across_} * blocks_down &&
+            l.byte_counts_.size() == l.offsets_.size(),
+        "tiff: '{}' expected {} blocks, got {}", path_.string(),
+        std::size_t{l.blocks_across_} * blocks_down, l.offsets_.size());
+    return l;
+  }
+
+  std::size_t get_level(resolution const& sampling) const {
+    auto best = std::size_t{0U};
+    for (auto i = std::size_t{1U}; i < levels_.size(); ++i) {
+      if (levels_[i].xdim_ <= sampling.x_ && levels_[i].ydim_ <= sampling.y_) {
+        best = i;
+      }
+    }
+    return best;
+  }
+
+  std::size_t pixel_size() const {
+    return pixel_type_ == pixel_type::int16 ? sizeof(std::int16_t)
+                                            : sizeof(float);
+  }
+
+  std::vector<elevation_meters_t> decode(level const& l,
+                                         std::uint32_t const block) const {
+    auto const block_row = block / l.blocks_across_;
+    // Strips (but not tiles) are truncated at the end of the image.
+    auto const rows =
+        l.block_width_ == l.width_
+            ? std::min(l.block_height_, l.height_ - block_row * l.block_height_)
+            : l.block_height_;
+    auto out = std::vector<elevation_meters_t>(
+        std::size_t{l.block_width_} * l.block_height_,
+        elevation_meters_t::invalid());
+
+    auto const offset = l.offsets_[block];
+    auto const size = l.byte_counts_[block];
+    if (size == 0U) {
+      return out;  // Sparse block, no data
+    }
+
+    auto const& file = file_.get();
+    utl::verify(offset <= file.size() && size <= file.size() - offset,
+                "tiff: '{}' block {} out of bounds", path_.string(), block);
+    auto const* src = file.data() + offset;
+
+    auto& buf = decode_buf();
+    auto const n_bytes = std::size_t{l.block_width_} * rows * pixel_size();
+    buf.resize(n_bytes);
+    switch (l.compression_) {
+      case compression::none:
+        utl::verify(size >= n_bytes, "tiff: '{}' block {} too small",
+                    path_.string(), block);
+        std::memcpy(buf.data(), src, n_bytes);
+        break;
+      case compression::deflate: {
+        auto len = static_cast<uLongf>(n_bytes);
+        auto const rc = uncompress(buf.data(), &len, src,
+                                   static_cast<uLong>(size));
+        utl::verify(rc == Z_OK && len == n_bytes,
+                    "tiff: '{}' block {} inflate failed ({})", path_.string(),
+                    block, rc);
+        break;
+      }
+    }
+
+    switch (pixel_type_) {
+      case pixel_type::int16:
+        decode_values<std::int16_t>(l, rows, out);
+        break;
+      case pixel_type::float32: decode_values<float>(l, rows, out); break;
+    }
+    return out;
+  }
+
+  template <typename T>
+  void decode_values(level const& l,
+                     std::uint32_t const rows,
+                     std::vector<elevation_meters_t>& out) const {
+    auto& buf = decode_buf();
+    auto const width = std::size_t{l.block_width_};
+    for (auto y = std::size_t{0U}; y != rows; ++y) {
+      auto* row = buf.data() + y * width * sizeof(T);
+      if (l.predictor_ == predictor::floating_point) {
+        undo_floating_point_predictor(row, width, sizeof(T));
+      } else if (swap_) {
+        for (auto x = std::size_t{0U}; x != width; ++x) {
+          std::reverse(row + x * sizeof(T), row + (x + 1U) * sizeof(T));
+        }
+      }
+
+      auto prev = T{};
+      for (auto x = std::size_t{0U}; x != width; ++x) {
+        auto value = T{};
+        std::memcpy(&value, row + x * sizeof(T), sizeof(T));
+        if constexpr (std::is_integral_v<T>) {
+          if (l.predictor_ == predictor::horizontal) {
+            using unsigned_t = std::make_unsigned_t<T>;
+            value = static_cast<T>(static_cast<unsigned_t>(value) +
+                                   static_cast<unsigned_t>(prev));
+            prev = value;
+          }
+        }
+        out[y * width + x] = to_meters(value, nodata_);
+      }
+    }
+  }
+
+  static std::vector<std::uint8_t>& decode_buf() {
+    thread_local auto buf = std::vector<std::uint8_t>{};
+    return buf;
+  }
+
+  block_cache::block_t get_block(std::size_t const level_idx,
+                                 std::uint32_t const block) const {
+    return blocks_.get(
+        {.tile_ = static_cast<std::uint32_t>(file_.tile_idx_),
+         .level_ = static_cast<std::uint8_t>(level_idx),
+         .block_ = block},
+        [&]() { return decode(levels_[level_idx], block); });
+  }
+
+  std::pair<std::uint32_t, std::uint32_t> get_pixel(
+      level const& l, geo::latlng const& pos) const {
+    auto const x = std::clamp((pos.lng_ - ulx_) / l.xdim_, 0.,
+                              static_cast<double>(l.width_ - 1U));
+    auto const y = std::clamp((uly_ - pos.lat_) / l.ydim_, 0.,
+                              static_cast<double>(l.height_ - 1U));
+    return {static_cast<std::uint32_t>(x), static_cast<std::uint32_t>(y)};
+  }
+
+  void get(std::span<geo::latlng const> pos,
+           std::span<elevation_meters_t> out,
+           std::size_t const level_idx) const {
+    constexpr auto const kNoBlock = std::numeric_limits<std::uint32_t>::max();
+
+    auto const& l = levels_[level_idx];
+    auto const box = get_box();
+    auto block_idx = kNoBlock;
+    auto block = block_cache::block_t{};
+    for (auto i = std::size_t{0U}; i != pos.size(); ++i) {
+      if (!box.contains(pos[i])) {
+        out[i] = elevation_meters_t::invalid();
+        continue;
+      }
+      auto const [x, y] = get_pixel(l, pos[i]);
+      auto const b =
+          (y / l.block_height_) * l.blocks_across_ + x / l.block_width_;
+      if (b != block_idx) {
+        block = get_block(level_idx, b);
+        block_idx = b;
+      }
+      out[i] = (*block)[(y % l.block_height_) * l.block_width_ +
+                        x % l.block_width_];
+    }
+  }
+
+  geo::box get_box() const {
+    auto const& full = levels_.front();
+    return {{uly_ - full.height_ * ydim_, ulx_},
+            {uly_, ulx_ + full.width_ * xdim_}};
+  }
+
+  fs::path path_;
+  tile_cache::handle file_;
+  block_cache& blocks_;
+  bool swap_{false};
+  pixel_type pixel_type_{pixel_type::int16};
+  pixel_value nodata_{};
+  double ulx_{0.};  // upper left lon
+  double uly_{0.};  // upper left lat
+  double xdim_{0.};  // x pixel dimension, degrees
+  double ydim_{0.};  // y pixel dimension, degrees
+  std::vector<level> levels_;  // full resolution first
+};
+
+tiff_tile::tiff_tile(fs::path const& path,
+                     tile_cache& files,
+                     block_cache& blocks)
+    : impl_{std::make_unique<impl>(path, files, blocks)} {}
+
+tiff_tile::~tiff_tile() = default;
+
+tiff_tile::tiff_tile(tiff_tile&&) noexcept = default;
+
+elevation_meters_t tiff_tile::get(geo::latlng const& pos) const {
+  auto meters = elevation_meters_t::invalid();
+  impl_->get({&pos, 1U}, {&meters, 1U}, 0U);
+  return meters;
+}
+
+void tiff_tile::get(std::span<geo::latlng const> pos,
+                    std::span<elevation_meters_t> out) const {
+  impl_->get(pos, out, 0U);
+}
+
+void tiff_tile::get(std::span<geo::latlng const> pos,
+                    std::span<elevation_meters_t> out,
+                    resolution const& sampling) const {
+  impl_->get(pos, out, impl_->get_level(sampling));
+}
+
+tile_idx_t tiff_tile::tile_idx(geo::latlng const& pos) const {
+  constexpr auto const kSegments = 1U << (tile_idx_t::kSubTileIdxSize / 2);
+  auto const box = impl_->get_box();
+  if (!box.contains(pos)) {
+    return tile_idx_t::invalid();
+  }
+  auto const segment = [&](double const from, double const to,
+                           double const x) {
+    return std::clamp(
+        static_cast<std::uint32_t>((x - from) / (to - from) * kSegments), 0U,
+        kSegments - 1U);
+  };
+  auto const column = segment(box.min_.lng_, box.max_.lng_, pos.lng_);
+  auto const row = segment(box.max_.lat_, box.min_.lat_, pos.lat_);
+  return tile_idx_t::from_sub_tile(row * kSegments + column);
+}
+
+geo::box tiff_tile::get_box() const { return impl_->get_box(); }
+
+resolution tiff_tile::max_resolution() const {
+  return {.x_ = impl_->xdim_, .y_ = impl_->ydim_};
+}
+
+std::size_t tiff_tile::n_levels() const { return impl_->levels_.size(); }
+
+}  // namespace osr::preprocessing::elevation
@@ -0,0 +1,112 @@
+#include "osr/preprocessing/elevation/tile_cache.h"
+
+#include <list>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "utl/verify.h"
+
+#include "osr/util/thread_slots.h"
+
+namespace fs = std::filesystem;
+
+namespace osr::preprocessing::elevation {
+
+namespace {
+
+using mapping_t = std::shared_ptr<cista::mmap const>;
+
+// Most recently used mapping of one thread.
+struct slot {
+  std::size_t tile_idx_{0U};
+  mapping_t mapping_{};
+};
+
+}  // namespace
+
+struct tile_cache::impl {
+  explicit impl(std::size_t const max_open) : max_open_{max_open} {}
+
+  struct entry {
+    fs::path path_;
+    mapping_t mapping_{};
+    std::list<std::size_t>::iterator lru_pos_{};
+  };
+
+  // Maps the file without holding the lock. Concurrent misses of the same
+  // tile may map it twice, the first inserted mapping is kept.
+  mapping_t get_mapping(std::size_t const tile_idx) {
+    {
+      auto const lock = std::lock_guard{mutex_};
+      if (auto const m = find(tile_idx); m != nullptr) {
+        return m;
+      }
+    }
+
+    auto mapping = std::make_shared<cista::mmap const>(
+        entries_.at(tile_idx).path_.string().c_str(),
+        cista::mmap::protection::READ);
+
+    auto evicted = std::vector<mapping_t>{};  // unmapped after unlocking
+    auto const lock = std::lock_guard{mutex_};
+    if (auto const m = find(tile_idx); m != nullptr) {
+      return m;
+    }
+    auto& e = entries_[tile_idx];
+    e.mapping_ = std::move(mapping);
+    e.lru_pos_ = lru_.insert(begin(lru_), tile_idx);
+    while (lru_.size() > max_open_) {
+      evicted.push_back(std::move(entries_[lru_.back()].mapping_));
+      lru_.pop_back();
+    }
+    return e.mapping_;
+  }
+
+  mapping_t find(std::size_t const tile_idx) {
+    auto& e = entries_.at(tile_idx);
+    if (e.mapping_ != nullptr) {
+      lru_.splice(begin(lru_), lru_, e.lru_pos_);
+    }
+    return e.mapping_;
+  }
+
+  std::size_t max_open_;
+  std::vector<entry> entries_;
+  std::list<std::size_t> lru_;
+  std::mutex mutex_;
+  thread_slots<slot> slots_;
+};
+
+tile_cache::tile_cache(std::size_t const max_open)
+    : impl_{std::make_unique<impl>(max_open)} {
+  utl::verify(max_open != 0U, "tile_cache: max_open must be positive");
+}
+
+tile_cache::~tile_cache() = default;
+
+tile_cache::handle tile_cache::add(fs::path p) {
+  impl_->entries_.push_back({.path_ = std::move(p)});
+  return {.cache_ = this, .tile_idx_ = impl_->entries_.size() - 1U};
+}
+
+cista::mmap const& tile_cache::get(std::size_t const tile_idx) const {
+  auto& s = impl_->slots_.get();
+  if (s.mapping_ == nullptr || s.tile_idx_ != tile_idx) {
+    s = {.tile_idx_ = tile_idx, .mapping_ = impl_->get_mapping(tile_idx)};
+  }
+  return *s.mapping_;
+}
+
+std::size_t tile_cache::n_tiles() const { return impl_->entries_.size(); }
+
+std::size_t tile_cache::n_open() const {
+  auto const lock = std::lock_guard{impl_->mutex_};
+  return impl_->lru_.size();
+}
+
+cista::mmap const& tile_cache::handle::get() const {
+  return cache_->get(tile_idx_);
+}
+
+}  // namespace osr::preprocessing::elevation
@@ -2,7 +2,10 @@
 
 #include <cstdint>
 #include <algorithm>
+#include <chrono>
 #include <optional>
+#include <span>
+#include <type_traits>
 
 #include "boost/thread/tss.hpp"
 
@@ -15,7 +18,11 @@
 #include "osr/elevation_storage.h"
 #include "osr/lookup.h"
 #include "osr/routing/bidirectional.h"
+#include "osr/routing/cancellation.h"
+#include "osr/routing/delta_stepping.h"
 #include "osr/routing/dijkstra.h"
+#include "osr/routing/landmarks.h"
+#include "osr/routing/path_arena.h"
 #include "osr/routing/path_reconstruction.h"
 #include "osr/routing/profiles/bike.h"
 #include "osr/routing/profiles/bike_sharing.h"
@@ -23,6 +30,7 @@
 #include "osr/routing/profiles/car_parking.h"
 #include "osr/routing/profiles/car_sharing.h"
 #include "osr/routing/profiles/foot.h"
+#include "osr/routing/search_stats.h"
 #include "osr/routing/sharing_data.h"
 #include "osr/routing/with_profile.h"
 #include "osr/util/infinite.h"
@@ -33,40 +41,127 @@ namespace osr {
 constexpr auto const kMaxMatchingDistanceSquaredRatio = 9.0;
 constexpr auto const kBottomKDefinitelyConsidered = 5;
 
-template <Profile P>
-bidirectional<P>& get_bidirectional() {
-  static auto s = boost::thread_specific_ptr<bidirectional<P>>{};
+template <typename Engine>
+Engine& get_thread_local() {
+  static auto s = boost::thread_specific_ptr<Engine>{};
   if (s.get() == nullptr) {
-    s.reset(new bidirectional<P>{});
+    s.reset(new Engine{});
   }
   return *s.get();
 }
 
+template <Profile P>
+bidirectional<P>& get_bidirectional() {
+  return get_thread_local<bidirectional<P>>();
+}
+
+thread_local auto store_connections = false;
+
+void set_store_connections(bool const x) { store_connections = x; }
+
 template <Profile P>
 dijkstra<P>& get_dijkstra() {
-  static auto s = boost::thread_specific_ptr<dijkstra<P>>{};
-  if (s.get() == nullptr) {
-    s.reset(new dijkstra<P>{});
+  auto& d = get_thread_local<dijkstra<P>>();
+  d.store_connections_ = store_connections;
+  return d;
+}
+
+// Cost map entry of a reached key.
+template <Profile P, bool WithStats>
+auto const& get_entry(dijkstra<P, false, WithStats> const& d,
+                      typename P::key const k) {
+  return d.cost_.at(k);
+}
+
+template <Profile P>
+auto const& get_entry(delta_stepping<P> const& d, typename P::key const k) {
+  return d.get_shard(k).cost_.at(k);
+}
+
+// Calls fn with the thread-local dijkstra. If stats are requested, the
+// instance with statistics enabled is used and its counters are copied out.
+template <Profile P, typename Fn>
+auto with_dijkstra(search_stats* stats, Fn&& fn) {
+  if (stats == nullptr) {
+    return fn(get_dijkstra<P>());
   }
-  return *s.get();
+  auto& d = get_thread_local<dijkstra<P, false, true>>();
+  d.store_connections_ = store_connections;
+  d.stats_ = {};
+  auto result = fn(d);
+  *stats = d.stats_;
+  return result;
+}
+
+// Calls fn with the thread-local engine of a one-to-many search.
+template <Profile P, typename Fn>
+auto with_one_to_many(bool const parallel, Fn&& fn) {
+  return parallel ? fn(get_thread_local<delta_stepping<P>>())
+                  : fn(get_dijkstra<P>());
+}
+
+template <Profile P, typename Fn>
+auto with_bidirectional(search_stats* stats, Fn&& fn) {
+  if (stats == nullptr) {
+    return fn(get_bidirectional<P>());
+  }
+  auto& b = get_thread_local<bidirectional<P, true>>();
+  b.stats_ = {};
+  auto result = fn(b);
+  *stats = b.total_stats();
+  return result;
+}
+
+// Measures the reconstruction for the search statistics and, if time is
+// set, for the caller (which does not need statistics enabled for that).
+template <typename Stats, typename Fn>
+auto timed_reconstruct(Stats& stats,
+                       std::chrono::microseconds* const time,
+                       Fn&& fn) {
+  constexpr auto const kWithStats = std::is_same_v<Stats, search_stats>;
+  if (!kWithStats && time == nullptr) {
+    return fn();
+  }
+  auto const start = std::chrono::steady_clock::now();
+  auto p = fn();
+  auto const duration = std::chrono::steady_clock::now() - start;
+  if constexpr (kWithStats) {
+    stats.reconstructed(duration);
+  }
+  if (time != nullptr) {
+    *time += std::chrono::duration_cast<std::chrono::microseconds>(duration);
+  }
+  return p;
 }
 
 routing_algorithm to_algorithm(std::string_view s) {
   switch (cista::hash(s)) {
     case cista::hash("dijkstra"): return routing_algorithm::kDijkstra;
     case cista::hash("bidirectional"): return routing_algorithm::kAStarBi;
+    case cista::hash("bidirectional_parallel"):
+      return routing_algorithm::kAStarBiParallel;
   }
   throw utl::fail("unknown routing algorithm: {}", s);
 }
 
-template <Profile P>
+std::string_view to_str(routing_algorithm const a) {
+  switch (a) {
+    case routing_algorithm::kDijkstra: return "dijkstra";
+    case routing_algorithm::kAStarBi: return "bidirectional";
+    case routing_algorithm::kAStarBiParallel: return "bidirectional_parallel";
+  }
+  throw utl::fail("{} is not a valid routing algorithm",
+                  static_cast<std::uint8_t>(a));
+}
+
+template <Profile P, bool WithStats>
 path reconstruct_bi(typename P::parameters const& params,
                     ways const& w,
                     lookup const& l,
                     bitvec<node_idx_t> const* blocked,
                     sharing_data const* sharing,
                     elevation_storage const* elevations,
-                    bidirectional<P> const& b,
+                    bidirectional<P, WithStats> const& b,
                     location const& from,
                     location const& to,
                     way_candidate const& start,
@@ -175,14 +270,98 @@ path reconstruct_bi(typename P::parameters const& params,
   return p;
 }
 
-template <Profile P>
+template <Profile P, typename Search>
+arena_path reconstruct_into(path_arena& arena,
+                            typename P::parameters const& params,
+                            ways const& w,
+                            lookup const& l,
+                            bitvec<node_idx_t> const* blocked,
+                            sharing_data const* sharing,
+                            elevation_storage const* elevations,
+                            Search const& d,
+                            location const& from,
+                            location const& to,
+                            way_candidate const& start,
+                            way_candidate const& dest,
+                            node_candidate const& dest_nc,
+                            typename P::node const dest_node,
+                            cost_t const cost,
+                            direction const dir) {
+  auto const segments_begin = arena.segments_.size();
+
+  auto n = dest_node;
+  arena.add_segment(
+      l.get_node_candidate_path(dest, dest_nc, dir == direction::kForward, to),
+      {.from_level_ = dest_nc.lvl_,
+       .to_level_ = dest_nc.lvl_,
+       .from_ =
+           dir == direction::kForward ? n.get_node() : node_idx_t::invalid(),
+       .to_ =
+           dir == direction::kBackward ? n.get_node() : node_idx_t::invalid(),
+       .way_ = way_idx_t::invalid(),
+       .cost_ = dest_nc.cost_,
+       .dist_ = static_cast<distance_t>(dest_nc.dist_to_node_),
+       .mode_ = dest_node.get_mode()});
+  auto dist = 0.0;
+  while (true) {
+    auto const& e = get_entry(d, n.get_key());
+    auto const pred = e.pred(n);
+    if (pred.has_value()) {
+      auto const expected_cost =
+          static_cast<cost_t>(e.cost(n) - d.get_cost(*pred));
+      dist += add_path<P>(params, w, *w.r_, blocked, sharing, elevations, *pred,
+                          n, expected_cost, arena, dir, d.get_connection(n));
+    } else {
+      break;
+    }
+    n = *pred;
+  }
+
+  auto const& start_nc =
+      n.get_node() == start.left_.node_ ? start.left_ : start.right_;
+  arena.add_segment(
+      l.get_node_candidate_path(start, start_nc, dir == direction::kBackward,
+                                from),
+      {.from_level_ = start_nc.lvl_,
+       .to_level_ = start_nc.lvl_,
+       .from_ =
+           dir == direction::kBackward ? n.get_node() : node_idx_t::invalid(),
+       .to_ = dir == direction::kForward ? n.get_node() : node_idx_t::invalid(),
+       .way_ = way_idx_t::invalid(),
+       .cost_ = start_nc.cost_,
+       .dist_ = static_cast<distance_t>(start_nc.dist_to_node_),
+       .mode_ = n.get_mode()});
+
+  auto const segments = std::span{arena.segments_}.subspan(segments_begin);
+  if (dir == direction::kForward) {
+    std::reverse(begin(segments), end(segments));
+  }
+  auto path_elevation = elevation_storage::elevation{};
+  for (auto const& segment : segments) {
+    path_elevation += segment.elevation_;
+  }
+
+  // Tracking information (elevator, track node) of the destination label.
+  auto tracked = path{};
+  get_entry(d, dest_node.get_key()).write(dest_node, tracked);
+
+  return {.cost_ = cost,
+          .dist_ = start_nc.dist_to_node_ + dist + dest_nc.dist_to_node_,
+          .elevation_ = path_elevation,
+          .segments_begin_ = static_cast<std::uint32_t>(segments_begin),
+          .segments_end_ = static_cast<std::uint32_t>(arena.segments_.size()),
+          .uses_elevator_ = tracked.uses_elevator_,
+          .track_node_ = tracked.track_node_};
+}
+
+template <Profile P, typename Search>
 path reconstruct(typename P::parameters const& params,
                  ways const& w,
                  lookup const& l,
                  bitvec<node_idx_t> const* blocked,
                  sharing_data const* sharing,
                  elevation_storage const* elevations,
-                 dijkstra<P> const& d,
+                 Search const& d,
                  location const& from,
                  location const& to,
                  way_candidate const& start,
@@ -191,7 +370,6 @@ path reconstruct(typename P::parameters const& params,
                  typename P::node const dest_node,
                  cost_t const cost,
                  direction const dir) {
-
   auto n = dest_node;
   auto segments = std::vector<path::segment>{
       {.polyline_ = l.get_node_candidate_path(dest, dest_nc,
@@ -208,13 +386,13 @@ path reconstruct(typename P::parameters const& params,
        .mode_ = dest_node.get_mode()}};
   auto dist = 0.0;
   while (true) {
-    auto const& e = d.cost_.at(n.get_key());
+    auto const& e = get_entry(d, n.get_key());
     auto const pred = e.pred(n);
     if (pred.has_value()) {
       auto const expected_cost =
           static_cast<cost_t>(e.cost(n) - d.get_cost(*pred));
       dist += add_path<P>(params, w, *w.r_, blocked, sharing, elevations, *pred,
-                          n, expected_cost, segments, dir);
+                          n, expected_cost, segments, dir, d.get_connection(n));
     } else {
       break;
     }
@@ -246,7 +424,7 @@ path reconstruct(typename P::parameters const& params,
                 .dist_ = start_nc.dist_to_node_ + dist + dest_nc.dist_to_node_,
                 .elevation_ = path_elevation,
                 .segments_ = segments};
-  d.cost_.at(dest_node.get_key()).write(dest_node, p);
+  get_entry(d, dest_node.get_key()).write(dest_node, p);
   return p;
 }
 
@@ -265,14 +443,14 @@ bool component_seen(ways const& w,
   return false;
 }
 
-template <Profile P>
+template <typename Search, Profile P = typename Search::profile_t>
 std::optional<std::tuple<node_candidate const*,
                          way_candidate const*,
                          typename P::node,
                          path>>
 best_candidate(typename P::parameters const& params,
                ways const& w,
-               dijkstra<P>& d,
+               Search& d,
                level_t const lvl,
                match_view_t m,
                cost_t const max,
@@ -360,29 +538,53 @@ std::optional<path> try_direct(osr::location const& from,
   }
 }
 
-template <Profile P>
-std::optional<path> route_bidirectional(typename P::parameters const& params,
-                                        ways const& w,
-                                        lookup const& l,
-                                        bidirectional<P>& b,
-                                        location const& from,
-                                        location const& to,
-                                        match_view_t from_match,
-                                        match_view_t to_match,
-                                        cost_t const max,
-                                        direction const dir,
-                                        bitvec<node_idx_t> const* blocked,
-                                        sharing_data const* sharing,
-                                        elevation_storage const* elevations) {
+template <Profile P, bool WithStats>
+std::optional<path> route_bidirectional(
+    typename P::parameters const& params,
+    ways const& w,
+    lookup const& l,
+    bidirectional<P, WithStats>& b,
+    location const& from,
+    location const& to,
+    match_view_t from_match,
+    match_view_t to_match,
+    cost_t const max,
+    direction const dir,
+    bitvec<node_idx_t> const* blocked,
+    sharing_data const* sharing,
+    elevation_storage const* elevations,
+    landmarks const* lm,
+    bool const parallel,
+    cancellation_token const* cancel,
+    std::chrono::microseconds* reconstruct_time) {
   if (auto const direct = try_direct(from, to); direct.has_value()) {
     return *direct;
   }
 
   b.reset(params, max, from, to);
+  b.cancel_.token_ = cancel;
   if (b.radius_ == max) {
     return std::nullopt;
   }
 
+  if (lm != nullptr) {
+    b.alt_.reset(lm, dir);
+    for (auto const& m : from_match) {
+      for (auto const* nc : {&m.left_, &m.right_}) {
+        if (nc->valid()) {
+          b.alt_.add_source(nc->node_);
+        }
+      }
+    }
+    for (auto const& m : to_match) {
+      for (auto const* nc : {&m.left_, &m.right_}) {
+        if (nc->valid()) {
+          b.alt_.add_target(nc->node_);
+        }
+      }
+    }
+  }
+
   auto const limit_squared_max_matching_distance =
       geo::approx_squared_distance(from.pos_, to.pos_,
                                    b.distance_lon_degrees_) /
@@ -433,7 +635,13 @@ std::optional<path> route_bidirectional(typename P::parameters const& params,
         continue;
       }
       auto const should_continue =
-          b.run(params, w, *w.r_, max, blocked, sharing, elevations, dir);
+          parallel ? b.run_parallel(params, w, *w.r_, max, blocked, sharing,
+                                    elevations, dir)
+                   : b.run(params, w, *w.r_, max, blocked, sharing,
+                           elevations, dir);
+      if (b.cancel_.cancelled_) {
+        throw search_cancelled{};
+      }
 
       if (b.meet_point_1_.get_node() == node_idx_t::invalid()) {
         if (should_continue) {
@@ -444,8 +652,10 @@ std::optional<path> route_bidirectional(typename P::parameters const& params,
 
       auto const cost = b.get_cost_to_mp(b.meet_point_1_, b.meet_point_2_);
 
-      return reconstruct_bi(params, w, l, blocked, sharing, elevations, b, from,
-                            to, start, end, cost, dir);
+      return timed_reconstruct(b.stats_[0], reconstruct_time, [&]() {
+        return reconstruct_bi(params, w, l, blocked, sharing, elevations, b,
+                              from, to, start, end, cost, dir);
+      });
     }
     b.pq1_.clear();
     b.pq2_.clear();
@@ -455,20 +665,23 @@ std::optional<path> route_bidirectional(typename P::parameters const& params,
   return std::nullopt;
 }
 
-template <Profile P>
-std::optional<path> route_dijkstra(typename P::parameters const& params,
-                                   ways const& w,
-                                   lookup const& l,
-                                   dijkstra<P>& d,
-                                   location const& from,
-                                   location const& to,
-                                   match_view_t from_match,
-                                   match_view_t to_match,
-                                   cost_t const max,
-                                   direction const dir,
-                                   bitvec<node_idx_t> const* blocked,
-                                   sharing_data const* sharing,
-                                   elevation_storage const* elevations) {
+template <Profile P, bool WithStats>
+std::optional<path> route_dijkstra(
+    typename P::parameters const& params,
+    ways const& w,
+    lookup const& l,
+    dijkstra<P, false, WithStats>& d,
+    location const& from,
+    location const& to,
+    match_view_t from_match,
+    match_view_t to_match,
+    cost_t const max,
+    direction const dir,
+    bitvec<node_idx_t> const* blocked,
+    sharing_data const* sharing,
+    elevation_storage const* elevations,
+    cancellation_token const* cancel,
+    std::chrono::microseconds* reconstruct_time) {
   if (auto const direct = try_direct(from, to); direct.has_value()) {
     return *direct;
   }
@@ -478,6 +691,7 @@ std::optional<path> route_dijkstra(typename P::parameters const& params,
       kMaxMatchingDistanceSquaredRatio;
 
   d.reset(max);
+  d.cancel_.token_ = cancel;
   auto should_continue = true;
   for (auto const [i, start] : utl::enumerate(from_match)) {
     if (!should_continue && component_seen(w, from_match, i)) {
@@ -505,26 +719,36 @@ std::optional<path> route_dijkstra(typename P::parameters const& params,
     should_continue =
         d.run(params, w, *w.r_, max, blocked, sharing, elevations, dir) &&
         should_continue;
+    if (d.cancel_.cancelled_) {
+      throw search_cancelled{};
+    }
 
     auto const c = best_candidate(params, w, d, to.lvl_, to_match, max, dir,
                                   should_continue, start,
                                   limit_squared_max_matching_distance);
     if (c.has_value()) {
       auto const [nc, wc, node, p] = *c;
-      return reconstruct<P>(params, w, l, blocked, sharing, elevations, d, from,
-                            to, start, *wc, *nc, node, p.cost_, dir);
+      return timed_reconstruct(d.stats_, reconstruct_time, [&]() {
+        return reconstruct<P>(params, w, l, blocked, sharing, elevations, d,
+                              from, to, start, *wc, *nc, node, p.cost_, dir);
+      });
     }
   }
 
   return std::nullopt;
 }
 
-template <Profile P>
-std::vector<std::optional<path>> route(
+// One-to-many search with dijkstra or delta_stepping. Result is either path
+// or arena_path. For arena_path, reconstructed (and direct) paths are written
+// to the arena.
+template <typename Result,
+          typename Search,
+          Profile P = typename Search::profile_t>
+std::vector<std::optional<Result>> route_one_to_many(
     typename P::parameters const& params,
     ways const& w,
     lookup const& l,
-    dijkstra<P>& d,
+    Search& d,
     location const& from,
     std::vector<location> const& to,
     match_view_t from_match,
@@ -534,8 +758,11 @@ std::vector<std::optional<path>> route(
     bitvec<node_idx_t> const* blocked,
     sharing_data const* sharing,
     elevation_storage const* elevations,
-    std::function<bool(path const&)> const& do_reconstruct) {
-  auto result = std::vector<std::optional<path>>{};
+    std::function<bool(path const&)> const& do_reconstruct,
+    path_arena* arena = nullptr) {
+  constexpr auto const kToArena = std::is_same_v<Result, arena_path>;
+
+  auto result = std::vector<std::optional<Result>>{};
   result.resize(to_match.size());
 
   if (from_match.empty()) {
@@ -571,7 +798,11 @@ std::vector<std::optional<path>> route(
       if (r.has_value()) {
         ++found;
       } else if (auto const direct = try_direct(from, t); direct.has_value()) {
-        r = direct;
+        if constexpr (kToArena) {
+          r = arena->append(*direct);
+        } else {
+          r = direct;
+        }
       } else {
         auto const limit_squared_max_matching_distance =
             geo::approx_squared_distance(from.pos_, t.pos_,
@@ -583,13 +814,37 @@ std::vector<std::optional<path>> route(
                            start, limit_squared_max_matching_distance);
         if (c.has_value()) {
           auto [nc, wc, n, p] = *c;
-          d.cost_.at(n.get_key()).write(n, p);
-          if (do_reconstruct(p)) {
-            p = reconstruct<P>(params, w, l, blocked, sharing, elevations, d,
-                               from, t, start, *wc, *nc, n, p.cost_, dir);
-            p.uses_elevator_ = true;
+          get_entry(d, n.get_key()).write(n, p);
+          if constexpr (kToArena) {
+            if (do_reconstruct(p)) {
+              r = timed_reconstruct(d.stats_, nullptr, [&]() {
+                return reconstruct_into<P>(*arena, params, w, l, blocked,
+                                           sharing, elevations, d, from, t,
+                                           start, *wc, *nc, n, p.cost_, dir);
+              });
+              r->uses_elevator_ = true;
+            } else {
+              auto const at =
+                  static_cast<std::uint32_t>(arena->segments_.size());
+              r = arena_path{.cost_ = p.cost_,
+                             .dist_ = p.dist_,
+                             .elevation_ = p.elevation_,
+                             .segments_begin_ = at,
+                             .segments_end_ = at,
+                             .uses_elevator_ = p.uses_elevator_,
+                             .track_node_ = p.track_node_};
+            }
+          } else {
+            if (do_reconstruct(p)) {
+              p = timed_reconstruct(d.stats_, nullptr, [&]() {
+                return reconstruct<P>(params, w, l, blocked, sharing,
+                                      elevations, d, from, t, start, *wc, *nc,
+                                      n, p.cost_, dir);
+              });
+              p.uses_elevator_ = true;
+            }
+            r = std::make_optional(p);
           }
-          r = std::make_optional(p);
           ++found;
         }
       }
@@ -603,18 +858,24 @@ std::vector<std::optional<path>> route(
   return result;
 }
 
-std::optional<path> route_bidirectional(profile_parameters const& params,
-                                        ways const& w,
-                                        lookup const& l,
-                                        search_profile const profile,
-                                        location const& from,
-                                        location const& to,
-                                        cost_t const max,
-                                        direction const dir,
-                                        double const max_match_distance,
-                                        bitvec<node_idx_t> const* blocked,
-                                        sharing_data const* sharing,
-                                        elevation_storage const* elevations) {
+std::optional<path> route_bidirectional(
+    profile_parameters const& params,
+    ways const& w,
+    lookup const& l,
+    search_profile const profile,
+    location const& from,
+    location const& to,
+    cost_t const max,
+    direction const dir,
+    double const max_match_distance,
+    bitvec<node_idx_t> const* blocked,
+    sharing_data const* sharing,
+    elevation_storage const* elevations,
+    landmarks const* lm,
+    bool const parallel,
+    search_stats* stats,
+    cancellation_token const* cancel,
+    std::chrono::microseconds* reconstruct_time) {
   return with_profile(profile, [&]<Profile P>(P&&) -> std::optional<path> {
     auto const& pp = std::get<typename P::parameters>(params);
     auto const from_match =
@@ -626,9 +887,11 @@ std::optional<path> route_bidirectional(profile_parameters const& params,
       return std::nullopt;
     }
 
-    return route_bidirectional(pp, w, l, get_bidirectional<P>(), from, to,
-                               from_match, to_match, max, dir, blocked, sharing,
-                               elevations);
+    return with_bidirectional<P>(stats, [&](auto& b) {
+      return route_bidirectional(pp, w, l, b, from, to, from_match, to_match,
+                                 max, dir, blocked, sharing, elevations, lm,
+                                 parallel, cancel, reconstruct_time);
+    });
   });
 }
 
@@ -645,7 +908,8 @@ std::vector<std::optional<path>> route(
     bitvec<node_idx_t> const* blocked,
     sharing_data const* sharing,
     elevation_storage const* elevations,
-    std::function<bool(path const&)> const& do_reconstruct) {
+    std::function<bool(path const&)> const& do_reconstruct,
+    bool const parallel) {
   return with_profile(
       profile, [&]<Profile P>(P&&) -> std::vector<std::optional<path>> {
         auto const& pp = std::get<typename P::parameters>(params);
@@ -657,24 +921,65 @@ std::vector<std::optional<path>> route(
         auto const to_match = utl::to_vec(to, [&](auto&& x) {
           return l.match<P>(pp, x, true, dir, max_match_distance, blocked);
         });
-        return route(pp, w, l, get_dijkstra<P>(), from, to, from_match,
-                     to_match, max, dir, blocked, sharing, elevations,
-                     do_reconstruct);
+        return with_one_to_many<P>(parallel, [&](auto& d) {
+          return route_one_to_many<path>(pp, w, l, d, from, to, from_match,
+                                         to_match, max, dir, blocked, sharing,
+                                         elevations, do_reconstruct);
+        });
+      });
+}
+
+std::vector<std::optional<arena_path>> route(
+    profile_parameters const& params,
+    ways const& w,
+    lookup const& l,
+    search_profile const profile,
+    location const& from,
+    std::vector<location> const& to,
+    cost_t const max,
+    direction const dir,
+    double const max_match_distance,
+    path_arena& arena,
+    bitvec<node_idx_t> const* blocked,
+    sharing_data const* sharing,
+    elevation_storage const* elevations,
+    std::function<bool(path const&)> const& do_reconstruct,
+    bool const parallel) {
+  return with_profile(
+      profile, [&]<Profile P>(P&&) -> std::vector<std::optional<arena_path>> {
+        auto const& pp = std::get<typename P::parameters>(params);
+        auto const from_match =
+            l.match<P>(pp, from, false, dir, max_match_distance, blocked);
+        if (from_match.empty()) {
+          return std::vector<std::optional<arena_path>>(to.size());
+        }
+        auto const to_match = utl::to_vec(to, [&](auto&& x) {
+          return l.match<P>(pp, x, true, dir, max_match_distance, blocked);
+        });
+        return with_one_to_many<P>(parallel, [&](auto& d) {
+          return route_one_to_many<arena_path>(
+              pp, w, l, d, from, to, from_match, to_match, max, dir, blocked,
+              sharing, elevations, do_reconstruct, &arena);
+        });
       });
 }
 
-std::optional<path> route_dijkstra(profile_parameters const& params,
-                                   ways const& w,
-                                   lookup const& l,
-                                   search_profile const profile,
-                                   location const& from,
-                                   location const& to,
-                                   cost_t const max,
-                                   direction const dir,
-                                   double const max_match_distance,
-                                   bitvec<node_idx_t> const* blocked,
-                                   sharing_data const* sharing,
-                                   elevation_storage const* elevations) {
+std::optional<path> route_dijkstra(
+    profile_parameters const& params,
+    ways const& w,
+    lookup const& l,
+    search_profile const profile,
+    location const& from,
+    location const& to,
+    cost_t const max,
+    direction const dir,
+    double const max_match_distance,
+    bitvec<node_idx_t> const* blocked,
+    sharing_data const* sharing,
+    elevation_storage const* elevations,
+    search_stats* stats,
+    cancellation_token const* cancel,
+    std::chrono::microseconds* reconstruct_time) {
   return with_profile(profile, [&]<Profile P>(P&&) -> std::optional<path> {
     auto const& pp = std::get<typename P::parameters>(params);
     auto const from_match =
@@ -686,8 +991,11 @@ std::optional<path> route_dijkstra(profile_parameters const& params,
       return std::nullopt;
     }
 
-    return route_dijkstra(pp, w, l, get_dijkstra<P>(), from, to, from_match,
-                          to_match, max, dir, blocked, sharing, elevations);
+    return with_dijkstra<P>(stats, [&](auto& d) {
+      return route_dijkstra(pp, w, l, d, from, to, from_match, to_match, max,
+                            dir, blocked, sharing, elevations, cancel,
+                            reconstruct_time);
+    });
   });
 }
 
@@ -705,14 +1013,18 @@ std::vector<std::optional<path>> route(
     bitvec<node_idx_t> const* blocked,
     sharing_data const* sharing,
     elevation_storage const* elevations,
-    std::function<bool(path const&)> const& do_reconstruct) {
+    std::function<bool(path const&)> const& do_reconstruct,
+    bool const parallel) {
   if (from_match.empty()) {
     return std::vector<std::optional<path>>(to.size());
   }
   return with_profile(profile, [&]<Profile P>(P&&) {
-    return route(std::get<typename P::parameters>(params), w, l,
-                 get_dijkstra<P>(), from, to, from_match, to_match, max, dir,
-                 blocked, sharing, elevations, do_reconstruct);
+    return with_one_to_many<P>(parallel, [&](auto& d) {
+      return route_one_to_many<path>(std::get<typename P::parameters>(params),
+                                     w, l, d, from, to, from_match, to_match,
+                                     max, dir, blocked, sharing, elevations,
+                                     do_reconstruct);
+    });
   });
 }
 
@@ -729,29 +1041,49 @@ std::optional<path> route(profile_parameters const& params,
                           bitvec<node_idx_t> const* blocked,
                           sharing_data const* sharing,
                           elevation_storage const* elevations,
-                          routing_algorithm algo) {
+                          routing_algorithm algo,
+                          landmarks const* lm,
+                          search_stats* stats,
+                          cancellation_token const* cancel,
+                          std::chrono::microseconds* reconstruct_time) {
   if (from_match.empty() || to_match.empty()) {
     return std::nullopt;
   }
 
+  utl::verify(lm == nullptr || lm->profile_ == profile,
+              "landmarks for profile {} used with profile {}",
+              lm == nullptr ? "" : to_str(lm->profile_), to_str(profile));
+  if (lm != nullptr && !lm->matches(params)) {
+    lm = nullptr;  // Computed with other parameters: bounds not admissible.
+  }
+
   if (profile == search_profile::kBikeSharing ||
-      profile == search_profile::kCarSharing) {
+      profile == search_profile::kCarSharing ||
+      profile == search_profile::kCarParkingWheelchair ||
+      profile == search_profile::kCarParking) {
     algo = routing_algorithm::kDijkstra;  // TODO
   }
 
   switch (algo) {
     case routing_algorithm::kDijkstra:
       return with_profile(profile, [&]<Profile P>(P&&) {
-        return route_dijkstra(std::get<typename P::parameters>(params), w, l,
-                              get_dijkstra<P>(), from, to, from_match, to_match,
-                              max, dir, blocked, sharing, elevations);
+        return with_dijkstra<P>(stats, [&](auto& d) {
+          return route_dijkstra(std::get<typename P::parameters>(params), w, l,
+                                d, from, to, from_match, to_match, max, dir,
+                                blocked, sharing, elevations, cancel,
+                                reconstruct_time);
+        });
       });
     case routing_algorithm::kAStarBi:
+    case routing_algorithm::kAStarBiParallel:
       return with_profile(profile, [&]<Profile P>(P&&) {
-        return route_bidirectional(std::get<typename P::parameters>(params), w,
-                                   l, get_bidirectional<P>(), from, to,
-                                   from_match, to_match, max, dir, blocked,
-                                   sharing, elevations);
+        return with_bidirectional<P>(stats, [&](auto& b) {
+          return route_bidirectional(
+              std::get<typename P::parameters>(params), w, l, b, from, to,
+              from_match, to_match, max, dir, blocked, sharing, elevations, lm,
+              algo == routing_algorithm::kAStarBiParallel, cancel,
+              reconstruct_time);
+        });
       });
   }
   throw utl::fail("not implemented");
@@ -769,7 +1101,17 @@ std::optional<path> route(profile_parameters const& params,
                           bitvec<node_idx_t> const* blocked,
                           sharing_data const* sharing,
                           elevation_storage const* elevations,
-                          routing_algorithm algo) {
+                          routing_algorithm algo,
+                          landmarks const* lm,
+                          search_stats* stats,
+                          cancellation_token const* cancel,
+                          std::chrono::microseconds* reconstruct_time) {
+  utl::verify(lm == nullptr || lm->profile_ == profile,
+              "landmarks for profile {} used with profile {}",
+              lm == nullptr ? "" : to_str(lm->profile_), to_str(profile));
+  if (lm != nullptr && !lm->matches(params)) {
+    lm = nullptr;  // Computed with other parameters: bounds not admissible.
+  }
   if (profile == search_profile::kBikeSharing ||
       profile == search_profile::kCarSharing ||
       profile == search_profile::kCarParkingWheelchair ||
@@ -779,11 +1121,15 @@ std::optional<path> route(profile_parameters const& params,
   switch (algo) {
     case routing_algorithm::kDijkstra:
       return route_dijkstra(params, w, l, profile, from, to, max, dir,
-                            max_match_distance, blocked, sharing, elevations);
+                            max_match_distance, blocked, sharing, elevations,
+                            stats, cancel, reconstruct_time);
     case routing_algorithm::kAStarBi:
+    case routing_algorithm::kAStarBiParallel:
       return route_bidirectional(params, w, l, profile, from, to, max, dir,
                                  max_match_distance, blocked, sharing,
-                                 elevations);
+                                 elevations, lm,
+                                 algo == routing_algorithm::kAStarBiParallel,
+                                 stats, cancel, reconstruct_time);
   }
   throw utl::fail("not implemented");
 }
@@ -0,0 +1,146 @@
+#include "osr/route_encoding.h"
+
+#include "utl/verify.h"
+
+#include "osr/json_writer.h"
+#include "osr/ways.h"
+
+namespace osr {
+
+namespace {
+
+// Rounds half away from zero, like the reference implementation.
+std::int32_t round_div(std::int32_t const x, std::int32_t const d) {
+  return x >= 0 ? (x + d / 2) / d : -((-x + d / 2) / d);
+}
+
+void encode_signed(std::string& out, std::int32_t const v) {
+  auto x = static_cast<std::uint32_t>(v) << 1U;
+  if (v < 0) {
+    x = ~x;
+  }
+  while (x >= 0x20U) {
+    out.push_back(static_cast<char>((0x20U | (x & 0x1FU)) + 63U));
+    x >>= 5U;
+  }
+  out.push_back(static_cast<char>(x + 63U));
+}
+
+void write_varint(std::string& out, std::uint64_t x) {
+  while (x >= 0x80U) {
+    out.push_back(static_cast<char>((x & 0x7FU) | 0x80U));
+    x >>= 7U;
+  }
+  out.push_back(static_cast<char>(x));
+}
+
+std::uint64_t zigzag(std::int64_t const x) {
+  return (static_cast<std::uint64_t>(x) << 1U) ^
+         static_cast<std::uint64_t>(x >> 63);
+}
+
+std::uint64_t get_osm_way_id(ways const& w, path::segment const& s) {
+  return s.way_ == way_idx_t::invalid() ? 0U : to_idx(w.way_osm_idx_[s.way_]);
+}
+
+}  // namespace
+
+polyline_encoder::polyline_encoder(std::string& out, unsigned const precision)
+    : out_{out}, divisor_{precision == 6U ? 10 : 100} {
+  utl::verify(precision == 5U || precision == 6U,
+              "polyline precision must be 5 or 6, got {}", precision);
+}
+
+void polyline_encoder::add(fixed_coord const c) {
+  auto const lat = round_div(c.lat_, divisor_);
+  auto const lng = round_div(c.lng_, divisor_);
+  encode_signed(out_, lat - prev_lat_);
+  encode_signed(out_, lng - prev_lng_);
+  prev_lat_ = lat;
+  prev_lng_ = lng;
+}
+
+std::vector<geo::latlng> decode_polyline(std::string_view const s,
+                                         unsigned const precision) {
+  auto const factor = precision == 6U ? 1e6 : 1e5;
+  auto i = std::size_t{0U};
+  auto const next = [&]() {
+    auto result = std::uint32_t{0U};
+    auto shift = 0U;
+    auto b = 0U;
+    do {
+      utl::verify(i < s.size(), "decode_polyline: unexpected end");
+      b = static_cast<unsigned>(static_cast<unsigned char>(s[i++])) - 63U;
+      result |= (b & 0x1FU) << shift;
+      shift += 5U;
+    } while (b >= 0x20U);
+    return (result & 1U) != 0U ? ~static_cast<std::int32_t>(result >> 1U)
+                               : static_cast<std::int32_t>(result >> 1U);
+  };
+
+  auto line = std::vector<geo::latlng>{};
+  auto lat = std::int32_t{0};
+  auto lng = std::int32_t{0};
+  while (i < s.size()) {
+    lat += next();
+    lng += next();
+    line.emplace_back(lat / factor, lng / factor);
+  }
+  return line;
+}
+
+void write_encoded_polyline_route(std::string& out,
+                                  ways const& w,
+                                  path const& p,
+                                  unsigned const precision) {
+  auto j = json_writer{out};
+  j.begin_object();
+  j.key("metadata")
+      .begin_object()
+      .member("duration", p.cost_)
+      .member("distance", p.dist_)
+      .end_object();
+  j.member("precision", precision);
+  j.key("segments").begin_array();
+  auto encoded = std::string{};
+  for (auto const& s : p.segments_) {
+    encoded.clear();
+    auto enc = polyline_encoder{encoded, precision};
+    enc.add_all(s.polyline_);
+    j.begin_object()
+        .member("level", s.from_level_.to_float())
+        .member("osm_way_id", get_osm_way_id(w, s))
+        .member("cost", s.cost_)
+        .member("distance", s.dist_)
+        .member("polyline", std::string_view{encoded})
+        .end_object();
+  }
+  j.end_array();
+  j.end_object();
+}
+
+void write_binary_route(std::string& out, ways const& w, path const& p) {
+  out.append("OSR");
+  out.push_back(1);
+  write_varint(out, p.cost_);
+  write_varint(out, static_cast<std::uint64_t>(std::llround(p.dist_)));
+  write_varint(out, p.segments_.size());
+
+  auto prev = fixed_coord{0, 0};
+  for (auto const& s : p.segments_) {
+    write_varint(out, get_osm_way_id(w, s));
+    write_varint(out, s.cost_);
+    write_varint(out, s.dist_);
+    out.push_back(static_cast<char>(to_idx(s.from_level_)));
+    out.push_back(static_cast<char>(s.mode_));
+    write_varint(out, s.polyline_.size());
+    for (auto const& x : s.polyline_) {
+      auto const c = to_fixed(x);
+      write_varint(out, zigzag(std::int64_t{c.lat_} - prev.lat_));
+      write_varint(out, zigzag(std::int64_t{c.lng_} - prev.lng_));
+      prev = c;
+    }
+  }
+}
+
+}  // namespace osr
@@ -0,0 +1,64 @@
+#include "osr/routing/path_arena.h"
+
+namespace osr {
+
+void path_arena::add_segment(std::span<geo::latlng const> polyline,
+                             arena_segment s) {
+  s.points_begin_ = static_cast<std::uint32_t>(points_.size());
+  points_.insert(end(points_), begin(polyline), end(polyline));
+  s.points_end_ = static_cast<std::uint32_t>(points_.size());
+  segments_.push_back(s);
+}
+
+arena_path path_arena::append(path const& p) {
+  auto const segments_begin = static_cast<std::uint32_t>(segments_.size());
+  for (auto const& s : p.segments_) {
+    add_segment(s.polyline_, {.from_level_ = s.from_level_,
+                              .to_level_ = s.to_level_,
+                              .from_ = s.from_,
+                              .to_ = s.to_,
+                              .way_ = s.way_,
+                              .cost_ = s.cost_,
+                              .dist_ = s.dist_,
+                              .elevation_ = s.elevation_,
+                              .mode_ = s.mode_});
+  }
+  return {.cost_ = p.cost_,
+          .dist_ = p.dist_,
+          .elevation_ = p.elevation_,
+          .segments_begin_ = segments_begin,
+          .segments_end_ = static_cast<std::uint32_t>(segments_.size()),
+          .uses_elevator_ = p.uses_elevator_,
+          .track_node_ = p.track_node_};
+}
+
+path path_arena::to_path(arena_path const& p) const {
+  auto const s = segments(p);
+  auto result = path{.cost_ = p.cost_,
+                     .dist_ = p.dist_,
+                     .elevation_ = p.elevation_,
+                     .uses_elevator_ = p.uses_elevator_,
+                     .track_node_ = p.track_node_};
+  result.segments_.reserve(s.size());
+  for (auto const& x : s) {
+    auto const line = polyline(x);
+    result.segments_.push_back({.polyline_ = {begin(line), end(line)},
+                                .from_level_ = x.from_level_,
+                                .to_level_ = x.to_level_,
+                                .from_ = x.from_,
+                                .to_ = x.to_,
+                                .way_ = x.way_,
+                                .cost_ = x.cost_,
+                                .dist_ = x.dist_,
+                                .elevation_ = x.elevation_,
+                                .mode_ = x.mode_});
+  }
+  return result;
+}
+
+path_arena& get_thread_local_path_arena() {
+  thread_local auto arena = path_arena{};
+  return arena;
+}
+
+}  // namespace osr
@@ -0,0 +1,110 @@
+#include "osr/routing/simplify.h"
+
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <utility>
+#include <vector>
+
+namespace osr {
+
+namespace {
+
+constexpr auto const kEarthRadius = 6'371'000.0;
+
+// Scratch buffers reused between calls of the same thread.
+struct simplify_buffers {
+  std::vector<double> x_, y_, d2_;
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> stack_;
+  std::vector<bool> keep_;
+};
+
+// Squared distance of all points in [from, to) to the segment a-b, written
+// to d2. Structure of arrays and no branches, so the loop vectorizes.
+void squared_segment_distances(double const* __restrict x,
+                               double const* __restrict y,
+                               double* __restrict d2,
+                               std::uint32_t const from,
+                               std::uint32_t const to,
+                               double const ax,
+                               double const ay,
+                               double const bx,
+                               double const by) {
+  auto const dx = bx - ax;
+  auto const dy = by - ay;
+  auto const len2 = dx * dx + dy * dy;
+  auto const inv_len2 = len2 == 0.0 ? 0.0 : 1.0 / len2;
+  for (auto i = from; i < to; ++i) {
+    auto const t = std::clamp(((x[i] - ax) * dx + (y[i] - ay) * dy) * inv_len2,
+                              0.0, 1.0);
+    auto const px = ax + t * dx - x[i];
+    auto const py = ay + t * dy - y[i];
+    d2[i] = px * px + py * py;
+  }
+}
+
+}  // namespace
+
+void simplify(geo::polyline& line, double const tolerance) {
+  if (line.size() < 3U || tolerance <= 0.0) {
+    return;
+  }
+
+  thread_local auto buf = simplify_buffers{};
+  auto const n = static_cast<std::uint32_t>(line.size());
+
+  // Local equirectangular projection to meters around the first point.
+  auto const deg_to_m = kEarthRadius * std::numbers::pi / 180.0;
+  auto const cos_lat = std::cos(line.front().lat_ * std::numbers::pi / 180.0);
+  buf.x_.resize(n);
+  buf.y_.resize(n);
+  buf.d2_.resize(n);
+  for (auto i = 0U; i != n; ++i) {
+    buf.x_[i] = (line[i].lng_ - line.front().lng_) * cos_lat * deg_to_m;
+    buf.y_[i] = (line[i].lat_ - line.front().lat_) * deg_to_m;
+  }
+
+  buf.keep_.assign(n, false);
+  buf.keep_.front() = true;
+  buf.keep_.back() = true;
+
+  auto const tolerance2 = tolerance * tolerance;
+  buf.stack_.clear();
+  buf.stack_.emplace_back(0U, n - 1U);
+  while (!buf.stack_.empty()) {
+    auto const [a, b] = buf.stack_.back();
+    buf.stack_.pop_back();
+    if (b - a < 2U) {
+      continue;
+    }
+
+    squared_segment_distances(buf.x_.data(), buf.y_.data(), buf.d2_.data(),
+                              a + 1U, b, buf.x_[a], buf.y_[a], buf.x_[b],
+                              buf.y_[b]);
+    auto const max_it =
+        std::max_element(begin(buf.d2_) + a + 1U, begin(buf.d2_) + b);
+    if (*max_it > tolerance2) {
+      auto const m = static_cast<std::uint32_t>(max_it - begin(buf.d2_));
+      buf.keep_[m] = true;
+      buf.stack_.emplace_back(a, m);
+      buf.stack_.emplace_back(m, b);
+    }
+  }
+
+  auto out = 0U;
+  for (auto i = 0U; i != n; ++i) {
+    if (buf.keep_[i]) {
+      line[out++] = line[i];
+    }
+  }
+  line.resize(out);
+}
+
+void simplify(path& p, double const tolerance) {
+  for (auto& s : p.segments_) {
+    simplify(s.polyline_, tolerance);
+  }
+}
+
+}  // namespace osr
@@ -0,0 +1,864 @@
+#include "osr/extract/update.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "osmium/handler.hpp"
+#include "osmium/io/gzip_compression.hpp"
+#include "osmium/io/reader.hpp"
+#include "osmium/io/xml_input.hpp"
+#include "osmium/visitor.hpp"
+
+#include "geo/box.h"
+#include "geo/latlng.h"
+
+#include "utl/enumerate.h"
+#include "utl/helpers/algorithm.h"
+#include "utl/progress_tracker.h"
+#include "utl/zip.h"
+
+#include "osr/extract/properties.h"
+#include "osr/extract/tags.h"
+#include "osr/lookup.h"
+#include "osr/ways.h"
+
+namespace osm = osmium;
+namespace osm_io = osmium::io;
+namespace fs = std::filesystem;
+
+namespace osr {
+
+namespace {
+
+template <typename Id, typename Obj>
+using changes_t = std::vector<std::pair<Id, Obj const*>>;
+
+// Collects the changed objects. Pointers refer to the buffers of the change
+// file which stay in memory during the update.
+struct change_handler : public osm::handler::Handler {
+  void node(osm::Node const& n) {
+    nodes_.emplace_back(osm_node_idx_t{n.positive_id()}, &n);
+  }
+
+  void way(osm::Way const& w) {
+    ways_.emplace_back(osm_way_idx_t{w.positive_id()}, &w);
+  }
+
+  // All relations: deleted relations have no tags, so deleted restrictions
+  // are only found through the stored restriction relations.
+  void relation(osm::Relation const& r) {
+    relations_.emplace_back(osm_rel_idx_t{r.positive_id()}, &r);
+  }
+
+  changes_t<osm_node_idx_t, osm::Node> nodes_;
+  changes_t<osm_way_idx_t, osm::Way> ways_;
+  changes_t<osm_rel_idx_t, osm::Relation> relations_;
+};
+
+// Sorts by id and keeps the last (= latest) change of every object.
+template <typename Id, typename Obj>
+void keep_latest(changes_t<Id, Obj>& changes) {
+  std::stable_sort(begin(changes), end(changes),
+                   [](auto&& a, auto&& b) { return a.first < b.first; });
+  auto out = begin(changes);
+  for (auto it = begin(changes); it != end(changes); ++it) {
+    if (std::next(it) == end(changes) || std::next(it)->first != it->first) {
+      *out++ = *it;
+    }
+  }
+  changes.erase(out, end(changes));
+}
+
+template <typename T>
+T tombstone() {
+  auto p = T{};
+  std::memset(&p, 0, sizeof(T));
+  return p;
+}
+
+bool same_nodes(osm::WayNodeList const& a, auto const& osm_nodes) {
+  return a.size() == osm_nodes.size() &&
+         std::equal(begin(a), end(a), begin(osm_nodes),
+                    [](osm::NodeRef const& x, osm_node_idx_t const y) {
+                      return osm_node_idx_t{x.positive_ref()} == y;
+                    });
+}
+
+// Properties of these ways depend on relations or elevator nodes, which are
+// not known without the full input.
+bool is_self_contained(tags const& t) {
+  return !t.is_elevator_ && (t.is_platform() || t.is_parking_ ||
+                             !t.highway_.empty() || t.is_ferry_route_);
+}
+
+// Ways without these tags are only routable as relation members.
+bool is_street(tags const& t) {
+  return !t.highway_.empty() || !t.railway_.empty() || t.is_ferry_route_ ||
+         t.is_platform() || t.is_parking_ || t.is_elevator_;
+}
+
+string_idx_t add_string(ways& w, std::string_view s) {
+  auto const i = string_idx_t{w.strings_.size()};
+  w.strings_.emplace_back(s);
+  return i;
+}
+
+void update_name(ways& w, way_idx_t const way, std::string_view name) {
+  auto const before = w.way_names_[way];
+  if (name.empty()) {
+    w.way_names_[way] = string_idx_t::invalid();
+  } else if (before == string_idx_t::invalid() ||
+             w.strings_[before].view() != name) {
+    w.way_names_[way] = add_string(w, name);
+  }
+}
+
+using positions_t = hash_map<osm_node_idx_t, point>;
+
+// Conditional access entries are stored sorted by way, so only existing
+// entries can be changed or removed in place (and entries of new ways, which
+// are appended).
+bool can_update_conditional_access(ways const& w,
+                                   way_idx_t const way,
+                                   std::string_view const conditional) {
+  return w.way_has_conditional_access_no_.test(way) || conditional.empty();
+}
+
+void update_conditional_access(ways& w,
+                               way_idx_t const way,
+                               std::string_view const conditional) {
+  if (!w.way_has_conditional_access_no_.test(way)) {
+    return;
+  }
+
+  if (conditional.empty()) {
+    w.way_has_conditional_access_no_.set(way, false);
+    return;
+  }
+
+  auto const it = std::lower_bound(
+      begin(w.way_conditional_access_no_), end(w.way_conditional_access_no_),
+      way, [](auto&& a, auto&& b) { return a.first < b; });
+  if (w.strings_[it->second].view() != conditional) {
+    it->second = add_string(w, conditional);
+  }
+}
+
+// Ways with a node that moved. Graph nodes are found through node_ways_.
+// Other nodes have no index, so their ways are found with one scan over the
+// way node ids (only if such a node moved).
+std::vector<way_idx_t> get_moved_ways(ways const& w,
+                                      positions_t const& positions) {
+  auto moved = std::vector<way_idx_t>{};
+  auto other_nodes = false;
+  for (auto const& [osm_node_idx, pos] : positions) {
+    auto const node_idx = w.find_node_idx(osm_node_idx);
+    if (!node_idx.has_value()) {
+      other_nodes = true;
+      continue;
+    }
+    auto const before = w.get_node_pos(*node_idx);
+    if (before.lat_ != pos.lat_ || before.lng_ != pos.lng_) {
+      for (auto const way : w.r_->node_ways_[*node_idx]) {
+        moved.push_back(way);
+      }
+    }
+  }
+
+  if (other_nodes) {
+    for (auto way = way_idx_t{0U}; way != w.n_ways(); ++way) {
+      for (auto const [osm_node, pos] :
+           utl::zip(w.way_osm_nodes_[way], w.way_polylines_[way])) {
+        if (auto const it = positions.find(osm_node);
+            it != end(positions) &&
+            (it->second.lat_ != pos.lat_ || it->second.lng_ != pos.lng_)) {
+          moved.push_back(way);
+          break;
+        }
+      }
+    }
+  }
+
+  utl::sort(moved);
+  moved.erase(std::unique(begin(moved), end(moved)), end(moved));
+  return moved;
+}
+
+// Distances between the graph nodes of a way with the changed node positions.
+// Returns nothing if a distance exceeds the short distance range now or
+// before (long distances are stored in a sorted side table).
+std::optional<std::vector<std::uint16_t>> get_way_node_distances(
+    ways const& w, way_idx_t const way, positions_t const& positions) {
+  constexpr auto const kLong = std::numeric_limits<std::uint16_t>::max();
+
+  auto dists = std::vector<std::uint16_t>{};
+  auto pred = std::optional<point>{};
+  auto distance = 0.0;
+  auto first = true;
+  for (auto const [osm_node, polyline_pos] :
+       utl::zip(w.way_osm_nodes_[way], w.way_polylines_[way])) {
+    auto const it = positions.find(osm_node);
+    auto const pos = it == end(positions) ? point{polyline_pos} : it->second;
+    if (pred.has_value()) {
+      distance += geo::distance(pos, *pred);
+    }
+    pred = pos;
+
+    if (!w.find_node_idx(osm_node).has_value()) {
+      continue;
+    }
+    if (!first) {
+      auto const d = std::round(distance);
+      if (d >= kLong) {
+        return std::nullopt;
+      }
+      dists.push_back(static_cast<std::uint16_t>(d));
+    }
+    first = false;
+    distance = 0.0;
+  }
+
+  auto const stored = w.r_->way_node_dist_[way];
+  if (stored.size() != dists.size() || utl::any_of(stored, [&](auto&& x) {
+        return x == kLong;
+      })) {
+    return std::nullopt;
+  }
+  return dists;
+}
+
+// Graph nodes of a way and the distances between them, as in
+// ways::connect_ways(). Long distances are added to the side table, which
+// has to be sorted afterwards.
+void get_way_graph(ways& w,
+                   way_idx_t const way,
+                   std::span<osm_node_idx_t const> osm_nodes,
+                   std::span<point const> polyline,
+                   std::vector<node_idx_t>& nodes,
+                   std::vector<std::uint16_t>& dists) {
+  auto pred_pos = std::optional<point>{};
+  auto distance = 0.0;
+  for (auto const [osm_node_idx, pos] : utl::zip(osm_nodes, polyline)) {
+    if (pred_pos.has_value()) {
+      distance += geo::distance(pos, *pred_pos);
+    }
+    pred_pos = pos;
+
+    auto const node = w.find_node_idx(osm_node_idx);
+    if (!node.has_value()) {
+      continue;
+    }
+
+    if (!nodes.empty()) {
+      auto const dist = static_cast<distance_t>(std::round(distance));
+      if (dist < std::numeric_limits<std::uint16_t>::max()) {
+        dists.push_back(static_cast<std::uint16_t>(dist));
+      } else {
+        w.r_->long_way_node_dist_.push_back(ways::routing::long_distance{
+            .way_ = way,
+            .node_ = static_cast<std::uint16_t>(nodes.size() - 1U),
+            .distance_ = dist});
+        dists.push_back(std::numeric_limits<std::uint16_t>::max());
+      }
+    }
+    nodes.push_back(*node);
+    distance = 0.0;
+  }
+}
+
+// Replaces the given buckets. The buckets before the first replaced one stay
+// in place, the ones behind it are copied once.
+template <typename Vecvec, typename Key, typename T>
+void replace_buckets(Vecvec& vv,
+                     std::map<Key, std::vector<T>> const& replaced) {
+  if (replaced.empty()) {
+    return;
+  }
+
+  auto const first = static_cast<std::size_t>(to_idx(begin(replaced)->first));
+  auto const n = static_cast<std::size_t>(vv.size());
+  auto const offset = static_cast<std::size_t>(vv.bucket_starts_[first]);
+  auto const data =
+      std::vector<T>(begin(vv.data_) + static_cast<std::ptrdiff_t>(offset),
+                     end(vv.data_));
+  auto const starts = std::vector<std::size_t>(
+      begin(vv.bucket_starts_) + static_cast<std::ptrdiff_t>(first),
+      end(vv.bucket_starts_));
+  vv.data_.resize(offset);
+  vv.bucket_starts_.resize(first + 1U);
+
+  auto it = begin(replaced);
+  for (auto i = first; i != n; ++i) {
+    if (it != end(replaced) && to_idx(it->first) == i) {
+      vv.emplace_back(it->second);
+      ++it;
+    } else {
+      auto const from = starts[i - first] - offset;
+      auto const to = starts[i - first + 1U] - offset;
+      vv.emplace_back(std::span{data}.subspan(from, to - from));
+    }
+  }
+}
+
+struct way_update {
+  way_idx_t way_;
+  way_properties p_;
+  std::string_view name_;
+  std::string_view conditional_;
+  osm::WayNodeList const* nodes_{nullptr};  // Only set if changed.
+};
+
+struct new_way {
+  osm_way_idx_t osm_idx_;
+  way_properties p_;
+  std::string_view name_;
+  std::string_view conditional_;
+  osm::WayNodeList const* nodes_;
+};
+
+struct geometry_update {
+  way_idx_t way_;
+  std::vector<std::uint16_t> dists_;
+};
+
+// Merges the components of the given ways with the components of the ways
+// they share a graph node with. Ways without a component are assigned one.
+void join_components(ways& w, std::span<way_idx_t const> joined) {
+  auto& components = w.r_->way_component_;
+  components.resize(w.n_ways(), component_idx_t::invalid());
+
+  auto next = component_idx_t{0U};
+  for (auto const c : components) {
+    if (c != component_idx_t::invalid() && c >= next) {
+      next = component_idx_t{to_idx(c) + 1U};
+    }
+  }
+
+  auto parent = hash_map<component_idx_t, component_idx_t>{};
+  auto const root = [&](component_idx_t c) {
+    for (auto it = parent.find(c); it != end(parent); it = parent.find(c)) {
+      c = it->second;
+    }
+    return c;
+  };
+
+  for (auto const way : joined) {
+    auto r = component_idx_t::invalid();
+    auto const join = [&](component_idx_t const c) {
+      if (c == component_idx_t::invalid()) {
+        return;
+      }
+      auto const x = root(c);
+      if (r == component_idx_t::invalid()) {
+        r = x;
+      } else if (x != r) {
+        parent[std::max(x, r)] = std::min(x, r);
+        r = std::min(x, r);
+      }
+    };
+
+    join(components[way]);
+    for (auto const n : w.r_->way_nodes_[way]) {
+      for (auto const other : w.r_->node_ways_[n]) {
+        join(components[other]);
+      }
+    }
+    components[way] = r == component_idx_t::invalid() ? next++ : r;
+  }
+
+  if (!parent.empty()) {
+    for (auto& c : components) {
+      c = root(c);
+    }
+  }
+}
+
+// Replaces the restrictions of the changed relations and rebuilds the node
+// restrictions from all stored ones. Returns the number of changed relations
+// which were or are turn restrictions.
+std::size_t update_restrictions(
+    ways& w, changes_t<osm_rel_idx_t, osm::Relation> const& relations) {
+  using entry_t = pair<osm_rel_idx_t, resolved_restriction>;
+
+  auto changed = hash_set<osm_rel_idx_t>{};
+  for (auto const& [id, r] : relations) {
+    changed.insert(id);
+  }
+
+  auto n_changed = hash_set<osm_rel_idx_t>{};
+  auto entries = std::vector<entry_t>{};
+  for (auto const& x : w.restriction_relations_) {
+    if (changed.contains(x.first)) {
+      n_changed.insert(x.first);
+    } else {
+      entries.push_back(x);
+    }
+  }
+
+  auto resolved = std::vector<resolved_restriction>{};
+  for (auto const& [id, r] : relations) {
+    if (!r->visible()) {
+      continue;
+    }
+    resolved.clear();
+    resolve_restriction(w, *r, resolved);
+    for (auto const& x : resolved) {
+      entries.push_back(entry_t{id, x});
+      n_changed.insert(id);
+    }
+  }
+  std::stable_sort(begin(entries), end(entries),
+                   [](auto&& a, auto&& b) { return a.first < b.first; });
+
+  w.restriction_relations_.resize(entries.size());
+  std::copy(begin(entries), end(entries), begin(w.restriction_relations_));
+
+  auto all = std::vector<resolved_restriction>{};
+  all.reserve(entries.size());
+  for (auto const& x : entries) {
+    all.push_back(x.second);
+  }
+  w.r_->node_restrictions_.clear();
+  w.r_->node_is_restricted_ = bitvec<node_idx_t>{};
+  w.r_->node_is_restricted_.resize(w.n_nodes());
+  w.add_restriction(all);
+
+  return n_changed.size();
+}
+
+// ALT bounds are only valid for the graph they were computed on.
+void remove_landmarks(fs::path const& dir) {
+  auto files = std::vector<fs::path>{};
+  for (auto const& e : fs::directory_iterator{dir}) {
+    if (e.path().filename().string().starts_with("landmarks_")) {
+      files.push_back(e.path());
+    }
+  }
+  for (auto const& f : files) {
+    auto ec = std::error_code{};
+    fs::remove(f, ec);
+  }
+}
+
+}  // namespace
+
+update_stats update(fs::path const& osc, fs::path const& dir) {
+  auto pt = utl::get_active_progress_tracker_or_activate("osr");
+  auto stats = update_stats{};
+
+  pt->status("Load changes").out_bounds(0, 10);
+  auto h = change_handler{};
+  auto buffers = std::vector<osm::memory::Buffer>{};
+  auto reader = osm_io::Reader{osm_io::File{osc.generic_string()}};
+  while (auto buf = reader.read()) {
+    osm::apply(buf, h);
+    buffers.emplace_back(std::move(buf));
+  }
+  reader.close();
+  keep_latest(h.nodes_);
+  keep_latest(h.ways_);
+  keep_latest(h.relations_);
+
+  auto w = ways{dir, cista::mmap::protection::MODIFY};
+
+  // New OSM objects have higher ids than all existing ones. Appending them
+  // keeps the id -> index mappings sorted.
+  auto const last_node = w.n_nodes() == 0U
+                             ? osm_node_idx_t{0U}
+                             : w.node_to_osm_[node_idx_t{w.n_nodes() - 1U}];
+  auto const last_way = w.n_ways() == 0U
+                            ? osm_way_idx_t{0U}
+                            : w.way_osm_idx_[way_idx_t{w.n_ways() - 1U}];
+
+  // Classify all changes first. Nothing is modified if one of them cannot be
+  // applied in place.
+  pt->status("Classify nodes").in_high(h.nodes_.size()).out_bounds(10, 30);
+  auto positions = positions_t{};
+  auto node_updates = std::vector<std::pair<node_idx_t, node_properties>>{};
+  auto other_node_properties = hash_map<osm_node_idx_t, node_properties>{};
+  auto uses = hash_map<osm_node_idx_t, unsigned>{};
+  for (auto const& [osm_node_idx, n] : h.nodes_) {
+    pt->increment();
+    auto const node_idx = w.find_node_idx(osm_node_idx);
+    if (!n->visible()) {
+      if (node_idx.has_value()) {
+        node_updates.emplace_back(*node_idx, tombstone<node_properties>());
+        ++stats.deleted_nodes_;
+      }
+      continue;
+    }
+
+    positions.emplace(osm_node_idx, point::from_location(n->location()));
+    auto const t = tags{*n};
+    auto const [p, level_bits] = get_node_properties(t);
+    if (!node_idx.has_value()) {
+      // Becomes a graph node if it has two uses (tags count as one use).
+      other_node_properties.emplace(osm_node_idx, p);
+      if (is_graph_node(t)) {
+        ++uses[osm_node_idx];
+      }
+      continue;
+    }
+
+    if (p.is_elevator() || w.r_->node_properties_[*node_idx].is_elevator()) {
+      ++stats.unsupported_;
+      continue;
+    }
+    node_updates.emplace_back(*node_idx, p);
+    ++stats.modified_nodes_;
+  }
+
+  pt->status("Classify ways").in_high(h.ways_.size()).out_bounds(30, 40);
+  auto way_updates = std::vector<way_update>{};
+  auto deleted_ways = std::vector<way_idx_t>{};
+  auto new_ways = std::vector<new_way>{};
+  for (auto const& [osm_way_idx, x] : h.ways_) {
+    pt->increment();
+    auto const way = w.find_way(osm_way_idx);
+    if (!way.has_value()) {
+      if (!x->visible()) {
+        continue;
+      }
+
+      auto const t = tags{*x};
+      if (!is_street(t)) {
+        continue;
+      }
+      auto const p = get_way_properties(t);
+      if (!t.is_elevator_ && !p.is_accessible()) {
+        continue;
+      }
+      if (!is_self_contained(t) || osm_way_idx <= last_way) {
+        ++stats.unsupported_;  // Old ids would need an index in the middle.
+        continue;
+      }
+      new_ways.push_back({.osm_idx_ = osm_way_idx,
+                          .p_ = p,
+                          .name_ = t.name_.empty() ? t.ref_ : t.name_,
+                          .conditional_ = t.access_conditional_no_,
+                          .nodes_ = &x->nodes()});
+      ++stats.new_ways_;
+      continue;
+    }
+
+    if (!x->visible()) {
+      deleted_ways.push_back(*way);
+      ++stats.deleted_ways_;
+      continue;
+    }
+
+    auto const t = tags{*x};
+    if (!is_self_contained(t) ||
+        !can_update_conditional_access(w, *way, t.access_conditional_no_)) {
+      ++stats.unsupported_;
+      continue;
+    }
+
+    auto const before = w.r_->way_properties_[*way];
+    auto p = get_way_properties(t);
+    p.in_route_ = p.in_route_ || before.in_route_;
+    p.is_big_street_ = p.is_big_street_ || before.is_big_street_;
+    auto const changed_nodes =
+        p.is_accessible() && !same_nodes(x->nodes(), w.way_osm_nodes_[*way]);
+    way_updates.push_back(
+        {.way_ = *way,
+         .p_ = p.is_accessible() ? p : tombstone<way_properties>(),
+         .name_ = t.name_.empty() ? t.ref_ : t.name_,
+         .conditional_ = t.access_conditional_no_,
+         .nodes_ = changed_nodes ? &x->nodes() : nullptr});
+    ++stats.modified_ways_;
+  }
+
+  // Ways with a new node list: existing ones first, then the new ways with
+  // their future indices.
+  auto node_lists =
+      std::vector<std::pair<way_idx_t, osm::WayNodeList const*>>{};
+  for (auto const& u : way_updates) {
+    if (u.nodes_ != nullptr) {
+      node_lists.emplace_back(u.way_, u.nodes_);
+    }
+  }
+  auto const n_changed_ways = node_lists.size();
+  for (auto const [i, x] : utl::enumerate(new_ways)) {
+    node_lists.emplace_back(way_idx_t{w.n_ways() + i}, x.nodes_);
+  }
+  auto changed_ways = hash_set<way_idx_t>{};
+  for (auto const& [way, nodes] : node_lists) {
+    changed_ways.insert(way);
+    for (auto const& n : *nodes) {
+      ++uses[osm_node_idx_t{n.positive_ref()}];
+    }
+  }
+
+  pt->status("Classify geometries").out_bounds(40, 50);
+  auto geometry_updates = std::vector<geometry_update>{};
+  for (auto const way : get_moved_ways(w, positions)) {
+    if (changed_ways.contains(way)) {
+      continue;
+    }
+    auto dists = get_way_node_distances(w, way, positions);
+    if (!dists.has_value()) {
+      ++stats.unsupported_;
+      continue;
+    }
+    geometry_updates.push_back({.way_ = way, .dists_ = std::move(*dists)});
+  }
+
+  // Uses by the other ways and positions of nodes which are neither graph
+  // nodes nor part of the change file. Such nodes have no index, so all ways
+  // are scanned once (only if there are such nodes).
+  auto missing = hash_set<osm_node_idx_t>{};
+  for (auto const& [osm_node_idx, n] : uses) {
+    if (!w.find_node_idx(osm_node_idx).has_value() &&
+        (osm_node_idx <= last_node || !positions.contains(osm_node_idx))) {
+      missing.insert(osm_node_idx);
+    }
+  }
+  if (!missing.empty()) {
+    auto const removed = hash_set<way_idx_t>{begin(deleted_ways),
+                                             end(deleted_ways)};
+    for (auto way = way_idx_t{0U}; way != w.n_ways(); ++way) {
+      auto const counted = !changed_ways.contains(way) &&
+                           !removed.contains(way) &&
+                           w.r_->way_properties_[way].is_accessible();
+      for (auto const [osm_node, pos] :
+           utl::zip(w.way_osm_nodes_[way], w.way_polylines_[way])) {
+        if (missing.contains(osm_node)) {
+          positions.emplace(osm_node, pos);
+          uses[osm_node] += counted ? 1U : 0U;
+        }
+      }
+    }
+  }
+
+  auto new_nodes = std::vector<osm_node_idx_t>{};
+  for (auto const& [osm_node_idx, n] : uses) {
+    if (n < 2U || w.find_node_idx(osm_node_idx).has_value()) {
+      continue;
+    }
+    auto const p = other_node_properties.find(osm_node_idx);
+    if (osm_node_idx <= last_node || p == end(other_node_properties) ||
+        p->second.is_elevator()) {
+      ++stats.unsupported_;  // Would split an existing way.
+      continue;
+    }
+    new_nodes.push_back(osm_node_idx);
+  }
+  utl::sort(new_nodes);
+  stats.new_nodes_ = new_nodes.size();
+
+  for (auto const& [way, nodes] : node_lists) {
+    if (utl::any_of(*nodes, [&](osm::NodeRef const& n) {
+          auto const i = osm_node_idx_t{n.positive_ref()};
+          return !positions.contains(i) && !w.find_node_idx(i).has_value();
+        })) {
+      ++stats.unsupported_;  // Node outside of the graph and the change file.
+    }
+  }
+
+  if (stats.unsupported_ != 0U) {
+    return {.unsupported_ = stats.unsupported_};
+  }
+
+  pt->status("Update")
+      .in_high(node_updates.size() + way_updates.size() + node_lists.size() +
+               geometry_updates.size())
+      .out_bounds(50, 95);
+  for (auto const& [node_idx, p] : node_updates) {
+    pt->increment();
+    w.r_->node_properties_[node_idx] = p;
+  }
+  for (auto const& [osm_node_idx, pos] : positions) {
+    if (auto const n = w.find_node_idx(osm_node_idx); n.has_value()) {
+      w.r_->node_positions_[*n] = pos;
+    }
+  }
+
+  for (auto const way : deleted_ways) {
+    w.r_->way_properties_[way] = tombstone<way_properties>();
+  }
+  for (auto const& u : way_updates) {
+    pt->increment();
+    w.r_->way_properties_[u.way_] = u.p_;
+    update_name(w, u.way_, u.name_);
+    update_conditional_access(w, u.way_, u.conditional_);
+  }
+
+  // New graph nodes, their ways are added below.
+  for (auto const osm_node_idx : new_nodes) {
+    w.node_to_osm_.push_back(osm_node_idx);
+    w.r_->node_properties_.push_back(other_node_properties.at(osm_node_idx));
+    w.r_->node_positions_.push_back(positions.at(osm_node_idx));
+    w.r_->node_ways_.add_back_sized(0U);
+    w.r_->node_in_way_idx_.add_back_sized(0U);
+    w.r_->node_turn_bearings_.add_back_sized(0U);
+  }
+  w.r_->node_is_restricted_.resize(w.n_nodes());
+
+  // Geometry and graph nodes of ways with a new node list. Uses of graph
+  // nodes by these ways are collected to rebuild the affected node buckets.
+  auto l = lookup{w, dir, cista::mmap::protection::MODIFY};
+  auto node_uses =
+      std::map<node_idx_t, std::vector<std::pair<way_idx_t, std::uint16_t>>>{};
+  auto osm_nodes = std::map<way_idx_t, std::vector<osm_node_idx_t>>{};
+  auto polylines = std::map<way_idx_t, std::vector<point>>{};
+  auto way_nodes = std::map<way_idx_t, std::vector<node_idx_t>>{};
+  auto way_dists = std::map<way_idx_t, std::vector<std::uint16_t>>{};
+  auto befores = std::vector<geo::box>{};
+  auto& long_dists = w.r_->long_way_node_dist_;
+  long_dists.erase(std::remove_if(begin(long_dists), end(long_dists),
+                                  [&](auto&& x) {
+                                    return changed_ways.contains(x.way_);
+                                  }),
+                   end(long_dists));
+  for (auto const [i, x] : utl::enumerate(node_lists)) {
+    pt->increment();
+    auto const& [way, nodes] = x;
+    auto& way_osm_nodes = osm_nodes[way];
+    auto& polyline = polylines[way];
+    for (auto const& n : *nodes) {
+      auto const osm_node_idx = osm_node_idx_t{n.positive_ref()};
+      auto const pos = positions.find(osm_node_idx);
+      way_osm_nodes.push_back(osm_node_idx);
+      polyline.push_back(pos != end(positions)
+                             ? pos->second
+                             : w.get_node_pos(w.get_node_idx(osm_node_idx)));
+    }
+    get_way_graph(w, way, way_osm_nodes, polyline, way_nodes[way],
+                  way_dists[way]);
+
+    if (i < n_changed_ways) {
+      auto before = geo::box{};
+      for (auto const& pos : w.way_polylines_[way]) {
+        before.extend(pos);
+      }
+      befores.push_back(before);
+      for (auto const n : w.r_->way_nodes_[way]) {
+        node_uses.emplace(n, decltype(node_uses)::mapped_type{});
+      }
+    }
+    for (auto const [j, n] : utl::enumerate(way_nodes[way])) {
+      node_uses[n].emplace_back(way, static_cast<std::uint16_t>(j));
+    }
+  }
+  std::sort(begin(long_dists), end(long_dists));
+
+  {  // Existing ways.
+    auto const existing = [&](auto& m) {
+      auto changed = std::remove_reference_t<decltype(m)>{};
+      while (!m.empty() && to_idx(begin(m)->first) < w.n_ways()) {
+        changed.insert(m.extract(begin(m)));
+      }
+      return changed;
+    };
+    replace_buckets(w.way_osm_nodes_, existing(osm_nodes));
+    replace_buckets(w.way_polylines_, existing(polylines));
+    replace_buckets(w.r_->way_nodes_, existing(way_nodes));
+    replace_buckets(w.r_->way_node_dist_, existing(way_dists));
+  }
+
+  for (auto const& x : new_ways) {
+    auto const way = way_idx_t{w.n_ways()};
+    w.way_osm_idx_.push_back(x.osm_idx_);
+    w.r_->way_properties_.push_back(x.p_);
+    w.way_osm_nodes_.emplace_back(osm_nodes.at(way));
+    w.way_polylines_.emplace_back(polylines.at(way));
+    w.r_->way_nodes_.emplace_back(way_nodes.at(way));
+    w.r_->way_node_dist_.emplace_back(way_dists.at(way));
+    w.way_names_.push_back(x.name_.empty() ? string_idx_t::invalid()
+                                           : add_string(w, x.name_));
+    w.way_has_conditional_access_no_.resize(to_idx(way) + 1U);
+    if (!x.conditional_.empty()) {
+      w.way_has_conditional_access_no_.set(way, true);
+      w.way_conditional_access_no_.emplace_back(
+          way, add_string(w, x.conditional_));
+    }
+  }
+
+  {  // Node buckets in way index order, as created by ways::connect_ways().
+    auto node_ways = std::map<node_idx_t, std::vector<way_idx_t>>{};
+    auto node_in_way_idx = std::map<node_idx_t, std::vector<std::uint16_t>>{};
+    auto bearings = std::map<node_idx_t, std::vector<turn_bearing>>{};
+    for (auto& [n, added] : node_uses) {
+      for (auto const [way, i] :
+           utl::zip(w.r_->node_ways_[n], w.r_->node_in_way_idx_[n])) {
+        if (!changed_ways.contains(way)) {
+          added.emplace_back(way, i);
+        }
+      }
+      utl::sort(added);
+      for (auto const& [way, i] : added) {
+        node_ways[n].push_back(way);
+        node_in_way_idx[n].push_back(i);
+      }
+      bearings[n].resize(added.size());
+    }
+    replace_buckets(w.r_->node_ways_, node_ways);
+    replace_buckets(w.r_->node_in_way_idx_, node_in_way_idx);
+    replace_buckets(w.r_->node_turn_bearings_, bearings);
+    for (auto const& [n, _] : node_uses) {
+      w.update_turn_bearings(n);
+    }
+  }
+
+  if (!node_lists.empty()) {
+    auto joined = std::vector<way_idx_t>{};
+    for (auto const& [way, nodes] : node_lists) {
+      joined.push_back(way);
+    }
+    join_components(w, joined);
+  }
+
+  for (auto const [i, x] : utl::enumerate(node_lists)) {
+    if (i < n_changed_ways) {
+      l.update_way(x.first, befores[i]);
+    } else {
+      l.insert(x.first);
+    }
+  }
+
+  for (auto const& [way, dists] : geometry_updates) {
+    pt->increment();
+    auto before = geo::box{};
+    for (auto const [osm_node, pos] :
+         utl::zip(w.way_osm_nodes_[way], w.way_polylines_[way])) {
+      before.extend(pos);
+      if (auto const it = positions.find(osm_node); it != end(positions)) {
+        pos = it->second;
+      }
+    }
+    for (auto const [stored, d] : utl::zip(w.r_->way_node_dist_[way], dists)) {
+      stored = d;
+    }
+    for (auto const n : w.r_->way_nodes_[way]) {
+      w.update_turn_bearings(n);
+    }
+    l.update_way(way, before);
+    ++stats.moved_ways_;
+  }
+  l.write_meta();
+
+  // Positions of restrictions change with the node buckets.
+  if (!h.relations_.empty() || !node_uses.empty()) {
+    stats.restrictions_ = update_restrictions(w, h.relations_);
+  }
+
+  pt->status("Write").out_bounds(95, 100);
+  remove_landmarks(dir);
+  w.compile_conditional_access();
+  w.r_->write(dir);
+  w.sync();
+
+  return stats;
+}
+
+}  // namespace osr
@@ -51,7 +51,7 @@ quantized_angle_t get_next_bearing(Polyline const& polyline,
 ways::ways(std::filesystem::path p, cista::mmap::protection const mode)
     : p_{std::move(p)},
       mode_{mode},
-      r_{mode == cista::mmap::protection::READ
+      r_{mode != cista::mmap::protection::WRITE
              ? routing::read(p_)
              : cista::wrapped<routing>{cista::raw::make_unique<routing>()}},
       node_to_osm_{mm("node_to_osm.bin")},
@@ -65,7 +65,9 @@ ways::ways(std::filesystem::path p, cista::mmap::protection const mode)
       way_names_{mm("way_names.bin")},
       way_has_conditional_access_no_{
           mm_vec<std::uint64_t>(mm("way_has_conditional_access_no"))},
-      way_conditional_access_no_{mm("way_conditional_access_no")} {}
+      way_conditional_access_no_{mm("way_conditional_access_no")},
+      way_conditional_access_rules_{mm("way_conditional_access_rules.bin")},
+      restriction_relations_{mm("restriction_relations.bin")} {}
 
 void ways::build_components() {
   auto q = hash_set<way_idx_t>{};
@@ -194,7 +196,7 @@ void ways::connect_ways() {
         .out_bounds(40, 50);
 
     auto node_idx = node_idx_t{0U};
-    node_way_counter_.multi_.for_each_set_bit([&](std::uint64_t const b_idx) {
+    node_way_counter_.for_each_multi([&](std::uint64_t const b_idx) {
       auto const i = osm_node_idx_t{b_idx};
       node_to_osm_.push_back(i);
       ++node_idx;
@@ -322,6 +324,18 @@ void ways::compute_turn_bearings() {
   }
 }
 
+void ways::update_turn_bearings(node_idx_t const n) {
+  for (auto const [way, node_in_way_idx, bearing] :
+       utl::zip(r_->node_ways_[n], r_->node_in_way_idx_[n],
+                r_->node_turn_bearings_[n])) {
+    auto const polyline = way_polylines_[way];
+    auto const polyline_idx = get_polyline_node_idx(way, node_in_way_idx);
+    bearing =
+        turn_bearing{.to_prev_ = get_prev_bearing(polyline, polyline_idx),
+                     .to_next_ = get_next_bearing(polyline, polyline_idx)};
+  }
+}
+
 void ways::sync() {
   node_to_osm_.mmap_.sync();
   way_osm_idx_.mmap_.sync();
@@ -332,6 +346,7 @@ void ways::sync() {
   strings_.data_.mmap_.sync();
   strings_.bucket_starts_.mmap_.sync();
   way_names_.mmap_.sync();
+  restriction_relations_.mmap_.sync();
 }
 
 std::optional<std::string_view> ways::get_access_restriction(
@@ -349,6 +364,65 @@ std::optional<std::string_view> ways::get_access_restriction(
   return strings_[it->second].view();
 }
 
+void ways::compile_conditional_access() {
+  way_conditional_access_rules_.clear();
+  for (auto const& [way, condition] : way_conditional_access_no_) {
+    if (!way_has_conditional_access_no_.test(way)) {
+      continue;  // Removed by an update.
+    }
+    if (auto const rules =
+            osr::compile_conditional_access(strings_[condition].view(), way);
+        rules.has_value()) {
+      for (auto const& r : *rules) {
+        way_conditional_access_rules_.push_back(r);
+      }
+    }
+  }
+}
+
+std::span<time_rule const> ways::get_access_rules(
+    way_idx_t const way) const {
+  if (!way_has_conditional_access_no_.test(way)) {
+    return {};
+  }
+  auto const lt = [](time_rule const& a, time_rule const& b) {
+    return a.way_ < b.way_;
+  };
+  auto const key = time_rule{.way_ = way};
+  auto const from = std::lower_bound(begin(way_conditional_access_rules_),
+                                     end(way_conditional_access_rules_), key,
+                                     lt);
+  auto const to =
+      std::upper_bound(from, end(way_conditional_access_rules_), key, lt);
+  return {from, to};
+}
+
+bitvec<way_idx_t> ways::get_blocked_ways(
+    std::chrono::local_seconds const t) const {
+  auto blocked = bitvec<way_idx_t>{};
+  blocked.resize(n_ways());
+  for (auto const& r : way_conditional_access_rules_) {
+    if (way_has_conditional_access_no_.test(r.way_) && r.matches(t)) {
+      blocked.set(r.way_, true);
+    }
+  }
+  return blocked;
+}
+
+bitvec<node_idx_t> ways::get_blocked_nodes(
+    std::chrono::local_seconds const t) const {
+  auto blocked = bitvec<node_idx_t>{};
+  blocked.resize(n_nodes());
+  for (auto const& r : way_conditional_access_rules_) {
+    if (way_has_conditional_access_no_.test(r.way_) && r.matches(t)) {
+      for (auto const n : r_->way_nodes_[r.way_]) {
+        blocked.set(n, true);
+      }
+    }
+  }
+  return blocked;
+}
+
 cista::wrapped<ways::routing> ways::routing::read(
     std::filesystem::path const& p) {
   return cista::read<ways::routing>(p / "routing.bin");
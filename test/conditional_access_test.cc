@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include "osr/conditional_access.h"
+#include "osr/routing/parameters.h"
+#include "osr/routing/route.h"
+
+#include "test_extract.h"
+
+using namespace osr;
+using namespace std::chrono;
+
+namespace {
+
+bool is_blocked(std::string_view const condition, local_seconds const t) {
+  auto const rules = compile_conditional_access(condition, way_idx_t{0U});
+  return rules.has_value() &&
+         std::ranges::any_of(*rules, [&](auto&& r) { return r.matches(t); });
+}
+
+local_seconds at(year_month_day const d, int const h, int const m) {
+  return local_days{d} + hours{h} + minutes{m};
+}
+
+}  // namespace
+
+TEST(conditional_access, compile_and_match) {
+  auto const monday = 2024y / October / 14d;
+  auto const saturday = 2024y / October / 19d;
+  auto const sunday = 2024y / October / 20d;
+
+  EXPECT_TRUE(is_blocked("Mo-Fr 07:00-19:00", at(monday, 8, 0)));
+  EXPECT_FALSE(is_blocked("Mo-Fr 07:00-19:00", at(monday, 19, 0)));
+  EXPECT_FALSE(is_blocked("Mo-Fr 07:00-19:00", at(saturday, 8, 0)));
+
+  // Wraps midnight: Sunday morning belongs to the Saturday rule.
+  EXPECT_TRUE(is_blocked("Sa 22:00-06:00", at(sunday, 5, 59)));
+  EXPECT_FALSE(is_blocked("Sa 22:00-06:00", at(saturday, 5, 59)));
+
+  EXPECT_TRUE(is_blocked("Nov-Feb", at(2025y / January / 3d, 12, 0)));
+  EXPECT_FALSE(is_blocked("Nov-Feb", at(2025y / March / 3d, 12, 0)));
+
+  EXPECT_TRUE(is_blocked("Mo-Fr 07:00-09:00,16:00-18:00; Sa 08:00-12:00",
+                         at(saturday, 9, 0)));
+  EXPECT_TRUE(is_blocked("24/7", at(sunday, 0, 0)));
+}
+
+TEST(conditional_access, unsupported) {
+  EXPECT_FALSE(compile_conditional_access("", way_idx_t{0U}).has_value());
+  EXPECT_FALSE(compile_conditional_access("PH", way_idx_t{0U}).has_value());
+  EXPECT_FALSE(
+      compile_conditional_access("Mo-Fr 07:00-19:00 AND weight>7.5",
+                                 way_idx_t{0U})
+          .has_value());
+  EXPECT_FALSE(compile_conditional_access("Mo 10:00-10:00", way_idx_t{0U})
+                   .has_value());
+}
+
+TEST(conditional_access, blocked_mask) {
+  // 1 - 2 - 3 - 5 along the street, way 100 (2-3) is closed on weekday
+  // mornings. Way 103 (1-4-5) is the detour.
+  auto const osm = std::filesystem::temp_directory_path() /
+                   "osr_conditional_access_test.osm";
+  std::ofstream{osm} << R"(<?xml version="1.0" encoding="UTF-8"?>
+<osm version="0.6">
+<node id="1" version="1" lat="49.0000" lon="8.0000"/>
+<node id="2" version="1" lat="49.0000" lon="8.0010"/>
+<node id="3" version="1" lat="49.0000" lon="8.0020"/>
+<node id="4" version="1" lat="49.0020" lon="8.0015"/>
+<node id="5" version="1" lat="49.0000" lon="8.0030"/>
+<way id="100" version="1"><nd ref="2"/><nd ref="3"/>
+<tag k="highway" v="residential"/>
+<tag k="access:conditional" v="no @ (Mo-Fr 07:00-09:00)"/></way>
+<way id="101" version="1"><nd ref="1"/><nd ref="2"/>
+<tag k="highway" v="residential"/></way>
+<way id="102" version="1"><nd ref="3"/><nd ref="5"/>
+<tag k="highway" v="residential"/></way>
+<way id="103" version="1"><nd ref="1"/><nd ref="4"/><nd ref="5"/>
+<tag k="highway" v="residential"/></way>
+</osm>
+)";
+  auto const data = test_extract{osm};
+  auto const& w = data.w_;
+
+  auto const closed = *w.find_way(osm_way_idx_t{100U});
+  auto const open = *w.find_way(osm_way_idx_t{103U});
+  ASSERT_EQ(1U, w.get_access_rules(closed).size());
+  EXPECT_EQ(closed, w.get_access_rules(closed).front().way_);
+  EXPECT_TRUE(w.get_access_rules(open).empty());
+
+  auto const monday = 2024y / October / 14d;
+  EXPECT_TRUE(w.get_blocked_ways(at(monday, 8, 0)).test(closed));
+  EXPECT_FALSE(w.get_blocked_ways(at(monday, 8, 0)).test(open));
+  EXPECT_FALSE(w.get_blocked_ways(at(monday, 12, 0)).test(closed));
+
+  auto const route_at = [&](local_seconds const t) {
+    auto const blocked = w.get_blocked_nodes(t);
+    return route(get_parameters(search_profile::kFoot), w, data.l_,
+                 search_profile::kFoot, location{49.0, 8.0, level_t{0.F}},
+                 location{49.0, 8.003, level_t{0.F}}, 3600,
+                 direction::kForward, 50.0, &blocked);
+  };
+  auto const direct = route_at(at(monday, 12, 0));
+  auto const detour = route_at(at(monday, 8, 0));
+  ASSERT_TRUE(direct.has_value());
+  ASSERT_TRUE(detour.has_value());
+  EXPECT_NEAR(220.0, direct->dist_, 10.0);
+  EXPECT_GT(detour->dist_, 400.0);
+  EXPECT_GT(detour->cost_, direct->cost_);
+}
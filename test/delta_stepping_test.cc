@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "osr/location.h"
+#include "osr/routing/delta_stepping.h"
+#include "osr/routing/dijkstra.h"
+#include "osr/routing/profiles/car.h"
+#include "osr/routing/profiles/foot.h"
+#include "osr/routing/route.h"
+#include "osr/types.h"
+#include "osr/ways.h"
+
+#include "test_extract.h"
+
+using namespace osr;
+
+template <Profile P>
+void compare_with_delta_stepping(ways const& w, direction const dir) {
+  constexpr auto const kMax = cost_t{3600U};
+
+  auto const params = typename P::parameters{};
+  auto ds = delta_stepping<P>{4U, 10U};
+
+  for (auto const start : {node_idx_t{0U}, node_idx_t{w.n_nodes() / 2U}}) {
+    ds.reset(kMax);
+    P::resolve_all(*w.r_, start, kNoLevel, [&](typename P::node const n) {
+      ds.add_start(w, typename P::label{n, 0U});
+    });
+    ds.run(params, w, *w.r_, kMax, nullptr, nullptr, nullptr, dir);
+    compare_with_dijkstra<P>(w, dir, kMax, start, ds);
+  }
+}
+
+TEST(delta_stepping, matches_dijkstra) {
+  auto const& w = luisenplatz().w_;
+
+  for (auto const dir : {direction::kForward, direction::kBackward}) {
+    compare_with_delta_stepping<foot<false, elevator_tracking>>(w, dir);
+    compare_with_delta_stepping<car>(w, dir);
+  }
+}
+
+TEST(delta_stepping, one_to_many) {
+  auto const& w = luisenplatz().w_;
+  auto const& l = luisenplatz().l_;
+
+  auto const from = location{49.872715, 8.651534, level_t{0.F}};
+  auto const to = std::vector<location>{
+      {49.874120, 8.655120, level_t{0.F}},
+      {49.873000, 8.653000, level_t{0.F}},
+      {49.875575, 8.647219, level_t{0.F}}};
+  auto const reconstruct_all = [](path const&) { return true; };
+
+  for (auto const profile : {search_profile::kFoot, search_profile::kCar}) {
+    auto const search = [&](bool const parallel) {
+      return route(get_parameters(profile), w, l, profile, from, to, 900,
+                   direction::kForward, 250.0, nullptr, nullptr, nullptr,
+                   reconstruct_all, parallel);
+    };
+    auto const expected = search(false);
+    auto const actual = search(true);
+    ASSERT_EQ(expected.size(), actual.size());
+    for (auto i = 0U; i != expected.size(); ++i) {
+      ASSERT_EQ(expected[i].has_value(), actual[i].has_value());
+      if (expected[i].has_value()) {
+        EXPECT_EQ(expected[i]->cost_, actual[i]->cost_);
+        EXPECT_FALSE(actual[i]->segments_.empty());
+      }
+    }
+  }
+}
@@ -19,12 +19,15 @@
 #include "osr/lookup.h"
 #include "osr/routing/bidirectional.h"
 #include "osr/routing/dijkstra.h"
+#include "osr/routing/landmarks.h"
 #include "osr/routing/profile.h"
 #include "osr/routing/profiles/car.h"
 #include "osr/routing/route.h"
 #include "osr/types.h"
 #include "osr/ways.h"
 
+#include "test_extract.h"
+
 namespace fs = std::filesystem;
 using namespace osr;
 
@@ -47,7 +50,9 @@ void run(ways const& w,
          lookup const& l,
          unsigned const n_samples,
          unsigned const max_cost,
-         direction const dir) {
+         direction const dir,
+         landmarks const* lm = nullptr,
+         routing_algorithm const algo = routing_algorithm::kAStarBi) {
 
   auto const from_tos = [&]() {
     auto prng = std::mt19937{};
@@ -114,7 +119,7 @@ void run(ways const& w,
       try {
         return route(car::parameters{}, w, l, search_profile::kCar, from_loc,
                      to_loc, from_matches_span, to_matches_span, max_cost, dir,
-                     nullptr, nullptr, nullptr, routing_algorithm::kAStarBi);
+                     nullptr, nullptr, nullptr, algo, lm);
       } catch (std::exception const& ex) {
         fmt::println("a* bidir exception: {}", ex.what());
         throw ex;
@@ -223,6 +228,84 @@ TEST(dijkstra_astarbidir, monaco_bwd) {
   run(w, l, num_samples, max_cost, dir);
 }
 
+TEST(dijkstra_astarbidir, monaco_alt) {
+  auto const raw_data = "test/monaco.osm.pbf";
+  auto const data_dir = "test/monaco";
+  auto const num_samples = 10000U;
+  auto const max_cost = 2 * 3600U;
+
+  if (!fs::exists(raw_data) && !fs::exists(data_dir)) {
+    GTEST_SKIP() << raw_data << " not found";
+  }
+
+  load(raw_data, data_dir);
+  auto const w = osr::ways{data_dir, cista::mmap::protection::READ};
+  auto const l = osr::lookup{w, data_dir, cista::mmap::protection::READ};
+
+  compute_landmarks(w, search_profile::kCar, data_dir);
+  auto const lm = landmarks::try_open(data_dir, search_profile::kCar);
+  ASSERT_NE(nullptr, lm);
+
+  run(w, l, num_samples, max_cost, direction::kForward, lm.get());
+  run(w, l, num_samples, max_cost, direction::kBackward, lm.get());
+}
+
+TEST(dijkstra_astarbidir, monaco_parallel) {
+  auto const raw_data = "test/monaco.osm.pbf";
+  auto const data_dir = "test/monaco";
+  auto const num_samples = 1000U;
+  auto const max_cost = 2 * 3600U;
+
+  if (!fs::exists(raw_data) && !fs::exists(data_dir)) {
+    GTEST_SKIP() << raw_data << " not found";
+  }
+
+  load(raw_data, data_dir);
+  auto const w = osr::ways{data_dir, cista::mmap::protection::READ};
+  auto const l = osr::lookup{w, data_dir, cista::mmap::protection::READ};
+
+  run(w, l, num_samples, max_cost, direction::kForward, nullptr,
+      routing_algorithm::kAStarBiParallel);
+  run(w, l, num_samples, max_cost, direction::kBackward, nullptr,
+      routing_algorithm::kAStarBiParallel);
+}
+
+TEST(dijkstra_astarbidir, luisenplatz_alt) {
+  auto const num_samples = 1000U;
+  auto const max_cost = 3600U;
+
+  // The shared extract stays read-only, landmarks go to their own directory.
+  auto const& w = luisenplatz().w_;
+  auto const& l = luisenplatz().l_;
+  auto const lm_dir = fs::temp_directory_path() / "osr_luisenplatz_landmarks";
+  auto ec = std::error_code{};
+  fs::remove_all(lm_dir, ec);
+  fs::create_directories(lm_dir, ec);
+  compute_landmarks(w, search_profile::kCar, lm_dir);
+  auto const lm = landmarks::try_open(lm_dir, search_profile::kCar);
+  ASSERT_NE(nullptr, lm);
+  EXPECT_TRUE(lm->matches(car::parameters{}));
+  EXPECT_FALSE(lm->matches(car::parameters{.uturn_penalty_ = 0U}));
+
+  run(w, l, num_samples, max_cost, direction::kForward, lm.get());
+  run(w, l, num_samples, max_cost, direction::kBackward, lm.get());
+  run(w, l, num_samples, max_cost, direction::kForward, lm.get(),
+      routing_algorithm::kAStarBiParallel);
+}
+
+TEST(dijkstra_astarbidir, luisenplatz_parallel) {
+  auto const num_samples = 1000U;
+  auto const max_cost = 3600U;
+
+  auto const& w = luisenplatz().w_;
+  auto const& l = luisenplatz().l_;
+
+  run(w, l, num_samples, max_cost, direction::kForward, nullptr,
+      routing_algorithm::kAStarBiParallel);
+  run(w, l, num_samples, max_cost, direction::kBackward, nullptr,
+      routing_algorithm::kAStarBiParallel);
+}
+
 TEST(dijkstra_astarbidir, hamburg) {
   auto const raw_data = "test/hamburg.osm.pbf";
   auto const data_dir = "test/hamburg";
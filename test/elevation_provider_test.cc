@@ -0,0 +1,129 @@
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "cista/mmap.h"
+
+#include "geo/latlng.h"
+
+#include "osr/elevation_storage.h"
+#include "osr/extract/extract.h"
+#include "osr/preprocessing/elevation/provider.h"
+#include "osr/ways.h"
+
+using namespace osr::preprocessing::elevation;
+
+TEST(elevation_provider, batch_matches_single) {
+  auto const provider = osr::preprocessing::elevation::provider{
+      "test/restriction_test_elevation/"};
+  ASSERT_EQ(1U, provider.driver_count());
+
+  // Grid reaching beyond the tile on every side.
+  auto pos = std::vector<geo::latlng>{};
+  for (auto lat = 49.8823; lat < 49.8842; lat += 0.00007) {
+    for (auto lng = 8.6559; lng < 8.6580; lng += 0.00007) {
+      pos.push_back({lat, lng});
+    }
+  }
+
+  auto out = std::vector<elevation_meters_t>(pos.size());
+  provider.get(pos, out);
+
+  auto n_valid = 0U;
+  for (auto i = 0U; i != pos.size(); ++i) {
+    EXPECT_EQ(provider.get(pos[i]), out[i]);
+    n_valid += out[i] != elevation_meters_t::invalid() ? 1U : 0U;
+  }
+  EXPECT_NE(0U, n_valid);
+  EXPECT_NE(pos.size(), n_valid);
+}
+
+TEST(elevation_provider, compute_elevations_matches_extract) {
+  namespace fs = std::filesystem;
+
+  auto const p = fs::temp_directory_path() / "osr_elevation_test";
+  auto ec = std::error_code{};
+  fs::remove_all(p, ec);
+  fs::create_directories(p, ec);
+
+  auto const dem = fs::path{"test/restriction_test_elevation/"};
+  osr::extract(false, "test/map.osm", p, dem);
+
+  auto const read_all = [&]() {
+    auto const e = osr::elevation_storage::try_open(p);
+    EXPECT_NE(nullptr, e);
+    auto all = std::vector<std::vector<std::uint8_t>>{};
+    for (auto const bucket : e->elevations_) {
+      auto& v = all.emplace_back();
+      for (auto const x : bucket) {
+        v.push_back(static_cast<std::uint8_t>(x.up_ << 4U | x.down_));
+      }
+    }
+    return all;
+  };
+  auto const expected = read_all();
+  ASSERT_FALSE(expected.empty());
+
+  auto const w = osr::ways{p, cista::mmap::protection::READ};
+  auto const provider = osr::preprocessing::elevation::provider{dem};
+
+  osr::compute_elevations(w, provider, p, p / "work", {});
+  EXPECT_EQ(expected, read_all());
+
+  auto const changed = provider.tile_boxes();
+  osr::compute_elevations(w, provider, p, p / "work", changed);
+  EXPECT_EQ(expected, read_all());
+  EXPECT_FALSE(fs::exists(p / "work" / "elevation_checkpoint.txt"));
+}
+
+TEST(elevation_provider, compute_elevations_resumes) {
+  namespace fs = std::filesystem;
+
+  auto const p = fs::temp_directory_path() / "osr_elevation_resume_test";
+  auto ec = std::error_code{};
+  fs::remove_all(p, ec);
+  fs::create_directories(p, ec);
+
+  auto const dem = fs::path{"test/restriction_test_elevation/"};
+  osr::extract(false, "test/map.osm", p, dem);
+
+  auto const read_all = [&]() {
+    auto const e = osr::elevation_storage::try_open(p);
+    EXPECT_NE(nullptr, e);
+    auto all = std::vector<std::vector<std::uint8_t>>{};
+    for (auto const bucket : e->elevations_) {
+      auto& v = all.emplace_back();
+      for (auto const x : bucket) {
+        v.push_back(static_cast<std::uint8_t>(x.up_ << 4U | x.down_));
+      }
+    }
+    return all;
+  };
+  auto const expected = read_all();
+  ASSERT_FALSE(expected.empty());
+
+  auto const w = osr::ways{p, cista::mmap::protection::READ};
+  auto const provider = osr::preprocessing::elevation::provider{dem};
+  auto const work = p / "work";
+  auto const checkpoint = work / "elevation_checkpoint.txt";
+
+  // Interrupted after two chunks, continued by the next call.
+  EXPECT_FALSE(osr::compute_elevations(w, provider, p, work, {}, 2U, 2U));
+  EXPECT_TRUE(fs::exists(checkpoint));
+  EXPECT_TRUE(osr::compute_elevations(w, provider, p, work, {}, 2U));
+  EXPECT_EQ(expected, read_all());
+  EXPECT_FALSE(fs::exists(checkpoint));
+
+  // A checkpoint written for a different input is not resumed.
+  EXPECT_FALSE(osr::compute_elevations(w, provider, p, work, {}, 2U, 2U));
+  {
+    auto f = std::ofstream{checkpoint};
+    f << 0U << ' ' << w.n_ways() << ' ' << 0U << '\n';
+  }
+  EXPECT_TRUE(osr::compute_elevations(w, provider, p, work, {}));
+  EXPECT_EQ(expected, read_all());
+  EXPECT_FALSE(fs::exists(checkpoint));
+}
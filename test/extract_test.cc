@@ -1,11 +1,21 @@
 #include "gtest/gtest.h"
 
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include "cista/mmap.h"
 
+#include "utl/zip.h"
+
 #include "osr/extract/extract.h"
+#include "osr/extract/update.h"
 #include "osr/lookup.h"
+#include "osr/routing/parameters.h"
+#include "osr/routing/route.h"
 #include "osr/types.h"
 #include "osr/ways.h"
 
@@ -48,3 +58,276 @@ TEST(extract, bus_only_on_highway) {
   ASSERT_FALSE(wp.is_bus_accessible());
   ASSERT_TRUE(wp.is_foot_accessible());
 }
+
+TEST(extract, all_graph_nodes_have_positions) {
+  auto p = fs::temp_directory_path() / "osr_test";
+  auto ec = std::error_code{};
+  fs::remove_all(p, ec);
+  fs::create_directories(p, ec);
+
+  // Platform and barrier nodes become graph nodes through their own tags.
+  extract(true, "test/luisenplatz-darmstadt.osm.pbf", p, {});
+  EXPECT_FALSE(fs::exists(p / "tmp_node_cache.bin"));
+
+  auto w = ways{p, cista::mmap::protection::READ};
+  ASSERT_NE(0U, w.n_nodes());
+  for (auto i = node_idx_t{0U}; i != w.n_nodes(); ++i) {
+    auto const pos = w.get_node_pos(i).as_latlng();
+    EXPECT_GT(pos.lat_, 49.0) << "node " << to_idx(i);
+    EXPECT_GT(pos.lng_, 8.0) << "node " << to_idx(i);
+  }
+}
+
+TEST(extract, update_matches_full_extract) {
+  auto const dir = fs::temp_directory_path() / "osr_update_test";
+  auto ec = std::error_code{};
+  fs::remove_all(dir, ec);
+  fs::create_directories(dir, ec);
+
+  auto in = std::stringstream{};
+  in << std::ifstream{"test/map.osm"}.rdbuf();
+  auto osm = in.str();
+  auto const element = [&](std::string const& start, std::string const& end) {
+    auto const from = osm.find(start);
+    auto const to = osm.find(end, from) + end.size();
+    return std::pair{from, to - from};
+  };
+  auto const replace_in = [&](std::pair<std::size_t, std::size_t> const e,
+                              std::string const& from, std::string const& to) {
+    auto const pos = osm.find(from, e.first);
+    ASSERT_LT(pos, e.first + e.second);
+    osm.replace(pos, from.size(), to);
+  };
+
+  // Move a graph node, rename a way, delete another way.
+  replace_in(element("<node id=\"1535946146\"", "</node>"),
+             "lat=\"49.8825808\"", "lat=\"49.8826308\"");
+  replace_in(element("<way id=\"140186757\"", "</way>"),
+             "v=\"Pankratiusstraße\"", "v=\"Neue Straße\"");
+  auto const [node_pos, node_len] =
+      element("<node id=\"1535946146\"", "</node>");
+  auto const [way_pos, way_len] = element("<way id=\"140186757\"", "</way>");
+  auto const osc = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                   "<osmChange version=\"0.6\">\n<modify>\n" +
+                   osm.substr(node_pos, node_len) + "\n" +
+                   osm.substr(way_pos, way_len) +
+                   "\n</modify>\n<delete>\n"
+                   "<way id=\"150023523\" version=\"9\"/>\n"
+                   "</delete>\n</osmChange>\n";
+  auto const [deleted_pos, deleted_len] =
+      element("<way id=\"150023523\"", "</way>");
+  osm.erase(deleted_pos, deleted_len);
+
+  std::ofstream{dir / "changes.osc"} << osc;
+  std::ofstream{dir / "updated.osm"} << osm;
+
+  extract(false, "test/map.osm", dir / "incremental", {});
+  auto const stats = update(dir / "changes.osc", dir / "incremental");
+  extract(false, dir / "updated.osm", dir / "full", {});
+
+  EXPECT_EQ(0U, stats.unsupported_);
+  EXPECT_EQ(1U, stats.modified_ways_);
+  EXPECT_EQ(1U, stats.deleted_ways_);
+  EXPECT_EQ(1U, stats.modified_nodes_);
+
+  auto a = ways{dir / "incremental", cista::mmap::protection::READ};
+  auto b = ways{dir / "full", cista::mmap::protection::READ};
+
+  auto const way_a = a.find_way(osm_way_idx_t{140186757});
+  auto const way_b = b.find_way(osm_way_idx_t{140186757});
+  ASSERT_TRUE(way_a.has_value());
+  ASSERT_TRUE(way_b.has_value());
+  EXPECT_EQ(0, std::memcmp(&a.r_->way_properties_[*way_a],
+                           &b.r_->way_properties_[*way_b],
+                           sizeof(way_properties)));
+  EXPECT_EQ("Neue Straße", a.strings_[a.way_names_[*way_a]].view());
+  ASSERT_EQ(a.way_polylines_[*way_a].size(), b.way_polylines_[*way_b].size());
+  for (auto const [pa, pb] :
+       utl::zip(a.way_polylines_[*way_a], b.way_polylines_[*way_b])) {
+    EXPECT_NEAR(pa.lat(), pb.lat(), 1e-6);
+    EXPECT_NEAR(pa.lng(), pb.lng(), 1e-6);
+  }
+  ASSERT_EQ(a.r_->way_node_dist_[*way_a].size(),
+            b.r_->way_node_dist_[*way_b].size());
+  for (auto const [da, db] : utl::zip(a.r_->way_node_dist_[*way_a],
+                                      b.r_->way_node_dist_[*way_b])) {
+    EXPECT_NEAR(da, db, 1);
+  }
+
+  auto const node_a = a.find_node_idx(osm_node_idx_t{1535946146});
+  auto const node_b = b.find_node_idx(osm_node_idx_t{1535946146});
+  ASSERT_TRUE(node_a.has_value());
+  ASSERT_TRUE(node_b.has_value());
+  EXPECT_NEAR(a.get_node_pos(*node_a).lat(), b.get_node_pos(*node_b).lat(),
+              1e-6);
+
+  auto const deleted_a = a.find_way(osm_way_idx_t{150023523});
+  ASSERT_TRUE(deleted_a.has_value());
+  EXPECT_FALSE(a.r_->way_properties_[*deleted_a].is_accessible());
+  EXPECT_FALSE(b.find_way(osm_way_idx_t{150023523}).has_value());
+}
+
+TEST(extract, update_adds_ways_and_restrictions) {
+  auto const dir = fs::temp_directory_path() / "osr_update_new_ways_test";
+  auto ec = std::error_code{};
+  fs::remove_all(dir, ec);
+  fs::create_directories(dir, ec);
+
+  // Two new footways from an existing graph node (20000000002 becomes a new
+  // graph node), a new restriction and a deleted one.
+  auto const nodes = std::string{
+      "<node id=\"20000000001\" version=\"1\" lat=\"49.8825500\" "
+      "lon=\"8.6600000\"/>\n"
+      "<node id=\"20000000002\" version=\"1\" lat=\"49.8825200\" "
+      "lon=\"8.6603000\"/>\n"
+      "<node id=\"20000000003\" version=\"1\" lat=\"49.8824900\" "
+      "lon=\"8.6606000\"/>\n"};
+  auto const new_ways = std::string{
+      "<way id=\"2000000001\" version=\"1\">\n"
+      "<nd ref=\"1535946146\"/>\n<nd ref=\"20000000001\"/>\n"
+      "<nd ref=\"20000000002\"/>\n"
+      "<tag k=\"highway\" v=\"footway\"/>\n</way>\n"
+      "<way id=\"2000000002\" version=\"1\">\n"
+      "<nd ref=\"20000000002\"/>\n<nd ref=\"20000000003\"/>\n"
+      "<tag k=\"highway\" v=\"footway\"/>\n</way>\n"};
+  auto const relations = std::string{
+      "<relation id=\"20000001\" version=\"1\">\n"
+      "<member type=\"way\" ref=\"140186757\" role=\"from\"/>\n"
+      "<member type=\"node\" ref=\"1535946146\" role=\"via\"/>\n"
+      "<member type=\"way\" ref=\"2000000001\" role=\"to\"/>\n"
+      "<tag k=\"restriction\" v=\"no_left_turn\"/>\n"
+      "<tag k=\"type\" v=\"restriction\"/>\n</relation>\n"};
+
+  auto in = std::stringstream{};
+  in << std::ifstream{"test/map.osm"}.rdbuf();
+  auto osm = in.str();
+  auto const deleted_from = osm.find("<relation id=\"1654115\"");
+  auto const deleted_to =
+      osm.find("</relation>", deleted_from) + std::string{"</relation>"}.size();
+  osm.erase(deleted_from, deleted_to - deleted_from);
+  osm.insert(osm.find("</osm>"), relations);
+  osm.insert(osm.find("<relation "), new_ways);
+  osm.insert(osm.find("<way "), nodes);
+
+  std::ofstream{dir / "changes.osc"}
+      << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+         "<osmChange version=\"0.6\">\n<create>\n"
+      << nodes << new_ways << relations
+      << "</create>\n<delete>\n"
+         "<relation id=\"1654115\" version=\"4\"/>\n"
+         "</delete>\n</osmChange>\n";
+  std::ofstream{dir / "updated.osm"} << osm;
+
+  extract(false, "test/map.osm", dir / "incremental", {});
+  std::ofstream{dir / "incremental" / "landmarks_foot_nodes.bin"} << "x";
+  auto const stats = update(dir / "changes.osc", dir / "incremental");
+  extract(false, dir / "updated.osm", dir / "full", {});
+
+  EXPECT_EQ(0U, stats.unsupported_);
+  EXPECT_EQ(2U, stats.new_ways_);
+  EXPECT_EQ(1U, stats.new_nodes_);
+  EXPECT_EQ(2U, stats.restrictions_);
+  EXPECT_FALSE(fs::exists(dir / "incremental" / "landmarks_foot_nodes.bin"));
+
+  auto a = ways{dir / "incremental", cista::mmap::protection::READ};
+  auto b = ways{dir / "full", cista::mmap::protection::READ};
+  ASSERT_EQ(a.n_ways(), b.n_ways());
+  ASSERT_EQ(a.n_nodes(), b.n_nodes());
+
+  auto const osm_nodes = [](ways const& w, way_idx_t const way) {
+    auto ids = std::vector<osm_node_idx_t>{};
+    for (auto const n : w.r_->way_nodes_[way]) {
+      ids.push_back(w.node_to_osm_[n]);
+    }
+    return ids;
+  };
+  auto const osm_ways = [](ways const& w, node_idx_t const n) {
+    auto ids = std::vector<osm_way_idx_t>{};
+    for (auto const way : w.r_->node_ways_[n]) {
+      ids.push_back(w.way_osm_idx_[way]);
+    }
+    return ids;
+  };
+
+  for (auto const id : {2000000001U, 2000000002U, 140186757U}) {
+    auto const way_a = a.find_way(osm_way_idx_t{id});
+    auto const way_b = b.find_way(osm_way_idx_t{id});
+    ASSERT_TRUE(way_a.has_value());
+    ASSERT_TRUE(way_b.has_value());
+    EXPECT_EQ(0, std::memcmp(&a.r_->way_properties_[*way_a],
+                             &b.r_->way_properties_[*way_b],
+                             sizeof(way_properties)));
+    EXPECT_EQ(osm_nodes(a, *way_a), osm_nodes(b, *way_b));
+    ASSERT_EQ(a.r_->way_node_dist_[*way_a].size(),
+              b.r_->way_node_dist_[*way_b].size());
+    for (auto const [da, db] : utl::zip(a.r_->way_node_dist_[*way_a],
+                                        b.r_->way_node_dist_[*way_b])) {
+      EXPECT_NEAR(da, db, 1);
+    }
+  }
+
+  for (auto const id : {1535946146U, 20000000002U, 528944U}) {
+    auto const node_a = a.find_node_idx(osm_node_idx_t{id});
+    auto const node_b = b.find_node_idx(osm_node_idx_t{id});
+    ASSERT_TRUE(node_a.has_value());
+    ASSERT_TRUE(node_b.has_value());
+    EXPECT_EQ(osm_ways(a, *node_a), osm_ways(b, *node_b));
+    EXPECT_EQ(a.r_->node_is_restricted_[*node_a],
+              b.r_->node_is_restricted_[*node_b]);
+    auto const ra = a.r_->node_restrictions_[*node_a];
+    auto const rb = b.r_->node_restrictions_[*node_b];
+    EXPECT_EQ((std::vector<restriction>{begin(ra), end(ra)}),
+              (std::vector<restriction>{begin(rb), end(rb)}));
+  }
+  EXPECT_TRUE(
+      a.r_->node_is_restricted_[a.get_node_idx(osm_node_idx_t{1535946146U})]);
+  EXPECT_EQ(a.r_->way_component_[*a.find_way(osm_way_idx_t{2000000002U})],
+            a.r_->way_component_[*a.find_way(osm_way_idx_t{140186757U})]);
+
+  // The new footways are found by the rtree and used by the search.
+  auto const la = lookup{a, dir / "incremental", cista::mmap::protection::READ};
+  auto const lb = lookup{b, dir / "full", cista::mmap::protection::READ};
+  auto const from = location{49.8824900, 8.6606000, level_t{0.F}};
+  auto const to = location{49.8835021, 8.6575619, level_t{0.F}};
+  auto const params = get_parameters(search_profile::kFoot);
+  auto const pa = route(params, a, la, search_profile::kFoot, from, to, 900,
+                        direction::kForward, 100.0);
+  auto const pb = route(params, b, lb, search_profile::kFoot, from, to, 900,
+                        direction::kForward, 100.0);
+  ASSERT_TRUE(pa.has_value());
+  ASSERT_TRUE(pb.has_value());
+  EXPECT_EQ(pb->cost_, pa->cost_);
+  EXPECT_NEAR(pb->dist_, pa->dist_, 1.0);
+}
+
+TEST(extract, update_with_unsupported_change_changes_nothing) {
+  auto const dir = fs::temp_directory_path() / "osr_update_unsupported_test";
+  auto ec = std::error_code{};
+  fs::remove_all(dir, ec);
+  fs::create_directories(dir, ec);
+
+  // Deletes a way and adds a new one from the middle of another way. This
+  // makes an existing node a graph node, which needs a full extract.
+  std::ofstream{dir / "changes.osc"}
+      << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+         "<osmChange version=\"0.6\">\n<create>\n"
+         "<node id=\"20000000001\" version=\"1\" lat=\"49.8825500\" "
+         "lon=\"8.6600000\"/>\n"
+         "<way id=\"2000000001\" version=\"1\">\n"
+         "<nd ref=\"2927368906\"/>\n<nd ref=\"20000000001\"/>\n"
+         "<tag k=\"highway\" v=\"footway\"/>\n</way>\n"
+         "</create>\n<delete>\n"
+         "<way id=\"140186757\" version=\"18\"/>\n"
+         "</delete>\n</osmChange>\n";
+
+  extract(false, "test/map.osm", dir / "data", {});
+  auto const stats = update(dir / "changes.osc", dir / "data");
+  EXPECT_EQ(1U, stats.unsupported_);
+  EXPECT_EQ(0U, stats.deleted_ways_);
+
+  auto w = ways{dir / "data", cista::mmap::protection::READ};
+  auto const deleted = w.find_way(osm_way_idx_t{140186757});
+  ASSERT_TRUE(deleted.has_value());
+  EXPECT_TRUE(w.r_->way_properties_[*deleted].is_accessible());
+  EXPECT_FALSE(w.find_way(osm_way_idx_t{2000000001}).has_value());
+}
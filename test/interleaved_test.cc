@@ -0,0 +1,49 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "osr/routing/dijkstra.h"
+#include "osr/routing/interleaved.h"
+#include "osr/routing/profiles/car.h"
+#include "osr/routing/profiles/foot.h"
+#include "osr/types.h"
+#include "osr/ways.h"
+
+#include "test_extract.h"
+
+using namespace osr;
+
+template <Profile P>
+void compare_with_single(ways const& w, direction const dir) {
+  constexpr auto const kMax = cost_t{3600U};
+  constexpr auto const kBatchSize = 4U;
+
+  auto const params = typename P::parameters{};
+  auto searches = std::vector<dijkstra<P>>(kBatchSize);
+
+  auto const start = [&](unsigned const i) {
+    return node_idx_t{i * (w.n_nodes() / kBatchSize)};
+  };
+
+  for (auto i = 0U; i != kBatchSize; ++i) {
+    searches[i].reset(kMax);
+    P::resolve_all(*w.r_, start(i), kNoLevel, [&](typename P::node const n) {
+      searches[i].add_start(w, typename P::label{n, 0U});
+    });
+  }
+  run_interleaved(params, w, *w.r_, kMax, nullptr, nullptr, nullptr, dir,
+                  std::span{searches});
+
+  for (auto i = 0U; i != kBatchSize; ++i) {
+    compare_with_dijkstra<P>(w, dir, kMax, start(i), searches[i]);
+  }
+}
+
+TEST(interleaved, matches_single_search) {
+  auto const& w = luisenplatz().w_;
+
+  for (auto const dir : {direction::kForward, direction::kBackward}) {
+    compare_with_single<foot<false, elevator_tracking>>(w, dir);
+    compare_with_single<car>(w, dir);
+  }
+}
@@ -5,6 +5,8 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+#include "boost/json.hpp"
+
 #include "utl/to_vec.h"
 
 #include "osr/extract/extract.h"
@@ -155,6 +157,30 @@ TEST_F(map_matching_karlsruhe, all_routed) {
               Pointwise(PolylineMatches(), expected_routed_polylines_));
 }
 
+TEST_F(map_matching_karlsruhe, trace_matches_debug_json) {
+  auto debug_json = boost::json::object{};
+  auto trace = std::shared_ptr<osr::map_match_trace const>{};
+  auto const mr = osr::map_match(
+      w_, l_, osr::search_profile::kBus, osr::bus::parameters{},
+      std::vector{
+          osr::location{.pos_ = {49.038863, 8.394161}, .lvl_ = osr::kNoLevel},
+          osr::location{.pos_ = {49.0404738, 8.3929049}, .lvl_ = osr::kNoLevel},
+          osr::location{.pos_ = {49.0422707, 8.3906472}, .lvl_ = osr::kNoLevel},
+      },
+      nullptr, nullptr,
+      [&](osr::matched_route const&,
+          std::function<boost::json::object()> const& get_json) {
+        debug_json = get_json();
+      },
+      [&](std::shared_ptr<osr::map_match_trace const> t) {
+        trace = std::move(t);
+      });
+
+  EXPECT_EQ(2U, mr.n_routed_);
+  ASSERT_NE(nullptr, trace);
+  EXPECT_EQ(debug_json, trace->to_json());
+}
+
 TEST_F(map_matching_karlsruhe, all_outside_2pts) {
   // all the points are outside the osm map extract -> expect a single beeline
 
@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "osr/util/multi_counter.h"
+
+using namespace osr;
+
+TEST(multi_counter, sparse_pages) {
+  auto c = multi_counter{};
+  auto const far = std::uint64_t{11'000'000'000U};
+  for (auto const i : {5U, 7U, 7U, 70'000U, 70'000U, 70'000U}) {
+    c.increment(i);
+  }
+  c.increment(far);
+  c.increment(far);
+
+  EXPECT_FALSE(c.is_multi(5U));
+  EXPECT_TRUE(c.is_multi(7U));
+  EXPECT_TRUE(c.is_multi(70'000U));
+  EXPECT_TRUE(c.is_multi(far));
+  EXPECT_FALSE(c.is_multi(far + 1U));
+  EXPECT_FALSE(c.is_multi(far * 2U));
+  EXPECT_FALSE(c.is_multi(multi_counter::kMaxSize));
+  EXPECT_ANY_THROW(c.increment(multi_counter::kMaxSize));
+  EXPECT_EQ(far + 1U, c.size());
+
+  auto multi = std::vector<std::uint64_t>{};
+  c.for_each_multi([&](std::uint64_t const i) { multi.push_back(i); });
+  EXPECT_EQ((std::vector<std::uint64_t>{7U, 70'000U, far}), multi);
+}
+
+TEST(multi_counter, concurrent_increments) {
+  // Crosses a directory boundary, so directories and pages are allocated
+  // concurrently.
+  auto const first = (std::uint64_t{1U} << 32U) - 500'000U;
+  auto c = multi_counter{};
+  auto threads = std::vector<std::thread>{};
+  for (auto t = 0U; t != 4U; ++t) {
+    threads.emplace_back([&, t]() {
+      for (auto i = std::uint64_t{0U}; i != 1'000'000U; ++i) {
+        if (i % 4U == t || i % 2U == 0U) {
+          c.increment(first + i);
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  auto n_multi = 0U;
+  c.for_each_multi([&](std::uint64_t const i) {
+    EXPECT_EQ(0U, i % 2U);
+    ++n_multi;
+  });
+  EXPECT_EQ(500'000U, n_multi);
+}
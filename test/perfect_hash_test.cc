@@ -0,0 +1,34 @@
+#include "gtest/gtest.h"
+
+#include "osr/extract/tags.h"
+#include "osr/util/perfect_hash.h"
+
+using namespace osr;
+
+TEST(perfect_hash, tag_tables) {
+  for (auto const& [key, id] : kTagKeys.entries_) {
+    EXPECT_EQ(id, kTagKeys.find(key)) << key;
+  }
+  for (auto const& [value, id] : kTagValues.entries_) {
+    EXPECT_EQ(id, kTagValues.find(value)) << value;
+  }
+
+  // Same length and first, middle and last character as known keys.
+  EXPECT_EQ(tag_key::kUnknown, kTagKeys.find("rump"));
+  EXPECT_EQ(tag_key::kUnknown, kTagKeys.find("oneway:bxs"));
+  EXPECT_EQ(tag_key::kUnknown, kTagKeys.find(""));
+  EXPECT_EQ(tag_key::kUnknown, kTagKeys.find("highway "));
+  EXPECT_EQ(tag_value::kUnknown, kTagValues.find("maybe"));
+}
+
+TEST(perfect_hash, constexpr_lookup) {
+  enum class color : std::uint8_t { kUnknown, kRed, kGreen, kBlue };
+  constexpr auto const kColors = perfect_hash_map<color, 3U>{{{
+      {"red", color::kRed},
+      {"green", color::kGreen},
+      {"blue", color::kBlue},
+  }}};
+  static_assert(kColors.find("green") == color::kGreen);
+  static_assert(kColors.find("yellow") == color::kUnknown);
+  EXPECT_EQ(color::kBlue, kColors.find(std::string_view{"blue"}));
+}
@@ -0,0 +1,175 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "boost/json.hpp"
+
+#include "geo/latlng.h"
+
+#include "osr/location.h"
+#include "osr/route_encoding.h"
+#include "osr/routing/route.h"
+
+#include "test_extract.h"
+
+using namespace osr;
+
+TEST(route_encoding, google_reference) {
+  auto const line = std::vector<geo::latlng>{
+      {38.5, -120.2}, {40.7, -120.95}, {43.252, -126.453}};
+  auto const encoded = encode_polyline(line);
+  EXPECT_EQ("_p~iF~ps|U_ulLnnqC_mqNvxq`@", encoded);
+
+  auto const decoded = decode_polyline(encoded);
+  ASSERT_EQ(line.size(), decoded.size());
+  for (auto i = 0U; i != line.size(); ++i) {
+    EXPECT_NEAR(line[i].lat_, decoded[i].lat_, 1e-5);
+    EXPECT_NEAR(line[i].lng_, decoded[i].lng_, 1e-5);
+  }
+}
+
+TEST(route_encoding, fixed_point) {
+  // point stores longitude in lat_ and latitude in lng_ (osmium x/y).
+  auto const p = point::from_latlng({49.8727447, 8.6515174});
+  auto const f = to_fixed(p);
+  EXPECT_EQ(498727447, f.lat_);
+  EXPECT_EQ(86515174, f.lng_);
+
+  auto const via_latlng = to_fixed(p.as_latlng());
+  EXPECT_EQ(f.lat_, via_latlng.lat_);
+  EXPECT_EQ(f.lng_, via_latlng.lng_);
+
+  EXPECT_EQ(encode_polyline(std::vector{p}, 6U),
+            encode_polyline(std::vector{p.as_latlng()}, 6U));
+
+  auto const decoded = decode_polyline(encode_polyline(std::vector{p}, 6U), 6U);
+  ASSERT_EQ(1U, decoded.size());
+  EXPECT_NEAR(49.872745, decoded[0].lat_, 1e-9);
+  EXPECT_NEAR(8.651517, decoded[0].lng_, 1e-9);
+}
+
+namespace {
+
+std::optional<path> luisenplatz_route() {
+  auto const& w = luisenplatz().w_;
+  auto const& l = luisenplatz().l_;
+  return route(get_parameters(search_profile::kFoot), w, l,
+               search_profile::kFoot,
+               location{49.872715, 8.651534, level_t{0.F}},
+               location{49.874120, 8.655120, level_t{0.F}}, 900,
+               direction::kForward, 250.0);
+}
+
+std::uint64_t get_osm_way_id(ways const& w, path::segment const& s) {
+  return s.way_ == way_idx_t::invalid() ? 0U : to_idx(w.way_osm_idx_[s.way_]);
+}
+
+struct binary_reader {
+  std::uint64_t varint() {
+    auto x = std::uint64_t{0U};
+    for (auto shift = 0U;; shift += 7U) {
+      EXPECT_LT(i_, in_.size());
+      auto const b = static_cast<std::uint8_t>(in_.at(i_++));
+      x |= static_cast<std::uint64_t>(b & 0x7FU) << shift;
+      if ((b & 0x80U) == 0U) {
+        return x;
+      }
+    }
+  }
+
+  std::int64_t zigzag() {
+    auto const x = varint();
+    return static_cast<std::int64_t>(x >> 1U) ^
+           -static_cast<std::int64_t>(x & 1U);
+  }
+
+  std::uint8_t byte() { return static_cast<std::uint8_t>(in_.at(i_++)); }
+
+  std::string_view in_;
+  std::size_t i_{0U};
+};
+
+}  // namespace
+
+TEST(route_encoding, binary_round_trip) {
+  auto const& w = luisenplatz().w_;
+  auto const p = luisenplatz_route();
+  ASSERT_TRUE(p.has_value());
+  ASSERT_FALSE(p->segments_.empty());
+
+  auto out = std::string{};
+  write_binary_route(out, w, *p);
+
+  auto r = binary_reader{.in_ = out};
+  EXPECT_EQ("OSR", out.substr(0U, 3U));
+  r.i_ = 3U;
+  EXPECT_EQ(1U, r.byte());
+  EXPECT_EQ(p->cost_, r.varint());
+  EXPECT_EQ(std::llround(p->dist_), r.varint());
+  ASSERT_EQ(p->segments_.size(), r.varint());
+
+  auto prev = fixed_coord{0, 0};
+  for (auto const& s : p->segments_) {
+    EXPECT_EQ(get_osm_way_id(w, s), r.varint());
+    EXPECT_EQ(s.cost_, r.varint());
+    EXPECT_EQ(s.dist_, r.varint());
+    EXPECT_EQ(to_idx(s.from_level_), r.byte());
+    EXPECT_EQ(static_cast<std::uint8_t>(s.mode_), r.byte());
+    ASSERT_EQ(s.polyline_.size(), r.varint());
+    for (auto const& x : s.polyline_) {
+      auto const c = fixed_coord{
+          static_cast<std::int32_t>(prev.lat_ + r.zigzag()),
+          static_cast<std::int32_t>(prev.lng_ + r.zigzag())};
+      EXPECT_EQ(to_fixed(x).lat_, c.lat_);
+      EXPECT_EQ(to_fixed(x).lng_, c.lng_);
+      EXPECT_NEAR(x.lat_, c.lat_ / 1e7, 1e-7);
+      EXPECT_NEAR(x.lng_, c.lng_ / 1e7, 1e-7);
+      prev = c;
+    }
+  }
+  EXPECT_EQ(out.size(), r.i_);
+}
+
+TEST(route_encoding, encoded_polyline_round_trip) {
+  auto const& w = luisenplatz().w_;
+  auto const p = luisenplatz_route();
+  ASSERT_TRUE(p.has_value());
+
+  for (auto const precision : {5U, 6U}) {
+    auto out = std::string{};
+    write_encoded_polyline_route(out, w, *p, precision);
+
+    auto const json = boost::json::parse(out).as_object();
+    auto const& metadata = json.at("metadata").as_object();
+    EXPECT_EQ(p->cost_, metadata.at("duration").to_number<cost_t>());
+    EXPECT_DOUBLE_EQ(p->dist_, metadata.at("distance").to_number<double>());
+    EXPECT_EQ(precision, json.at("precision").to_number<unsigned>());
+
+    auto const& segments = json.at("segments").as_array();
+    ASSERT_EQ(p->segments_.size(), segments.size());
+    auto const max_error = 0.5 / std::pow(10.0, precision) + 1e-7;
+    for (auto i = 0U; i != segments.size(); ++i) {
+      auto const& expected = p->segments_[i];
+      auto const& s = segments[i].as_object();
+      EXPECT_EQ(expected.from_level_.to_float(),
+                s.at("level").to_number<float>());
+      EXPECT_EQ(get_osm_way_id(w, expected),
+                s.at("osm_way_id").to_number<std::uint64_t>());
+      EXPECT_EQ(expected.cost_, s.at("cost").to_number<cost_t>());
+      EXPECT_EQ(expected.dist_, s.at("distance").to_number<distance_t>());
+
+      auto const line =
+          decode_polyline(s.at("polyline").as_string(), precision);
+      ASSERT_EQ(expected.polyline_.size(), line.size());
+      for (auto j = 0U; j != line.size(); ++j) {
+        EXPECT_NEAR(expected.polyline_[j].lat_, line[j].lat_, max_error);
+        EXPECT_NEAR(expected.polyline_[j].lng_, line[j].lng_, max_error);
+      }
+    }
+  }
+}
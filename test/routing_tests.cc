@@ -1,4 +1,5 @@
 #include <filesystem>
+#include <limits>
 
 #include "gtest/gtest.h"
 #include "osr/geojson.h"
@@ -6,9 +7,13 @@
 #include "osr/extract/extract.h"
 #include "osr/lookup.h"
 #include "osr/routing/profiles/foot.h"
+#include "osr/routing/cancellation.h"
 #include "osr/routing/route.h"
+#include "osr/routing/search_stats.h"
 #include "osr/ways.h"
 
+#include "test_extract.h"
+
 namespace fs = std::filesystem;
 
 std::string extract_and_route(
@@ -201,3 +206,196 @@ TEST(routing, bus_platform) {
       R"({"type":"FeatureCollection","metadata":{},"features":[{"type":"Feature","properties":{"level":0E0,"osm_way_id":0,"cost":0,"distance":1},"geometry":{"type":"LineString","coordinates":[[8.647215893993957E0,4.987558480274741E1],[8.6472223E0,4.98755857E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551411,"cost":0,"distance":6},"geometry":{"type":"LineString","coordinates":[[8.6472223E0,4.98755857E1],[8.6473042E0,4.98755972E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551411,"cost":1,"distance":11},"geometry":{"type":"LineString","coordinates":[[8.6473042E0,4.98755972E1],[8.6473987E0,4.98756104E1],[8.6474599E0,4.98756205E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551411,"cost":0,"distance":8},"geometry":{"type":"LineString","coordinates":[[8.6474599E0,4.98756205E1],[8.647511E0,4.98756289E1],[8.6475641E0,4.98756376E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551411,"cost":1,"distance":17},"geometry":{"type":"LineString","coordinates":[[8.6475641E0,4.98756376E1],[8.6477018E0,4.98756603E1],[8.6477364E0,4.98756669E1],[8.6477912E0,4.98756773E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551413,"cost":1,"distance":15},"geometry":{"type":"LineString","coordinates":[[8.6477912E0,4.98756773E1],[8.6479897E0,4.98757129E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551413,"cost":1,"distance":15},"geometry":{"type":"LineString","coordinates":[[8.6479897E0,4.98757129E1],[8.6480341E0,4.9875721E1],[8.64819E0,4.98757429E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551413,"cost":1,"distance":12},"geometry":{"type":"LineString","coordinates":[[8.64819E0,4.98757429E1],[8.6483493E0,4.98757643E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551413,"cost":0,"distance":5},"geometry":{"type":"LineString","coordinates":[[8.6483493E0,4.98757643E1],[8.6484161E0,4.9875773E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551412,"cost":1,"distance":14},"geometry":{"type":"LineString","coordinates":[[8.6484161E0,4.9875773E1],[8.648613E0,4.9875798E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551412,"cost":1,"distance":20},"geometry":{"type":"LineString","coordinates":[[8.648613E0,4.9875798E1],[8.6488875E0,4.9875833E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551412,"cost":0,"distance":4},"geometry":{"type":"LineString","coordinates":[[8.6488875E0,4.9875833E1],[8.648948E0,4.98758407E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551412,"cost":1,"distance":8},"geometry":{"type":"LineString","coordinates":[[8.648948E0,4.98758407E1],[8.6490562E0,4.98758544E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551422,"cost":3,"distance":41},"geometry":{"type":"LineString","coordinates":[[8.6490562E0,4.98758544E1],[8.6495122E0,4.98759191E1],[8.6496122E0,4.9875934E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551422,"cost":1,"distance":10},"geometry":{"type":"LineString","coordinates":[[8.6496122E0,4.9875934E1],[8.6497483E0,4.9875948E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551417,"cost":1,"distance":9},"geometry":{"type":"LineString","coordinates":[[8.6497483E0,4.9875948E1],[8.6498691E0,4.9875976E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551417,"cost":1,"distance":17},"geometry":{"type":"LineString","coordinates":[[8.6498691E0,4.9875976E1],[8.6500904E0,4.98760396E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551418,"cost":1,"distance":9},"geometry":{"type":"LineString","coordinates":[[8.6500904E0,4.98760396E1],[8.6502086E0,4.98760764E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":1201551418,"cost":1,"distance":11},"geometry":{"type":"LineString","coordinates":[[8.6502086E0,4.98760764E1],[8.6502881E0,4.9876129E1],[8.6503107E0,4.98761538E1]]}},{"type":"Feature","properties":{"level":0E0,"osm_way_id":0,"cost":0,"distance":0},"geometry":{"type":"LineString","coordinates":[[8.6503107E0,4.98761538E1],[8.650311050022971E0,4.98761541839459E1]]}}]})", extract_and_route(
                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                 "test/darmstadt-bismarckstr.osm.pbf", from, to, osr::bus::parameters{}, osr::search_profile::kBus));
 }
+
+TEST(routing, search_stats) {
+  auto const& w = osr::luisenplatz().w_;
+  auto const& l = osr::luisenplatz().l_;
+
+  auto const params = osr::foot<false, osr::elevator_tracking>::parameters{};
+  auto const from = osr::location{49.872715, 8.651534, osr::level_t{0.F}};
+  auto const to = osr::location{49.874120, 8.655120, osr::level_t{0.F}};
+
+  for (auto const algo : {osr::routing_algorithm::kDijkstra,
+                          osr::routing_algorithm::kAStarBi}) {
+    auto const expected =
+        osr::route(params, w, l, osr::search_profile::kFoot, from, to, 900,
+                   osr::direction::kForward, 250.0, nullptr, nullptr, nullptr,
+                   algo);
+    auto stats = osr::search_stats{};
+    auto const p = osr::route(params, w, l, osr::search_profile::kFoot, from,
+                              to, 900, osr::direction::kForward, 250.0, nullptr,
+                              nullptr, nullptr, algo, nullptr, &stats);
+    ASSERT_TRUE(expected.has_value());
+    ASSERT_TRUE(p.has_value());
+    EXPECT_EQ(expected->cost_, p->cost_);
+    EXPECT_GT(stats.n_popped_, 0U);
+    EXPECT_GT(stats.n_pushed_, 0U);
+    EXPECT_LE(stats.n_adjacent_calls_, stats.n_popped_);
+    EXPECT_GE(stats.n_buckets_scanned_, stats.n_popped_);
+    EXPECT_GT(stats.cost_map_size_, 0U);
+  }
+}
+
+TEST(routing, cancelled) {
+  auto const& w = osr::luisenplatz().w_;
+  auto const& l = osr::luisenplatz().l_;
+
+  auto const params = osr::foot<false, osr::elevator_tracking>::parameters{};
+  auto const from = osr::location{49.872715, 8.651534, osr::level_t{0.F}};
+  auto const to = osr::location{49.874120, 8.655120, osr::level_t{0.F}};
+
+  auto cancel = osr::cancellation_token{};
+  cancel.cancel();
+  for (auto const algo : {osr::routing_algorithm::kDijkstra,
+                          osr::routing_algorithm::kAStarBi,
+                          osr::routing_algorithm::kAStarBiParallel}) {
+    EXPECT_THROW(osr::route(params, w, l, osr::search_profile::kFoot, from, to,
+                            900, osr::direction::kForward, 250.0, nullptr,
+                            nullptr, nullptr, algo, nullptr, nullptr, &cancel),
+                 osr::search_cancelled);
+  }
+
+  auto const expired = osr::cancellation_token::with_timeout(
+      std::chrono::steady_clock::duration{0});
+  EXPECT_THROW(osr::route(params, w, l, osr::search_profile::kFoot, from, to,
+                          900, osr::direction::kForward, 250.0, nullptr,
+                          nullptr, nullptr, osr::routing_algorithm::kDijkstra,
+                          nullptr, nullptr, &expired),
+               osr::search_cancelled);
+
+  auto const generous =
+      osr::cancellation_token::with_timeout(std::chrono::minutes{10});
+  EXPECT_TRUE(osr::route(params, w, l, osr::search_profile::kFoot, from, to,
+                         900, osr::direction::kForward, 250.0, nullptr,
+                         nullptr, nullptr, osr::routing_algorithm::kDijkstra,
+                         nullptr, nullptr, &generous)
+                  .has_value());
+}
+
+namespace {
+
+// Structural equality with all numbers compared as doubles: the DOM writes
+// 0E0 where the streaming writer writes 0.
+void expect_json_eq(boost::json::value const& a, boost::json::value const& b) {
+  if (a.is_number() && b.is_number()) {
+    EXPECT_DOUBLE_EQ(a.to_number<double>(), b.to_number<double>());
+  } else if (a.is_object() && b.is_object()) {
+    ASSERT_EQ(a.as_object().size(), b.as_object().size());
+    for (auto const& [k, v] : a.as_object()) {
+      ASSERT_TRUE(b.as_object().contains(k)) << k;
+      expect_json_eq(v, b.as_object().at(k));
+    }
+  } else if (a.is_array() && b.is_array()) {
+    ASSERT_EQ(a.as_array().size(), b.as_array().size());
+    for (auto i = 0U; i != a.as_array().size(); ++i) {
+      expect_json_eq(a.as_array()[i], b.as_array()[i]);
+    }
+  } else {
+    EXPECT_EQ(a, b);
+  }
+}
+
+}  // namespace
+
+TEST(routing, streaming_featurecollection) {
+  auto const& w = osr::luisenplatz().w_;
+  auto const& l = osr::luisenplatz().l_;
+
+  auto const params = osr::foot<false, osr::elevator_tracking>::parameters{};
+  auto const from = osr::location{49.872715, 8.651534, osr::level_t{0.F}};
+  auto const to = osr::location{49.874120, 8.655120, osr::level_t{0.F}};
+
+  auto stats = osr::search_stats{};
+  auto const p =
+      osr::route(params, w, l, osr::search_profile::kFoot, from, to, 900,
+                 osr::direction::kForward, 250.0, nullptr, nullptr, nullptr,
+                 osr::routing_algorithm::kDijkstra, nullptr, &stats);
+  ASSERT_TRUE(p.has_value());
+
+  for (auto const with_properties : {true, false}) {
+    for (auto const s : {&stats, static_cast<osr::search_stats*>(nullptr)}) {
+      expect_json_eq(
+          boost::json::parse(
+              osr::to_featurecollection(w, p, with_properties, s)),
+          boost::json::parse(
+              osr::to_featurecollection_stream(w, *p, with_properties, s)));
+    }
+  }
+
+  auto escaped = std::string{};
+  osr::json_writer{escaped}.begin_array().value("a\"b\\c\n\x01").end_array();
+  EXPECT_EQ(R"(["a\"b\\c\n\u0001"])", escaped);
+
+  auto non_finite = std::string{};
+  osr::json_writer{non_finite}
+      .begin_array()
+      .value(std::numeric_limits<double>::quiet_NaN())
+      .value(std::numeric_limits<double>::infinity())
+      .value(-std::numeric_limits<float>::infinity())
+      .value(1.5)
+      .coordinate(geo::latlng{std::numeric_limits<double>::quiet_NaN(), 8.5})
+      .end_array();
+  EXPECT_EQ("[null,null,null,1.5,[8.5,null]]", non_finite);
+  EXPECT_NO_THROW(boost::json::parse(non_finite));
+}
+
+TEST(routing, stored_connections) {
+  using profile_t = osr::foot<false, osr::elevator_tracking>;
+
+  auto const& w = osr::luisenplatz().w_;
+  auto const& l = osr::luisenplatz().l_;
+
+  auto const params = profile_t::parameters{};
+  auto const from = osr::location{49.872715, 8.651534, osr::level_t{0.F}};
+  auto const to = osr::location{49.874120, 8.655120, osr::level_t{0.F}};
+  auto const search = [&]() {
+    auto const p = osr::route(params, w, l, osr::search_profile::kFoot, from,
+                              to, 900, osr::direction::kForward, 250.0);
+    EXPECT_TRUE(p.has_value());
+    return p.has_value() ? osr::to_featurecollection(w, p) : std::string{};
+  };
+
+  auto const expected = search();
+  osr::set_store_connections(true);
+  auto const actual = search();
+  EXPECT_FALSE(osr::get_dijkstra<profile_t>().connections_.empty());
+  osr::set_store_connections(false);
+  EXPECT_EQ(expected, actual);
+}
+
+TEST(routing, path_arena) {
+  auto const& w = osr::luisenplatz().w_;
+  auto const& l = osr::luisenplatz().l_;
+
+  auto const params = osr::get_parameters(osr::search_profile::kFoot);
+  auto const from = osr::location{49.872715, 8.651534, osr::level_t{0.F}};
+  auto const to = std::vector<osr::location>{
+      {49.874120, 8.655120, osr::level_t{0.F}},
+      {49.873000, 8.653000, osr::level_t{0.F}},
+      from};
+  auto const reconstruct_all = [](osr::path const&) { return true; };
+
+  auto const expected =
+      osr::route(params, w, l, osr::search_profile::kFoot, from, to, 900,
+                 osr::direction::kForward, 250.0, nullptr, nullptr, nullptr,
+                 reconstruct_all);
+
+  auto& arena = osr::get_thread_local_path_arena();
+  arena.clear();
+  auto const actual =
+      osr::route(params, w, l, osr::search_profile::kFoot, from, to, 900,
+                 osr::direction::kForward, 250.0, arena, nullptr, nullptr,
+                 nullptr, reconstruct_all);
+
+  ASSERT_EQ(expected.size(), actual.size());
+  for (auto i = 0U; i != expected.size(); ++i) {
+    auto const& e = expected[i];
+    auto const& a = actual[i];
+    ASSERT_EQ(e.has_value(), a.has_value());
+    if (e.has_value()) {
+      EXPECT_EQ(e->cost_, a->cost_);
+      EXPECT_EQ(osr::to_featurecollection(w, e),
+                osr::to_featurecollection(w, arena.to_path(*a)));
+    }
+  }
+}
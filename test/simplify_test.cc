@@ -0,0 +1,47 @@
+#include "gtest/gtest.h"
+
+#include "osr/routing/simplify.h"
+
+using namespace osr;
+
+TEST(simplify, douglas_peucker) {
+  // ~11m per 1e-4 degrees latitude.
+  auto straight = geo::polyline{
+      {49.0, 8.0}, {49.0001, 8.0}, {49.0002, 8.0}, {49.0003, 8.0}};
+  simplify(straight, 1.0);
+  EXPECT_EQ((geo::polyline{{49.0, 8.0}, {49.0003, 8.0}}), straight);
+
+  // The bend of ~7m survives 1m tolerance but not 10m, the points between
+  // are on the simplified line.
+  auto const bent = geo::polyline{{49.0, 8.0},
+                                  {49.0001, 8.00005},
+                                  {49.0002, 8.0001},
+                                  {49.0003, 8.00005},
+                                  {49.0004, 8.0}};
+  auto fine = bent;
+  simplify(fine, 1.0);
+  EXPECT_EQ((geo::polyline{{49.0, 8.0}, {49.0002, 8.0001}, {49.0004, 8.0}}),
+            fine);
+  auto coarse = bent;
+  simplify(coarse, 10.0);
+  EXPECT_EQ((geo::polyline{{49.0, 8.0}, {49.0004, 8.0}}), coarse);
+}
+
+TEST(simplify, keeps_segments) {
+  auto p = path{};
+  p.segments_.push_back(path::segment{
+      .polyline_ = {{49.0, 8.0}, {49.0001, 8.0}, {49.0002, 8.0}},
+      .from_level_ = level_t{0.F},
+      .to_level_ = level_t{0.F}});
+  p.segments_.push_back(path::segment{
+      .polyline_ = {{49.0002, 8.0}, {49.0002, 8.0001}},
+      .from_level_ = level_t{1.F},
+      .to_level_ = level_t{1.F}});
+  simplify(p, 5.0);
+  ASSERT_EQ(2U, p.segments_.size());
+  EXPECT_EQ((geo::polyline{{49.0, 8.0}, {49.0002, 8.0}}),
+            p.segments_[0].polyline_);
+  EXPECT_EQ((geo::polyline{{49.0002, 8.0}, {49.0002, 8.0001}}),
+            p.segments_[1].polyline_);
+  EXPECT_EQ(level_t{1.F}, p.segments_[1].from_level_);
+}
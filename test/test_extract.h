@@ -0,0 +1,73 @@
+#pragma once
+
+#include <filesystem>
+#include <system_error>
+
+#include "gtest/gtest.h"
+
+#include "cista/mmap.h"
+
+#include "osr/extract/extract.h"
+#include "osr/lookup.h"
+#include "osr/routing/dijkstra.h"
+#include "osr/routing/profile.h"
+#include "osr/types.h"
+#include "osr/ways.h"
+
+namespace osr {
+
+// Extract of an OSM file into a fresh directory below the temp directory,
+// opened read-only.
+struct test_extract {
+  explicit test_extract(std::filesystem::path const& osm_path)
+      : dir_{prepare(osm_path)},
+        w_{dir_, cista::mmap::protection::READ},
+        l_{w_, dir_, cista::mmap::protection::READ} {}
+
+  static std::filesystem::path prepare(std::filesystem::path const& osm_path) {
+    auto const dir =
+        std::filesystem::temp_directory_path() / "osr_test_extract" /
+        osm_path.stem();
+    auto ec = std::error_code{};
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir, ec);
+    extract(false, osm_path, dir, {});
+    return dir;
+  }
+
+  std::filesystem::path dir_;
+  ways w_;
+  lookup l_;
+};
+
+// Shared by all tests that only read it, extracted on first use.
+inline test_extract const& luisenplatz() {
+  static auto const data = test_extract{"test/luisenplatz-darmstadt.osm.pbf"};
+  return data;
+}
+
+// Runs dijkstra<P> from all nodes of start and expects the same costs for
+// every node as in the finished search `actual` started there.
+template <Profile P, typename Search>
+void compare_with_dijkstra(ways const& w,
+                           direction const dir,
+                           cost_t const max,
+                           node_idx_t const start,
+                           Search const& actual) {
+  auto const params = typename P::parameters{};
+  auto d = dijkstra<P>{};
+  d.reset(max);
+  P::resolve_all(*w.r_, start, kNoLevel, [&](typename P::node const n) {
+    d.add_start(w, typename P::label{n, 0U});
+  });
+  d.run(params, w, *w.r_, max, nullptr, nullptr, nullptr, dir);
+
+  EXPECT_EQ(d.max_reached_, actual.max_reached_);
+  for (auto n = node_idx_t{0U}; n != w.n_nodes(); ++n) {
+    P::resolve_all(*w.r_, n, kNoLevel, [&](typename P::node const x) {
+      EXPECT_EQ(d.get_cost(x), actual.get_cost(x));
+    });
+  }
+}
+
+}  // namespace osr
@@ -0,0 +1,127 @@
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "geo/latlng.h"
+
+#include "osr/preprocessing/elevation/provider.h"
+#include "osr/preprocessing/elevation/tiff_driver.h"
+
+using namespace osr::preprocessing::elevation;
+
+namespace {
+
+// See test/tiff_test_elevation/create_data.py
+constexpr auto const kWidth = 40;
+constexpr auto const kHeight = 36;
+constexpr auto const kDim = 0.001;
+
+geo::latlng pixel_center(int const x, int const y) {
+  return {50.0 - (y + 0.5) * kDim, 8.0 + (x + 0.5) * kDim};
+}
+
+elevation_meters_t expected(int const x, int const y) {
+  return x == kWidth - 1 && y == kHeight - 1
+             ? elevation_meters_t::invalid()
+             : elevation_meters_t{static_cast<std::int16_t>(100 + 3 * x +
+                                                            7 * y)};
+}
+
+std::vector<geo::latlng> all_pixels() {
+  auto pos = std::vector<geo::latlng>{};
+  for (auto y = 0; y != kHeight; ++y) {
+    for (auto x = 0; x != kWidth; ++x) {
+      pos.push_back(pixel_center(x, y));
+    }
+  }
+  return pos;
+}
+
+}  // namespace
+
+TEST(tiff_driver, full_resolution) {
+  auto d = tiff_driver{};
+  ASSERT_TRUE(d.add_tile("test/tiff_test_elevation/elevations.tif"));
+  ASSERT_EQ(2U, d.tiles_.front().n_levels());
+  EXPECT_DOUBLE_EQ(kDim, d.max_resolution().x_);
+
+  auto const pos = all_pixels();
+  auto out = std::vector<elevation_meters_t>(pos.size(),
+                                             elevation_meters_t::invalid());
+  d.get(pos, out);
+  for (auto y = 0; y != kHeight; ++y) {
+    for (auto x = 0; x != kWidth; ++x) {
+      EXPECT_EQ(expected(x, y), out[y * kWidth + x]);
+      EXPECT_EQ(expected(x, y), d.get(pixel_center(x, y)));
+    }
+  }
+  EXPECT_EQ(9U, d.blocks_->n_decoded());
+
+  EXPECT_EQ(elevation_meters_t::invalid(), d.get({49.9, 8.01}));
+  EXPECT_EQ(tile_idx_t::invalid(), d.tile_idx({49.9, 8.01}));
+  EXPECT_NE(d.tile_idx(pixel_center(0, 0)), d.tile_idx(pixel_center(39, 35)));
+}
+
+TEST(tiff_driver, overview) {
+  auto d = tiff_driver{};
+  ASSERT_TRUE(d.add_tile("test/tiff_test_elevation/elevations.tif"));
+
+  auto const pos = all_pixels();
+  auto out = std::vector<elevation_meters_t>(pos.size(),
+                                             elevation_meters_t::invalid());
+
+  // Finer than the overview: full resolution
+  d.get(pos, out, {.x_ = 0.0015, .y_ = 0.0015});
+  EXPECT_EQ(expected(5, 7), out[7 * kWidth + 5]);
+
+  std::ranges::fill(out, elevation_meters_t::invalid());
+  auto coarse = tiff_driver{};
+  coarse.add_tile("test/tiff_test_elevation/elevations.tif");
+  coarse.get(pos, out, {.x_ = 0.002, .y_ = 0.002});
+  for (auto y = 0; y != kHeight; ++y) {
+    for (auto x = 0; x != kWidth; ++x) {
+      auto const ov_x = x / 2;
+      auto const ov_y = y / 2;
+      auto const nodata = ov_x == kWidth / 2 - 1 && ov_y == kHeight / 2 - 1;
+      EXPECT_EQ(nodata ? elevation_meters_t::invalid()
+                       : expected(2 * ov_x, 2 * ov_y),
+                out[y * kWidth + x]);
+    }
+  }
+  EXPECT_EQ(4U, coarse.blocks_->n_decoded());
+}
+
+TEST(tiff_driver, provider) {
+  auto const p = provider{"test/tiff_test_elevation/"};
+  ASSERT_EQ(1U, p.driver_count());
+  EXPECT_EQ(expected(12, 20), p.get(pixel_center(12, 20)));
+
+  auto const pos = all_pixels();
+  auto out = std::vector<elevation_meters_t>(pos.size());
+  p.get(pos, out, {.x_ = 0.01, .y_ = 0.01});
+  EXPECT_EQ(expected(12, 20), out[20 * kWidth + 12]);
+}
+
+TEST(tiff_driver, skips_unsupported_files) {
+  namespace fs = std::filesystem;
+  auto const dir = fs::temp_directory_path() / "osr_tiff_driver_test";
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  std::ofstream{dir / "broken.tif"} << "II*";
+  fs::copy_file("test/tiff_test_elevation/elevations.tif",
+                dir / "elevations.tif");
+
+  auto d = tiff_driver{};
+  EXPECT_FALSE(d.add_tile(dir / "broken.tif"));
+  EXPECT_TRUE(d.add_tile(dir / "elevations.tif"));
+  EXPECT_EQ(1U, d.n_tiles());
+  EXPECT_EQ(expected(3, 4), d.get(pixel_center(3, 4)));
+
+  auto const p = provider{dir};
+  EXPECT_EQ(1U, p.driver_count());
+  EXPECT_EQ(expected(3, 4), p.get(pixel_center(3, 4)));
+
+  fs::remove_all(dir);
+}
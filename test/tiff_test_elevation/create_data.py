@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+#-*- coding: utf8 -*-
+
+# Writes a tiled, DEFLATE compressed GeoTIFF (horizontal predictor) with one
+# overview, laid out like a cloud optimized GeoTIFF.
+#
+# Full resolution: 40x36 pixels, 16x16 tiles, value(x, y) = BASE + 3x + 7y
+# Overview:        20x18 pixels, 16x16 tiles, value(x, y) = full(2x, 2y)
+# The bottom right pixel of both images is NODATA.
+
+import struct
+import sys
+import zlib
+
+BASE = 100
+NODATA = -32767
+WIDTH = 40
+HEIGHT = 36
+TILE = 16
+ULX = 8.0
+ULY = 50.0
+DIM = 0.001
+
+SHORT = 3
+LONG = 4
+DOUBLE = 12
+ASCII = 2
+
+
+def main():
+    full = [[BASE + 3 * x + 7 * y for x in range(WIDTH)] for y in range(HEIGHT)]
+    full[HEIGHT - 1][WIDTH - 1] = NODATA
+    overview = [row[::2] for row in full[::2]]
+    overview[-1][-1] = NODATA
+
+    geo = [
+        (33550, DOUBLE, [DIM, DIM, 0.0]),
+        (33922, DOUBLE, [0.0, 0.0, 0.0, ULX, ULY, 0.0]),
+        # GTModelType = geographic, GTRasterType = PixelIsArea, WGS 84
+        (34735, SHORT, [1, 1, 0, 3, 1024, 0, 1, 2, 1025, 0, 1, 1, 2048, 0, 1, 4326]),
+        (42113, ASCII, f'{NODATA}'),
+    ]
+    save('elevations.tif', [(0, full, geo), (1, overview, [])])
+
+
+def encode_tile(grid, tx, ty):
+    data = bytearray()
+    for y in range(ty * TILE, (ty + 1) * TILE):
+        prev = 0
+        for x in range(tx * TILE, (tx + 1) * TILE):
+            inside = y < len(grid) and x < len(grid[0])
+            value = grid[y][x] if inside else 0
+            # Horizontal predictor: difference to the left neighbour
+            data += struct.pack('<H', (value - prev) & 0xFFFF)
+            prev = value
+    return zlib.compress(bytes(data))
+
+
+def save(path, images):
+    ifds = []
+    for subfile, grid, extra in images:
+        height = len(grid)
+        width = len(grid[0])
+        tiles = [encode_tile(grid, tx, ty)
+                 for ty in range((height + TILE - 1) // TILE)
+                 for tx in range((width + TILE - 1) // TILE)]
+        tags = [
+            (254, LONG, [subfile]),
+            (256, LONG, [width]),
+            (257, LONG, [height]),
+            (258, SHORT, [16]),
+            (259, SHORT, [8]),  # DEFLATE
+            (277, SHORT, [1]),
+            (317, SHORT, [2]),  # Horizontal predictor
+            (322, SHORT, [TILE]),
+            (323, SHORT, [TILE]),
+            (324, LONG, [0] * len(tiles)),
+            (325, LONG, [len(t) for t in tiles]),
+            (339, SHORT, [2]),  # Signed integer
+        ] + extra
+        ifds.append((sorted(tags, key=lambda t: t[0]), tiles))
+
+    def value_bytes(type, values):
+        if type == ASCII:
+            return values.encode() + b'\0'
+        fmt = {SHORT: 'H', LONG: 'I', DOUBLE: 'd'}[type]
+        return struct.pack(f'<{len(values)}{fmt}', *values)
+
+    # Directories first, tile data last
+    offset = 8
+    layout = []
+    for tags, tiles in ifds:
+        ifd_offset = offset
+        offset += 2 + 12 * len(tags) + 4
+        data_offsets = {}
+        for tag, type, values in tags:
+            size = len(value_bytes(type, values))
+            if size > 4:
+                data_offsets[tag] = offset
+                offset += size + size % 2
+        layout.append((ifd_offset, data_offsets))
+    for i, (tags, tiles) in enumerate(ifds):
+        tile_offsets = []
+        for t in tiles:
+            tile_offsets.append(offset)
+            offset += len(t)
+        ifds[i] = ([(tag, type, tile_offsets if tag == 324 else values)
+                    for tag, type, values in tags], tiles)
+
+    out = bytearray(b'II' + struct.pack('<HI', 42, layout[0][0]))
+    for i, ((tags, tiles), (ifd_offset, data_offsets)) in enumerate(zip(ifds, layout)):
+        assert len(out) == ifd_offset
+        next_ifd = layout[i + 1][0] if i + 1 < len(layout) else 0
+        out += struct.pack('<H', len(tags))
+        for tag, type, values in tags:
+            data = value_bytes(type, values)
+            count = len(data) if type == ASCII else len(values)
+            value = struct.pack('<I', data_offsets[tag]) if tag in data_offsets \
+                else data.ljust(4, b'\0')
+            out += struct.pack('<HHI', tag, type, count) + value
+        out += struct.pack('<I', next_ifd)
+        for tag, type, values in tags:
+            if tag in data_offsets:
+                assert len(out) == data_offsets[tag]
+                data = value_bytes(type, values)
+                out += data + b'\0' * (len(data) % 2)
+    for tags, tiles in ifds:
+        for t in tiles:
+            out += t
+
+    with open(path, 'wb') as f:
+        f.write(out)
+
+
+if __name__ == '__main__':
+    main()
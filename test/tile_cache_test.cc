@@ -0,0 +1,70 @@
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "osr/preprocessing/elevation/tile_cache.h"
+
+namespace fs = std::filesystem;
+using namespace osr::preprocessing::elevation;
+
+TEST(tile_cache, bounded_lru) {
+  auto const dir = fs::temp_directory_path() / "osr_tile_cache_test";
+  fs::create_directories(dir);
+
+  auto c = tile_cache{2U};
+  auto handles = std::vector<tile_cache::handle>{};
+  for (auto i = 0U; i != 5U; ++i) {
+    auto const p = dir / ("tile_" + std::to_string(i));
+    std::ofstream{p} << static_cast<char>('a' + i);
+    handles.push_back(c.add(p));
+  }
+  EXPECT_EQ(5U, c.n_tiles());
+  EXPECT_EQ(0U, c.n_open());
+
+  for (auto round = 0U; round != 3U; ++round) {
+    for (auto i = 0U; i != handles.size(); ++i) {
+      EXPECT_EQ('a' + i, handles[i].get().data()[0]);
+      EXPECT_LE(c.n_open(), 2U);
+    }
+  }
+
+  auto threads = std::vector<std::thread>{};
+  auto errors = std::vector<unsigned>(4U, 0U);
+  for (auto t = 0U; t != 4U; ++t) {
+    threads.emplace_back([&, t]() {
+      for (auto k = 0U; k != 10'000U; ++k) {
+        auto const i = (k * 7U + t) % handles.size();
+        errors[t] += handles[i].get().data()[0] == 'a' + i ? 0U : 1U;
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ((std::vector<unsigned>(4U, 0U)), errors);
+  EXPECT_LE(c.n_open(), 2U);
+
+  fs::remove_all(dir);
+}
+
+TEST(tile_cache, independent_instances) {
+  auto const dir = fs::temp_directory_path() / "osr_tile_cache_instances";
+  fs::create_directories(dir);
+  std::ofstream{dir / "a"} << 'a';
+  std::ofstream{dir / "b"} << 'b';
+
+  {
+    auto a = tile_cache{1U};
+    EXPECT_EQ('a', a.add(dir / "a").get().data()[0]);
+  }
+  auto b = tile_cache{1U};
+  auto const h = b.add(dir / "b");
+  EXPECT_EQ('b', h.get().data()[0]);
+  EXPECT_EQ(1U, b.n_open());
+
+  fs::remove_all(dir);
+}
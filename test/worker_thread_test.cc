@@ -0,0 +1,36 @@
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <thread>
+
+#include "osr/util/worker_thread.h"
+
+using namespace osr;
+
+TEST(worker_thread, reuses_thread) {
+  auto w = worker_thread{};
+  auto first = std::thread::id{};
+  w.start([&]() { first = std::this_thread::get_id(); });
+  w.wait();
+  EXPECT_NE(std::this_thread::get_id(), first);
+
+  for (auto i = 0U; i != 100U; ++i) {
+    auto id = std::thread::id{};
+    w.start([&]() { id = std::this_thread::get_id(); });
+    w.wait();
+    EXPECT_EQ(first, id);
+  }
+}
+
+TEST(worker_thread, rethrows_exceptions) {
+  auto w = worker_thread{};
+  w.start([]() { throw std::runtime_error{"fail"}; });
+  EXPECT_THROW(w.wait(), std::runtime_error);
+
+  auto ran = false;
+  w.start([&]() { ran = true; });
+  EXPECT_NO_THROW(w.wait());
+  EXPECT_TRUE(ran);
+}
+
+TEST(worker_thread, unused) { auto const w = worker_thread{}; }